@@ -0,0 +1,135 @@
+/**
+ * @file dirwd_ring.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog shared memory event ring
+ *
+ * Ring is a memory mapped file with a header followed by slot_count fixed
+ * size slots. Single producer publishes events with increasing sequence
+ * numbers starting from 1, event n is stored in slot n % slot_count.
+ * Any number of readers map the file read only and consume events without
+ * system calls.
+ *
+ * Every slot is guarded by a sequence counter: producer stores 2n - 1
+ * before writing event n and 2n after, then advances header head to n.
+ * Reader copies the slot and checks that the counter was 2n before and
+ * after the copy, otherwise the event was overwritten and the reader
+ * skips to the oldest event still in the ring (overrun).
+ *
+ * Producer restart continues the sequence of existing ring. Ring with other
+ * geometry is created as new file and renamed over the old one, the old
+ * ring is marked stale and readers must reopen the path. Sequence numbers
+ * are comparable only within one ring instance.
+ */
+
+#ifndef __DIRWD_RING_H__
+#define __DIRWD_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_RING_MAGIC   "DWRING01"
+#define DIRWD_RING_VERSION ((uint32_t) 1)
+
+#define DIRWD_RING_SLOT_SIZE     ((size_t) 1024)
+#define DIRWD_RING_PATH_CAP      (DIRWD_RING_SLOT_SIZE - sizeof(struct dirwd_ring_slot_head_t))
+#define DIRWD_RING_DEFAULT_SLOTS ((size_t) 4096)
+#define DIRWD_RING_MIN_SLOTS     ((size_t) 8)
+#define DIRWD_RING_MAX_SLOTS     ((size_t) 1048576)
+
+/* Event types */
+#define DIRWD_RING_NEW      ((uint32_t) 1)
+#define DIRWD_RING_DELETED  ((uint32_t) 2)
+#define DIRWD_RING_MODIFIED ((uint32_t) 3)
+
+/* Event flags */
+#define DIRWD_RING_TRUNCATED ((uint32_t) 0x1) /* Path is longer than DIRWD_RING_PATH_CAP */
+
+/* Reader results */
+#define DIRWD_RING_EMPTY   0 /* No new events */
+#define DIRWD_RING_EVENT   1 /* Event is read */
+#define DIRWD_RING_OVERRUN 2 /* Events were overwritten before read, see lost */
+#define DIRWD_RING_STALE   3 /* Ring was replaced, reader must be reopened */
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+/* File header, producer and reader fields are on separate cache lines */
+struct dirwd_ring_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_size;
+    uint64_t slot_count;
+    uint64_t instance;
+    uint8_t reserved[32];
+
+    _Atomic uint64_t head; /* Sequence number of last published event */
+    uint8_t head_pad[56];
+};
+
+struct dirwd_ring_slot_head_t {
+    _Atomic uint64_t lock;
+    uint32_t type;
+    uint32_t flags;
+    int64_t size;
+    int64_t mtime_ns;
+    uint32_t path_len;
+    uint32_t reserved;
+};
+
+struct dirwd_ring_slot_t {
+    struct dirwd_ring_slot_head_t head;
+    char path[DIRWD_RING_PATH_CAP];
+};
+
+struct dirwd_ring_event_t {
+    uint64_t seq;
+    uint32_t type;
+    uint32_t flags;
+    int64_t size;
+    int64_t mtime_ns;
+    char path[DIRWD_RING_PATH_CAP + 1];
+};
+
+/* Producer */
+struct dirwd_ring_t {
+    int fd;
+    size_t map_len;
+    struct dirwd_ring_header_t* header;
+    struct dirwd_ring_slot_t* slots;
+    uint64_t head;
+};
+
+struct dirwd_ring_reader_t {
+    int fd;
+    size_t map_len;
+    const struct dirwd_ring_header_t* header;
+    const struct dirwd_ring_slot_t* slots;
+    uint64_t instance;
+    uint64_t next;  /* Sequence number of next event to read */
+    uint64_t lost;  /* Total number of overwritten events */
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Create ring file or reuse existing one with the same geometry, slot_count must be power of two */
+struct dirwd_ring_t* dirwd_ring_open(const char* path, size_t slot_count);
+
+void dirwd_ring_close(struct dirwd_ring_t** self);
+
+void dirwd_ring_publish(struct dirwd_ring_t* self, uint32_t type, const char* path, int64_t size, int64_t mtime_ns);
+
+/* Start reading from oldest event in the ring or from the next published one */
+bool dirwd_ring_reader_open(struct dirwd_ring_reader_t* self, const char* path, bool from_oldest);
+
+void dirwd_ring_reader_close(struct dirwd_ring_reader_t* self);
+
+int dirwd_ring_read(struct dirwd_ring_reader_t* self, struct dirwd_ring_event_t* event);
+
+const char* dirwd_ring_type_name(uint32_t type);
+
+#endif /* __DIRWD_RING_H__ */
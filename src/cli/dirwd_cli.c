@@ -0,0 +1,568 @@
+/**
+ * @file dirwd_cli.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog one-shot command line mode
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <time.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "../config.h"
+#include "../util/fsnap.h"
+#include "../daemon/dirwd_scan.h"
+#include "../daemon/dirwd_ctl.h"
+#include "../daemon/dirwd_query.h"
+#include "../journal/dirwd_journal.h"
+#include "dirwd_ring.h"
+#include "dirwd_cli.h"
+
+static void dirwd_cli_usage(FILE* fout) {
+    fprintf(fout,
+        "Usage:\n"
+        "  dirwdd                                   start daemon\n"
+        "  dirwdd scan [-j threads] [-x] [-P] [-I] [-p] [-o snapshot] <dir>\n"
+        "      scan directory tree and write snapshot file (stdout by default),\n"
+        "      with -p print slow subtree report to stderr\n"
+        "  dirwdd diff [-j threads] [-x] [-P] [-I] [-0] <old> <new>\n"
+        "      compare snapshot files or directories, print events to stdout\n"
+        "      as '<NEW|DELETED|MODIFIED>\\t<path>' lines ('\\0' terminated with -0)\n"
+        "  dirwdd events [-f] [-0] <ring>\n"
+        "      print events published to daemon event ring, keep waiting with -f\n"
+        "  dirwdd since [-0] <journal> <seq>\n"
+        "      print journal events after sequence number seq as '<seq>\\t<event>\\t<path>'\n"
+        "  dirwdd rescan <socket> <path>\n"
+        "      ask daemon to rescan path now through its control socket, wait until\n"
+        "      events are published and print their number\n"
+        "  dirwdd query <socket> <INFO|STAT path>\n"
+        "      look up latest published snapshot through daemon query socket,\n"
+        "      answered even while an inspection is running\n"
+        "\n"
+        "Scan options:\n"
+        "  -x  stay on the target filesystem\n"
+        "  -P  record symlinks as links instead of following them\n"
+        "  -I  stat directory entries in inode order (large directories on disks)\n"
+        "\n"
+        "Exit status: 0 - no changes, 1 - changes found (diff, since, rescan), 2 - error,\n"
+        "             3 - journal no longer holds changes after seq, full rescan required\n"
+    );
+}
+
+static void dirwd_cli_default_scan_opts(struct dirwd_scan_opts_t* scan_opts) {
+    scan_opts->threads = dirwd_scan_default_threads();
+    scan_opts->one_fs = false;
+    scan_opts->follow_symlinks = true;
+    scan_opts->inode_order = false;
+    scan_opts->filter = NULL;
+    scan_opts->filter_ctx = NULL;
+    scan_opts->visit = NULL;
+    scan_opts->visit_ctx = NULL;
+    scan_opts->prof = NULL;
+    scan_opts->fs = NULL;
+    scan_opts->fs_ctx = NULL;
+}
+
+/* Parse -j argument */
+static bool dirwd_cli_parse_threads(const char* arg, size_t* threads) {
+    char* end = NULL;
+    const long value = strtol(arg, &end, 10);
+
+    if ((end == arg) || (*end != '\0') || (value <= 0) || ((size_t) value > DIRWD_SCAN_MAX_THREADS)) {
+        fprintf(stderr, "Invalid thread count '%s', expected 1..%zu\n", arg, DIRWD_SCAN_MAX_THREADS);
+        return false;
+    }
+
+    *threads = (size_t) value;
+    return true;
+}
+
+/* Load snapshot from file or by scanning live directory */
+static struct fsnap_t* dirwd_cli_load(const char* path, const struct dirwd_scan_opts_t* scan_opts) {
+    struct stat path_stat;
+
+    if ((strcmp(path, "-") != 0) && (stat(path, &path_stat) == 0) && S_ISDIR(path_stat.st_mode)) {
+        struct fsnap_t* snap = fsnap_new();
+        dirwd_scan_tree(snap, path, scan_opts);
+        fsnap_seal(snap);
+        return snap;
+    }
+
+    FILE* const fin = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (fin == NULL) {
+        fprintf(stderr, "Failed to open snapshot '%s': %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct fsnap_t* snap = fsnap_read(fin);
+    if (snap == NULL) {
+        fprintf(stderr, "Failed to read snapshot '%s': invalid or truncated file\n", path);
+    }
+
+    if (fin != stdin) {
+        fclose(fin);
+    }
+
+    return snap;
+}
+
+static int dirwd_cli_scan(int argc, char** argv) {
+    struct dirwd_scan_opts_t scan_opts;
+    dirwd_cli_default_scan_opts(&scan_opts);
+    const char* output_path = "-";
+    bool profile = false;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "j:xPIpo:h")) != -1) {
+        switch (opt) {
+        case 'j':
+            if (!dirwd_cli_parse_threads(optarg, &scan_opts.threads)) {
+                return DIRWD_CLI_ERROR;
+            }
+            break;
+        case 'x':
+            scan_opts.one_fs = true;
+            break;
+        case 'P':
+            scan_opts.follow_symlinks = false;
+            break;
+        case 'I':
+            scan_opts.inode_order = true;
+            break;
+        case 'p':
+            profile = true;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'h':
+            dirwd_cli_usage(stdout);
+            return DIRWD_CLI_NO_CHANGES;
+        default:
+            dirwd_cli_usage(stderr);
+            return DIRWD_CLI_ERROR;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const char* target_dir = argv[optind];
+    struct stat target_stat;
+    if ((stat(target_dir, &target_stat) != 0) || !S_ISDIR(target_stat.st_mode)) {
+        fprintf(stderr, "Target '%s' is not a directory\n", target_dir);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const bool to_stdout = strcmp(output_path, "-") == 0;
+    if (to_stdout && isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Refusing to write binary snapshot to terminal, use -o\n");
+        return DIRWD_CLI_ERROR;
+    }
+
+    struct dirwd_prof_opts_t prof_opts = { .enabled = true, .top = DIRWD_PROF_TOP_DEFAULT, .file = "" };
+    scan_opts.prof = profile ? dirwd_prof_new(&prof_opts) : NULL;
+
+    struct fsnap_t* snap = fsnap_new();
+    dirwd_prof_begin(scan_opts.prof);
+    dirwd_scan_tree(snap, target_dir, &scan_opts);
+    dirwd_prof_end(scan_opts.prof);
+    fsnap_seal(snap);
+
+    if (scan_opts.prof != NULL) {
+        dirwd_prof_write(scan_opts.prof, stderr);
+        dirwd_prof_drop(&scan_opts.prof);
+    }
+
+    /* Write to temporary file and rename, so readers never see partial snapshot */
+    char tmp_path[PATH_MAX];
+    FILE* fout = stdout;
+
+    if (!to_stdout) {
+        if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", output_path) >= (int) sizeof(tmp_path)) {
+            fprintf(stderr, "Output path is too long\n");
+            fsnap_drop(&snap);
+            return DIRWD_CLI_ERROR;
+        }
+
+        fout = fopen(tmp_path, "wb");
+        if (fout == NULL) {
+            fprintf(stderr, "Failed to create '%s': %s\n", tmp_path, strerror(errno));
+            fsnap_drop(&snap);
+            return DIRWD_CLI_ERROR;
+        }
+    }
+
+    bool is_written = fsnap_write(snap, fout);
+    is_written = (fflush(fout) == 0) && is_written;
+
+    if (!to_stdout) {
+        is_written = (fclose(fout) == 0) && is_written;
+        is_written = is_written && (rename(tmp_path, output_path) == 0);
+        if (!is_written) {
+            unlink(tmp_path);
+        }
+    }
+
+    if (!is_written) {
+        fprintf(stderr, "Failed to write snapshot '%s': %s\n", output_path, strerror(errno));
+        fsnap_drop(&snap);
+        return DIRWD_CLI_ERROR;
+    }
+
+    fprintf(stderr, "%zu files scanned\n", fsnap_len(snap));
+    fsnap_drop(&snap);
+    return DIRWD_CLI_NO_CHANGES;
+}
+
+static void dirwd_cli_print_events(
+    const char* event,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries,
+    char terminator
+)
+{
+    for (size_t i = 0; i < entries->len; i++) {
+        fputs(event, stdout);
+        fputc('\t', stdout);
+        fputs(fsnap_path(snap, entries->buffer[i]), stdout);
+        fputc(terminator, stdout);
+    }
+}
+
+static int dirwd_cli_diff(int argc, char** argv) {
+    struct dirwd_scan_opts_t scan_opts;
+    dirwd_cli_default_scan_opts(&scan_opts);
+    char terminator = '\n';
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "j:xPI0h")) != -1) {
+        switch (opt) {
+        case 'j':
+            if (!dirwd_cli_parse_threads(optarg, &scan_opts.threads)) {
+                return DIRWD_CLI_ERROR;
+            }
+            break;
+        case 'x':
+            scan_opts.one_fs = true;
+            break;
+        case 'P':
+            scan_opts.follow_symlinks = false;
+            break;
+        case 'I':
+            scan_opts.inode_order = true;
+            break;
+        case '0':
+            terminator = '\0';
+            break;
+        case 'h':
+            dirwd_cli_usage(stdout);
+            return DIRWD_CLI_NO_CHANGES;
+        default:
+            dirwd_cli_usage(stderr);
+            return DIRWD_CLI_ERROR;
+        }
+    }
+
+    if (optind + 2 != argc) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    struct fsnap_t* old_snap = dirwd_cli_load(argv[optind], &scan_opts);
+    struct fsnap_t* new_snap = (old_snap != NULL) ? dirwd_cli_load(argv[optind + 1], &scan_opts) : NULL;
+
+    if (new_snap == NULL) {
+        fsnap_drop(&old_snap);
+        return DIRWD_CLI_ERROR;
+    }
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+
+    dirwd_cli_print_events("NEW", new_snap, &diff.new_entries, terminator);
+    dirwd_cli_print_events("DELETED", old_snap, &diff.deleted_entries, terminator);
+    dirwd_cli_print_events("MODIFIED", new_snap, &diff.modified_entries, terminator);
+
+    const bool has_changes = (diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len) > 0;
+    const bool is_written = fflush(stdout) == 0;
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&new_snap);
+
+    if (!is_written) {
+        fprintf(stderr, "Failed to write events: %s\n", strerror(errno));
+        return DIRWD_CLI_ERROR;
+    }
+
+    return has_changes ? DIRWD_CLI_CHANGES : DIRWD_CLI_NO_CHANGES;
+}
+
+static int dirwd_cli_events(int argc, char** argv) {
+    bool follow = false;
+    char terminator = '\n';
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "f0h")) != -1) {
+        switch (opt) {
+        case 'f':
+            follow = true;
+            break;
+        case '0':
+            terminator = '\0';
+            break;
+        case 'h':
+            dirwd_cli_usage(stdout);
+            return DIRWD_CLI_NO_CHANGES;
+        default:
+            dirwd_cli_usage(stderr);
+            return DIRWD_CLI_ERROR;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const char* ring_path = argv[optind];
+    struct dirwd_ring_reader_t reader;
+
+    if (!dirwd_ring_reader_open(&reader, ring_path, true)) {
+        fprintf(stderr, "Failed to open event ring '%s'\n", ring_path);
+        return DIRWD_CLI_ERROR;
+    }
+
+    /* Poll interval when ring is empty */
+    const struct timespec idle = { .tv_sec = 0, .tv_nsec = 10000000 };
+    struct dirwd_ring_event_t event;
+    bool is_done = false;
+
+    while (!is_done) {
+        switch (dirwd_ring_read(&reader, &event)) {
+        case DIRWD_RING_EVENT:
+            fputs(dirwd_ring_type_name(event.type), stdout);
+            fputc('\t', stdout);
+            fputs(event.path, stdout);
+            fputc(terminator, stdout);
+            break;
+        case DIRWD_RING_OVERRUN:
+            fprintf(stderr, "Reader overrun, %" PRIu64 " events lost\n", reader.lost);
+            break;
+        case DIRWD_RING_STALE:
+            dirwd_ring_reader_close(&reader);
+            while (follow && !dirwd_ring_reader_open(&reader, ring_path, true)) {
+                nanosleep(&idle, NULL);
+            }
+            is_done = !follow;
+            break;
+        default:
+            fflush(stdout);
+            if (follow) {
+                nanosleep(&idle, NULL);
+            } else {
+                is_done = true;
+            }
+            break;
+        }
+    }
+
+    dirwd_ring_reader_close(&reader);
+    return (fflush(stdout) == 0) ? DIRWD_CLI_NO_CHANGES : DIRWD_CLI_ERROR;
+}
+
+static int dirwd_cli_since(int argc, char** argv) {
+    char terminator = '\n';
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "0h")) != -1) {
+        switch (opt) {
+        case '0':
+            terminator = '\0';
+            break;
+        case 'h':
+            dirwd_cli_usage(stdout);
+            return DIRWD_CLI_NO_CHANGES;
+        default:
+            dirwd_cli_usage(stderr);
+            return DIRWD_CLI_ERROR;
+        }
+    }
+
+    if (optind + 2 != argc) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const char* journal_dir = argv[optind];
+    const char* seq_arg = argv[optind + 1];
+    char* end = NULL;
+    errno = 0;
+    const unsigned long long since = strtoull(seq_arg, &end, 10);
+
+    if ((end == seq_arg) || (*end != '\0') || (seq_arg[0] == '-') || (errno != 0)) {
+        fprintf(stderr, "Invalid sequence number '%s'\n", seq_arg);
+        return DIRWD_CLI_ERROR;
+    }
+
+    struct dirwd_journal_cursor_t cursor;
+    switch (dirwd_journal_cursor_open(&cursor, journal_dir, (uint64_t) since)) {
+    case DIRWD_JOURNAL_OK:
+        break;
+    case DIRWD_JOURNAL_GAP:
+        fprintf(stderr, "Changes after %llu were removed from journal, oldest available is %" PRIu64 "\n",
+            since, dirwd_journal_cursor_oldest(&cursor));
+        dirwd_journal_cursor_close(&cursor);
+        return DIRWD_CLI_RESYNC;
+    default:
+        fprintf(stderr, "Failed to open change journal '%s'\n", journal_dir);
+        return DIRWD_CLI_ERROR;
+    }
+
+    struct dirwd_journal_event_t* event = (struct dirwd_journal_event_t*) malloc(sizeof(struct dirwd_journal_event_t));
+    bool has_changes = false;
+
+    while (dirwd_journal_cursor_next(&cursor, event)) {
+        printf("%" PRIu64 "\t%s\t%s", event->seq, dirwd_ring_type_name(event->type), event->path);
+        fputc(terminator, stdout);
+        has_changes = true;
+    }
+
+    free(event);
+    dirwd_journal_cursor_close(&cursor);
+
+    if (fflush(stdout) != 0) {
+        fprintf(stderr, "Failed to write events: %s\n", strerror(errno));
+        return DIRWD_CLI_ERROR;
+    }
+
+    return has_changes ? DIRWD_CLI_CHANGES : DIRWD_CLI_NO_CHANGES;
+}
+
+static int dirwd_cli_rescan(int argc, char** argv) {
+    if ((argc == 2) && (strcmp(argv[1], "-h") == 0)) {
+        dirwd_cli_usage(stdout);
+        return DIRWD_CLI_NO_CHANGES;
+    } else if (argc != 3) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const char* socket_path = argv[1];
+    const char* path = argv[2];
+
+    char command[DIRWD_CTL_LINE_SIZE];
+    if ((size_t) snprintf(command, sizeof(command), "%s %s", DIRWD_CTL_RESCAN_COMMAND, path) >= sizeof(command)) {
+        fprintf(stderr, "Path is too long: '%s'\n", path);
+        return DIRWD_CLI_ERROR;
+    }
+
+    char reply[DIRWD_CTL_LINE_SIZE];
+    if (!dirwd_ctl_send(socket_path, command, reply, sizeof(reply))) {
+        fprintf(stderr, "Failed to send request to '%s': %s\n", socket_path, strerror(errno));
+        return DIRWD_CLI_ERROR;
+    }
+
+    if (strcmp(reply, "QUEUED") == 0) {
+        printf("queued\n");
+        return DIRWD_CLI_NO_CHANGES;
+    }
+
+    char* end = NULL;
+    const unsigned long long events = (strncmp(reply, "OK ", 3) == 0) ? strtoull(reply + 3, &end, 10) : 0;
+
+    if ((end == NULL) || (end == reply + 3) || (*end != '\0')) {
+        fprintf(stderr, "Rescan failed: %s\n", reply);
+        return DIRWD_CLI_ERROR;
+    }
+
+    printf("%llu\n", events);
+    return (events > 0) ? DIRWD_CLI_CHANGES : DIRWD_CLI_NO_CHANGES;
+}
+
+static int dirwd_cli_query(int argc, char** argv) {
+    if ((argc == 2) && (strcmp(argv[1], "-h") == 0)) {
+        dirwd_cli_usage(stdout);
+        return DIRWD_CLI_NO_CHANGES;
+    } else if ((argc != 3) && (argc != 4)) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    const char* socket_path = argv[1];
+
+    char command[DIRWD_QUERY_LINE_SIZE];
+    const int command_len = (argc == 4)
+        ? snprintf(command, sizeof(command), "%s %s", argv[2], argv[3])
+        : snprintf(command, sizeof(command), "%s", argv[2]);
+    if ((size_t) command_len >= sizeof(command)) {
+        fprintf(stderr, "Query is too long\n");
+        return DIRWD_CLI_ERROR;
+    }
+
+    char reply[DIRWD_QUERY_REPLY_SIZE];
+    if (!dirwd_ctl_send(socket_path, command, reply, sizeof(reply))) {
+        fprintf(stderr, "Failed to send query to '%s': %s\n", socket_path, strerror(errno));
+        return DIRWD_CLI_ERROR;
+    }
+
+    if (strncmp(reply, "ERR", 3) == 0) {
+        fprintf(stderr, "Query failed: %s\n", reply);
+        return DIRWD_CLI_ERROR;
+    }
+
+    printf("%s\n", reply);
+    return DIRWD_CLI_NO_CHANGES;
+}
+
+int dirwd_cli_exec(int argc, char** argv) {
+    if (argc < 2) {
+        dirwd_cli_usage(stderr);
+        return DIRWD_CLI_ERROR;
+    }
+
+    /* Scanner reports errors through syslog, mirror them to stderr */
+    openlog(DIRWD_SYSLOG_IDENT, LOG_PID | LOG_PERROR, LOG_USER);
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    const char* command = argv[1];
+    int status = DIRWD_CLI_ERROR;
+
+    if (strcmp(command, "scan") == 0) {
+        status = dirwd_cli_scan(argc - 1, argv + 1);
+    } else if (strcmp(command, "diff") == 0) {
+        status = dirwd_cli_diff(argc - 1, argv + 1);
+    } else if (strcmp(command, "events") == 0) {
+        status = dirwd_cli_events(argc - 1, argv + 1);
+    } else if (strcmp(command, "since") == 0) {
+        status = dirwd_cli_since(argc - 1, argv + 1);
+    } else if (strcmp(command, "rescan") == 0) {
+        status = dirwd_cli_rescan(argc - 1, argv + 1);
+    } else if (strcmp(command, "query") == 0) {
+        status = dirwd_cli_query(argc - 1, argv + 1);
+    } else if ((strcmp(command, "help") == 0) || (strcmp(command, "-h") == 0)) {
+        dirwd_cli_usage(stdout);
+        status = DIRWD_CLI_NO_CHANGES;
+    } else {
+        fprintf(stderr, "Unknown command '%s'\n", command);
+        dirwd_cli_usage(stderr);
+    }
+
+    closelog();
+    return status;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file dirwd_cli.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog one-shot command line mode
+ */
+
+#ifndef __CLI_DIRWD_CLI_H__
+#define __CLI_DIRWD_CLI_H__
+
+/* Define -------------------------------------------------------------------*/
+
+/* Exit codes, diff(1) style */
+#define DIRWD_CLI_NO_CHANGES ((int) 0)
+#define DIRWD_CLI_CHANGES    ((int) 1)
+#define DIRWD_CLI_ERROR      ((int) 2)
+#define DIRWD_CLI_RESYNC     ((int) 3) /* Journal no longer holds requested changes */
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Run foreground subcommand, argv[1] is the subcommand name */
+int dirwd_cli_exec(int argc, char** argv);
+
+#endif /* __CLI_DIRWD_CLI_H__ */
@@ -4,6 +4,8 @@
  * @brief Directory watchdog Linux daemon
  */
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -11,22 +13,93 @@
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
 
 #include <sys/unistd.h>
 #include <sys/types.h>
 #include <sys/signal.h>
 #include <sys/stat.h>
 #include <sys/syslog.h>
-#include <dirent.h>
 
 #include "../config.h"
 #include "dirwd_status.h"
 #include "dirwd_config.h"
 #include "dirwd_state.h"
+#include "dirwd_scan.h"
 #include "dirwd.h"
 
 static struct dirwd_state_t state;
 
+/* Set by SIGUSR1, report is written from the main loop */
+static volatile sig_atomic_t profile_dump_requested = 0;
+
+/* Set by SIGHUP, state is only replaced between inspections */
+static volatile sig_atomic_t reload_requested = 0;
+
+/* Set by SIGTERM, state is cleaned by the main loop once scan threads are done */
+static volatile sig_atomic_t stop_requested = 0;
+
+static void dirwd_dump_profile(const struct dirwd_state_t* cur_state) {
+    if (cur_state->prof == NULL) {
+        syslog(LOG_INFO, "Scan profiling is disabled, no report written");
+    } else if (dirwd_prof_dump(cur_state->prof)) {
+        syslog(LOG_INFO, "Scan profile written to '%s'", cur_state->prof->opts.file);
+    }
+}
+
+/* Wait for the next inspection, serving report and rescan requests meanwhile */
+static void dirwd_wait(struct dirwd_state_t* cur_state) {
+    const int64_t deadline_ms = dirwd_ctl_now_ms() + (int64_t) cur_state->timeout_sec * 1000;
+
+    while (true) {
+        /* Request may also arrive during inspection */
+        if (profile_dump_requested) {
+            profile_dump_requested = 0;
+            dirwd_dump_profile(cur_state);
+        }
+
+        if (reload_requested || stop_requested) {
+            return;
+        }
+
+        /* Generations released by readers since the last publish */
+        fsnap_pub_reclaim(cur_state->pub);
+
+        const int64_t now_ms = dirwd_ctl_now_ms();
+        if (now_ms >= deadline_ms) {
+            return;
+        }
+
+        int64_t timeout_ms = deadline_ms - now_ms;
+        const int64_t rescan_ms = dirwd_ctl_due_ms(cur_state->ctl, now_ms);
+
+        if (rescan_ms == 0) {
+            dirwd_rescan(cur_state);
+            continue;
+        } else if ((rescan_ms > 0) && (rescan_ms < timeout_ms)) {
+            timeout_ms = rescan_ms;
+        }
+
+        /* Without descriptors poll only sleeps, signals interrupt it */
+        struct pollfd poll_fds[2];
+        nfds_t poll_len = 0;
+
+        if (cur_state->fan != NULL) {
+            poll_fds[poll_len++] = (struct pollfd) { .fd = cur_state->fan->fd, .events = POLLIN, .revents = 0 };
+        }
+        if ((cur_state->ctl != NULL) && (cur_state->ctl->fd >= 0)) {
+            poll_fds[poll_len++] = (struct pollfd) { .fd = cur_state->ctl->fd, .events = POLLIN, .revents = 0 };
+        }
+
+        if (poll(poll_fds, poll_len, (int) timeout_ms) > 0) {
+            dirwd_fan_read(cur_state->fan);
+            dirwd_ctl_read(cur_state->ctl);
+        }
+    }
+}
+
 dirwd_status_t dirwd_exec() {
     /* Initialize daemon with current configuration */
     const dirwd_status_t status = dirwd_init(DIRWD_CONFIG_PATH, &state);
@@ -39,11 +112,17 @@ dirwd_status_t dirwd_exec() {
     }
 
     /* Main loop */
-    while (true) {
+    while (!stop_requested) {
         dirwd_inspect(&state);
-        sleep(state.timeout_sec);
+        dirwd_wait(&state);
+
+        if (reload_requested && !stop_requested) {
+            reload_requested = 0;
+            dirwd_reload(&state);
+        }
     }
 
+    syslog(LOG_INFO, "SIGTERM signal is received. Daemon is shutting down...");
     dirwd_state_clean(&state);
     return DIRWD_SUCCESS;
 }
@@ -86,104 +165,137 @@ dirwd_status_t dirwd_init(const char* config_path, struct dirwd_state_t* cur_sta
     }
 
     syslog(LOG_INFO,
-        "Current configuration: target directory '%s' timeout: %lu seconds",
+        "Current configuration: target directory '%s' timeout: %lu seconds "
+        "one_fs: %s symlinks: %s inode order: %s scan threads: %lu tiers: %s (warm %lu cold %lu) "
+        "fanotify: %s (reconcile %lu) storm threshold: %lu profile: %s (top %lu) control: %s query: %s "
+        "chunks: %s (%lu KiB) fingerprint: %s (cache %lu) events: %s%s%s%s%s",
         config.target_dir,
-        config.timeout_sec
+        config.timeout_sec,
+        config.scan_opts.one_fs ? "yes" : "no",
+        config.scan_opts.follow_symlinks ? "follow" : "record",
+        config.scan_opts.inode_order ? "yes" : "no",
+        config.scan_opts.threads,
+        config.tier_opts.enabled ? "yes" : "no",
+        config.tier_opts.warm_ticks,
+        config.tier_opts.cold_ticks,
+        config.fan_opts.enabled ? "yes" : "no",
+        config.fan_opts.reconcile_ticks,
+        config.output_opts.storm_threshold,
+        config.prof_opts.enabled ? config.prof_opts.file : "no",
+        config.prof_opts.top,
+        (config.ctl_opts.socket_path[0] != '\0') ? config.ctl_opts.socket_path : "no",
+        (config.query_opts.socket_path[0] != '\0') ? config.query_opts.socket_path : "no",
+        config.chunk_opts.enabled ? config.chunk_opts.pattern : "no",
+        config.chunk_opts.chunk_bytes / 1024,
+        config.fprint_opts.enabled ? "yes" : "no",
+        config.fprint_opts.cache_dirs,
+        ((config.output_opts.sinks & DIRWD_OUTPUT_SYSLOG) != 0) ? "syslog " : "",
+        ((config.output_opts.sinks & DIRWD_OUTPUT_RING) != 0) ? "ring " : "",
+        ((config.output_opts.sinks & DIRWD_OUTPUT_RING) != 0) ? config.output_opts.ring_path : "",
+        ((config.output_opts.sinks & DIRWD_OUTPUT_JOURNAL) != 0) ? " journal " : "",
+        ((config.output_opts.sinks & DIRWD_OUTPUT_JOURNAL) != 0) ? config.output_opts.journal_dir : ""
     );
 
     free(config.target_dir);
     return DIRWD_SUCCESS;
 }
 
+/* Publish sealed snapshot for readers, it is the baseline of the next inspection */
+static void dirwd_publish(struct dirwd_state_t* cur_state, struct fsnap_t* new_snap) {
+    /* Empty baseline of the first inspection was never published */
+    if (fsnap_pub_latest(cur_state->pub) == NULL) {
+        fsnap_drop(&cur_state->entries);
+    }
+
+    fsnap_pub_publish(cur_state->pub, new_snap);
+    cur_state->entries = new_snap;
+}
+
+/* Fingerprint mode keeps no snapshot of the tree, events come from changed directories only */
+static void dirwd_inspect_fprint(struct dirwd_state_t* cur_state) {
+    struct dirwd_fprint_t* const fprint = cur_state->fprint;
+    struct dirwd_scan_opts_t scan_opts = cur_state->scan_opts;
+    scan_opts.visit = dirwd_fprint_visit;
+    scan_opts.visit_ctx = fprint;
+
+    dirwd_fprint_begin(fprint);
+    dirwd_prof_begin(cur_state->prof);
+    dirwd_scan_tree(cur_state->entries, cur_state->target_dir, &scan_opts);
+    dirwd_prof_end(cur_state->prof);
+    dirwd_fprint_end(fprint);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(fprint->old_events, fprint->new_events, &diff);
+
+    dirwd_output_diff(&cur_state->output, fprint->old_events, fprint->new_events, &diff);
+    dirwd_chunk_update(cur_state->chunks, fprint->old_events, fprint->new_events, &diff);
+    fsnap_diff_clean(&diff);
+}
+
 void dirwd_inspect(struct dirwd_state_t* cur_state) {
     assert(cur_state != NULL);
 
-    struct fentry_set_t* old_state_entries = cur_state->entries;
-    struct fentry_set_t* new_state_entries = fentry_set_new();
-    dirwd_scan_dir(new_state_entries, cur_state->target_dir);
-
-    struct fentry_set_t* new_entries = fentry_set_diff(new_state_entries, old_state_entries);
-    struct fentry_set_t* deleted_entries = fentry_set_diff(old_state_entries, new_state_entries);
-    struct fentry_set_t* modified_entries = fentry_set_new();
-
-    /* Find modiefies entries */
-    const size_t old_entries_num = fentry_set_len(old_state_entries);
-
-    for (size_t i = 0; i < old_entries_num; i++) {
-        struct fentry_t* old_file = fentry_set_pop(old_state_entries);
-        
-        if (fentry_set_contains(new_state_entries, old_file->file_name)) {
-            const struct fentry_t* new_file = fentry_set_get(new_state_entries, old_file->file_name);
-            if (!fentry_equals(old_file, new_file)) {
-                fentry_set_insert(modified_entries, fentry_clone(old_file));
-            }
-        }
-
-        fentry_drop(&old_file);
+    if (cur_state->fprint != NULL) {
+        dirwd_inspect_fprint(cur_state);
+        return;
     }
 
-    dirwd_log_diff(new_entries, deleted_entries, modified_entries);
+    struct dirwd_scan_opts_t scan_opts = cur_state->scan_opts;
 
-    fentry_set_drop(&new_entries);
-    fentry_set_drop(&deleted_entries);
-    fentry_set_drop(&modified_entries);
+    if (cur_state->tiers != NULL) {
+        dirwd_tier_begin(cur_state->tiers);
+        scan_opts.filter = dirwd_tier_filter;
+        scan_opts.filter_ctx = cur_state->tiers;
+    } else if (cur_state->fan != NULL) {
+        dirwd_fan_begin(cur_state->fan);
+        scan_opts.filter = dirwd_fan_filter;
+        scan_opts.filter_ctx = cur_state->fan;
+    }
 
-    fentry_set_drop(&cur_state->entries);
-    cur_state->entries = new_state_entries;
-}
+    struct fsnap_t* new_snap = fsnap_new();
+    dirwd_prof_begin(cur_state->prof);
+    dirwd_scan_tree(new_snap, cur_state->target_dir, &scan_opts);
+    dirwd_prof_end(cur_state->prof);
+    dirwd_tier_carry(cur_state->tiers, cur_state->entries, new_snap);
+    dirwd_fan_carry(cur_state->fan, cur_state->entries, new_snap);
+    fsnap_seal(new_snap);
 
-void dirwd_scan_dir(struct fentry_set_t* entries, const char* path) {
-    if ((entries == NULL) || (path == NULL)) {
-        return;
-    }
+    struct fsnap_diff_t diff;
+    fsnap_diff(cur_state->entries, new_snap, &diff);
 
-    char file_path_buffer[STRING_BUFFER_SIZE] = { 0 };
-    const size_t path_len = strlen(path);
-    strcpy(file_path_buffer, path);
+    dirwd_output_diff(&cur_state->output, cur_state->entries, new_snap, &diff);
+    dirwd_chunk_update(cur_state->chunks, cur_state->entries, new_snap, &diff);
+    dirwd_tier_update(cur_state->tiers, cur_state->entries, new_snap, &diff);
+    dirwd_fan_end(cur_state->fan);
+    fsnap_diff_clean(&diff);
 
-    DIR* const dir = opendir(path);
+    dirwd_publish(cur_state, new_snap);
+}
 
-    if (dir == NULL) {
-        syslog(LOG_ERR, "Failed to open directory '%s': %s", path, strerror(errno));
-        return;
-    }
+void dirwd_rescan(struct dirwd_state_t* cur_state) {
+    assert(cur_state != NULL);
 
-    struct dirent* dir_entry = NULL;
-    struct stat file_stat = { 0 };
+    /* Tier schedules and profile follow full inspections only */
+    struct dirwd_scan_opts_t scan_opts = cur_state->scan_opts;
+    dirwd_ctl_begin(cur_state->ctl);
+    scan_opts.filter = dirwd_ctl_filter;
+    scan_opts.filter_ctx = cur_state->ctl;
+    scan_opts.prof = NULL;
 
-    while ((dir_entry = readdir(dir)) != NULL) {
-        /* Check if entry is not . or .. directory */
-        const bool is_entry_current_dir = strcmp(dir_entry->d_name, ".") == 0;
-        const bool is_entry_parent_dir = strcmp(dir_entry->d_name, "..") == 0;
-        if (is_entry_current_dir || is_entry_parent_dir) {
-            continue;
-        }
+    struct fsnap_t* new_snap = fsnap_new();
+    dirwd_scan_tree(new_snap, cur_state->target_dir, &scan_opts);
+    dirwd_ctl_carry(cur_state->ctl, cur_state->entries, new_snap);
+    fsnap_seal(new_snap);
 
-        /* Get file full path */
-        file_path_buffer[path_len] = '/';
-        file_path_buffer[path_len + 1] = '\0';
-        strcat(file_path_buffer, dir_entry->d_name);
-
-        /* Get file metadata */
-        if (stat(file_path_buffer, &file_stat) != 0) {
-            syslog(LOG_ERR,
-                "Failed to read metadata of file '%s': %s",
-                file_path_buffer,
-                strerror(errno)
-            );
-            continue;
-        }
+    struct fsnap_diff_t diff;
+    fsnap_diff(cur_state->entries, new_snap, &diff);
 
-        if (S_ISDIR(file_stat.st_mode)) {
-            /* If file isdirectory - scan directory recursively */
-            dirwd_scan_dir(entries, file_path_buffer);
-        } else {
-            /* If file is not directory - insert file entry to the set */
-            fentry_set_insert(entries, fentry_new(file_path_buffer, &file_stat));
-        }
-    }
+    dirwd_output_diff(&cur_state->output, cur_state->entries, new_snap, &diff);
+    dirwd_chunk_update(cur_state->chunks, cur_state->entries, new_snap, &diff);
+    dirwd_ctl_end(cur_state->ctl, &diff);
+    fsnap_diff_clean(&diff);
 
-    closedir(dir);
+    dirwd_publish(cur_state, new_snap);
 }
 
 void dirwd_log_error(const dirwd_status_t err) {
@@ -203,6 +315,9 @@ void dirwd_log_error(const dirwd_status_t err) {
     case DIRWD_INVALID_CONFIG_TIMEOUT:
         syslog(LOG_ERR, "Invalid timeout parameter.");
         break;
+    case DIRWD_INVALID_CONFIG_OPTION:
+        syslog(LOG_ERR, "Invalid configuration option.");
+        break;
     case DIRWD_INVALID_CONFIG_TARGET_DIR:
         syslog(LOG_ERR, "Invalid target directory parameter.");
         break;
@@ -215,69 +330,58 @@ void dirwd_log_error(const dirwd_status_t err) {
     case DIRWD_FAILED_TO_READ_TARGET_DIR:
         syslog(LOG_ERR, "Failed to read target dir: %s.", strerror(errno));
         break;
+    case DIRWD_FAILED_TO_WATCH_TARGET_DIR:
+        syslog(LOG_ERR, "Failed to watch target dir with fanotify.");
+        break;
+    case DIRWD_FAILED_TO_OPEN_RING:
+        syslog(LOG_ERR, "Failed to open event ring.");
+        break;
+    case DIRWD_FAILED_TO_OPEN_JOURNAL:
+        syslog(LOG_ERR, "Failed to open change journal.");
+        break;
+    case DIRWD_FAILED_TO_OPEN_CONTROL:
+        syslog(LOG_ERR, "Failed to open control socket.");
+        break;
+    case DIRWD_FAILED_TO_OPEN_QUERY:
+        syslog(LOG_ERR, "Failed to open query socket.");
+        break;
     default:
         syslog(LOG_DEBUG, "Unhandled dirwd error status.");
         break;
     }
 }
 
-void dirwd_log_diff(
-    struct fentry_set_t* new_entries,
-    struct fentry_set_t* deleted_entries,
-    struct fentry_set_t* modified_entries
-)
-{
-    const size_t new_entries_mum = fentry_set_len(new_entries);
-    for (size_t i = 0; i < new_entries_mum; i++) {
-        struct fentry_t* entry = fentry_set_pop(new_entries);
-        syslog(LOG_INFO,
-            "NEW: '%s'",
-            entry->file_name
-        );
-        fentry_drop(&entry);
-    }
-
-    const size_t deleted_entries_mum = fentry_set_len(deleted_entries);
-    for (size_t i = 0; i < deleted_entries_mum; i++) {
-        struct fentry_t* entry = fentry_set_pop(deleted_entries);
-        syslog(LOG_INFO,
-            "DELETED: '%s'",
-            entry->file_name
-        );
-        fentry_drop(&entry);
+void dirwd_sigterm_handler(int sig) {
+    if (sig == SIGTERM) {
+        stop_requested = 1;
     }
 
-    const size_t modified_entries_mum = fentry_set_len(modified_entries);
-    for (size_t i = 0; i < modified_entries_mum; i++) {
-        struct fentry_t* entry = fentry_set_pop(modified_entries);
-        syslog(LOG_INFO,
-            "MODIFIED: '%s'",
-            entry->file_name
-        );
-        fentry_drop(&entry);
-    }
+    signal(SIGTERM, dirwd_sigterm_handler);
 }
 
-void dirwd_sigterm_handler(int sig) {
-    if (sig == SIGTERM) {
-        syslog(LOG_INFO, "SIGTERM signal is received. Daemon is shutting down...");
-        syslog(LOG_INFO, "Deamon finished successfully");
-        dirwd_state_clean(&state);
-        exit(EXIT_SUCCESS);
+void dirwd_reload(struct dirwd_state_t* cur_state) {
+    syslog(LOG_INFO, "SIGHUP signal is received. Refreshing configuration...");
+    const dirwd_status_t status = dirwd_init(DIRWD_CONFIG_PATH, cur_state);
+
+    if (status == DIRWD_SUCCESS) {
+        syslog(LOG_INFO, "Daemon initialized successfully.");
+    } else {
+        syslog(LOG_ERR, "Failed to initialize daemon. Previous configuration kept.");
     }
 }
 
 void dirwd_sighup_handler(int sig) {
     if (sig == SIGHUP) {
-        syslog(LOG_INFO, "SIGHUP signal is received. Refreshing configuration...");
-        const dirwd_status_t status = dirwd_init(DIRWD_CONFIG_PATH, &state);
-
-        if (status == DIRWD_SUCCESS) {
-            syslog(LOG_INFO, "Daemon initialized successfully.");
-        } else {
-            syslog(LOG_ERR, "Failed to initialize daemon. Previous configuration kept.");
-        }
+        reload_requested = 1;
     }
 
     signal(SIGHUP, dirwd_sighup_handler);
 }
+
+void dirwd_sigusr1_handler(int sig) {
+    if (sig == SIGUSR1) {
+        profile_dump_requested = 1;
+    }
+
+    signal(SIGUSR1, dirwd_sigusr1_handler);
+}
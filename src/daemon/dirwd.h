@@ -27,18 +27,21 @@ dirwd_status_t dirwd_init(const char* config_path, struct dirwd_state_t* cur_sta
 
 void dirwd_inspect(struct dirwd_state_t* cur_state);
 
-void dirwd_scan_dir(struct fentry_set_t* entries, const char* path);
+/* Rescan subtrees requested through control socket */
+void dirwd_rescan(struct dirwd_state_t* cur_state);
 
-void dirwd_log_error(const dirwd_status_t err);
+/* Read configuration again, called from the main loop after SIGHUP */
+void dirwd_reload(struct dirwd_state_t* cur_state);
 
-void dirwd_log_diff(
-    struct fentry_set_t* new_entries,
-    struct fentry_set_t* deleted_entries,
-    struct fentry_set_t* modified_entries
-);
+void dirwd_log_error(const dirwd_status_t err);
 
+/* Request shutdown after the running inspection */
 void dirwd_sigterm_handler(int sig);
 
+/* Request configuration reload */
 void dirwd_sighup_handler(int sig);
 
+/* Request scan profile report */
+void dirwd_sigusr1_handler(int sig);
+
 #endif /* __DAEMON_DIRWD_H__ */
\ No newline at end of file
@@ -0,0 +1,479 @@
+/**
+ * @file dirwd_chunk.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog chunk-level delta detection for large files
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <fnmatch.h>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "dirwd_chunk.h"
+
+#define DIRWD_CHUNK_PRIME_1 ((uint64_t) 0x9e3779b185ebca87ULL)
+#define DIRWD_CHUNK_PRIME_2 ((uint64_t) 0xc2b2ae3d27d4eb4fULL)
+
+#define DIRWD_CHUNK_TABLE_PATH_SIZE ((size_t) (PATH_MAX + 32))
+
+/* Per-file ranges of one inspection */
+struct dirwd_chunk_detail_t {
+    FILE* fout;
+    bool is_failed;
+    char path[PATH_MAX];
+};
+
+static uint64_t dirwd_chunk_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= DIRWD_CHUNK_PRIME_2;
+    x ^= x >> 29;
+    x *= DIRWD_CHUNK_PRIME_1;
+    x ^= x >> 32;
+    return x;
+}
+
+uint64_t dirwd_chunk_hash(const unsigned char* data, size_t len) {
+    /* Four independent lanes keep multipliers busy */
+    uint64_t lanes[4] = { DIRWD_CHUNK_PRIME_1, DIRWD_CHUNK_PRIME_2, ~DIRWD_CHUNK_PRIME_1, ~DIRWD_CHUNK_PRIME_2 };
+    size_t pos = 0;
+
+    for (; pos + 32 <= len; pos += 32) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            uint64_t word = 0;
+            memcpy(&word, data + pos + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * DIRWD_CHUNK_PRIME_1;
+            lanes[lane] ^= lanes[lane] >> 31;
+        }
+    }
+
+    uint64_t hash = (uint64_t) len;
+    for (size_t lane = 0; lane < 4; lane++) {
+        hash = dirwd_chunk_mix(hash ^ lanes[lane]);
+    }
+
+    for (; pos < len; pos++) {
+        hash = (hash ^ data[pos]) * DIRWD_CHUNK_PRIME_2;
+    }
+
+    return dirwd_chunk_mix(hash);
+}
+
+static void dirwd_chunk_reserve(struct dirwd_chunk_t* self, size_t count) {
+    if (count <= self->hashes_cap) {
+        return;
+    }
+
+    self->hashes_cap = count;
+    self->old_hashes = (uint64_t*) realloc(self->old_hashes, count * sizeof(uint64_t));
+    self->new_hashes = (uint64_t*) realloc(self->new_hashes, count * sizeof(uint64_t));
+}
+
+static void dirwd_chunk_ranges_push(struct dirwd_chunk_ranges_t* ranges, uint64_t offset, uint64_t length) {
+    /* Adjacent changed chunks form one range */
+    if ((ranges->len > 0) && (ranges->buffer[ranges->len - 1].offset + ranges->buffer[ranges->len - 1].length == offset)) {
+        ranges->buffer[ranges->len - 1].length += length;
+        return;
+    }
+
+    if (ranges->len == ranges->cap) {
+        ranges->cap = (ranges->cap == 0) ? 16 : ranges->cap * 2;
+        ranges->buffer = (struct dirwd_chunk_range_t*) realloc(ranges->buffer,
+            ranges->cap * sizeof(struct dirwd_chunk_range_t));
+    }
+
+    ranges->buffer[ranges->len].offset = offset;
+    ranges->buffer[ranges->len].length = length;
+    ranges->len++;
+}
+
+static void dirwd_chunk_table_path(const struct dirwd_chunk_t* self, const char* path, char* table_path) {
+    snprintf(table_path, DIRWD_CHUNK_TABLE_PATH_SIZE, "%s/%016llx.chunks", self->opts.dir, (unsigned long long) fsnap_hash_path(path));
+}
+
+/* Read table of path into old hashes, false if it is missing or was made for other path or chunk size */
+static bool dirwd_chunk_load(
+    struct dirwd_chunk_t* self,
+    const char* table_path,
+    const char* path,
+    struct dirwd_chunk_file_header_t* header
+)
+{
+    FILE* const fin = fopen(table_path, "rb");
+    if (fin == NULL) {
+        return false;
+    }
+
+    const size_t path_len = strlen(path);
+    char stored_path[PATH_MAX];
+
+    bool is_loaded = (fread(header, sizeof(*header), 1, fin) == 1)
+        && (memcmp(header->magic, DIRWD_CHUNK_FILE_MAGIC, sizeof(header->magic)) == 0)
+        && (header->version == DIRWD_CHUNK_FILE_VERSION)
+        && (header->chunk_bytes == self->opts.chunk_bytes)
+        && (header->path_len == path_len)
+        && (header->size >= 0)
+        && (header->count == ((uint64_t) header->size + self->opts.chunk_bytes - 1) / self->opts.chunk_bytes)
+        && (fread(stored_path, 1, path_len, fin) == path_len)
+        && (memcmp(stored_path, path, path_len) == 0);
+
+    if (is_loaded) {
+        dirwd_chunk_reserve(self, (size_t) header->count);
+        is_loaded = fread(self->old_hashes, sizeof(uint64_t), (size_t) header->count, fin) == header->count;
+    }
+
+    fclose(fin);
+    return is_loaded;
+}
+
+static bool dirwd_chunk_store(
+    const struct dirwd_chunk_t* self,
+    const char* table_path,
+    const char* path,
+    const struct dirwd_chunk_file_header_t* header
+)
+{
+    char tmp_path[DIRWD_CHUNK_TABLE_PATH_SIZE + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", table_path);
+
+    FILE* const fout = fopen(tmp_path, "wb");
+    if (fout == NULL) {
+        return false;
+    }
+
+    bool is_written = (fwrite(header, sizeof(*header), 1, fout) == 1)
+        && (fwrite(path, 1, header->path_len, fout) == header->path_len)
+        && (fwrite(self->new_hashes, sizeof(uint64_t), (size_t) header->count, fout) == header->count);
+    is_written = (fclose(fout) == 0) && is_written;
+    is_written = is_written && (rename(tmp_path, table_path) == 0);
+
+    if (!is_written) {
+        unlink(tmp_path);
+    }
+
+    return is_written;
+}
+
+/* Read up to len bytes at offset, short only at end of file */
+static ssize_t dirwd_chunk_read(int fd, unsigned char* buffer, size_t len, off_t offset) {
+    size_t done = 0;
+
+    while (done < len) {
+        const ssize_t bytes = pread(fd, buffer + done, len - done, offset + (off_t) done);
+        if ((bytes < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytes < 0) {
+            return -1;
+        } else if (bytes == 0) {
+            break;
+        }
+
+        done += (size_t) bytes;
+    }
+
+    return (ssize_t) done;
+}
+
+struct dirwd_chunk_t* dirwd_chunk_new(const struct dirwd_chunk_opts_t* opts) {
+    if ((opts == NULL) || (opts->chunk_bytes == 0)) {
+        return NULL;
+    }
+
+    /* Parent of default directory may be missing too */
+    char parent[PATH_MAX];
+    strcpy(parent, opts->dir);
+    char* p_slash = strrchr(parent, '/');
+    if ((p_slash != NULL) && (p_slash != parent)) {
+        *p_slash = '\0';
+        mkdir(parent, 0755);
+    }
+
+    if ((mkdir(opts->dir, 0755) != 0) && (errno != EEXIST)) {
+        syslog(LOG_ERR, "Failed to create chunk table directory '%s': %s", opts->dir, strerror(errno));
+    }
+
+    struct dirwd_chunk_t* new_chunk = (struct dirwd_chunk_t*) calloc(1, sizeof(struct dirwd_chunk_t));
+    new_chunk->opts = *opts;
+    new_chunk->buffer = (unsigned char*) malloc(opts->chunk_bytes);
+
+    /* Delta files of earlier runs count towards the limit */
+    detail_files_init(&new_chunk->delta_files, opts->dir, "delta-", DIRWD_CHUNK_DELTA_FILES);
+
+    return new_chunk;
+}
+
+void dirwd_chunk_drop(struct dirwd_chunk_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    detail_files_clean(&(*self)->delta_files);
+    free((*self)->buffer);
+    free((*self)->old_hashes);
+    free((*self)->new_hashes);
+    free(*self);
+    *self = NULL;
+}
+
+bool dirwd_chunk_matches(const struct dirwd_chunk_t* self, const char* path) {
+    return (self != NULL) && (fnmatch(self->opts.pattern, path, 0) == 0);
+}
+
+bool dirwd_chunk_file(struct dirwd_chunk_t* self, const char* path, struct dirwd_chunk_ranges_t* ranges, bool* has_table) {
+    ranges->len = 0;
+    ranges->size = 0;
+    ranges->removed = 0;
+    *has_table = false;
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if ((fstat(fd, &file_stat) != 0) || !S_ISREG(file_stat.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    const int64_t mtime_ns = (int64_t) file_stat.st_mtim.tv_sec * 1000000000 + file_stat.st_mtim.tv_nsec;
+
+    char table_path[DIRWD_CHUNK_TABLE_PATH_SIZE];
+    dirwd_chunk_table_path(self, path, table_path);
+
+    struct dirwd_chunk_file_header_t header;
+    *has_table = dirwd_chunk_load(self, table_path, path, &header);
+    const size_t old_count = *has_table ? (size_t) header.count : 0;
+
+    /* Size, modification time and inode as hashed before, nothing to read */
+    if (*has_table && (header.size == (int64_t) file_stat.st_size) && (header.mtime_ns == mtime_ns)
+        && (header.ino == (uint64_t) file_stat.st_ino))
+    {
+        self->files_unchanged++;
+        ranges->size = (uint64_t) header.size;
+        close(fd);
+        return true;
+    }
+
+    const size_t chunk_bytes = self->opts.chunk_bytes;
+    const size_t count = ((size_t) file_stat.st_size + chunk_bytes - 1) / chunk_bytes;
+    dirwd_chunk_reserve(self, count);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    /* File may shrink while it is read, its new mtime triggers another pass */
+    uint64_t size = 0;
+    size_t hashed = 0;
+    for (; hashed < count; hashed++) {
+        const ssize_t bytes = dirwd_chunk_read(fd, self->buffer, chunk_bytes, (off_t) (hashed * chunk_bytes));
+        if (bytes < 0) {
+            close(fd);
+            return false;
+        } else if (bytes == 0) {
+            break;
+        }
+
+        self->new_hashes[hashed] = dirwd_chunk_hash(self->buffer, (size_t) bytes);
+        size += (uint64_t) bytes;
+
+        if ((hashed >= old_count) || (self->old_hashes[hashed] != self->new_hashes[hashed])) {
+            dirwd_chunk_ranges_push(ranges, (uint64_t) hashed * chunk_bytes, (uint64_t) bytes);
+        }
+
+        if ((size_t) bytes < chunk_bytes) {
+            hashed++;
+            break;
+        }
+    }
+    close(fd);
+
+    self->files_hashed++;
+    self->bytes_read += size;
+
+    /* Truncation to a chunk boundary changes no remaining chunk */
+    ranges->size = size;
+    if (*has_table && (header.size > (int64_t) size)) {
+        ranges->removed = (uint64_t) header.size - size;
+    }
+
+    memcpy(header.magic, DIRWD_CHUNK_FILE_MAGIC, sizeof(header.magic));
+    header.version = DIRWD_CHUNK_FILE_VERSION;
+    header.path_len = (uint32_t) strlen(path);
+    header.chunk_bytes = chunk_bytes;
+    header.size = (int64_t) size;
+    header.mtime_ns = mtime_ns;
+    header.ino = (uint64_t) file_stat.st_ino;
+    header.count = hashed;
+
+    if (!dirwd_chunk_store(self, table_path, path, &header)) {
+        syslog(LOG_ERR, "Failed to write chunk table '%s': %s", table_path, strerror(errno));
+    }
+
+    return true;
+}
+
+void dirwd_chunk_forget(struct dirwd_chunk_t* self, const char* path) {
+    char table_path[DIRWD_CHUNK_TABLE_PATH_SIZE];
+    dirwd_chunk_table_path(self, path, table_path);
+    unlink(table_path);
+}
+
+static FILE* dirwd_chunk_detail_open(struct dirwd_chunk_t* self, struct dirwd_chunk_detail_t* detail) {
+    if ((detail->fout != NULL) || detail->is_failed) {
+        return detail->fout;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const int path_len = snprintf(detail->path, sizeof(detail->path), "%s/delta-%lld-%09ld.tsv",
+        self->opts.dir, (long long) now.tv_sec, (long) now.tv_nsec);
+
+    detail->fout = (path_len < (int) sizeof(detail->path)) ? fopen(detail->path, "w") : NULL;
+    if (detail->fout == NULL) {
+        syslog(LOG_ERR, "Failed to create chunk delta file '%s': %s", detail->path, strerror(errno));
+        detail->is_failed = true;
+        return NULL;
+    }
+
+    /* Keep last DIRWD_CHUNK_DELTA_FILES files */
+    detail_files_push(&self->delta_files, detail->path);
+
+    return detail->fout;
+}
+
+static void dirwd_chunk_report(
+    struct dirwd_chunk_t* self,
+    const char* path,
+    const struct dirwd_chunk_ranges_t* ranges,
+    struct dirwd_chunk_detail_t* detail
+)
+{
+    FILE* const fout = dirwd_chunk_detail_open(self, detail);
+    uint64_t bytes = 0;
+
+    for (size_t i = 0; i < ranges->len; i++) {
+        bytes += ranges->buffer[i].length;
+        if (fout != NULL) {
+            fprintf(fout, "%s\t%llu\t%llu\n", path,
+                (unsigned long long) ranges->buffer[i].offset, (unsigned long long) ranges->buffer[i].length);
+        }
+    }
+
+    if ((fout != NULL) && (ranges->removed > 0)) {
+        fprintf(fout, "%s\t%llu\t%llu\tTRUNCATED\n", path,
+            (unsigned long long) ranges->size, (unsigned long long) ranges->removed);
+    }
+
+    char text[256] = "";
+    size_t text_len = 0;
+    for (size_t i = 0; (i < ranges->len) && (i < DIRWD_CHUNK_LOG_RANGES); i++) {
+        text_len += (size_t) snprintf(text + text_len, sizeof(text) - text_len, "%s%llu+%llu",
+            (i > 0) ? " " : "",
+            (unsigned long long) ranges->buffer[i].offset,
+            (unsigned long long) ranges->buffer[i].length);
+    }
+
+    char truncated[64] = "";
+    if (ranges->removed > 0) {
+        snprintf(truncated, sizeof(truncated), "%struncated %llu bytes at %llu",
+            (ranges->len > 0) ? ", " : "",
+            (unsigned long long) ranges->removed, (unsigned long long) ranges->size);
+    }
+
+    syslog(LOG_INFO, "MODIFIED RANGES: '%s' %zu ranges, %llu bytes: %s%s%s%s%s%s",
+        path,
+        ranges->len,
+        (unsigned long long) bytes,
+        text,
+        (ranges->len > DIRWD_CHUNK_LOG_RANGES) ? " ..." : "",
+        truncated,
+        (fout != NULL) ? ", details in '" : "",
+        (fout != NULL) ? detail->path : "",
+        (fout != NULL) ? "'" : ""
+    );
+}
+
+static void dirwd_chunk_update_entries(
+    struct dirwd_chunk_t* self,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries,
+    struct dirwd_chunk_ranges_t* ranges,
+    struct dirwd_chunk_detail_t* detail
+)
+{
+    for (size_t i = 0; i < entries->len; i++) {
+        const char* path = fsnap_path(snap, entries->buffer[i]);
+        bool has_table = false;
+
+        if (!dirwd_chunk_matches(self, path)) {
+            continue;
+        } else if (!dirwd_chunk_file(self, path, ranges, &has_table)) {
+            syslog(LOG_DEBUG, "Failed to hash chunks of '%s': %s", path, strerror(errno));
+            continue;
+        }
+
+        /* First hash of a file has nothing to compare with */
+        if (has_table && ((ranges->len > 0) || (ranges->removed > 0))) {
+            dirwd_chunk_report(self, path, ranges, detail);
+        }
+    }
+}
+
+void dirwd_chunk_update(
+    struct dirwd_chunk_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+)
+{
+    if ((self == NULL) || (old_snap == NULL) || (new_snap == NULL) || (diff == NULL)) {
+        return;
+    }
+
+    self->files_hashed = 0;
+    self->files_unchanged = 0;
+    self->bytes_read = 0;
+
+    struct dirwd_chunk_ranges_t ranges = { .cap = 0, .len = 0, .buffer = NULL, .size = 0, .removed = 0 };
+    struct dirwd_chunk_detail_t detail = { .fout = NULL, .is_failed = false };
+
+    /* New entries may have tables from before daemon restart */
+    dirwd_chunk_update_entries(self, new_snap, &diff->new_entries, &ranges, &detail);
+    dirwd_chunk_update_entries(self, new_snap, &diff->modified_entries, &ranges, &detail);
+
+    for (size_t i = 0; i < diff->deleted_entries.len; i++) {
+        const char* path = fsnap_path(old_snap, diff->deleted_entries.buffer[i]);
+        if (dirwd_chunk_matches(self, path)) {
+            dirwd_chunk_forget(self, path);
+        }
+    }
+
+    dirwd_chunk_ranges_clean(&ranges);
+
+    if ((detail.fout != NULL) && (fclose(detail.fout) != 0)) {
+        syslog(LOG_ERR, "Failed to write chunk delta file '%s': %s", detail.path, strerror(errno));
+    }
+
+    if ((self->files_hashed > 0) || (self->files_unchanged > 0)) {
+        syslog(LOG_DEBUG, "Chunks: %zu files hashed (%llu bytes read), %zu files unchanged since their tables",
+            self->files_hashed, (unsigned long long) self->bytes_read, self->files_unchanged);
+    }
+}
+
+void dirwd_chunk_ranges_clean(struct dirwd_chunk_ranges_t* ranges) {
+    free(ranges->buffer);
+    ranges->cap = 0;
+    ranges->len = 0;
+    ranges->buffer = NULL;
+}
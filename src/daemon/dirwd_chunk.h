@@ -0,0 +1,122 @@
+/**
+ * @file dirwd_chunk.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog chunk-level delta detection for large files
+ *
+ * Files whose path matches a pattern are split into fixed-size chunks and
+ * a hash of every chunk is kept in a table file per path. When such file is
+ * reported new or modified, its chunks are hashed again and compared with
+ * the table, changed byte ranges are logged and written to a detail file.
+ * Bytes cut off the end of a truncated file are reported separately.
+ * Tables record size, modification time and inode of the hashed file, file
+ * still matching them is not read at all, also after daemon restart.
+ *
+ * Chunks have fixed offsets, so appends and in-place patches change only
+ * chunks they touch. Data inserted in the middle shifts all later chunks.
+ */
+
+#ifndef __DAEMON_DIRWD_CHUNK_H__
+#define __DAEMON_DIRWD_CHUNK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "../util/fsnap.h"
+#include "../util/detail_files.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_CHUNK_KB_DEFAULT   ((size_t) 1024)
+#define DIRWD_CHUNK_MIN_KB       ((size_t) 4)
+#define DIRWD_CHUNK_MAX_KB       ((size_t) 1048576)
+#define DIRWD_CHUNK_PATTERN_SIZE ((size_t) 256)
+#define DIRWD_CHUNK_DELTA_FILES  ((size_t) 32) /* Detail files kept */
+#define DIRWD_CHUNK_LOG_RANGES   ((size_t) 4)  /* Ranges printed to syslog per file */
+
+#define DIRWD_CHUNK_DEFAULT_DIR "/var/tmp/dirwdd/chunks"
+
+#define DIRWD_CHUNK_FILE_MAGIC   "DWCHUNK1"
+#define DIRWD_CHUNK_FILE_VERSION ((uint32_t) 1)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_chunk_opts_t {
+    bool enabled;
+    char pattern[DIRWD_CHUNK_PATTERN_SIZE]; /* fnmatch(3) pattern of full path, '*' also matches '/' */
+    size_t chunk_bytes;
+    char dir[PATH_MAX]; /* Table and detail files */
+};
+
+/* Table file header, followed by path and chunk hashes in native byte order */
+struct dirwd_chunk_file_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t path_len;
+    uint64_t chunk_bytes;
+    int64_t size;
+    int64_t mtime_ns;
+    uint64_t ino;
+    uint64_t count;
+};
+
+struct dirwd_chunk_range_t {
+    uint64_t offset;
+    uint64_t length;
+};
+
+struct dirwd_chunk_ranges_t {
+    size_t cap;
+    size_t len;
+    struct dirwd_chunk_range_t* buffer;
+    uint64_t size; /* Hashed file size */
+    uint64_t removed; /* Bytes removed from the end since the table, starting at size */
+};
+
+struct dirwd_chunk_t {
+    struct dirwd_chunk_opts_t opts;
+    unsigned char* buffer; /* One chunk */
+
+    size_t hashes_cap;
+    uint64_t* old_hashes;
+    uint64_t* new_hashes;
+
+    struct detail_files_t delta_files;
+
+    /* Current inspection statistics */
+    size_t files_hashed;
+    size_t files_unchanged;
+    uint64_t bytes_read;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct dirwd_chunk_t* dirwd_chunk_new(const struct dirwd_chunk_opts_t* opts);
+
+void dirwd_chunk_drop(struct dirwd_chunk_t** self);
+
+bool dirwd_chunk_matches(const struct dirwd_chunk_t* self, const char* path);
+
+uint64_t dirwd_chunk_hash(const unsigned char* data, size_t len);
+
+/* Hash file unless its table is current, store table and receive byte ranges changed since the table.
+ * Without usable previous table whole file is changed and has_table is false. False if file can not be read */
+bool dirwd_chunk_file(struct dirwd_chunk_t* self, const char* path, struct dirwd_chunk_ranges_t* ranges, bool* has_table);
+
+/* Remove table of deleted file */
+void dirwd_chunk_forget(struct dirwd_chunk_t* self, const char* path);
+
+/* Update tables of matching new, modified and deleted entries and report changed ranges */
+void dirwd_chunk_update(
+    struct dirwd_chunk_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+);
+
+void dirwd_chunk_ranges_clean(struct dirwd_chunk_ranges_t* ranges);
+
+#endif /* __DAEMON_DIRWD_CHUNK_H__ */
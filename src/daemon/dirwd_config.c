@@ -4,6 +4,8 @@
  * @brief Directory watchdog Linux daemon configuration module
  */
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -21,7 +23,42 @@
 dirwd_status_t dirwd_config_read(const char* path, struct dirwd_config_t* config_buf) {
     config_buf->target_dir = NULL;
     config_buf->timeout_sec = 0;
-    
+    config_buf->scan_opts.threads = 1;
+    config_buf->scan_opts.one_fs = false;
+    config_buf->scan_opts.follow_symlinks = true;
+    config_buf->scan_opts.inode_order = false;
+    config_buf->scan_opts.filter = NULL;
+    config_buf->scan_opts.filter_ctx = NULL;
+    config_buf->scan_opts.visit = NULL;
+    config_buf->scan_opts.visit_ctx = NULL;
+    config_buf->scan_opts.prof = NULL;
+    config_buf->scan_opts.fs = NULL;
+    config_buf->scan_opts.fs_ctx = NULL;
+    config_buf->tier_opts.enabled = false;
+    config_buf->tier_opts.warm_ticks = DIRWD_TIER_WARM_TICKS_DEFAULT;
+    config_buf->tier_opts.cold_ticks = DIRWD_TIER_COLD_TICKS_DEFAULT;
+    config_buf->fan_opts.enabled = false;
+    config_buf->fan_opts.reconcile_ticks = DIRWD_FAN_RECONCILE_TICKS_DEFAULT;
+    config_buf->output_opts.sinks = DIRWD_OUTPUT_SYSLOG;
+    config_buf->output_opts.ring_slots = DIRWD_RING_DEFAULT_SLOTS;
+    strcpy(config_buf->output_opts.ring_path, DIRWD_OUTPUT_DEFAULT_RING_PATH);
+    config_buf->output_opts.journal_segment_bytes = DIRWD_JOURNAL_SEGMENT_BYTES_DEFAULT;
+    config_buf->output_opts.journal_retain_bytes = DIRWD_JOURNAL_RETAIN_BYTES_DEFAULT;
+    config_buf->output_opts.journal_dir[0] = '\0';
+    config_buf->output_opts.storm_threshold = 0;
+    strcpy(config_buf->output_opts.storm_dir, DIRWD_OUTPUT_DEFAULT_STORM_DIR);
+    config_buf->prof_opts.enabled = false;
+    config_buf->prof_opts.top = DIRWD_PROF_TOP_DEFAULT;
+    strcpy(config_buf->prof_opts.file, DIRWD_PROF_DEFAULT_FILE);
+    config_buf->ctl_opts.socket_path[0] = '\0';
+    config_buf->chunk_opts.enabled = false;
+    config_buf->chunk_opts.pattern[0] = '\0';
+    config_buf->chunk_opts.chunk_bytes = DIRWD_CHUNK_KB_DEFAULT * 1024;
+    strcpy(config_buf->chunk_opts.dir, DIRWD_CHUNK_DEFAULT_DIR);
+    config_buf->fprint_opts.enabled = false;
+    config_buf->fprint_opts.cache_dirs = DIRWD_FPRINT_CACHE_DEFAULT;
+    config_buf->query_opts.socket_path[0] = '\0';
+
     /* Assert parametrs */
     assert(path != NULL);
     assert(config_buf != NULL);
@@ -32,13 +69,15 @@ dirwd_status_t dirwd_config_read(const char* path, struct dirwd_config_t* config
         return DIRWD_FAILED_TO_OPEN_CONFIG;
     }
 
-    /* Raed configuration from file */
-    char file_string_buffer[STRING_BUFFER_SIZE] = { 0 };
-    char config_string_buffer[STRING_BUFFER_SIZE] = { 0 };
-    bool config_string_found = false;
+    /* Raed configuration from file, line is read whole whatever its length */
+    char* file_string_buffer = NULL;
+    size_t file_string_cap = 0;
+    char* config_string_buffer = NULL;
     bool config_redefinition = false;
+    bool config_too_long = false;
+    ssize_t file_string_len = 0;
 
-    while (fgets(file_string_buffer, STRING_BUFFER_SIZE, fin) != NULL) {
+    while ((file_string_len = getline(&file_string_buffer, &file_string_cap, fin)) >= 0) {
         /* Replace newline character if any */
         char* newline_char_ptr = strchr(file_string_buffer, '\n');
         if (newline_char_ptr != NULL) {
@@ -47,39 +86,54 @@ dirwd_status_t dirwd_config_read(const char* path, struct dirwd_config_t* config
 
         if (strlen(file_string_buffer) == 0) {
             continue;
-        } else if (!config_string_found) {
-            config_string_found = true;
-            strcpy(config_string_buffer, file_string_buffer);
-        } else if (config_string_found) {
+        } else if ((size_t) file_string_len > DIRWD_CONFIG_MAX_LINE_LEN) {
+            config_too_long = true;
+            break;
+        } else if (config_string_buffer == NULL) {
+            config_string_buffer = file_string_buffer;
+            file_string_buffer = NULL;
+            file_string_cap = 0;
+        } else {
             config_redefinition = true;
             break;
         }
     }
 
+    free(file_string_buffer);
+
+    dirwd_status_t status = DIRWD_SUCCESS;
     if (ferror(fin) != 0) {
-        fclose(fin);
-        return DIRWD_FAILED_TO_READ_CONFIG;
-    } else if (!config_string_found || config_redefinition) {
-        fclose(fin);
-        return DIRWD_INVALID_CONFIG_FORMAT;
+        status = DIRWD_FAILED_TO_READ_CONFIG;
+    } else if ((config_string_buffer == NULL) || config_redefinition || config_too_long) {
+        status = DIRWD_INVALID_CONFIG_FORMAT;
     } else if (feof(fin) == 0) {
-        fclose(fin);
-        return DIRWD_FAILED_TO_READ_CONFIG;
+        status = DIRWD_FAILED_TO_READ_CONFIG;
     }
 
     fclose(fin);
 
-    char target_dir_buffer[STRING_BUFFER_SIZE] = { 0 };
+    if (status != DIRWD_SUCCESS) {
+        free(config_string_buffer);
+        return status;
+    }
+
+    /* Target directory is never longer than the line */
+    char* target_dir = (char*) calloc(strlen(config_string_buffer) + 1, sizeof(char));
     size_t timeout = 0;
+    const char* options_string = NULL;
+
+    status = dirwd_config_tokenize(config_string_buffer, target_dir, &timeout, &options_string);
+    if (status == DIRWD_SUCCESS) {
+        status = dirwd_config_parse_options(options_string, config_buf);
+    }
+
+    free(config_string_buffer);
 
-    dirwd_status_t status = dirwd_config_tokenize(config_string_buffer, target_dir_buffer, &timeout);
     if (status != DIRWD_SUCCESS) {
+        free(target_dir);
         return status;
     }
 
-    char* target_dir = (char*) malloc((strlen(target_dir_buffer) + 1) *sizeof(char));
-    strcpy(target_dir, target_dir_buffer);
-
     /* Copy configuration parameters to the buffer structure */
     config_buf->target_dir = target_dir;
     config_buf->timeout_sec = timeout;
@@ -110,6 +164,27 @@ dirwd_status_t dirwd_config_assert(const struct dirwd_config_t* config) {
         return DIRWD_INVALID_CONFIG_TIMEOUT;
     }
 
+    /* Assert tier intervals */
+    if (config->tier_opts.warm_ticks > config->tier_opts.cold_ticks) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    /* Fanotify decides which directories are scanned, tiers can not be used with it */
+    if (config->fan_opts.enabled && config->tier_opts.enabled) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    /* Partial scans carry entries over from a full snapshot, which fingerprint mode does not keep */
+    const bool is_partial = config->tier_opts.enabled || config->fan_opts.enabled || (config->ctl_opts.socket_path[0] != '\0');
+    if (config->fprint_opts.enabled && is_partial) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    /* Queries are answered from the snapshot of all files */
+    if (config->fprint_opts.enabled && (config->query_opts.socket_path[0] != '\0')) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
     return DIRWD_SUCCESS;
 }
 
@@ -117,34 +192,51 @@ dirwd_status_t dirwd_config_setup(const struct dirwd_config_t* config, struct di
     assert(config != NULL);
     assert(cur_state != NULL);
 
-    dirwd_status_t status = 0;
-
-    status = dirwd_state_clean(cur_state);
+    /* New state is built next to the current one, which stays in use if setup fails */
+    struct dirwd_state_t new_state;
+    memset(&new_state, 0, sizeof(new_state));
+
+    dirwd_status_t status = dirwd_state_set(&new_state,
+        config->target_dir,
+        config->timeout_sec,
+        &config->scan_opts,
+        &config->tier_opts,
+        &config->fan_opts,
+        &config->output_opts,
+        &config->prof_opts,
+        &config->ctl_opts,
+        &config->chunk_opts,
+        &config->fprint_opts,
+        &config->query_opts
+    );
     if (status != DIRWD_SUCCESS) {
         return status;
     }
 
-    status = dirwd_state_set(cur_state, config->target_dir, config->timeout_sec);
-    if (status != DIRWD_SUCCESS) {
-        return status;
-    }
+    status = dirwd_state_clean(cur_state);
+    *cur_state = new_state;
 
-    return DIRWD_SUCCESS;
+    return status;
 }
 
-dirwd_status_t dirwd_config_tokenize(const char* config_string, char* target_dir_buf, size_t* timeout_buf) {
+dirwd_status_t dirwd_config_tokenize(
+    const char* config_string,
+    char* target_dir_buf,
+    size_t* timeout_buf,
+    const char** options_buf
+)
+{
     assert(config_string != NULL);
     assert(target_dir_buf != NULL);
     assert(timeout_buf != NULL);
+    assert(options_buf != NULL);
 
     const size_t config_string_len = strlen(config_string);
     const char* p_current = config_string;
     const char* const p_end = config_string + config_string_len;
 
-    const char* cur_char_ptr = config_string;
-
     /* Skip whitespace */
-    while (isspace(*cur_char_ptr) && (p_current != p_end)) {
+    while ((p_current != p_end) && isspace((unsigned char) *p_current)) {
         p_current++;
     }
 
@@ -158,8 +250,7 @@ dirwd_status_t dirwd_config_tokenize(const char* config_string, char* target_dir
     char* p_buffer = target_dir_buf;
 
     while ((p_current != p_end)
-        && (quotes_opened 
-            || (!quotes_opened && !isspace(*p_current))))
+        && (quotes_opened || shield_detected || !isspace((unsigned char) *p_current)))
     {
         if (shield_detected) {
             /* If shield symbol was detected read verbatim */
@@ -184,13 +275,14 @@ dirwd_status_t dirwd_config_tokenize(const char* config_string, char* target_dir
 
         p_current++;
     }
+    *p_buffer = '\0';
 
     if (p_current == p_end) {
         return DIRWD_INVALID_CONFIG_TARGET_DIR;
     }
 
     /* Skip whitespace */
-    while (isspace(*cur_char_ptr) && (p_current != p_end)) {
+    while ((p_current != p_end) && isspace((unsigned char) *p_current)) {
         p_current++;
     }
 
@@ -201,19 +293,324 @@ dirwd_status_t dirwd_config_tokenize(const char* config_string, char* target_dir
     /* Parse timeout */
     char timeout_string_buffer[STRING_BUFFER_SIZE] = { 0 };
     p_buffer = timeout_string_buffer;
-    while (!isspace(*cur_char_ptr) && (p_current != p_end)) {
+    while ((p_current != p_end) && !isspace((unsigned char) *p_current)) {
+        if (p_buffer == timeout_string_buffer + STRING_BUFFER_SIZE - 1) {
+            return DIRWD_INVALID_CONFIG_TIMEOUT;
+        }
         *p_buffer = *p_current;
         p_buffer++;
         p_current++;
     }
     *p_buffer = '\0';
 
-    const long timeout_parsed = strtol(timeout_string_buffer, NULL, 10);
-    if ((timeout_parsed <= 0) || (errno == ERANGE)) {
+    char* p_timeout_end = NULL;
+    errno = 0;
+    const long timeout_parsed = strtol(timeout_string_buffer, &p_timeout_end, 10);
+    if ((timeout_parsed <= 0) || (errno == ERANGE) || (*p_timeout_end != '\0')) {
         return DIRWD_INVALID_CONFIG_TIMEOUT;
     }
 
     *timeout_buf = (size_t) timeout_parsed;
+    *options_buf = p_current;
+
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_bool(const char* value, bool* option) {
+    if ((strcmp(value, "yes") == 0) || (strcmp(value, "1") == 0)) {
+        *option = true;
+    } else if ((strcmp(value, "no") == 0) || (strcmp(value, "0") == 0)) {
+        *option = false;
+    } else {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_size(const char* value, size_t min, size_t max, size_t* option) {
+    char* p_end = NULL;
+    errno = 0;
+    const unsigned long long parsed = strtoull(value, &p_end, 10);
+
+    if ((p_end == value) || (*p_end != '\0') || (errno == ERANGE)
+        || (parsed < min) || (parsed > max))
+    {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    *option = (size_t) parsed;
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_one_fs(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->scan_opts.one_fs);
+}
+
+static dirwd_status_t dirwd_config_parse_inode_order(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->scan_opts.inode_order);
+}
+
+static dirwd_status_t dirwd_config_parse_symlinks(const char* value, struct dirwd_config_t* config) {
+    if (strcmp(value, "follow") == 0) {
+        config->scan_opts.follow_symlinks = true;
+    } else if (strcmp(value, "record") == 0) {
+        config->scan_opts.follow_symlinks = false;
+    } else {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_scan_threads(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_SCAN_MAX_THREADS, &config->scan_opts.threads);
+}
+
+static dirwd_status_t dirwd_config_parse_tiers(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->tier_opts.enabled);
+}
+
+static dirwd_status_t dirwd_config_parse_warm_ticks(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_TIER_MAX_TICKS, &config->tier_opts.warm_ticks);
+}
+
+static dirwd_status_t dirwd_config_parse_cold_ticks(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_TIER_MAX_TICKS, &config->tier_opts.cold_ticks);
+}
+
+static dirwd_status_t dirwd_config_parse_fanotify(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->fan_opts.enabled);
+}
+
+static dirwd_status_t dirwd_config_parse_reconcile_ticks(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_FAN_MAX_RECONCILE_TICKS, &config->fan_opts.reconcile_ticks);
+}
+
+static dirwd_status_t dirwd_config_parse_events(const char* value, struct dirwd_config_t* config) {
+    /* Journal sink is enabled separately by journal option */
+    uint8_t* const sinks = &config->output_opts.sinks;
+
+    if (strcmp(value, "syslog") == 0) {
+        *sinks = (*sinks & DIRWD_OUTPUT_JOURNAL) | DIRWD_OUTPUT_SYSLOG;
+    } else if (strcmp(value, "ring") == 0) {
+        *sinks = (*sinks & DIRWD_OUTPUT_JOURNAL) | DIRWD_OUTPUT_RING;
+    } else if (strcmp(value, "both") == 0) {
+        *sinks = (*sinks & DIRWD_OUTPUT_JOURNAL) | DIRWD_OUTPUT_SYSLOG | DIRWD_OUTPUT_RING;
+    } else {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_ring(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) >= sizeof(config->output_opts.ring_path))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->output_opts.ring_path, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_ring_slots(const char* value, struct dirwd_config_t* config) {
+    size_t* const ring_slots = &config->output_opts.ring_slots;
+    const dirwd_status_t status = dirwd_config_parse_size(value, DIRWD_RING_MIN_SLOTS, DIRWD_RING_MAX_SLOTS, ring_slots);
+
+    if ((status == DIRWD_SUCCESS) && ((*ring_slots & (*ring_slots - 1)) != 0)) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    return status;
+}
+
+static dirwd_status_t dirwd_config_parse_journal(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) >= sizeof(config->output_opts.journal_dir))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->output_opts.journal_dir, value);
+    config->output_opts.sinks |= DIRWD_OUTPUT_JOURNAL;
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_journal_segment_mb(const char* value, struct dirwd_config_t* config) {
+    size_t segment_mb = 0;
+    const dirwd_status_t status = dirwd_config_parse_size(value, 1, DIRWD_CONFIG_MAX_JOURNAL_MB, &segment_mb);
+
+    config->output_opts.journal_segment_bytes = segment_mb * 1024 * 1024;
+    return status;
+}
+
+static dirwd_status_t dirwd_config_parse_journal_retain_mb(const char* value, struct dirwd_config_t* config) {
+    size_t retain_mb = 0;
+    const dirwd_status_t status = dirwd_config_parse_size(value, 1, DIRWD_CONFIG_MAX_JOURNAL_MB, &retain_mb);
+
+    config->output_opts.journal_retain_bytes = retain_mb * 1024 * 1024;
+    return status;
+}
+
+static dirwd_status_t dirwd_config_parse_storm_threshold(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 0, DIRWD_STORM_MAX_THRESHOLD, &config->output_opts.storm_threshold);
+}
+
+static dirwd_status_t dirwd_config_parse_storm_dir(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) + 64 >= sizeof(config->output_opts.storm_dir))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->output_opts.storm_dir, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_profile(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->prof_opts.enabled);
+}
+
+static dirwd_status_t dirwd_config_parse_profile_top(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_PROF_MAX_TOP, &config->prof_opts.top);
+}
+
+static dirwd_status_t dirwd_config_parse_profile_file(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) + 8 >= sizeof(config->prof_opts.file))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->prof_opts.file, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_control(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) >= sizeof(config->ctl_opts.socket_path))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->ctl_opts.socket_path, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_query(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) >= sizeof(config->query_opts.socket_path))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->query_opts.socket_path, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_chunk_pattern(const char* value, struct dirwd_config_t* config) {
+    if (strlen(value) >= sizeof(config->chunk_opts.pattern)) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->chunk_opts.pattern, value);
+    config->chunk_opts.enabled = true;
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_chunk_kb(const char* value, struct dirwd_config_t* config) {
+    size_t chunk_kb = 0;
+    const dirwd_status_t status = dirwd_config_parse_size(value, DIRWD_CHUNK_MIN_KB, DIRWD_CHUNK_MAX_KB, &chunk_kb);
+
+    config->chunk_opts.chunk_bytes = chunk_kb * 1024;
+    return status;
+}
+
+static dirwd_status_t dirwd_config_parse_chunk_dir(const char* value, struct dirwd_config_t* config) {
+    if ((value[0] != '/') || (strlen(value) + 64 >= sizeof(config->chunk_opts.dir))) {
+        return DIRWD_INVALID_CONFIG_OPTION;
+    }
+
+    strcpy(config->chunk_opts.dir, value);
+    return DIRWD_SUCCESS;
+}
+
+static dirwd_status_t dirwd_config_parse_fingerprint(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_bool(value, &config->fprint_opts.enabled);
+}
+
+static dirwd_status_t dirwd_config_parse_fingerprint_cache(const char* value, struct dirwd_config_t* config) {
+    return dirwd_config_parse_size(value, 1, DIRWD_FPRINT_MAX_CACHE, &config->fprint_opts.cache_dirs);
+}
+
+static const struct dirwd_config_option_t dirwd_config_options[] = {
+    { "one_fs", dirwd_config_parse_one_fs },
+    { "symlinks", dirwd_config_parse_symlinks },
+    { "inode_order", dirwd_config_parse_inode_order },
+    { "scan_threads", dirwd_config_parse_scan_threads },
+    { "tiers", dirwd_config_parse_tiers },
+    { "warm_ticks", dirwd_config_parse_warm_ticks },
+    { "cold_ticks", dirwd_config_parse_cold_ticks },
+    { "fanotify", dirwd_config_parse_fanotify },
+    { "reconcile_ticks", dirwd_config_parse_reconcile_ticks },
+    { "events", dirwd_config_parse_events },
+    { "ring", dirwd_config_parse_ring },
+    { "ring_slots", dirwd_config_parse_ring_slots },
+    { "journal", dirwd_config_parse_journal },
+    { "journal_segment_mb", dirwd_config_parse_journal_segment_mb },
+    { "journal_retain_mb", dirwd_config_parse_journal_retain_mb },
+    { "storm_threshold", dirwd_config_parse_storm_threshold },
+    { "storm_dir", dirwd_config_parse_storm_dir },
+    { "profile", dirwd_config_parse_profile },
+    { "profile_top", dirwd_config_parse_profile_top },
+    { "profile_file", dirwd_config_parse_profile_file },
+    { "control", dirwd_config_parse_control },
+    { "query", dirwd_config_parse_query },
+    { "chunk_pattern", dirwd_config_parse_chunk_pattern },
+    { "chunk_kb", dirwd_config_parse_chunk_kb },
+    { "chunk_dir", dirwd_config_parse_chunk_dir },
+    { "fingerprint", dirwd_config_parse_fingerprint },
+    { "fingerprint_cache", dirwd_config_parse_fingerprint_cache },
+};
+
+dirwd_status_t dirwd_config_parse_options(const char* options_string, struct dirwd_config_t* config) {
+    assert(options_string != NULL);
+    assert(config != NULL);
+
+    const char* p_current = options_string;
+    const size_t options_num = sizeof(dirwd_config_options) / sizeof(dirwd_config_options[0]);
+
+    while (*p_current != '\0') {
+        /* Skip whitespace */
+        while (isspace((unsigned char) *p_current)) {
+            p_current++;
+        }
+
+        if (*p_current == '\0') {
+            break;
+        }
+
+        /* Read key=value token */
+        char token_buffer[DIRWD_CONFIG_TOKEN_SIZE] = { 0 };
+        size_t token_len = 0;
+        while ((*p_current != '\0') && !isspace((unsigned char) *p_current)) {
+            if (token_len + 1 == sizeof(token_buffer)) {
+                return DIRWD_INVALID_CONFIG_OPTION;
+            }
+            token_buffer[token_len++] = *p_current++;
+        }
+
+        char* p_value = strchr(token_buffer, '=');
+        if ((p_value == NULL) || (p_value == token_buffer) || (p_value[1] == '\0')) {
+            return DIRWD_INVALID_CONFIG_OPTION;
+        }
+        *p_value = '\0';
+        p_value++;
+
+        size_t option_idx = 0;
+        while ((option_idx < options_num) && (strcmp(dirwd_config_options[option_idx].key, token_buffer) != 0)) {
+            option_idx++;
+        }
+
+        if (option_idx == options_num) {
+            return DIRWD_INVALID_CONFIG_OPTION;
+        }
+
+        const dirwd_status_t status = dirwd_config_options[option_idx].parse(p_value, config);
+        if (status != DIRWD_SUCCESS) {
+            return status;
+        }
+    }
 
     return DIRWD_SUCCESS;
 }
@@ -8,18 +8,35 @@
 #define __DIRWD_CONFIG_H__
 
 #include <stdint.h>
+#include <limits.h>
 
 #include "dirwd_status.h"
 #include "dirwd_state.h"
+#include "dirwd_scan.h"
+#include "dirwd_tier.h"
+#include "dirwd_fan.h"
+#include "dirwd_output.h"
+#include "dirwd_storm.h"
+#include "dirwd_prof.h"
+#include "dirwd_ctl.h"
+#include "dirwd_query.h"
+#include "dirwd_chunk.h"
+#include "dirwd_fprint.h"
 
 /* Define -------------------------------------------------------------------*/
 
 #define MAX_DIR_NAME_LEN    ((size_t) 128)
 #define STRING_BUFFER_SIZE  ((size_t) 256)
 
+/* Target directory and every option with a value of PATH_MAX fit in a line */
+#define DIRWD_CONFIG_MAX_LINE_LEN ((size_t) 32 * PATH_MAX)
+#define DIRWD_CONFIG_TOKEN_SIZE   ((size_t) PATH_MAX + 32) /* key=value */
+
 #define MAX_TIMEOUT ((uint64_t) 3600)
 #define MIN_TIMEOUT ((uint64_t) 10)
 
+#define DIRWD_CONFIG_MAX_JOURNAL_MB ((size_t) 1048576)
+
 #define QUOTE_SYMBOL '"'
 #define SHIELD_SYMBOL '\\'
 
@@ -30,6 +47,21 @@
 struct dirwd_config_t {
     char* target_dir;
     size_t timeout_sec;
+    struct dirwd_scan_opts_t scan_opts;
+    struct dirwd_tier_opts_t tier_opts;
+    struct dirwd_fan_opts_t fan_opts;
+    struct dirwd_output_opts_t output_opts;
+    struct dirwd_prof_opts_t prof_opts;
+    struct dirwd_ctl_opts_t ctl_opts;
+    struct dirwd_chunk_opts_t chunk_opts;
+    struct dirwd_fprint_opts_t fprint_opts;
+    struct dirwd_query_opts_t query_opts;
+};
+
+/* Optional 'key=value' configuration field */
+struct dirwd_config_option_t {
+    const char* key;
+    dirwd_status_t (*parse)(const char* value, struct dirwd_config_t* config);
 };
 
 /* Function definitions -----------------------------------------------------*/
@@ -38,8 +70,16 @@ dirwd_status_t dirwd_config_read(const char* path, struct dirwd_config_t* config
 
 dirwd_status_t dirwd_config_assert(const struct dirwd_config_t* config);
 
+/* Replace state with one set up from config, state is kept unchanged on failure */
 dirwd_status_t dirwd_config_setup(const struct dirwd_config_t* config, struct dirwd_state_t* cur_state);
 
-dirwd_status_t dirwd_config_tokenize(const char* config_string, char* target_dir_buf, size_t* timeout_buf);
+dirwd_status_t dirwd_config_tokenize(
+    const char* config_string,
+    char* target_dir_buf,
+    size_t* timeout_buf,
+    const char** options_buf
+);
+
+dirwd_status_t dirwd_config_parse_options(const char* options_string, struct dirwd_config_t* config);
 
 #endif /* __DIRWD_CONFIG_H__ */
\ No newline at end of file
@@ -0,0 +1,498 @@
+/**
+ * @file dirwd_ctl.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog control socket and targeted subtree rescans
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/syslog.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../util/dir_table.h"
+#include "dirwd_ctl.h"
+
+/* Check if path is strictly below directory */
+static bool dirwd_ctl_is_below(const char* path, size_t len, const char* dir, size_t dir_len) {
+    return (len > dir_len) && (memcmp(path, dir, dir_len) == 0) && (path[dir_len] == '/');
+}
+
+/* Absolute path without empty, '.' or '..' components */
+static bool dirwd_ctl_is_normalized(const char* path, size_t len) {
+    if ((len > 0) && (path[0] != '/')) {
+        return false;
+    }
+
+    size_t start = 1;
+    for (size_t i = 1; i <= len; i++) {
+        if ((i < len) && (path[i] != '/')) {
+            continue;
+        }
+
+        const size_t part_len = i - start;
+        const bool is_dot = (part_len == 1) && (path[start] == '.');
+        const bool is_dot_dot = (part_len == 2) && (path[start] == '.') && (path[start + 1] == '.');
+
+        if ((part_len == 0) || is_dot || is_dot_dot) {
+            return false;
+        }
+        start = i + 1;
+    }
+
+    return true;
+}
+
+/* Directory whose files are rescanned with request, false if it is outside target */
+static bool dirwd_ctl_parent_len(const struct dirwd_ctl_t* self, const char* request, size_t len, size_t* parent_len) {
+    if (len <= self->target_len) {
+        return false;
+    }
+
+    *parent_len = (size_t) (strrchr(request, '/') - request);
+    return true;
+}
+
+static void dirwd_ctl_reply(int client, const char* text) {
+    if (send(client, text, strlen(text), MSG_NOSIGNAL) < 0) {
+        syslog(LOG_DEBUG, "Failed to reply to control client: %s", strerror(errno));
+    }
+    close(client);
+}
+
+static void dirwd_ctl_free_requests(char** requests, size_t* len) {
+    for (size_t i = 0; i < *len; i++) {
+        free(requests[i]);
+    }
+    *len = 0;
+}
+
+static void dirwd_ctl_handle(struct dirwd_ctl_t* self, int client) {
+    const struct timeval timeout = {
+        .tv_sec = 0,
+        .tv_usec = (suseconds_t) (DIRWD_CTL_READ_TIMEOUT_MS * 1000),
+    };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    /* Read one line, slow client gets whatever arrived within timeout */
+    char line[DIRWD_CTL_LINE_SIZE];
+    size_t len = 0;
+
+    while (len + 1 < sizeof(line)) {
+        const ssize_t bytes = recv(client, line + len, sizeof(line) - 1 - len, 0);
+        if ((bytes < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytes <= 0) {
+            break;
+        }
+
+        len += (size_t) bytes;
+        if (memchr(line, '\n', len) != NULL) {
+            break;
+        }
+    }
+    line[len] = '\0';
+
+    char* p_newline = strpbrk(line, "\r\n");
+    if (p_newline != NULL) {
+        *p_newline = '\0';
+    }
+
+    const size_t command_len = strlen(DIRWD_CTL_RESCAN_COMMAND);
+    if ((strncmp(line, DIRWD_CTL_RESCAN_COMMAND, command_len) != 0) || (line[command_len] != ' ')) {
+        dirwd_ctl_reply(client, "ERR unknown command\n");
+        return;
+    }
+
+    const char* path = line + command_len + 1;
+    if (!dirwd_ctl_request(self, path)) {
+        dirwd_ctl_reply(client, "ERR path is not a normalized absolute path under target\n");
+        return;
+    }
+
+    syslog(LOG_DEBUG, "Rescan of '%s' requested", path);
+
+    if (self->clients_len < DIRWD_CTL_MAX_CLIENTS) {
+        self->clients[self->clients_len++] = client;
+    } else {
+        dirwd_ctl_reply(client, "QUEUED\n");
+    }
+}
+
+int dirwd_ctl_listen(const char* socket_path, struct dirwd_ctl_socket_t* socket_file) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        syslog(LOG_ERR, "Socket path is too long: '%s'", socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    /* Socket left by previous daemon, or still open by the state being reloaded */
+    struct stat socket_stat;
+    if ((lstat(socket_path, &socket_stat) == 0) && S_ISSOCK(socket_stat.st_mode)) {
+        unlink(socket_path);
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        syslog(LOG_ERR, "Failed to create socket: %s", strerror(errno));
+        return -1;
+    }
+
+    if ((bind(fd, (const struct sockaddr*) &addr, sizeof(addr)) != 0) || (listen(fd, SOMAXCONN) != 0)
+        || (lstat(socket_path, &socket_stat) != 0))
+    {
+        syslog(LOG_ERR, "Failed to listen on socket '%s': %s", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    socket_file->dev = (uint64_t) socket_stat.st_dev;
+    socket_file->ino = (uint64_t) socket_stat.st_ino;
+    return fd;
+}
+
+void dirwd_ctl_unlisten(int fd, const char* socket_path, const struct dirwd_ctl_socket_t* socket_file) {
+    close(fd);
+
+    /* Socket of a reloaded state may already listen at the same path */
+    struct stat socket_stat;
+    if ((lstat(socket_path, &socket_stat) == 0) && ((uint64_t) socket_stat.st_dev == socket_file->dev)
+        && ((uint64_t) socket_stat.st_ino == socket_file->ino))
+    {
+        unlink(socket_path);
+    }
+}
+
+struct dirwd_ctl_t* dirwd_ctl_open(const char* target_dir, const struct dirwd_ctl_opts_t* opts) {
+    if ((target_dir == NULL) || (opts == NULL)) {
+        return NULL;
+    }
+
+    const size_t target_len = dir_table_trim(target_dir, strlen(target_dir));
+    if (target_len >= PATH_MAX) {
+        syslog(LOG_ERR, "Path is too long: '%s'", target_dir);
+        return NULL;
+    }
+
+    int fd = -1;
+    struct dirwd_ctl_socket_t socket_file = { 0, 0 };
+
+    if (opts->socket_path[0] != '\0') {
+        fd = dirwd_ctl_listen(opts->socket_path, &socket_file);
+        if (fd < 0) {
+            return NULL;
+        }
+    }
+
+    struct dirwd_ctl_t* new_ctl = (struct dirwd_ctl_t*) calloc(1, sizeof(struct dirwd_ctl_t));
+    new_ctl->opts = *opts;
+    new_ctl->fd = fd;
+    new_ctl->socket_file = socket_file;
+    memcpy(new_ctl->target, target_dir, target_len);
+    new_ctl->target[target_len] = '\0';
+    new_ctl->target_len = target_len;
+
+    return new_ctl;
+}
+
+void dirwd_ctl_close(struct dirwd_ctl_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    struct dirwd_ctl_t* ctl = *self;
+
+    for (size_t i = 0; i < ctl->clients_len; i++) {
+        dirwd_ctl_reply(ctl->clients[i], "ERR daemon stopped or reloaded\n");
+    }
+    for (size_t i = 0; i < ctl->active_clients_len; i++) {
+        dirwd_ctl_reply(ctl->active_clients[i], "ERR daemon stopped or reloaded\n");
+    }
+
+    dirwd_ctl_free_requests(ctl->requests, &ctl->len);
+    dirwd_ctl_free_requests(ctl->active, &ctl->active_len);
+
+    if (ctl->fd >= 0) {
+        dirwd_ctl_unlisten(ctl->fd, ctl->opts.socket_path, &ctl->socket_file);
+    }
+
+    free(ctl);
+    *self = NULL;
+}
+
+void dirwd_ctl_read(struct dirwd_ctl_t* self) {
+    if ((self == NULL) || (self->fd < 0)) {
+        return;
+    }
+
+    while (true) {
+        const int client = accept4(self->fd, NULL, NULL, SOCK_CLOEXEC);
+
+        if (client >= 0) {
+            dirwd_ctl_handle(self, client);
+        } else if (errno != EINTR) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                syslog(LOG_ERR, "Failed to accept control connection: %s", strerror(errno));
+            }
+            return;
+        }
+    }
+}
+
+bool dirwd_ctl_request(struct dirwd_ctl_t* self, const char* path) {
+    if ((self == NULL) || (path == NULL) || (path[0] != '/')) {
+        return false;
+    }
+
+    const size_t len = dir_table_trim(path, strlen(path));
+    const bool is_under_target = ((len == self->target_len) && (memcmp(path, self->target, len) == 0))
+        || dirwd_ctl_is_below(path, len, self->target, self->target_len);
+
+    if ((len >= PATH_MAX) || !is_under_target || !dirwd_ctl_is_normalized(path, len)) {
+        return false;
+    }
+
+    if (self->len == 0) {
+        self->first_request_ms = dirwd_ctl_now_ms();
+    }
+
+    /* Already covered by queued subtree */
+    for (size_t i = 0; i < self->len; i++) {
+        const size_t request_len = strlen(self->requests[i]);
+        if (((len == request_len) && (memcmp(path, self->requests[i], len) == 0))
+            || dirwd_ctl_is_below(path, len, self->requests[i], request_len))
+        {
+            return true;
+        }
+    }
+
+    /* Drop queued subtrees below new one */
+    for (size_t i = 0; i < self->len;) {
+        if (dirwd_ctl_is_below(self->requests[i], strlen(self->requests[i]), path, len)) {
+            free(self->requests[i]);
+            self->requests[i] = self->requests[--self->len];
+        } else {
+            i++;
+        }
+    }
+
+    if (self->len == DIRWD_CTL_MAX_REQUESTS) {
+        dirwd_ctl_free_requests(self->requests, &self->len);
+        self->requests[self->len++] = strdup(self->target);
+        return true;
+    }
+
+    self->requests[self->len++] = strndup(path, len);
+    return true;
+}
+
+int64_t dirwd_ctl_due_ms(const struct dirwd_ctl_t* self, int64_t now_ms) {
+    if ((self == NULL) || (self->len == 0)) {
+        return -1;
+    }
+
+    const int64_t due_ms = self->first_request_ms + DIRWD_CTL_COALESCE_MS - now_ms;
+    return (due_ms > 0) ? due_ms : 0;
+}
+
+int64_t dirwd_ctl_now_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void dirwd_ctl_begin(struct dirwd_ctl_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    dirwd_ctl_free_requests(self->active, &self->active_len);
+    memcpy(self->active, self->requests, self->len * sizeof(char*));
+    self->active_len = self->len;
+    self->len = 0;
+
+    memcpy(self->active_clients, self->clients, self->clients_len * sizeof(int));
+    self->active_clients_len = self->clients_len;
+    self->clients_len = 0;
+
+    self->dirs_full = 0;
+    self->dirs_descend = 0;
+    self->dirs_skip = 0;
+    self->entries_carried = 0;
+}
+
+dirwd_scan_action_t dirwd_ctl_filter(void* ctx, const char* path) {
+    struct dirwd_ctl_t* self = (struct dirwd_ctl_t*) ctx;
+    const size_t len = dir_table_trim(path, strlen(path));
+    bool is_ancestor = false;
+
+    for (size_t i = 0; i < self->active_len; i++) {
+        const char* request = self->active[i];
+        const size_t request_len = strlen(request);
+        size_t parent_len = 0;
+
+        const bool is_rescanned = ((len == request_len) && (memcmp(path, request, len) == 0))
+            || dirwd_ctl_is_below(path, len, request, request_len)
+            || (dirwd_ctl_parent_len(self, request, request_len, &parent_len)
+                && (len == parent_len) && (memcmp(path, request, len) == 0));
+
+        if (is_rescanned) {
+            self->dirs_full++;
+            return DIRWD_SCAN_FULL;
+        }
+
+        is_ancestor = is_ancestor || dirwd_ctl_is_below(request, request_len, path, len);
+    }
+
+    if (is_ancestor) {
+        self->dirs_descend++;
+        return DIRWD_SCAN_DESCEND;
+    }
+
+    self->dirs_skip++;
+    return DIRWD_SCAN_SKIP;
+}
+
+/* Entry is carried unless it is below requested path or directly in its parent directory */
+static bool dirwd_ctl_is_carried(const struct dirwd_ctl_t* self, const char* path) {
+    const size_t len = strlen(path);
+    const char* p_last = strrchr(path, '/');
+    const size_t dir_len = (p_last != NULL) ? (size_t) (p_last - path) : 0;
+
+    for (size_t i = 0; i < self->active_len; i++) {
+        const char* request = self->active[i];
+        const size_t request_len = strlen(request);
+        size_t parent_len = 0;
+
+        if (dirwd_ctl_is_below(path, len, request, request_len)) {
+            return false;
+        }
+
+        if ((p_last != NULL) && dirwd_ctl_parent_len(self, request, request_len, &parent_len)
+            && (dir_len == parent_len) && (memcmp(path, request, dir_len) == 0))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void dirwd_ctl_carry(struct dirwd_ctl_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap) {
+    if ((self == NULL) || (old_snap == NULL) || (new_snap == NULL)) {
+        return;
+    }
+
+    const size_t old_len = fsnap_len(old_snap);
+    for (size_t i = 0; i < old_len; i++) {
+        if (dirwd_ctl_is_carried(self, fsnap_path(old_snap, i))) {
+            fsnap_push_copy(new_snap, old_snap, i);
+            self->entries_carried++;
+        }
+    }
+}
+
+void dirwd_ctl_end(struct dirwd_ctl_t* self, const struct fsnap_diff_t* diff) {
+    if (self == NULL) {
+        return;
+    }
+
+    const size_t events = (diff != NULL)
+        ? diff->new_entries.len + diff->deleted_entries.len + diff->modified_entries.len
+        : 0;
+
+    syslog(LOG_DEBUG,
+        "Rescan of %zu subtrees for %zu clients: %zu scanned, %zu descended, %zu skipped, "
+        "%zu entries carried over, %zu events",
+        self->active_len,
+        self->active_clients_len,
+        self->dirs_full,
+        self->dirs_descend,
+        self->dirs_skip,
+        self->entries_carried,
+        events
+    );
+
+    char reply[64];
+    snprintf(reply, sizeof(reply), "OK %zu\n", events);
+
+    for (size_t i = 0; i < self->active_clients_len; i++) {
+        dirwd_ctl_reply(self->active_clients[i], reply);
+    }
+    self->active_clients_len = 0;
+
+    dirwd_ctl_free_requests(self->active, &self->active_len);
+}
+
+bool dirwd_ctl_send(const char* socket_path, const char* command, char* reply, size_t reply_size) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if ((reply_size == 0) || (strlen(socket_path) >= sizeof(addr.sun_path))) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (connect(fd, (const struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        const int err = errno;
+        close(fd);
+        errno = err;
+        return false;
+    }
+
+    const size_t command_len = strlen(command);
+    const bool is_sent = (send(fd, command, command_len, MSG_NOSIGNAL) == (ssize_t) command_len)
+        && (send(fd, "\n", 1, MSG_NOSIGNAL) == 1);
+
+    /* Reply arrives after the rescan, wait for it */
+    size_t len = 0;
+    while (is_sent && (len + 1 < reply_size)) {
+        const ssize_t bytes = recv(fd, reply + len, reply_size - 1 - len, 0);
+        if ((bytes < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytes <= 0) {
+            break;
+        }
+
+        len += (size_t) bytes;
+        if (memchr(reply, '\n', len) != NULL) {
+            break;
+        }
+    }
+    reply[len] = '\0';
+
+    const int err = errno;
+    close(fd);
+    errno = err;
+
+    char* p_newline = strchr(reply, '\n');
+    if (p_newline != NULL) {
+        *p_newline = '\0';
+    }
+
+    return is_sent && (len > 0);
+}
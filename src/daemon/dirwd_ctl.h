@@ -0,0 +1,126 @@
+/**
+ * @file dirwd_ctl.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog control socket and targeted subtree rescans
+ *
+ * Daemon listens on a Unix stream socket for 'RESCAN <path>' lines, one
+ * command per connection. Requested paths are rescanned shortly after the
+ * request without waiting for the next inspection: only the subtree below
+ * the path, files directly in its parent directory and directories leading
+ * to them are read, all other entries are carried over from the previous
+ * snapshot, so a path may also name a file or a removed directory.
+ *
+ * Requests arriving within the coalescing window are served by one rescan,
+ * requests arriving during a rescan by the next one. Nested paths are
+ * merged. Client gets 'OK <events>' after events of its rescan were
+ * published, 'QUEUED' if too many clients wait, or 'ERR <reason>'.
+ */
+
+#ifndef __DAEMON_DIRWD_CTL_H__
+#define __DAEMON_DIRWD_CTL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "../util/fsnap.h"
+#include "dirwd_scan.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_CTL_MAX_REQUESTS  ((size_t) 64)  /* More subtrees rescan whole target */
+#define DIRWD_CTL_MAX_CLIENTS   ((size_t) 64)  /* Further clients are answered without waiting */
+#define DIRWD_CTL_COALESCE_MS   ((int64_t) 100)
+#define DIRWD_CTL_READ_TIMEOUT_MS ((int64_t) 100)
+#define DIRWD_CTL_LINE_SIZE     ((size_t) (PATH_MAX + 16))
+
+#define DIRWD_CTL_RESCAN_COMMAND "RESCAN"
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_ctl_opts_t {
+    char socket_path[108]; /* Empty if control socket is disabled, sun_path size */
+};
+
+/* Identity of socket file, so it is removed only by the socket that created it */
+struct dirwd_ctl_socket_t {
+    uint64_t dev;
+    uint64_t ino;
+};
+
+struct dirwd_ctl_t {
+    struct dirwd_ctl_opts_t opts;
+    int fd; /* Listening socket, -1 without socket */
+    struct dirwd_ctl_socket_t socket_file;
+
+    char target[PATH_MAX]; /* Target path without trailing '/' */
+    size_t target_len;
+
+    /* Requested subtrees without trailing '/', none is below another */
+    size_t len;
+    char* requests[DIRWD_CTL_MAX_REQUESTS];
+    int64_t first_request_ms; /* Arrival of oldest pending request */
+
+    /* Connections waiting for the result of next rescan */
+    size_t clients_len;
+    int clients[DIRWD_CTL_MAX_CLIENTS];
+
+    /* Current rescan, requests are moved here by begin */
+    size_t active_len;
+    char* active[DIRWD_CTL_MAX_REQUESTS];
+    size_t active_clients_len;
+    int active_clients[DIRWD_CTL_MAX_CLIENTS];
+
+    /* Current rescan statistics */
+    size_t dirs_full;
+    size_t dirs_descend;
+    size_t dirs_skip;
+    size_t entries_carried;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Listen on non-blocking Unix stream socket, replacing socket file at the path. -1 on failure */
+int dirwd_ctl_listen(const char* socket_path, struct dirwd_ctl_socket_t* socket_file);
+
+/* Close listening socket, its file is removed unless another socket was bound to the path since */
+void dirwd_ctl_unlisten(int fd, const char* socket_path, const struct dirwd_ctl_socket_t* socket_file);
+
+/* Listen on socket_path of opts, without socket path requests are only queued by dirwd_ctl_request.
+ * NULL on failure */
+struct dirwd_ctl_t* dirwd_ctl_open(const char* target_dir, const struct dirwd_ctl_opts_t* opts);
+
+/* Close socket and remove its file, waiting clients get an error */
+void dirwd_ctl_close(struct dirwd_ctl_t** self);
+
+/* Accept pending connections and queue their requests without blocking on idle socket */
+void dirwd_ctl_read(struct dirwd_ctl_t* self);
+
+/* Queue rescan of path, false if it is not a normalized absolute path under target */
+bool dirwd_ctl_request(struct dirwd_ctl_t* self, const char* path);
+
+/* Milliseconds until queued requests are due, 0 if due now, -1 if nothing is queued */
+int64_t dirwd_ctl_due_ms(const struct dirwd_ctl_t* self, int64_t now_ms);
+
+/* Monotonic clock used for coalescing */
+int64_t dirwd_ctl_now_ms();
+
+/* Start rescan of queued requests */
+void dirwd_ctl_begin(struct dirwd_ctl_t* self);
+
+/* Scan filter, ctx is struct dirwd_ctl_t* */
+dirwd_scan_action_t dirwd_ctl_filter(void* ctx, const char* path);
+
+/* Copy entries outside rescanned subtrees from old to unsealed new snapshot */
+void dirwd_ctl_carry(struct dirwd_ctl_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap);
+
+/* Finish rescan, reply to clients of its requests with number of events */
+void dirwd_ctl_end(struct dirwd_ctl_t* self, const struct fsnap_diff_t* diff);
+
+/* Client side: send command to daemon socket and read reply line without newline, false on failure */
+bool dirwd_ctl_send(const char* socket_path, const char* command, char* reply, size_t reply_size);
+
+#endif /* __DAEMON_DIRWD_CTL_H__ */
@@ -0,0 +1,479 @@
+/**
+ * @file dirwd_fan.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog fanotify change source
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <sys/fanotify.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "dirwd_fan.h"
+
+#define DIRWD_FAN_EVENT_MASK \
+    (FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_MODIFY | FAN_ATTRIB | FAN_ONDIR)
+
+#define DIRWD_FAN_ENTRY_EVENTS (FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO)
+
+static const struct dirwd_fan_dir_t* dirwd_fan_find(const struct dirwd_fan_t* self, uint64_t hash) {
+    return (const struct dirwd_fan_dir_t*) dir_table_find(&self->dirs, hash);
+}
+
+static struct dirwd_fan_dir_t* dirwd_fan_insert(struct dirwd_fan_t* self, uint64_t hash) {
+    return (struct dirwd_fan_dir_t*) dir_table_insert(&self->dirs, hash);
+}
+
+/* Mark directory of len bytes of path and all its ancestors up to target */
+static void dirwd_fan_mark(struct dirwd_fan_t* self, const char* path, size_t len, uint8_t flags) {
+    struct dirwd_fan_dir_t* dir = dirwd_fan_insert(self, fsnap_hash_update(FSNAP_HASH_INIT, path, len));
+
+    if (((flags & DIRWD_FAN_SUBTREE) != 0) && ((dir->flags & DIRWD_FAN_SUBTREE) == 0)) {
+        self->subtrees++;
+    }
+    dir->flags |= flags;
+
+    while (len > self->target_len) {
+        while ((len > 0) && (path[len - 1] != '/')) {
+            len--;
+        }
+        len = (len > 0) ? len - 1 : 0;
+
+        dir = dirwd_fan_insert(self, fsnap_hash_update(FSNAP_HASH_INIT, path, len));
+        if ((dir->flags & DIRWD_FAN_ANCESTOR) != 0) {
+            break;
+        }
+        dir->flags |= DIRWD_FAN_ANCESTOR;
+    }
+}
+
+/* Check if directory or any of its ancestors was marked as changed subtree */
+static bool dirwd_fan_in_subtree(const struct dirwd_fan_t* self, const char* path, size_t len) {
+    uint64_t hash = FSNAP_HASH_INIT;
+    size_t prev = 0;
+
+    for (size_t i = 0; i <= len; i++) {
+        if ((i < len) && (path[i] != '/')) {
+            continue;
+        }
+
+        hash = fsnap_hash_update(hash, path + prev, i - prev);
+        prev = i;
+
+        const struct dirwd_fan_dir_t* dir = dirwd_fan_find(self, hash);
+        if ((dir != NULL) && ((dir->flags & DIRWD_FAN_SUBTREE) != 0)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Map path under real target to path under configured target, false if it is outside */
+static bool dirwd_fan_to_target(const struct dirwd_fan_t* self, const char* real_path, char* path, size_t* len) {
+    const size_t real_len = dir_table_trim(real_path, strlen(real_path));
+
+    if ((real_len < self->real_target_len) || (memcmp(real_path, self->real_target, self->real_target_len) != 0)) {
+        return false;
+    }
+
+    const char* rest = real_path + self->real_target_len;
+    const size_t rest_len = real_len - self->real_target_len;
+
+    if (((rest_len > 0) && (rest[0] != '/')) || (self->target_len + rest_len >= PATH_MAX)) {
+        return false;
+    }
+
+    memcpy(path, self->target, self->target_len);
+    memcpy(path + self->target_len, rest, rest_len);
+    path[self->target_len + rest_len] = '\0';
+    *len = self->target_len + rest_len;
+
+    return true;
+}
+
+/* Resolve directory handle to its current path, returns 0 or errno */
+static int dirwd_fan_resolve(struct dirwd_fan_t* self, const struct file_handle* handle, char* real_path) {
+    struct dirwd_fan_handle_cache_t* cache = &self->cache;
+
+    if (handle->handle_bytes > DIRWD_FAN_HANDLE_MAX_BYTES) {
+        return EOVERFLOW;
+    }
+
+    const bool is_cached = cache->valid
+        && (cache->type == handle->handle_type)
+        && (cache->bytes == handle->handle_bytes)
+        && (memcmp(cache->handle, handle->f_handle, handle->handle_bytes) == 0);
+
+    if (is_cached) {
+        strcpy(real_path, cache->path);
+        return 0;
+    }
+
+    /* Event record is not aligned for file_handle, copy it */
+    union {
+        struct file_handle handle;
+        unsigned char buffer[sizeof(struct file_handle) + DIRWD_FAN_HANDLE_MAX_BYTES];
+    } handle_copy;
+    memcpy(&handle_copy, handle, sizeof(struct file_handle) + handle->handle_bytes);
+
+    const int dir_fd = open_by_handle_at(self->mount_fd, &handle_copy.handle, O_PATH | O_DIRECTORY);
+    if (dir_fd < 0) {
+        return errno;
+    }
+
+    char link_path[64];
+    snprintf(link_path, sizeof(link_path), "/proc/self/fd/%d", dir_fd);
+    const ssize_t len = readlink(link_path, real_path, PATH_MAX - 1);
+    const int err = (len < 0) ? errno : 0;
+    close(dir_fd);
+
+    if (len < 0) {
+        return err;
+    } else if (len >= (ssize_t) PATH_MAX - 1) {
+        return ENAMETOOLONG;
+    }
+    real_path[len] = '\0';
+
+    cache->valid = true;
+    cache->type = handle->handle_type;
+    cache->bytes = handle->handle_bytes;
+    memcpy(cache->handle, handle->f_handle, handle->handle_bytes);
+    strcpy(cache->path, real_path);
+
+    return 0;
+}
+
+static void dirwd_fan_apply(struct dirwd_fan_t* self, uint64_t mask, const struct file_handle* handle, const char* name) {
+    const bool is_dir = (mask & FAN_ONDIR) != 0;
+    const bool is_self = strcmp(name, ".") == 0;
+
+    self->events++;
+
+    /* Directories are not snapshot entries, only their creation and removal matter */
+    if (is_dir && (((mask & DIRWD_FAN_ENTRY_EVENTS) == 0) || is_self)) {
+        return;
+    }
+
+    /* Moved directory changes paths of everything below it */
+    if (is_dir) {
+        self->cache.valid = false;
+    }
+
+    char real_path[PATH_MAX];
+    const int err = dirwd_fan_resolve(self, handle, real_path);
+
+    if ((err == ESTALE) || (err == ENOENT)) {
+        /* Directory is already gone, its parent gets own event */
+        return;
+    } else if (err != 0) {
+        syslog(LOG_DEBUG, "Failed to resolve fanotify directory handle: %s", strerror(err));
+        self->resync = true;
+        return;
+    }
+
+    char path[PATH_MAX];
+    size_t len = 0;
+    if (!dirwd_fan_to_target(self, real_path, path, &len)) {
+        self->events_outside++;
+        return;
+    }
+
+    if (!is_dir) {
+        dirwd_fan_mark(self, path, len, DIRWD_FAN_FILES);
+        return;
+    }
+
+    const size_t name_len = strlen(name);
+    if (len + 1 + name_len >= PATH_MAX) {
+        self->resync = true;
+        return;
+    }
+
+    path[len] = '/';
+    memcpy(path + len + 1, name, name_len + 1);
+    dirwd_fan_mark(self, path, len + 1 + name_len, DIRWD_FAN_SUBTREE);
+}
+
+static void dirwd_fan_event(struct dirwd_fan_t* self, const struct fanotify_event_metadata* meta) {
+    if ((meta->mask & FAN_Q_OVERFLOW) != 0) {
+        syslog(LOG_WARNING, "Fanotify event queue overflow, next inspection scans whole tree");
+        self->resync = true;
+        return;
+    }
+
+    const char* p_info = (const char*) meta + meta->metadata_len;
+    const char* p_end = (const char*) meta + meta->event_len;
+
+    while (p_info + sizeof(struct fanotify_event_info_header) <= p_end) {
+        struct fanotify_event_info_header header;
+        memcpy(&header, p_info, sizeof(header));
+
+        if ((header.len == 0) || (p_info + header.len > p_end)) {
+            break;
+        }
+
+        const bool has_name = header.info_type == FAN_EVENT_INFO_TYPE_DFID_NAME;
+        if (has_name || (header.info_type == FAN_EVENT_INFO_TYPE_DFID)) {
+            const struct fanotify_event_info_fid* info = (const struct fanotify_event_info_fid*) p_info;
+            const struct file_handle* handle = (const struct file_handle*) info->handle;
+            const char* name = has_name ? (const char*) handle->f_handle + handle->handle_bytes : ".";
+
+            dirwd_fan_apply(self, meta->mask, handle, name);
+        }
+
+        p_info += header.len;
+    }
+}
+
+void dirwd_fan_read(struct dirwd_fan_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    while (true) {
+        ssize_t len = read(self->fd, self->events_buffer, DIRWD_FAN_EVENT_BUF_SIZE);
+
+        if (len < 0) {
+            if ((errno != EAGAIN) && (errno != EINTR)) {
+                syslog(LOG_ERR, "Failed to read fanotify events: %s", strerror(errno));
+                self->resync = true;
+            }
+            return;
+        } else if (len == 0) {
+            return;
+        }
+
+        const struct fanotify_event_metadata* meta = (const struct fanotify_event_metadata*) self->events_buffer;
+
+        for (; FAN_EVENT_OK(meta, len); meta = FAN_EVENT_NEXT(meta, len)) {
+            if (meta->vers != FANOTIFY_METADATA_VERSION) {
+                syslog(LOG_ERR, "Unsupported fanotify metadata version %u", (unsigned) meta->vers);
+                self->resync = true;
+                return;
+            }
+
+            if (meta->fd >= 0) {
+                close(meta->fd);
+            }
+
+            dirwd_fan_event(self, meta);
+        }
+    }
+}
+
+struct dirwd_fan_t* dirwd_fan_open(const char* target_dir, const struct dirwd_fan_opts_t* opts) {
+    if ((target_dir == NULL) || (opts == NULL)) {
+        return NULL;
+    }
+
+    const size_t target_len = dir_table_trim(target_dir, strlen(target_dir));
+    if (target_len >= PATH_MAX) {
+        syslog(LOG_ERR, "Path is too long: '%s'", target_dir);
+        return NULL;
+    }
+
+    char real_target[PATH_MAX];
+    if (realpath(target_dir, real_target) == NULL) {
+        syslog(LOG_ERR, "Failed to resolve target directory '%s': %s", target_dir, strerror(errno));
+        return NULL;
+    }
+
+    const int fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME,
+        O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+        syslog(LOG_ERR, "Failed to initialize fanotify: %s", strerror(errno));
+        return NULL;
+    }
+
+    if (fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, DIRWD_FAN_EVENT_MASK, AT_FDCWD, real_target) != 0) {
+        syslog(LOG_ERR, "Failed to watch filesystem of '%s': %s", real_target, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    const int mount_fd = open(real_target, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mount_fd < 0) {
+        syslog(LOG_ERR, "Failed to open directory '%s': %s", real_target, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    struct dirwd_fan_t* new_fan = (struct dirwd_fan_t*) calloc(1, sizeof(struct dirwd_fan_t));
+    new_fan->opts = *opts;
+    new_fan->fd = fd;
+    new_fan->mount_fd = mount_fd;
+    memcpy(new_fan->target, target_dir, target_len);
+    new_fan->target[target_len] = '\0';
+    new_fan->target_len = target_len;
+    new_fan->real_target_len = dir_table_trim(real_target, strlen(real_target));
+    memcpy(new_fan->real_target, real_target, new_fan->real_target_len);
+    new_fan->real_target[new_fan->real_target_len] = '\0';
+    dir_table_init(&new_fan->dirs, sizeof(struct dirwd_fan_dir_t), DIRWD_FAN_DEFAULT_CAP);
+    new_fan->events_buffer = (char*) malloc(DIRWD_FAN_EVENT_BUF_SIZE);
+
+    return new_fan;
+}
+
+void dirwd_fan_close(struct dirwd_fan_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    close((*self)->fd);
+    close((*self)->mount_fd);
+    dir_table_clean(&(*self)->dirs);
+    free((*self)->events_buffer);
+    free(*self);
+    *self = NULL;
+}
+
+bool dirwd_fan_dirty(struct dirwd_fan_t* self, const char* dir, bool subtree) {
+    if ((self == NULL) || (dir == NULL)) {
+        return false;
+    }
+
+    const size_t len = dir_table_trim(dir, strlen(dir));
+    const bool is_under_target = (len >= self->target_len)
+        && (memcmp(dir, self->target, self->target_len) == 0)
+        && ((len == self->target_len) || (dir[self->target_len] == '/'));
+
+    if (!is_under_target) {
+        return false;
+    }
+
+    dirwd_fan_mark(self, dir, len, subtree ? DIRWD_FAN_SUBTREE : DIRWD_FAN_FILES);
+    return true;
+}
+
+void dirwd_fan_begin(struct dirwd_fan_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    dirwd_fan_read(self);
+
+    self->tick++;
+    self->full_scan = self->resync || (((self->tick - 1) % self->opts.reconcile_ticks) == 0);
+    self->resync = false;
+
+    self->dirs_full = 0;
+    self->dirs_descend = 0;
+    self->dirs_skip = 0;
+    self->entries_carried = 0;
+}
+
+dirwd_scan_action_t dirwd_fan_filter(void* ctx, const char* path) {
+    struct dirwd_fan_t* self = (struct dirwd_fan_t*) ctx;
+
+    if (self->full_scan) {
+        self->dirs_full++;
+        return DIRWD_SCAN_FULL;
+    }
+
+    const size_t len = dir_table_trim(path, strlen(path));
+    const struct dirwd_fan_dir_t* dir = dirwd_fan_find(self, fsnap_hash_update(FSNAP_HASH_INIT, path, len));
+    const uint8_t flags = (dir != NULL) ? dir->flags : 0;
+
+    if (((flags & DIRWD_FAN_FILES) != 0) || ((self->subtrees > 0) && dirwd_fan_in_subtree(self, path, len))) {
+        self->dirs_full++;
+        return DIRWD_SCAN_FULL;
+    } else if ((flags & DIRWD_FAN_ANCESTOR) != 0) {
+        self->dirs_descend++;
+        return DIRWD_SCAN_DESCEND;
+    }
+
+    self->dirs_skip++;
+    return DIRWD_SCAN_SKIP;
+}
+
+/* Entry is carried unless its directory was rescanned or it is inside changed subtree */
+static bool dirwd_fan_is_carried(const struct dirwd_fan_t* self, const char* path) {
+    const char* p_last = strrchr(path, '/');
+
+    if (p_last == NULL) {
+        return true;
+    }
+
+    if (self->subtrees == 0) {
+        const struct dirwd_fan_dir_t* dir = dirwd_fan_find(self,
+            fsnap_hash_update(FSNAP_HASH_INIT, path, (size_t) (p_last - path)));
+        return (dir == NULL) || ((dir->flags & DIRWD_FAN_FILES) == 0);
+    }
+
+    const char* p_prev = path;
+    uint64_t hash = FSNAP_HASH_INIT;
+
+    for (const char* p = strchr(path, '/'); p != NULL; p = strchr(p + 1, '/')) {
+        hash = fsnap_hash_update(hash, p_prev, (size_t) (p - p_prev));
+        p_prev = p;
+
+        const struct dirwd_fan_dir_t* dir = dirwd_fan_find(self, hash);
+        if (dir == NULL) {
+            continue;
+        }
+
+        if ((dir->flags & DIRWD_FAN_SUBTREE) != 0) {
+            return false;
+        } else if ((p == p_last) && ((dir->flags & DIRWD_FAN_FILES) != 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void dirwd_fan_carry(struct dirwd_fan_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap) {
+    if ((self == NULL) || (old_snap == NULL) || (new_snap == NULL) || self->full_scan) {
+        return;
+    }
+
+    const size_t old_len = fsnap_len(old_snap);
+    for (size_t i = 0; i < old_len; i++) {
+        if ((self->dirs.len == 0) || dirwd_fan_is_carried(self, fsnap_path(old_snap, i))) {
+            fsnap_push_copy(new_snap, old_snap, i);
+            self->entries_carried++;
+        }
+    }
+}
+
+void dirwd_fan_end(struct dirwd_fan_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    syslog(LOG_DEBUG,
+        "Fanotify: %zu events (%zu outside target), %zu dirty directories; "
+        "%s scan: %zu scanned, %zu descended, %zu skipped, %zu entries carried over",
+        self->events,
+        self->events_outside,
+        self->dirs.len,
+        self->full_scan ? "full" : "partial",
+        self->dirs_full,
+        self->dirs_descend,
+        self->dirs_skip,
+        self->entries_carried
+    );
+
+    /* Shrink table after event storm */
+    if (self->dirs.cap > DIRWD_FAN_DEFAULT_CAP) {
+        dir_table_clean(&self->dirs);
+        dir_table_init(&self->dirs, sizeof(struct dirwd_fan_dir_t), DIRWD_FAN_DEFAULT_CAP);
+    } else {
+        dir_table_clear(&self->dirs);
+    }
+
+    self->subtrees = 0;
+    self->events = 0;
+    self->events_outside = 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file dirwd_fan.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog fanotify change source
+ *
+ * Whole filesystem holding the target directory is watched with one
+ * fanotify mark reporting parent directory handle and entry name
+ * (FAN_REPORT_DFID_NAME, Linux 5.9+, CAP_SYS_ADMIN). Between inspections
+ * events are resolved to directory paths under the target and collected
+ * as dirty directories. Inspection then reads only dirty directories and
+ * their ancestors, other entries are carried over from the previous
+ * snapshot. Every reconcile_ticks inspections, and after event queue
+ * overflow, the whole tree is scanned.
+ */
+
+#ifndef __DAEMON_DIRWD_FAN_H__
+#define __DAEMON_DIRWD_FAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include "../util/dir_table.h"
+#include "../util/fsnap.h"
+#include "dirwd_scan.h"
+
+/* Define -------------------------------------------------------------------*/
+
+/* Dirty directory flags */
+#define DIRWD_FAN_FILES    ((uint8_t) 0x1) /* Files of directory changed */
+#define DIRWD_FAN_SUBTREE  ((uint8_t) 0x2) /* Directory itself was created, removed or moved */
+#define DIRWD_FAN_ANCESTOR ((uint8_t) 0x4) /* Dirty directory below */
+
+#define DIRWD_FAN_RECONCILE_TICKS_DEFAULT ((size_t) 60)
+#define DIRWD_FAN_MAX_RECONCILE_TICKS     ((size_t) 65536)
+#define DIRWD_FAN_DEFAULT_CAP             ((size_t) 256)
+#define DIRWD_FAN_EVENT_BUF_SIZE          ((size_t) 65536)
+#define DIRWD_FAN_HANDLE_MAX_BYTES        ((size_t) 128)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_fan_opts_t {
+    bool enabled;
+    size_t reconcile_ticks;
+};
+
+struct dirwd_fan_dir_t {
+    struct dir_key_t key;
+    uint8_t flags;
+};
+
+/* Last resolved directory handle */
+struct dirwd_fan_handle_cache_t {
+    bool valid;
+    int type;
+    size_t bytes;
+    unsigned char handle[DIRWD_FAN_HANDLE_MAX_BYTES];
+    char path[PATH_MAX];
+};
+
+struct dirwd_fan_t {
+    struct dirwd_fan_opts_t opts;
+    int fd;
+    int mount_fd; /* Target directory, reference for open_by_handle_at */
+
+    char target[PATH_MAX];      /* Target path without trailing '/' */
+    size_t target_len;
+    char real_target[PATH_MAX]; /* Resolved target path as reported by kernel */
+    size_t real_target_len;
+
+    uint64_t tick;
+    bool full_scan; /* Current inspection scans whole tree */
+    bool resync;    /* Events were lost, next inspection scans whole tree */
+
+    struct dir_table_t dirs; /* Dirty directories */
+    size_t subtrees;
+
+    struct dirwd_fan_handle_cache_t cache;
+    char* events_buffer;
+
+    /* Current inspection statistics */
+    size_t events;
+    size_t events_outside;
+    size_t dirs_full;
+    size_t dirs_descend;
+    size_t dirs_skip;
+    size_t entries_carried;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Start watching filesystem of target directory, NULL on failure */
+struct dirwd_fan_t* dirwd_fan_open(const char* target_dir, const struct dirwd_fan_opts_t* opts);
+
+void dirwd_fan_close(struct dirwd_fan_t** self);
+
+/* Collect queued events without blocking */
+void dirwd_fan_read(struct dirwd_fan_t* self);
+
+/* Mark directory for rescan at next inspection, with subtree also everything below it.
+ * False if directory is outside target */
+bool dirwd_fan_dirty(struct dirwd_fan_t* self, const char* dir, bool subtree);
+
+/* Start new inspection */
+void dirwd_fan_begin(struct dirwd_fan_t* self);
+
+/* Scan filter, ctx is struct dirwd_fan_t* */
+dirwd_scan_action_t dirwd_fan_filter(void* ctx, const char* path);
+
+/* Copy entries of directories which were not scanned from old to unsealed new snapshot */
+void dirwd_fan_carry(struct dirwd_fan_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap);
+
+/* Finish inspection and forget dirty directories */
+void dirwd_fan_end(struct dirwd_fan_t* self);
+
+#endif /* __DAEMON_DIRWD_FAN_H__ */
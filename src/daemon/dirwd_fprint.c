@@ -0,0 +1,335 @@
+/**
+ * @file dirwd_fprint.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog bounded-memory directory fingerprints
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/stat.h>
+#include <sys/syslog.h>
+
+#include "dirwd_fprint.h"
+
+static uint64_t dirwd_fprint_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static struct dirwd_fprint_dir_t* dirwd_fprint_find(const struct dirwd_fprint_t* self, uint64_t hash) {
+    return (struct dirwd_fprint_dir_t*) dir_table_find(&self->dirs, hash);
+}
+
+static struct dirwd_fprint_dir_t* dirwd_fprint_insert(struct dirwd_fprint_t* self, uint64_t hash, const char* path, size_t path_len) {
+    struct dirwd_fprint_dir_t* dir = (struct dirwd_fprint_dir_t*) dir_table_insert(&self->dirs, hash);
+    dir->path = strndup(path, path_len);
+    self->paths_bytes += path_len + 1;
+
+    return dir;
+}
+
+/* Directory was scanned in current inspection */
+static bool dirwd_fprint_is_seen(const void* ctx, const void* elem) {
+    return ((const struct dirwd_fprint_dir_t*) elem)->seen_tick == ((const struct dirwd_fprint_t*) ctx)->tick;
+}
+
+/* Directory event entry, path gets trailing '/' and size is number of files */
+static void dirwd_fprint_push_dir(struct fsnap_t* events, const char* path, uint32_t files, int64_t mtime_ns) {
+    char dir_path[PATH_MAX + 1];
+    const size_t path_len = strlen(path);
+    memcpy(dir_path, path, path_len);
+    dir_path[path_len] = '/';
+    dir_path[path_len + 1] = '\0';
+
+    struct stat dir_stat;
+    memset(&dir_stat, 0, sizeof(dir_stat));
+    dir_stat.st_mode = S_IFDIR;
+    dir_stat.st_size = (off_t) files;
+    dir_stat.st_mtim.tv_sec = (time_t) (mtime_ns / 1000000000LL);
+    dir_stat.st_mtim.tv_nsec = (long) (mtime_ns % 1000000000LL);
+
+    fsnap_push(events, dir_path, &dir_stat);
+}
+
+static void dirwd_fprint_push_all(struct fsnap_t* events, const struct fsnap_t* files) {
+    const size_t len = fsnap_len(files);
+
+    for (size_t i = 0; i < len; i++) {
+        fsnap_push_copy(events, files, i);
+    }
+}
+
+static struct dirwd_fprint_listing_t* dirwd_fprint_cache_find(struct dirwd_fprint_t* self, uint64_t hash) {
+    for (size_t i = 0; i < self->opts.cache_dirs; i++) {
+        if ((self->cache[i].files != NULL) && (self->cache[i].hash == hash)) {
+            return &self->cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void dirwd_fprint_cache_free(struct dirwd_fprint_listing_t* listing) {
+    fsnap_drop(&listing->files);
+    listing->hash = 0;
+    listing->used_tick = 0;
+}
+
+/* Move files to sealed listing of its own */
+static struct fsnap_t* dirwd_fprint_listing_new(struct fsnap_t* files) {
+    struct fsnap_t* listing = fsnap_new();
+    fsnap_append(listing, files);
+    fsnap_seal(listing);
+    fsnap_shrink(listing);
+
+    return listing;
+}
+
+/* Cache listing of directory in free or least recently used slot */
+static void dirwd_fprint_cache_store(struct dirwd_fprint_t* self, uint64_t hash, struct fsnap_t* files) {
+    struct dirwd_fprint_listing_t* listing = &self->cache[0];
+
+    for (size_t i = 0; (i < self->opts.cache_dirs) && (listing->files != NULL); i++) {
+        if ((self->cache[i].files == NULL) || (self->cache[i].used_tick < listing->used_tick)) {
+            listing = &self->cache[i];
+        }
+    }
+
+    dirwd_fprint_cache_free(listing);
+    listing->hash = hash;
+    listing->used_tick = ++self->cache_tick;
+    listing->files = dirwd_fprint_listing_new(files);
+}
+
+/* Compare changed directory with its cached listing, which is replaced by current files */
+static void dirwd_fprint_detail(struct dirwd_fprint_t* self, struct dirwd_fprint_listing_t* listing, struct fsnap_t* files) {
+    struct fsnap_t* new_files = dirwd_fprint_listing_new(files);
+    const struct fsnap_t* old_files = listing->files;
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_files, new_files, &diff);
+
+    for (size_t i = 0; i < diff.new_entries.len; i++) {
+        fsnap_push_copy(self->new_events, new_files, diff.new_entries.buffer[i]);
+    }
+    for (size_t i = 0; i < diff.deleted_entries.len; i++) {
+        fsnap_push_copy(self->old_events, old_files, diff.deleted_entries.buffer[i]);
+    }
+    for (size_t i = 0; i < diff.modified_entries.len; i++) {
+        size_t old_idx = 0;
+        const char* path = fsnap_path(new_files, diff.modified_entries.buffer[i]);
+
+        if (fsnap_find(old_files, path, &old_idx)) {
+            fsnap_push_copy(self->old_events, old_files, old_idx);
+        }
+        fsnap_push_copy(self->new_events, new_files, diff.modified_entries.buffer[i]);
+    }
+    fsnap_diff_clean(&diff);
+
+    fsnap_drop(&listing->files);
+    listing->files = new_files;
+    listing->used_tick = ++self->cache_tick;
+}
+
+struct dirwd_fprint_t* dirwd_fprint_new(const struct dirwd_fprint_opts_t* opts) {
+    if ((opts == NULL) || (opts->cache_dirs == 0)) {
+        return NULL;
+    }
+
+    struct dirwd_fprint_t* new_fprint = (struct dirwd_fprint_t*) calloc(1, sizeof(struct dirwd_fprint_t));
+    new_fprint->opts = *opts;
+    dir_table_init(&new_fprint->dirs, sizeof(struct dirwd_fprint_dir_t), DIRWD_FPRINT_DEFAULT_CAP);
+    new_fprint->cache = (struct dirwd_fprint_listing_t*) calloc(opts->cache_dirs, sizeof(struct dirwd_fprint_listing_t));
+    new_fprint->old_events = fsnap_new();
+    new_fprint->new_events = fsnap_new();
+
+    return new_fprint;
+}
+
+void dirwd_fprint_drop(struct dirwd_fprint_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    for (size_t i = 0; i < (*self)->dirs.cap; i++) {
+        struct dirwd_fprint_dir_t* dir = (struct dirwd_fprint_dir_t*) dir_table_at(&(*self)->dirs, i);
+        if (dir != NULL) {
+            free(dir->path);
+        }
+    }
+    for (size_t i = 0; i < (*self)->opts.cache_dirs; i++) {
+        fsnap_drop(&(*self)->cache[i].files);
+    }
+
+    dir_table_clean(&(*self)->dirs);
+    free((*self)->cache);
+    fsnap_drop(&(*self)->old_events);
+    fsnap_drop(&(*self)->new_events);
+    free(*self);
+    *self = NULL;
+}
+
+uint64_t dirwd_fprint_files(const struct fsnap_t* files) {
+    const size_t len = fsnap_len(files);
+    uint64_t sum = 0;
+
+    /* Sum of mixed terms does not depend on entry order */
+    for (size_t i = 0; i < len; i++) {
+        const size_t primary = fsnap_primary(files, i);
+        const uint64_t path_hash = (i < files->len) ? files->path_hash[i] : files->alias_hash[i - files->len];
+
+        sum += dirwd_fprint_mix(path_hash
+            ^ dirwd_fprint_mix((uint64_t) files->size[primary] ^ dirwd_fprint_mix((uint64_t) files->mtime_ns[primary])));
+    }
+
+    return dirwd_fprint_mix(sum + (uint64_t) len);
+}
+
+void dirwd_fprint_begin(struct dirwd_fprint_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    /* Events of a large change are not kept until the next one */
+    fsnap_drop(&self->old_events);
+    fsnap_drop(&self->new_events);
+    self->old_events = fsnap_new();
+    self->new_events = fsnap_new();
+
+    self->tick++;
+    self->dirs_changed = 0;
+    self->dirs_detailed = 0;
+    self->dirs_new = 0;
+    self->dirs_removed = 0;
+}
+
+void dirwd_fprint_visit(void* ctx, const char* path, struct fsnap_t* files) {
+    struct dirwd_fprint_t* self = (struct dirwd_fprint_t*) ctx;
+
+    const size_t path_len = dir_table_trim(path, strlen(path));
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, path, path_len);
+    const uint64_t fingerprint = dirwd_fprint_files(files);
+    const size_t len = fsnap_len(files);
+    const uint32_t files_len = (len < UINT32_MAX) ? (uint32_t) len : UINT32_MAX;
+
+    struct dirwd_fprint_dir_t* dir = dirwd_fprint_find(self, hash);
+
+    if (dir == NULL) {
+        dir = dirwd_fprint_insert(self, hash, path, path_len);
+        dir->fingerprint = fingerprint;
+        dir->files = files_len;
+        dir->seen_tick = self->tick;
+
+        /* New directory is likely still being filled */
+        if (self->has_baseline) {
+            self->dirs_new++;
+            dirwd_fprint_push_all(self->new_events, files);
+            dirwd_fprint_cache_store(self, hash, files);
+        }
+        return;
+    }
+
+    dir->seen_tick = self->tick;
+    if (dir->fingerprint == fingerprint) {
+        return;
+    }
+
+    self->dirs_changed++;
+    struct dirwd_fprint_listing_t* listing = dirwd_fprint_cache_find(self, hash);
+
+    if (listing != NULL) {
+        self->dirs_detailed++;
+        dirwd_fprint_detail(self, listing, files);
+    } else {
+        /* Old version never equals new one, its mtime is invalid */
+        int64_t newest_ns = 0;
+        for (size_t i = 0; i < files->len; i++) {
+            newest_ns = (files->mtime_ns[i] > newest_ns) ? files->mtime_ns[i] : newest_ns;
+        }
+
+        dirwd_fprint_push_dir(self->old_events, dir->path, dir->files, -1);
+        dirwd_fprint_push_dir(self->new_events, dir->path, files_len, newest_ns);
+        dirwd_fprint_cache_store(self, hash, files);
+    }
+
+    dir->fingerprint = fingerprint;
+    dir->files = files_len;
+}
+
+void dirwd_fprint_end(struct dirwd_fprint_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < self->dirs.cap; i++) {
+        struct dirwd_fprint_dir_t* dir = (struct dirwd_fprint_dir_t*) dir_table_at(&self->dirs, i);
+        if ((dir == NULL) || (dir->seen_tick == self->tick)) {
+            continue;
+        }
+
+        struct dirwd_fprint_listing_t* listing = dirwd_fprint_cache_find(self, dir->key.hash);
+        if (listing != NULL) {
+            dirwd_fprint_push_all(self->old_events, listing->files);
+            dirwd_fprint_cache_free(listing);
+        } else {
+            dirwd_fprint_push_dir(self->old_events, dir->path, dir->files, 0);
+        }
+
+        self->paths_bytes -= strlen(dir->path) + 1;
+        free(dir->path);
+        dir->path = NULL;
+        self->dirs_removed++;
+    }
+
+    if (self->dirs_removed > 0) {
+        dir_table_rebuild(&self->dirs, self->dirs.cap, dirwd_fprint_is_seen, self);
+    }
+
+    self->has_baseline = true;
+    fsnap_seal(self->old_events);
+    fsnap_seal(self->new_events);
+
+    syslog(LOG_DEBUG,
+        "Fingerprints: %zu directories (%zu KiB), %zu changed, %zu detailed from cache, %zu new, %zu removed",
+        self->dirs.len,
+        dirwd_fprint_memory(self) / 1024,
+        self->dirs_changed,
+        self->dirs_detailed,
+        self->dirs_new,
+        self->dirs_removed
+    );
+}
+
+size_t dirwd_fprint_memory(const struct dirwd_fprint_t* self) {
+    if (self == NULL) {
+        return 0;
+    }
+
+    size_t bytes = self->dirs.cap * self->dirs.elem_size
+        + self->paths_bytes
+        + self->opts.cache_dirs * sizeof(struct dirwd_fprint_listing_t);
+
+    for (size_t i = 0; i < self->opts.cache_dirs; i++) {
+        const struct fsnap_t* files = self->cache[i].files;
+
+        if (files != NULL) {
+            bytes += sizeof(struct fsnap_t)
+                + files->cap * (3 * sizeof(uint64_t) + sizeof(int64_t) + sizeof(size_t))
+                + files->paths_cap
+                + files->alias_len * (sizeof(uint64_t) + 2 * sizeof(size_t))
+                + files->dir_len * (2 * sizeof(uint64_t) + 6 * sizeof(size_t));
+        }
+    }
+
+    return bytes;
+}
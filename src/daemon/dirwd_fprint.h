@@ -0,0 +1,104 @@
+/**
+ * @file dirwd_fprint.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog bounded-memory directory fingerprints
+ *
+ * Instead of a snapshot entry per file every directory keeps a fixed-size
+ * fingerprint of its files: an order independent sum of mixed hashes of
+ * their paths, sizes and modification times. Subdirectories are not part
+ * of it, they have fingerprints of their own. Memory between inspections
+ * grows with the number of directories, not files.
+ *
+ * Directory with changed fingerprint is compared entry by entry if its
+ * listing is in a small LRU cache of recently changed directories.
+ * Otherwise the change is reported as one MODIFIED event of the directory
+ * path with trailing '/' and the listing is cached, so its next change is
+ * detailed. Removed directories are reported the same way, files of new
+ * directories one by one. The first inspection records fingerprints only.
+ */
+
+#ifndef __DAEMON_DIRWD_FPRINT_H__
+#define __DAEMON_DIRWD_FPRINT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../util/dir_table.h"
+#include "../util/fsnap.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_FPRINT_CACHE_DEFAULT ((size_t) 64)
+#define DIRWD_FPRINT_MAX_CACHE     ((size_t) 65536)
+#define DIRWD_FPRINT_DEFAULT_CAP   ((size_t) 256)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_fprint_opts_t {
+    bool enabled;
+    size_t cache_dirs; /* Directory listings kept for detailed diffs */
+};
+
+struct dirwd_fprint_dir_t {
+    struct dir_key_t key;
+    uint64_t fingerprint;
+    char* path;
+    uint32_t files;
+    uint32_t seen_tick; /* Last inspection directory was scanned */
+};
+
+/* Listing of recently changed directory, slot is free if files is NULL */
+struct dirwd_fprint_listing_t {
+    uint64_t hash;
+    uint64_t used_tick;
+    struct fsnap_t* files; /* Sealed */
+};
+
+struct dirwd_fprint_t {
+    struct dirwd_fprint_opts_t opts;
+    uint32_t tick;
+    bool has_baseline;
+
+    struct dir_table_t dirs; /* Known directories */
+    size_t paths_bytes;
+
+    /* LRU cache of opts.cache_dirs slots */
+    struct dirwd_fprint_listing_t* cache;
+    uint64_t cache_tick;
+
+    /* Events of current inspection, sealed by dirwd_fprint_end */
+    struct fsnap_t* old_events; /* Deleted entries and old versions of modified ones */
+    struct fsnap_t* new_events; /* New entries and new versions of modified ones */
+
+    /* Current inspection statistics */
+    size_t dirs_changed;
+    size_t dirs_detailed;
+    size_t dirs_new;
+    size_t dirs_removed;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct dirwd_fprint_t* dirwd_fprint_new(const struct dirwd_fprint_opts_t* opts);
+
+void dirwd_fprint_drop(struct dirwd_fprint_t** self);
+
+/* Fingerprint of files of one directory, independent of entry order */
+uint64_t dirwd_fprint_files(const struct fsnap_t* files);
+
+/* Start new inspection, events of the previous one are dropped */
+void dirwd_fprint_begin(struct dirwd_fprint_t* self);
+
+/* Scan visit callback, ctx is struct dirwd_fprint_t* */
+void dirwd_fprint_visit(void* ctx, const char* path, struct fsnap_t* files);
+
+/* Report directories which were not scanned as removed and seal events of inspection */
+void dirwd_fprint_end(struct dirwd_fprint_t* self);
+
+/* Approximate heap memory of fingerprints and cached listings */
+size_t dirwd_fprint_memory(const struct dirwd_fprint_t* self);
+
+#endif /* __DAEMON_DIRWD_FPRINT_H__ */
@@ -0,0 +1,63 @@
+/**
+ * @file dirwd_fs.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog filesystem backend interface
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+
+#include "dirwd_fs.h"
+
+static void* dirwd_fs_posix_opendir(void* ctx, const char* path) {
+    (void) ctx;
+    return opendir(path);
+}
+
+static bool dirwd_fs_posix_readdir(void* ctx, void* dir, struct dirwd_fs_dirent_t* entry) {
+    (void) ctx;
+    const struct dirent* const dir_entry = readdir((DIR*) dir);
+
+    if (dir_entry == NULL) {
+        return false;
+    }
+
+    entry->name = dir_entry->d_name;
+    entry->ino = (uint64_t) dir_entry->d_ino;
+    entry->type = dir_entry->d_type;
+    return true;
+}
+
+static void dirwd_fs_posix_closedir(void* ctx, void* dir) {
+    (void) ctx;
+    closedir((DIR*) dir);
+}
+
+static int dirwd_fs_posix_statat(void* ctx, void* dir, const char* name, struct stat* stat_buf, int flags) {
+    (void) ctx;
+    return fstatat(dirfd((DIR*) dir), name, stat_buf, flags);
+}
+
+static int dirwd_fs_posix_stat(void* ctx, const char* path, struct stat* stat_buf) {
+    (void) ctx;
+    return stat(path, stat_buf);
+}
+
+static const struct dirwd_fs_ops_t dirwd_fs_posix_ops = {
+    .opendir = dirwd_fs_posix_opendir,
+    .readdir = dirwd_fs_posix_readdir,
+    .closedir = dirwd_fs_posix_closedir,
+    .statat = dirwd_fs_posix_statat,
+    .stat = dirwd_fs_posix_stat,
+};
+
+const struct dirwd_fs_ops_t* dirwd_fs_posix() {
+    return &dirwd_fs_posix_ops;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file dirwd_fs.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog filesystem backend interface
+ *
+ * Scanner reads directory trees only through these operations, so the
+ * same scan, diff and output code can run against the real filesystem or
+ * a simulated one. Operations are called concurrently from scan threads
+ * and report failures through errno like their POSIX counterparts.
+ */
+
+#ifndef __DAEMON_DIRWD_FS_H__
+#define __DAEMON_DIRWD_FS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <sys/stat.h>
+
+/* Define -------------------------------------------------------------------*/
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_fs_dirent_t {
+    const char* name; /* Valid until next readdir or closedir of the directory */
+    uint64_t ino;
+    unsigned char type; /* DT_* value, DT_UNKNOWN if not known without stat */
+};
+
+struct dirwd_fs_ops_t {
+    /* Directory handle, NULL on failure */
+    void* (*opendir)(void* ctx, const char* path);
+
+    /* False at the end of directory, "." and ".." may be returned */
+    bool (*readdir)(void* ctx, void* dir, struct dirwd_fs_dirent_t* entry);
+
+    void (*closedir)(void* ctx, void* dir);
+
+    /* Metadata of directory entry, flags as for fstatat, 0 on success */
+    int (*statat)(void* ctx, void* dir, const char* name, struct stat* stat_buf, int flags);
+
+    /* Metadata of path, follows symlinks, 0 on success */
+    int (*stat)(void* ctx, const char* path, struct stat* stat_buf);
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Real filesystem through opendir, readdir and fstatat, context is unused */
+const struct dirwd_fs_ops_t* dirwd_fs_posix();
+
+#endif /* __DAEMON_DIRWD_FS_H__ */
@@ -0,0 +1,672 @@
+/**
+ * @file dirwd_memfs.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog in-memory simulated filesystem backend
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include "dirwd_memfs.h"
+
+#define DIRWD_MEMFS_REMOVED  ((size_t) -2) /* Table slot of removed node */
+#define DIRWD_MEMFS_DEV      ((dev_t) 1)
+#define DIRWD_MEMFS_EPOCH_NS ((int64_t) 1700000000 * 1000000000LL)
+#define DIRWD_MEMFS_TICK_NS  ((int64_t) 1000)
+#define DIRWD_MEMFS_MAX_SIZE ((uint64_t) 1048576) /* Generated file size limit */
+#define DIRWD_MEMFS_PROBES   ((size_t) 64)        /* Random picks before linear search */
+
+struct dirwd_memfs_dir_t {
+    size_t node;
+    size_t cursor;
+    uint64_t prefix_hash; /* Directory path with trailing '/' */
+};
+
+/* Helpers ------------------------------------------------------------------*/
+
+static uint64_t dirwd_memfs_rand(struct dirwd_memfs_t* self) {
+    self->rand_state ^= self->rand_state >> 12;
+    self->rand_state ^= self->rand_state << 25;
+    self->rand_state ^= self->rand_state >> 27;
+    return self->rand_state * 0x2545f4914f6cdd1dULL;
+}
+
+static uint64_t dirwd_memfs_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+static void dirwd_memfs_delay(uint64_t latency_ns) {
+    if (latency_ns == 0) {
+        return;
+    }
+
+    if (latency_ns >= DIRWD_MEMFS_SPIN_NS) {
+        const struct timespec delay = {
+            .tv_sec = (time_t) (latency_ns / 1000000000ULL),
+            .tv_nsec = (long) (latency_ns % 1000000000ULL),
+        };
+        nanosleep(&delay, NULL);
+        return;
+    }
+
+    const uint64_t deadline_ns = dirwd_memfs_now_ns() + latency_ns;
+    while (dirwd_memfs_now_ns() < deadline_ns) {
+    }
+}
+
+static size_t dirwd_memfs_slot(const struct dirwd_memfs_t* self, uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (size_t) hash & (self->table_cap - 1);
+}
+
+static const char* dirwd_memfs_name(const struct dirwd_memfs_t* self, size_t idx) {
+    return self->names + self->nodes[idx].name_off;
+}
+
+static bool dirwd_memfs_name_equal(const struct dirwd_memfs_t* self, size_t idx, const char* name, size_t name_len) {
+    const char* const node_name = dirwd_memfs_name(self, idx);
+    return (strncmp(node_name, name, name_len) == 0) && (node_name[name_len] == '\0');
+}
+
+/* Rebuild hash table with live nodes only */
+static void dirwd_memfs_rehash(struct dirwd_memfs_t* self, size_t cap) {
+    free(self->table);
+    self->table_cap = cap;
+    self->table_used = 0;
+    self->table = (size_t*) malloc(cap * sizeof(size_t));
+    memset(self->table, 0xff, cap * sizeof(size_t));
+
+    for (size_t i = 0; i < self->len; i++) {
+        if (self->nodes[i].removed) {
+            continue;
+        }
+
+        size_t slot = dirwd_memfs_slot(self, self->nodes[i].hash);
+        while (self->table[slot] != DIRWD_MEMFS_NONE) {
+            slot = (slot + 1) & (self->table_cap - 1);
+        }
+        self->table[slot] = i;
+        self->table_used++;
+    }
+}
+
+static size_t dirwd_memfs_find_child(const struct dirwd_memfs_t* self, size_t parent, uint64_t hash,
+    const char* name, size_t name_len)
+{
+    size_t slot = dirwd_memfs_slot(self, hash);
+
+    while (self->table[slot] != DIRWD_MEMFS_NONE) {
+        const size_t idx = self->table[slot];
+
+        if ((idx != DIRWD_MEMFS_REMOVED) && (self->nodes[idx].hash == hash) && (self->nodes[idx].parent == parent)
+            && dirwd_memfs_name_equal(self, idx, name, name_len))
+        {
+            return idx;
+        }
+        slot = (slot + 1) & (self->table_cap - 1);
+    }
+
+    return DIRWD_MEMFS_NONE;
+}
+
+static uint64_t dirwd_memfs_child_hash(const struct dirwd_memfs_t* self, size_t parent, const char* name, size_t name_len) {
+    return fsnap_hash_update(fsnap_hash_update(self->nodes[parent].hash, "/", 1), name, name_len);
+}
+
+/* Node of path, DIRWD_MEMFS_NONE if path is not below root or does not exist */
+static size_t dirwd_memfs_lookup(const struct dirwd_memfs_t* self, const char* path) {
+    size_t len = strlen(path);
+    while ((len > 0) && (path[len - 1] == '/')) {
+        len--;
+    }
+
+    if ((len < self->root_len) || (memcmp(path, self->root, self->root_len) != 0)) {
+        return DIRWD_MEMFS_NONE;
+    } else if (len == self->root_len) {
+        return 0;
+    } else if (path[self->root_len] != '/') {
+        return DIRWD_MEMFS_NONE;
+    }
+
+    size_t name_off = len;
+    while (path[name_off - 1] != '/') {
+        name_off--;
+    }
+
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, path, len);
+    const uint64_t parent_hash = fsnap_hash_update(FSNAP_HASH_INIT, path, name_off - 1);
+    size_t slot = dirwd_memfs_slot(self, hash);
+
+    while (self->table[slot] != DIRWD_MEMFS_NONE) {
+        const size_t idx = self->table[slot];
+
+        if ((idx != DIRWD_MEMFS_REMOVED) && (self->nodes[idx].hash == hash)
+            && (self->nodes[self->nodes[idx].parent].hash == parent_hash)
+            && dirwd_memfs_name_equal(self, idx, path + name_off, len - name_off))
+        {
+            return idx;
+        }
+        slot = (slot + 1) & (self->table_cap - 1);
+    }
+
+    return DIRWD_MEMFS_NONE;
+}
+
+static void dirwd_memfs_touch(struct dirwd_memfs_t* self, size_t idx, int64_t size) {
+    self->clock_ns += DIRWD_MEMFS_TICK_NS;
+    self->nodes[idx].size = size;
+    self->nodes[idx].mtime_ns = self->clock_ns;
+    self->nodes[idx].churn = self->churn;
+}
+
+static size_t dirwd_memfs_insert(struct dirwd_memfs_t* self, size_t parent, const char* name, size_t name_len,
+    bool is_dir, int64_t size)
+{
+    if (self->len == self->cap) {
+        self->cap *= 2;
+        self->nodes = (struct dirwd_memfs_node_t*) realloc(self->nodes, self->cap * sizeof(struct dirwd_memfs_node_t));
+    }
+
+    if (self->names_len + name_len + 1 > self->names_cap) {
+        while (self->names_len + name_len + 1 > self->names_cap) {
+            self->names_cap *= 2;
+        }
+        self->names = (char*) realloc(self->names, self->names_cap);
+    }
+
+    /* Removed slots are dropped on rehash, live nodes take at most a quarter after it */
+    if (2 * (self->table_used + 1) > self->table_cap) {
+        size_t table_cap = self->table_cap;
+        while (4 * (self->files + self->dirs + 1) > table_cap) {
+            table_cap *= 2;
+        }
+        dirwd_memfs_rehash(self, table_cap);
+    }
+
+    const size_t idx = self->len++;
+    struct dirwd_memfs_node_t* node = &self->nodes[idx];
+    node->hash = (parent != DIRWD_MEMFS_NONE)
+        ? dirwd_memfs_child_hash(self, parent, name, name_len)
+        : fsnap_hash_update(FSNAP_HASH_INIT, name, name_len);
+    node->parent = parent;
+    node->name_off = self->names_len;
+    node->first_child = DIRWD_MEMFS_NONE;
+    node->prev = DIRWD_MEMFS_NONE;
+    node->next = DIRWD_MEMFS_NONE;
+    node->ino = self->next_ino++;
+    node->is_dir = is_dir;
+    node->removed = false;
+    dirwd_memfs_touch(self, idx, is_dir ? 4096 : size);
+
+    memcpy(self->names + self->names_len, name, name_len);
+    self->names[self->names_len + name_len] = '\0';
+    self->names_len += name_len + 1;
+
+    /* New entries are listed first */
+    if (parent != DIRWD_MEMFS_NONE) {
+        struct dirwd_memfs_node_t* const parent_node = &self->nodes[parent];
+        node->next = parent_node->first_child;
+        if (parent_node->first_child != DIRWD_MEMFS_NONE) {
+            self->nodes[parent_node->first_child].prev = idx;
+        }
+        parent_node->first_child = idx;
+    }
+
+    size_t slot = dirwd_memfs_slot(self, node->hash);
+    while ((self->table[slot] != DIRWD_MEMFS_NONE) && (self->table[slot] != DIRWD_MEMFS_REMOVED)) {
+        slot = (slot + 1) & (self->table_cap - 1);
+    }
+    self->table_used += (self->table[slot] == DIRWD_MEMFS_NONE) ? 1 : 0;
+    self->table[slot] = idx;
+
+    if (is_dir) {
+        self->dirs++;
+    } else {
+        self->files++;
+    }
+
+    return idx;
+}
+
+/* Find or create child, DIRWD_MEMFS_NONE if it exists with other type */
+static size_t dirwd_memfs_child(struct dirwd_memfs_t* self, size_t parent, const char* name, size_t name_len,
+    bool is_dir, int64_t size)
+{
+    const uint64_t hash = dirwd_memfs_child_hash(self, parent, name, name_len);
+    const size_t idx = dirwd_memfs_find_child(self, parent, hash, name, name_len);
+
+    if (idx == DIRWD_MEMFS_NONE) {
+        return dirwd_memfs_insert(self, parent, name, name_len, is_dir, size);
+    } else if (self->nodes[idx].is_dir != is_dir) {
+        return DIRWD_MEMFS_NONE;
+    }
+
+    if (!is_dir) {
+        dirwd_memfs_touch(self, idx, size);
+    }
+
+    return idx;
+}
+
+static void dirwd_memfs_unlink(struct dirwd_memfs_t* self, size_t idx) {
+    struct dirwd_memfs_node_t* const node = &self->nodes[idx];
+
+    if (node->prev != DIRWD_MEMFS_NONE) {
+        self->nodes[node->prev].next = node->next;
+    } else {
+        self->nodes[node->parent].first_child = node->next;
+    }
+
+    if (node->next != DIRWD_MEMFS_NONE) {
+        self->nodes[node->next].prev = node->prev;
+    }
+}
+
+static void dirwd_memfs_remove_node(struct dirwd_memfs_t* self, size_t idx) {
+    dirwd_memfs_unlink(self, idx);
+
+    /* Subtree nodes are removed depth first with explicit stack */
+    size_t stack_cap = 16;
+    size_t stack_len = 0;
+    size_t* stack = (size_t*) malloc(stack_cap * sizeof(size_t));
+    stack[stack_len++] = idx;
+
+    while (stack_len > 0) {
+        const size_t cur = stack[--stack_len];
+        struct dirwd_memfs_node_t* const node = &self->nodes[cur];
+
+        size_t slot = dirwd_memfs_slot(self, node->hash);
+        while (self->table[slot] != cur) {
+            slot = (slot + 1) & (self->table_cap - 1);
+        }
+        self->table[slot] = DIRWD_MEMFS_REMOVED;
+        node->removed = true;
+
+        if (node->is_dir) {
+            self->dirs--;
+        } else {
+            self->files--;
+        }
+
+        for (size_t child = node->first_child; child != DIRWD_MEMFS_NONE; child = self->nodes[child].next) {
+            if (stack_len == stack_cap) {
+                stack_cap *= 2;
+                stack = (size_t*) realloc(stack, stack_cap * sizeof(size_t));
+            }
+            stack[stack_len++] = child;
+        }
+    }
+
+    free(stack);
+}
+
+static bool dirwd_memfs_pickable(const struct dirwd_memfs_t* self, size_t idx, bool is_dir) {
+    const struct dirwd_memfs_node_t* const node = &self->nodes[idx];
+    return !node->removed && (node->is_dir == is_dir) && (is_dir || (node->churn != self->churn));
+}
+
+/* Random live node of given type, files changed in current churn round are not picked */
+static size_t dirwd_memfs_pick(struct dirwd_memfs_t* self, bool is_dir) {
+    for (size_t k = 0; k < DIRWD_MEMFS_PROBES; k++) {
+        const size_t idx = (size_t) (dirwd_memfs_rand(self) % self->len);
+        if (dirwd_memfs_pickable(self, idx, is_dir)) {
+            return idx;
+        }
+    }
+
+    /* Nodes of the type are rare, search from random position */
+    const size_t start = (size_t) (dirwd_memfs_rand(self) % self->len);
+    for (size_t i = 0; i < self->len; i++) {
+        const size_t idx = (start + i) % self->len;
+        if (dirwd_memfs_pickable(self, idx, is_dir)) {
+            return idx;
+        }
+    }
+
+    return DIRWD_MEMFS_NONE;
+}
+
+static void dirwd_memfs_fill_stat(const struct dirwd_memfs_t* self, size_t idx, struct stat* stat_buf) {
+    const struct dirwd_memfs_node_t* const node = &self->nodes[idx];
+
+    memset(stat_buf, 0, sizeof(struct stat));
+    stat_buf->st_dev = DIRWD_MEMFS_DEV;
+    stat_buf->st_ino = (ino_t) node->ino;
+    stat_buf->st_mode = node->is_dir ? (S_IFDIR | 0755) : (S_IFREG | 0644);
+    stat_buf->st_nlink = node->is_dir ? 2 : 1;
+    stat_buf->st_size = (off_t) node->size;
+    stat_buf->st_mtim.tv_sec = (time_t) (node->mtime_ns / 1000000000LL);
+    stat_buf->st_mtim.tv_nsec = (long) (node->mtime_ns % 1000000000LL);
+    stat_buf->st_ctim = stat_buf->st_mtim;
+}
+
+/* Backend operations -------------------------------------------------------*/
+
+static void* dirwd_memfs_opendir(void* ctx, const char* path) {
+    const struct dirwd_memfs_t* const self = (const struct dirwd_memfs_t*) ctx;
+    dirwd_memfs_delay(self->opts.opendir_latency_ns);
+
+    const size_t idx = dirwd_memfs_lookup(self, path);
+    if (idx == DIRWD_MEMFS_NONE) {
+        errno = ENOENT;
+        return NULL;
+    } else if (!self->nodes[idx].is_dir) {
+        errno = ENOTDIR;
+        return NULL;
+    }
+
+    struct dirwd_memfs_dir_t* dir = (struct dirwd_memfs_dir_t*) malloc(sizeof(struct dirwd_memfs_dir_t));
+    dir->node = idx;
+    dir->cursor = self->nodes[idx].first_child;
+    dir->prefix_hash = fsnap_hash_update(self->nodes[idx].hash, "/", 1);
+
+    return dir;
+}
+
+static bool dirwd_memfs_readdir(void* ctx, void* dir, struct dirwd_fs_dirent_t* entry) {
+    const struct dirwd_memfs_t* const self = (const struct dirwd_memfs_t*) ctx;
+    struct dirwd_memfs_dir_t* const memfs_dir = (struct dirwd_memfs_dir_t*) dir;
+
+    if (memfs_dir->cursor == DIRWD_MEMFS_NONE) {
+        return false;
+    }
+
+    const struct dirwd_memfs_node_t* const node = &self->nodes[memfs_dir->cursor];
+    entry->name = dirwd_memfs_name(self, memfs_dir->cursor);
+    entry->ino = node->ino;
+    entry->type = node->is_dir ? DT_DIR : DT_REG;
+    memfs_dir->cursor = node->next;
+
+    return true;
+}
+
+static void dirwd_memfs_closedir(void* ctx, void* dir) {
+    (void) ctx;
+    free(dir);
+}
+
+static int dirwd_memfs_statat(void* ctx, void* dir, const char* name, struct stat* stat_buf, int flags) {
+    (void) flags;
+    const struct dirwd_memfs_t* const self = (const struct dirwd_memfs_t*) ctx;
+    const struct dirwd_memfs_dir_t* const memfs_dir = (const struct dirwd_memfs_dir_t*) dir;
+    dirwd_memfs_delay(self->opts.stat_latency_ns);
+
+    const size_t name_len = strlen(name);
+    const uint64_t hash = fsnap_hash_update(memfs_dir->prefix_hash, name, name_len);
+    const size_t idx = dirwd_memfs_find_child(self, memfs_dir->node, hash, name, name_len);
+
+    if (idx == DIRWD_MEMFS_NONE) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    dirwd_memfs_fill_stat(self, idx, stat_buf);
+    return 0;
+}
+
+static int dirwd_memfs_stat(void* ctx, const char* path, struct stat* stat_buf) {
+    const struct dirwd_memfs_t* const self = (const struct dirwd_memfs_t*) ctx;
+    const size_t idx = dirwd_memfs_lookup(self, path);
+
+    if (idx == DIRWD_MEMFS_NONE) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    dirwd_memfs_fill_stat(self, idx, stat_buf);
+    return 0;
+}
+
+static const struct dirwd_fs_ops_t dirwd_memfs_fs_ops = {
+    .opendir = dirwd_memfs_opendir,
+    .readdir = dirwd_memfs_readdir,
+    .closedir = dirwd_memfs_closedir,
+    .statat = dirwd_memfs_statat,
+    .stat = dirwd_memfs_stat,
+};
+
+/* Public functions ---------------------------------------------------------*/
+
+struct dirwd_memfs_t* dirwd_memfs_new(const char* root, const struct dirwd_memfs_opts_t* opts) {
+    if ((root == NULL) || (opts == NULL)) {
+        return NULL;
+    }
+
+    size_t root_len = strlen(root);
+    while ((root_len > 0) && (root[root_len - 1] == '/')) {
+        root_len--;
+    }
+
+    struct dirwd_memfs_t* new_memfs = (struct dirwd_memfs_t*) calloc(1, sizeof(struct dirwd_memfs_t));
+    new_memfs->opts = *opts;
+    new_memfs->root = strndup(root, root_len);
+    new_memfs->root_len = root_len;
+    new_memfs->cap = DIRWD_MEMFS_DEFAULT_CAP;
+    new_memfs->nodes = (struct dirwd_memfs_node_t*) malloc(new_memfs->cap * sizeof(struct dirwd_memfs_node_t));
+    new_memfs->names_cap = DIRWD_MEMFS_NAMES_DEFAULT_CAP;
+    new_memfs->names = (char*) malloc(new_memfs->names_cap);
+    new_memfs->next_ino = 2;
+    new_memfs->clock_ns = DIRWD_MEMFS_EPOCH_NS;
+    new_memfs->rand_state = (opts->seed != 0) ? opts->seed : 0x9e3779b97f4a7c15ULL;
+    dirwd_memfs_rehash(new_memfs, 2 * DIRWD_MEMFS_DEFAULT_CAP);
+
+    /* Root node name is the whole root path, so its hash is the path hash */
+    dirwd_memfs_insert(new_memfs, DIRWD_MEMFS_NONE, new_memfs->root, root_len, true, 0);
+
+    return new_memfs;
+}
+
+void dirwd_memfs_drop(struct dirwd_memfs_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    free((*self)->root);
+    free((*self)->nodes);
+    free((*self)->names);
+    free((*self)->table);
+    free(*self);
+    *self = NULL;
+}
+
+const struct dirwd_fs_ops_t* dirwd_memfs_ops() {
+    return &dirwd_memfs_fs_ops;
+}
+
+bool dirwd_memfs_add(struct dirwd_memfs_t* self, const char* path, bool is_dir, int64_t size) {
+    if ((self == NULL) || (path == NULL)) {
+        return false;
+    }
+
+    const size_t len = strlen(path);
+    if ((len <= self->root_len + 1) || (memcmp(path, self->root, self->root_len) != 0)
+        || (path[self->root_len] != '/'))
+    {
+        return false;
+    }
+
+    size_t idx = 0;
+    const char* p_name = path + self->root_len + 1;
+
+    while (*p_name != '\0') {
+        const char* p_slash = strchr(p_name, '/');
+        const size_t name_len = (p_slash != NULL) ? (size_t) (p_slash - p_name) : strlen(p_name);
+        const bool is_last = (p_slash == NULL) || (p_slash[1] == '\0');
+
+        if (name_len > 0) {
+            idx = dirwd_memfs_child(self, idx, p_name, name_len, is_last ? is_dir : true, size);
+            if (idx == DIRWD_MEMFS_NONE) {
+                return false;
+            }
+        }
+
+        if (p_slash == NULL) {
+            break;
+        }
+        p_name = p_slash + 1;
+    }
+
+    return true;
+}
+
+bool dirwd_memfs_remove(struct dirwd_memfs_t* self, const char* path) {
+    if ((self == NULL) || (path == NULL)) {
+        return false;
+    }
+
+    const size_t idx = dirwd_memfs_lookup(self, path);
+    if ((idx == DIRWD_MEMFS_NONE) || (idx == 0)) {
+        return false;
+    }
+
+    dirwd_memfs_remove_node(self, idx);
+    return true;
+}
+
+static void dirwd_memfs_generate_dir(struct dirwd_memfs_t* self, size_t dir, size_t fanout, size_t depth,
+    size_t files_per_dir)
+{
+    char name[32];
+
+    for (size_t i = 0; i < files_per_dir; i++) {
+        const int name_len = snprintf(name, sizeof(name), "f%zu", i);
+        const int64_t size = (int64_t) (dirwd_memfs_rand(self) % DIRWD_MEMFS_MAX_SIZE);
+        dirwd_memfs_child(self, dir, name, (size_t) name_len, false, size);
+    }
+
+    if (depth == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < fanout; i++) {
+        const int name_len = snprintf(name, sizeof(name), "d%zu", i);
+        const size_t subdir = dirwd_memfs_child(self, dir, name, (size_t) name_len, true, 0);
+
+        if (subdir != DIRWD_MEMFS_NONE) {
+            dirwd_memfs_generate_dir(self, subdir, fanout, depth - 1, files_per_dir);
+        }
+    }
+}
+
+void dirwd_memfs_generate(struct dirwd_memfs_t* self, size_t fanout, size_t depth, size_t files_per_dir) {
+    if (self == NULL) {
+        return;
+    }
+
+    dirwd_memfs_generate_dir(self, 0, fanout, depth, files_per_dir);
+}
+
+size_t dirwd_memfs_replay(struct dirwd_memfs_t* self, const struct fsnap_t* snap) {
+    if ((self == NULL) || (snap == NULL)) {
+        return 0;
+    }
+
+    size_t added = 0;
+    for (size_t i = 0; i < fsnap_len(snap); i++) {
+        const int64_t size = snap->size[fsnap_primary(snap, i)];
+        added += dirwd_memfs_add(self, fsnap_path(snap, i), false, size) ? 1 : 0;
+    }
+
+    return added;
+}
+
+void dirwd_memfs_apply(
+    struct dirwd_memfs_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff,
+    struct dirwd_memfs_churn_t* done
+)
+{
+    struct dirwd_memfs_churn_t applied = { 0, 0, 0, 0 };
+    self->churn++;
+
+    /* Removes first, a path deleted and created again in one diff is new */
+    for (size_t i = 0; i < diff->deleted_entries.len; i++) {
+        applied.removes += dirwd_memfs_remove(self, fsnap_path(old_snap, diff->deleted_entries.buffer[i])) ? 1 : 0;
+    }
+
+    /* Existing files are updated with next modification time, so recorded times are not kept */
+    for (size_t i = 0; i < diff->modified_entries.len; i++) {
+        const size_t idx = diff->modified_entries.buffer[i];
+        const int64_t size = new_snap->size[fsnap_primary(new_snap, idx)];
+        applied.modifies += dirwd_memfs_add(self, fsnap_path(new_snap, idx), false, size) ? 1 : 0;
+    }
+
+    for (size_t i = 0; i < diff->new_entries.len; i++) {
+        const size_t idx = diff->new_entries.buffer[i];
+        const int64_t size = new_snap->size[fsnap_primary(new_snap, idx)];
+        applied.creates += dirwd_memfs_add(self, fsnap_path(new_snap, idx), false, size) ? 1 : 0;
+    }
+
+    if (done != NULL) {
+        *done = applied;
+    }
+}
+
+void dirwd_memfs_churn(
+    struct dirwd_memfs_t* self,
+    const struct dirwd_memfs_churn_t* churn,
+    struct dirwd_memfs_churn_t* done
+)
+{
+    struct dirwd_memfs_churn_t applied = { 0, 0, 0, churn->create_dirs };
+    self->churn++;
+
+    for (; applied.modifies < churn->modifies; applied.modifies++) {
+        const size_t idx = dirwd_memfs_pick(self, false);
+        if (idx == DIRWD_MEMFS_NONE) {
+            break;
+        }
+        dirwd_memfs_touch(self, idx, self->nodes[idx].size + 1 + (int64_t) (dirwd_memfs_rand(self) % 4096));
+    }
+
+    for (; applied.removes < churn->removes; applied.removes++) {
+        const size_t idx = dirwd_memfs_pick(self, false);
+        if (idx == DIRWD_MEMFS_NONE) {
+            break;
+        }
+        dirwd_memfs_remove_node(self, idx);
+    }
+
+    /* Target directories of new files, picked up front so creates are clustered */
+    size_t* targets = NULL;
+    if (churn->create_dirs > 0) {
+        targets = (size_t*) malloc(churn->create_dirs * sizeof(size_t));
+        for (size_t i = 0; i < churn->create_dirs; i++) {
+            targets[i] = dirwd_memfs_pick(self, true);
+        }
+    }
+
+    char name[32];
+    for (; applied.creates < churn->creates; applied.creates++) {
+        const size_t dir = (targets != NULL)
+            ? targets[applied.creates % churn->create_dirs]
+            : dirwd_memfs_pick(self, true);
+        const int name_len = snprintf(name, sizeof(name), "n%llu", (unsigned long long) self->next_name++);
+        const int64_t size = (int64_t) (dirwd_memfs_rand(self) % DIRWD_MEMFS_MAX_SIZE);
+
+        dirwd_memfs_insert(self, dir, name, (size_t) name_len, false, size);
+    }
+
+    free(targets);
+
+    if (done != NULL) {
+        *done = applied;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @file dirwd_memfs.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog in-memory simulated filesystem backend
+ *
+ * Simulated tree of directories and regular files below one root path,
+ * served through filesystem backend operations. Trees are generated from
+ * a shape (fanout, depth, files per directory) or replayed from a recorded
+ * snapshot. Churn applies seeded random creates, removes and modifications,
+ * or replays the recorded changes between two snapshots of a real tree.
+ * Inode numbers and modification times come from counters, so the same
+ * seed and operations always give the same scans and diffs.
+ *
+ * Optional latency is added to every directory open and every stat. Short
+ * latencies are busy-waited for precision, longer ones sleep like blocking
+ * device reads, so parallel scan threads overlap them. Tree must not be
+ * changed while it is scanned.
+ */
+
+#ifndef __DAEMON_DIRWD_MEMFS_H__
+#define __DAEMON_DIRWD_MEMFS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../util/fsnap.h"
+#include "dirwd_fs.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_MEMFS_NONE             ((size_t) -1)
+#define DIRWD_MEMFS_DEFAULT_CAP      ((size_t) 1024)
+#define DIRWD_MEMFS_NAMES_DEFAULT_CAP ((size_t) 16384)
+#define DIRWD_MEMFS_SPIN_NS          ((uint64_t) 50000) /* Longer latencies sleep */
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_memfs_opts_t {
+    uint64_t seed;
+    uint64_t opendir_latency_ns;
+    uint64_t stat_latency_ns;
+};
+
+struct dirwd_memfs_node_t {
+    uint64_t hash; /* Full path hash */
+    size_t parent;
+    size_t name_off;
+    size_t first_child;
+    size_t prev;
+    size_t next;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime_ns;
+    uint64_t churn; /* Last churn round which created or changed the node */
+    bool is_dir;
+    bool removed;
+};
+
+struct dirwd_memfs_t {
+    struct dirwd_memfs_opts_t opts;
+    char* root; /* Without trailing '/' */
+    size_t root_len;
+
+    /* Removed nodes are kept, node 0 is the root */
+    size_t cap;
+    size_t len;
+    struct dirwd_memfs_node_t* nodes;
+
+    size_t names_cap;
+    size_t names_len;
+    char* names;
+
+    /* Path hash to node index, open addressing */
+    size_t table_cap;
+    size_t table_used; /* Including removed slots */
+    size_t* table;
+
+    size_t files;
+    size_t dirs;
+    uint64_t next_ino;
+    uint64_t next_name;
+    int64_t clock_ns;
+    uint64_t churn;
+    uint64_t rand_state;
+};
+
+/* Changes of one churn round */
+struct dirwd_memfs_churn_t {
+    size_t creates;
+    size_t removes;
+    size_t modifies;
+    size_t create_dirs; /* New files are spread over this many directories, 0 for any directory */
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct dirwd_memfs_t* dirwd_memfs_new(const char* root, const struct dirwd_memfs_opts_t* opts);
+
+void dirwd_memfs_drop(struct dirwd_memfs_t** self);
+
+/* Backend operations, context is the simulated filesystem */
+const struct dirwd_fs_ops_t* dirwd_memfs_ops();
+
+/* Add file or directory below root with missing parents, existing file is updated */
+bool dirwd_memfs_add(struct dirwd_memfs_t* self, const char* path, bool is_dir, int64_t size);
+
+/* Remove file or whole directory subtree */
+bool dirwd_memfs_remove(struct dirwd_memfs_t* self, const char* path);
+
+/* Directories with fanout subdirectories down to depth levels, files in each of them */
+void dirwd_memfs_generate(struct dirwd_memfs_t* self, size_t fanout, size_t depth, size_t files_per_dir);
+
+/* Add files of recorded snapshot below root, returns number of files added */
+size_t dirwd_memfs_replay(struct dirwd_memfs_t* self, const struct fsnap_t* snap);
+
+/* Apply recorded changes from old to new snapshot, both sealed, done receives applied counts */
+void dirwd_memfs_apply(
+    struct dirwd_memfs_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff,
+    struct dirwd_memfs_churn_t* done
+);
+
+/* Apply random changes, every file is changed at most once per round, done receives applied counts */
+void dirwd_memfs_churn(
+    struct dirwd_memfs_t* self,
+    const struct dirwd_memfs_churn_t* churn,
+    struct dirwd_memfs_churn_t* done
+);
+
+#endif /* __DAEMON_DIRWD_MEMFS_H__ */
@@ -0,0 +1,228 @@
+/**
+ * @file dirwd_output.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog event output sinks
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "dirwd_storm.h"
+#include "dirwd_output.h"
+
+/* Per-file detail of summarized events of one inspection */
+struct dirwd_output_detail_t {
+    FILE* fout;
+    bool is_failed;
+    char path[PATH_MAX];
+};
+
+dirwd_status_t dirwd_output_open(struct dirwd_output_t* self, const struct dirwd_output_opts_t* opts) {
+    assert(self != NULL);
+    assert(opts != NULL);
+
+    self->sinks = opts->sinks;
+    self->ring = NULL;
+    self->journal = NULL;
+    self->storm_threshold = opts->storm_threshold;
+    strcpy(self->storm_dir, opts->storm_dir);
+    self->storm_files.cap = 0;
+    self->storm_files.len = 0;
+    self->storm_files.paths = NULL;
+
+    if ((opts->sinks & DIRWD_OUTPUT_RING) != 0) {
+        self->ring = dirwd_ring_open(opts->ring_path, opts->ring_slots);
+
+        if (self->ring == NULL) {
+            syslog(LOG_ERR, "Failed to open event ring '%s': %s", opts->ring_path, strerror(errno));
+            return DIRWD_FAILED_TO_OPEN_RING;
+        }
+    }
+
+    if ((opts->sinks & DIRWD_OUTPUT_JOURNAL) != 0) {
+        self->journal = dirwd_journal_open(opts->journal_dir, opts->journal_segment_bytes, opts->journal_retain_bytes);
+
+        if (self->journal == NULL) {
+            syslog(LOG_ERR, "Failed to open change journal '%s': %s", opts->journal_dir, strerror(errno));
+            dirwd_ring_close(&self->ring);
+            return DIRWD_FAILED_TO_OPEN_JOURNAL;
+        }
+    }
+
+    /* Missing detail directory only loses details, summaries are still logged */
+    if ((opts->storm_threshold > 0) && (mkdir(opts->storm_dir, 0755) != 0) && (errno != EEXIST)) {
+        syslog(LOG_ERR, "Failed to create storm detail directory '%s': %s", opts->storm_dir, strerror(errno));
+    }
+
+    /* Detail files of earlier runs count towards the limit */
+    if (opts->storm_threshold > 0) {
+        detail_files_init(&self->storm_files, opts->storm_dir, "storm-", DIRWD_OUTPUT_STORM_FILES);
+    }
+
+    return DIRWD_SUCCESS;
+}
+
+void dirwd_output_close(struct dirwd_output_t* self) {
+    assert(self != NULL);
+
+    dirwd_ring_close(&self->ring);
+    dirwd_journal_close(&self->journal);
+    self->sinks = 0;
+
+    detail_files_clean(&self->storm_files);
+}
+
+static FILE* dirwd_output_detail_open(struct dirwd_output_t* self, struct dirwd_output_detail_t* detail) {
+    if ((detail->fout != NULL) || detail->is_failed) {
+        return detail->fout;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const int path_len = snprintf(detail->path, sizeof(detail->path), "%s/storm-%lld-%09ld.tsv",
+        self->storm_dir, (long long) now.tv_sec, (long) now.tv_nsec);
+
+    detail->fout = (path_len < (int) sizeof(detail->path)) ? fopen(detail->path, "w") : NULL;
+    if (detail->fout == NULL) {
+        syslog(LOG_ERR, "Failed to create storm detail file '%s': %s", detail->path, strerror(errno));
+        detail->is_failed = true;
+        return NULL;
+    }
+
+    /* Keep last DIRWD_OUTPUT_STORM_FILES files */
+    detail_files_push(&self->storm_files, detail->path);
+
+    return detail->fout;
+}
+
+static void dirwd_output_syslog(
+    struct dirwd_output_t* self,
+    const char* event,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries,
+    struct dirwd_output_detail_t* detail
+)
+{
+    if ((self->storm_threshold == 0) || (entries->len < self->storm_threshold)) {
+        for (size_t i = 0; i < entries->len; i++) {
+            syslog(LOG_INFO, "%s: '%s'", event, fsnap_path(snap, entries->buffer[i]));
+        }
+        return;
+    }
+
+    struct dirwd_storm_t storm;
+    dirwd_storm_find(&storm, snap, entries, self->storm_threshold);
+    FILE* const fout = (storm.roots_len > 0) ? dirwd_output_detail_open(self, detail) : NULL;
+
+    for (size_t i = 0; i < storm.len; i++) {
+        const struct dirwd_storm_event_t* storm_event = &storm.events[i];
+
+        if (storm_event->root == DIRWD_STORM_NONE) {
+            syslog(LOG_INFO, "%s: '%s'", event, storm_event->path);
+        } else if (fout != NULL) {
+            fprintf(fout, "%s\t%s\n", event, storm_event->path);
+        }
+    }
+
+    for (size_t i = 0; i < storm.roots_len; i++) {
+        const struct dirwd_storm_root_t* root = &storm.roots[i];
+
+        /* Root "/" has empty directory path, print leading '/' of its event path instead */
+        syslog(LOG_INFO, "%s: %zu files (%lld bytes) under '%.*s'%s%s%s",
+            event,
+            root->count,
+            (long long) root->bytes,
+            (root->dir_len > 0) ? (int) root->dir_len : 1,
+            root->dir,
+            (fout != NULL) ? ", details in '" : "",
+            (fout != NULL) ? detail->path : "",
+            (fout != NULL) ? "'" : ""
+        );
+    }
+
+    dirwd_storm_clean(&storm);
+}
+
+static void dirwd_output_ring(
+    struct dirwd_ring_t* ring,
+    uint32_t type,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries
+)
+{
+    for (size_t i = 0; i < entries->len; i++) {
+        const size_t idx = entries->buffer[i];
+        const size_t primary = fsnap_primary(snap, idx);
+
+        dirwd_ring_publish(ring, type, fsnap_path(snap, idx), snap->size[primary], snap->mtime_ns[primary]);
+    }
+}
+
+static bool dirwd_output_journal(
+    struct dirwd_journal_t* journal,
+    uint32_t type,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries
+)
+{
+    for (size_t i = 0; i < entries->len; i++) {
+        const size_t idx = entries->buffer[i];
+        const size_t primary = fsnap_primary(snap, idx);
+
+        if (dirwd_journal_append(journal, type, fsnap_path(snap, idx), snap->size[primary], snap->mtime_ns[primary]) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void dirwd_output_diff(
+    struct dirwd_output_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+)
+{
+    assert(self != NULL);
+
+    if ((self->sinks & DIRWD_OUTPUT_SYSLOG) != 0) {
+        struct dirwd_output_detail_t detail = { .fout = NULL, .is_failed = false };
+
+        dirwd_output_syslog(self, "NEW", new_snap, &diff->new_entries, &detail);
+        dirwd_output_syslog(self, "DELETED", old_snap, &diff->deleted_entries, &detail);
+        dirwd_output_syslog(self, "MODIFIED", new_snap, &diff->modified_entries, &detail);
+
+        if ((detail.fout != NULL) && (fclose(detail.fout) != 0)) {
+            syslog(LOG_ERR, "Failed to write storm detail file '%s': %s", detail.path, strerror(errno));
+        }
+    }
+
+    if (self->ring != NULL) {
+        dirwd_output_ring(self->ring, DIRWD_RING_NEW, new_snap, &diff->new_entries);
+        dirwd_output_ring(self->ring, DIRWD_RING_DELETED, old_snap, &diff->deleted_entries);
+        dirwd_output_ring(self->ring, DIRWD_RING_MODIFIED, new_snap, &diff->modified_entries);
+    }
+
+    if (self->journal != NULL) {
+        const bool is_appended = dirwd_output_journal(self->journal, DIRWD_RING_NEW, new_snap, &diff->new_entries)
+            && dirwd_output_journal(self->journal, DIRWD_RING_DELETED, old_snap, &diff->deleted_entries)
+            && dirwd_output_journal(self->journal, DIRWD_RING_MODIFIED, new_snap, &diff->modified_entries);
+
+        if (!is_appended || !dirwd_journal_commit(self->journal)) {
+            syslog(LOG_ERR, "Failed to write change journal: %s", strerror(errno));
+        }
+    }
+}
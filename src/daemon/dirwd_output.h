@@ -0,0 +1,71 @@
+/**
+ * @file dirwd_output.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog event output sinks
+ */
+
+#ifndef __DAEMON_DIRWD_OUTPUT_H__
+#define __DAEMON_DIRWD_OUTPUT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "dirwd_ring.h"
+#include "../journal/dirwd_journal.h"
+#include "dirwd_status.h"
+#include "../util/fsnap.h"
+#include "../util/detail_files.h"
+
+/* Define -------------------------------------------------------------------*/
+
+/* Output sinks */
+#define DIRWD_OUTPUT_SYSLOG  ((uint8_t) 0x1)
+#define DIRWD_OUTPUT_RING    ((uint8_t) 0x2)
+#define DIRWD_OUTPUT_JOURNAL ((uint8_t) 0x4)
+
+#define DIRWD_OUTPUT_DEFAULT_RING_PATH "/dev/shm/dirwdd.ring"
+#define DIRWD_OUTPUT_DEFAULT_STORM_DIR "/var/tmp/dirwdd"
+#define DIRWD_OUTPUT_STORM_FILES       ((size_t) 32) /* Detail files kept */
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_output_opts_t {
+    uint8_t sinks;
+    size_t ring_slots;
+    char ring_path[PATH_MAX];
+    size_t journal_segment_bytes;
+    size_t journal_retain_bytes;
+    char journal_dir[PATH_MAX];
+    size_t storm_threshold; /* Syslog events below one directory to summarize, 0 disables */
+    char storm_dir[PATH_MAX];
+};
+
+struct dirwd_output_t {
+    uint8_t sinks;
+    struct dirwd_ring_t* ring;
+    struct dirwd_journal_t* journal;
+
+    /* Syslog storm aggregation */
+    size_t storm_threshold;
+    char storm_dir[PATH_MAX];
+    struct detail_files_t storm_files;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+dirwd_status_t dirwd_output_open(struct dirwd_output_t* self, const struct dirwd_output_opts_t* opts);
+
+void dirwd_output_close(struct dirwd_output_t* self);
+
+/* Emit inspection events to all configured sinks */
+void dirwd_output_diff(
+    struct dirwd_output_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+);
+
+#endif /* __DAEMON_DIRWD_OUTPUT_H__ */
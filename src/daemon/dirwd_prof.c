@@ -0,0 +1,379 @@
+/**
+ * @file dirwd_prof.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog per-directory scan profiling
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "../util/fsnap.h"
+#include "dirwd_prof.h"
+
+static size_t dirwd_prof_bucket(uint64_t value) {
+    if (value == 0) {
+        return 0;
+    }
+
+    const size_t bucket = 64 - (size_t) __builtin_clzll(value);
+    return (bucket < DIRWD_PROF_BUCKETS) ? bucket : DIRWD_PROF_BUCKETS - 1;
+}
+
+static size_t dirwd_prof_slot_hash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+static void dirwd_prof_clear_slow(struct dirwd_prof_t* self) {
+    for (size_t i = 0; i < self->slow_len; i++) {
+        free(self->slow[i].path);
+    }
+
+    free(self->slow);
+    self->slow = NULL;
+    self->slow_len = 0;
+}
+
+struct dirwd_prof_t* dirwd_prof_new(const struct dirwd_prof_opts_t* opts) {
+    if (opts == NULL) {
+        return NULL;
+    }
+
+    struct dirwd_prof_t* new_prof = (struct dirwd_prof_t*) calloc(1, sizeof(struct dirwd_prof_t));
+    new_prof->opts = *opts;
+    new_prof->cap = DIRWD_PROF_DEFAULT_CAP;
+    new_prof->dirs = (struct dirwd_prof_dir_t*) malloc(new_prof->cap * sizeof(struct dirwd_prof_dir_t));
+    new_prof->paths_cap = DIRWD_PROF_PATHS_DEFAULT_CAP;
+    new_prof->paths = (char*) malloc(new_prof->paths_cap);
+
+    return new_prof;
+}
+
+void dirwd_prof_drop(struct dirwd_prof_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    dirwd_prof_clear_slow(*self);
+    free((*self)->dirs);
+    free((*self)->paths);
+    free(*self);
+    *self = NULL;
+}
+
+uint64_t dirwd_prof_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+void dirwd_prof_begin(struct dirwd_prof_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    self->start_ns = dirwd_prof_now_ns();
+    self->len = 0;
+    self->paths_len = 0;
+}
+
+void dirwd_prof_record(struct dirwd_prof_t* self, const char* path, const struct dirwd_prof_dir_stats_t* stats) {
+    if (self == NULL) {
+        return;
+    }
+
+    size_t len = strlen(path);
+    while ((len > 0) && (path[len - 1] == '/')) {
+        len--;
+    }
+
+    if (self->len == self->cap) {
+        self->cap *= 2;
+        self->dirs = (struct dirwd_prof_dir_t*) realloc(self->dirs, self->cap * sizeof(struct dirwd_prof_dir_t));
+    }
+
+    if (self->paths_len + len + 1 > self->paths_cap) {
+        while (self->paths_len + len + 1 > self->paths_cap) {
+            self->paths_cap *= 2;
+        }
+        self->paths = (char*) realloc(self->paths, self->paths_cap);
+    }
+
+    struct dirwd_prof_dir_t* dir = &self->dirs[self->len++];
+    dir->hash = fsnap_hash_update(FSNAP_HASH_INIT, path, len);
+    dir->path_off = self->paths_len;
+    dir->depth = 0;
+    dir->stats = *stats;
+
+    size_t parent_len = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (path[i] == '/') {
+            dir->depth++;
+            parent_len = i;
+        }
+    }
+    dir->parent_hash = (dir->depth > 0) ? fsnap_hash_update(FSNAP_HASH_INIT, path, parent_len) : dir->hash;
+
+    memcpy(self->paths + self->paths_len, path, len);
+    self->paths[self->paths_len + len] = '\0';
+    self->paths_len += len + 1;
+
+    self->readdir_hist.count[dirwd_prof_bucket(stats->readdir_ns)]++;
+    self->stat_hist.count[dirwd_prof_bucket(stats->stat_ns)]++;
+    self->entries_hist.count[dirwd_prof_bucket(stats->entries)]++;
+}
+
+/* Min-heap of directory indices by subtree time */
+static void dirwd_prof_heap_sift(const struct dirwd_prof_dir_t* dirs, size_t* heap, size_t len, size_t pos) {
+    while (true) {
+        const size_t left = 2 * pos + 1;
+        const size_t right = left + 1;
+        size_t min = pos;
+
+        if ((left < len) && (dirs[heap[left]].subtree_ns < dirs[heap[min]].subtree_ns)) {
+            min = left;
+        }
+        if ((right < len) && (dirs[heap[right]].subtree_ns < dirs[heap[min]].subtree_ns)) {
+            min = right;
+        }
+        if (min == pos) {
+            return;
+        }
+
+        const size_t tmp = heap[pos];
+        heap[pos] = heap[min];
+        heap[min] = tmp;
+        pos = min;
+    }
+}
+
+static int dirwd_prof_slow_cmp(const void* a, const void* b) {
+    const uint64_t a_ns = ((const struct dirwd_prof_slow_t*) a)->dir.subtree_ns;
+    const uint64_t b_ns = ((const struct dirwd_prof_slow_t*) b)->dir.subtree_ns;
+
+    return (a_ns < b_ns) - (a_ns > b_ns);
+}
+
+void dirwd_prof_end(struct dirwd_prof_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    self->inspections++;
+    self->last_ns = dirwd_prof_now_ns() - self->start_ns;
+    self->last_dirs = self->len;
+    self->last_entries = 0;
+    self->last_errors = 0;
+
+    /* Directory lookup table and depth order */
+    size_t table_cap = 16;
+    size_t max_depth = 0;
+    while (table_cap < 2 * self->len) {
+        table_cap *= 2;
+    }
+
+    size_t* table = (size_t*) malloc(table_cap * sizeof(size_t));
+    memset(table, 0xff, table_cap * sizeof(size_t));
+
+    for (size_t i = 0; i < self->len; i++) {
+        struct dirwd_prof_dir_t* dir = &self->dirs[i];
+        dir->subtree_ns = dir->stats.readdir_ns + dir->stats.stat_ns;
+        dir->subtree_dirs = 1;
+        dir->subtree_entries = dir->stats.entries;
+        dir->subtree_errors = dir->stats.errors;
+        dir->max_sub_ns = 0;
+
+        self->last_entries += dir->stats.entries;
+        self->last_errors += dir->stats.errors;
+        max_depth = (dir->depth > max_depth) ? dir->depth : max_depth;
+
+        size_t slot = dirwd_prof_slot_hash(dir->hash) & (table_cap - 1);
+        while (table[slot] != SIZE_MAX) {
+            slot = (slot + 1) & (table_cap - 1);
+        }
+        table[slot] = i;
+    }
+
+    size_t* depth_off = (size_t*) calloc(max_depth + 2, sizeof(size_t));
+    size_t* order = (size_t*) malloc((self->len + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < self->len; i++) {
+        depth_off[max_depth - self->dirs[i].depth + 1]++;
+    }
+    for (size_t d = 1; d <= max_depth + 1; d++) {
+        depth_off[d] += depth_off[d - 1];
+    }
+    for (size_t i = 0; i < self->len; i++) {
+        order[depth_off[max_depth - self->dirs[i].depth]++] = i;
+    }
+
+    /* Deepest directories first, so subtrees are complete when added to parent */
+    for (size_t k = 0; k < self->len; k++) {
+        const struct dirwd_prof_dir_t* dir = &self->dirs[order[k]];
+        if (dir->parent_hash == dir->hash) {
+            continue;
+        }
+
+        size_t slot = dirwd_prof_slot_hash(dir->parent_hash) & (table_cap - 1);
+        while ((table[slot] != SIZE_MAX) && (self->dirs[table[slot]].hash != dir->parent_hash)) {
+            slot = (slot + 1) & (table_cap - 1);
+        }
+
+        if (table[slot] == SIZE_MAX) {
+            continue;
+        }
+
+        struct dirwd_prof_dir_t* parent = &self->dirs[table[slot]];
+        parent->subtree_ns += dir->subtree_ns;
+        parent->subtree_dirs += dir->subtree_dirs;
+        parent->subtree_entries += dir->subtree_entries;
+        parent->subtree_errors += dir->subtree_errors;
+        parent->max_sub_ns = (dir->subtree_ns > parent->max_sub_ns) ? dir->subtree_ns : parent->max_sub_ns;
+    }
+
+    /* Slowest subtrees which are not dominated by one subdirectory */
+    size_t* heap = order;
+    size_t heap_len = 0;
+
+    for (size_t i = 0; i < self->len; i++) {
+        const struct dirwd_prof_dir_t* dir = &self->dirs[i];
+        if ((self->opts.top == 0) || (2 * dir->max_sub_ns >= dir->subtree_ns)) {
+            continue;
+        }
+
+        if (heap_len < self->opts.top) {
+            heap[heap_len++] = i;
+            for (size_t pos = heap_len / 2; pos-- > 0;) {
+                dirwd_prof_heap_sift(self->dirs, heap, heap_len, pos);
+            }
+        } else if (dir->subtree_ns > self->dirs[heap[0]].subtree_ns) {
+            heap[0] = i;
+            dirwd_prof_heap_sift(self->dirs, heap, heap_len, 0);
+        }
+    }
+
+    dirwd_prof_clear_slow(self);
+    self->slow = (struct dirwd_prof_slow_t*) malloc((heap_len + 1) * sizeof(struct dirwd_prof_slow_t));
+    self->slow_len = heap_len;
+
+    for (size_t k = 0; k < heap_len; k++) {
+        const struct dirwd_prof_dir_t* dir = &self->dirs[heap[k]];
+        self->slow[k].path = strdup(self->paths + dir->path_off);
+        self->slow[k].dir = *dir;
+    }
+    qsort(self->slow, self->slow_len, sizeof(struct dirwd_prof_slow_t), dirwd_prof_slow_cmp);
+
+    free(order);
+    free(depth_off);
+    free(table);
+}
+
+static void dirwd_prof_write_hist(FILE* fout, const char* title, const struct dirwd_prof_hist_t* hist, bool is_time) {
+    static const char* const units[] = { "ns", "us", "ms", "s" };
+
+    fprintf(fout, "\n%s\n", title);
+
+    for (size_t i = 0; i < DIRWD_PROF_BUCKETS; i++) {
+        if (hist->count[i] == 0) {
+            continue;
+        }
+
+        /* Lower bound of bucket */
+        uint64_t bound = (i == 0) ? 0 : (1ULL << (i - 1));
+        size_t unit = 0;
+        if (is_time) {
+            while ((unit < 3) && (bound >= 1000)) {
+                bound /= 1000;
+                unit++;
+            }
+        }
+
+        fprintf(fout, "  >= %6llu%-2s %12llu\n",
+            (unsigned long long) bound,
+            is_time ? units[unit] : "",
+            (unsigned long long) hist->count[i]);
+    }
+}
+
+bool dirwd_prof_write(const struct dirwd_prof_t* self, FILE* fout) {
+    if ((self == NULL) || (fout == NULL)) {
+        return false;
+    }
+
+    fprintf(fout, "inspections: %llu\n", (unsigned long long) self->inspections);
+    fprintf(fout, "last inspection: %.3f ms, %llu directories, %llu entries, %llu errors\n",
+        (double) self->last_ns / 1e6,
+        (unsigned long long) self->last_dirs,
+        (unsigned long long) self->last_entries,
+        (unsigned long long) self->last_errors);
+
+    fprintf(fout, "\nslow subtrees of last inspection\n");
+    fprintf(fout, "  %12s %12s %12s %10s %12s %8s  %s\n",
+        "subtree_ms", "readdir_ms", "stat_ms", "dirs", "entries", "errors", "path");
+
+    for (size_t i = 0; i < self->slow_len; i++) {
+        const struct dirwd_prof_dir_t* dir = &self->slow[i].dir;
+        fprintf(fout, "  %12.3f %12.3f %12.3f %10llu %12llu %8llu  %s\n",
+            (double) dir->subtree_ns / 1e6,
+            (double) dir->stats.readdir_ns / 1e6,
+            (double) dir->stats.stat_ns / 1e6,
+            (unsigned long long) dir->subtree_dirs,
+            (unsigned long long) dir->subtree_entries,
+            (unsigned long long) dir->subtree_errors,
+            (self->slow[i].path[0] != '\0') ? self->slow[i].path : "/");
+    }
+
+    dirwd_prof_write_hist(fout, "directory readdir time", &self->readdir_hist, true);
+    dirwd_prof_write_hist(fout, "directory stat time", &self->stat_hist, true);
+    dirwd_prof_write_hist(fout, "directory entries", &self->entries_hist, false);
+
+    return ferror(fout) == 0;
+}
+
+bool dirwd_prof_dump(const struct dirwd_prof_t* self) {
+    if (self == NULL) {
+        return false;
+    }
+
+    /* Create parent directory of report file if missing */
+    char dir[PATH_MAX];
+    strcpy(dir, self->opts.file);
+    char* p_slash = strrchr(dir, '/');
+    if ((p_slash != NULL) && (p_slash != dir)) {
+        *p_slash = '\0';
+        mkdir(dir, 0755);
+    }
+
+    char tmp_path[PATH_MAX + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", self->opts.file);
+
+    FILE* const fout = fopen(tmp_path, "w");
+    if (fout == NULL) {
+        syslog(LOG_ERR, "Failed to create profile report '%s': %s", tmp_path, strerror(errno));
+        return false;
+    }
+
+    bool is_written = dirwd_prof_write(self, fout);
+    is_written = (fclose(fout) == 0) && is_written;
+    is_written = is_written && (rename(tmp_path, self->opts.file) == 0);
+
+    if (!is_written) {
+        syslog(LOG_ERR, "Failed to write profile report '%s': %s", self->opts.file, strerror(errno));
+        unlink(tmp_path);
+    }
+
+    return is_written;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file dirwd_prof.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog per-directory scan profiling
+ *
+ * Scanner reports readdir time, stat time, entry and error count of every
+ * directory it reads. At the end of inspection directory times are summed
+ * up the tree and the slowest subtrees are kept for the report. Subtree
+ * whose time is mostly spent in one of its subdirectories is not reported,
+ * so the report points at the directories responsible instead of the chain
+ * of their ancestors. Log2 histograms of per-directory times and entry
+ * counts are accumulated over all inspections.
+ */
+
+#ifndef __DAEMON_DIRWD_PROF_H__
+#define __DAEMON_DIRWD_PROF_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <limits.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_PROF_BUCKETS      ((size_t) 48) /* Bucket i counts values in [2^(i-1), 2^i) */
+#define DIRWD_PROF_TOP_DEFAULT  ((size_t) 20)
+#define DIRWD_PROF_MAX_TOP      ((size_t) 1000)
+#define DIRWD_PROF_DEFAULT_CAP  ((size_t) 1024)
+#define DIRWD_PROF_PATHS_DEFAULT_CAP ((size_t) 65536)
+
+#define DIRWD_PROF_DEFAULT_FILE "/var/tmp/dirwdd/profile.txt"
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_prof_opts_t {
+    bool enabled;
+    size_t top;
+    char file[PATH_MAX]; /* Report file written on request */
+};
+
+/* Filled by scanner for one directory */
+struct dirwd_prof_dir_stats_t {
+    uint64_t readdir_ns; /* opendir, readdir and closedir */
+    uint64_t stat_ns;
+    uint64_t entries;
+    uint64_t errors;
+};
+
+struct dirwd_prof_hist_t {
+    uint64_t count[DIRWD_PROF_BUCKETS];
+};
+
+struct dirwd_prof_dir_t {
+    uint64_t hash;        /* Directory path hash without trailing '/' */
+    uint64_t parent_hash;
+    size_t path_off;
+    size_t depth;
+    struct dirwd_prof_dir_stats_t stats;
+
+    /* Computed at the end of inspection */
+    uint64_t subtree_ns;
+    uint64_t subtree_dirs;
+    uint64_t subtree_entries;
+    uint64_t subtree_errors;
+    uint64_t max_sub_ns; /* Slowest subdirectory subtree */
+};
+
+/* Reported subtree, path is owned */
+struct dirwd_prof_slow_t {
+    char* path;
+    struct dirwd_prof_dir_t dir;
+};
+
+struct dirwd_prof_t {
+    struct dirwd_prof_opts_t opts;
+
+    /* Current inspection */
+    uint64_t start_ns;
+    size_t cap;
+    size_t len;
+    struct dirwd_prof_dir_t* dirs;
+    size_t paths_cap;
+    size_t paths_len;
+    char* paths;
+
+    /* Last finished inspection */
+    uint64_t last_ns;
+    uint64_t last_dirs;
+    uint64_t last_entries;
+    uint64_t last_errors;
+    size_t slow_len;
+    struct dirwd_prof_slow_t* slow; /* Sorted by subtree time, slowest first */
+
+    /* All inspections */
+    uint64_t inspections;
+    struct dirwd_prof_hist_t readdir_hist;
+    struct dirwd_prof_hist_t stat_hist;
+    struct dirwd_prof_hist_t entries_hist;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct dirwd_prof_t* dirwd_prof_new(const struct dirwd_prof_opts_t* opts);
+
+void dirwd_prof_drop(struct dirwd_prof_t** self);
+
+uint64_t dirwd_prof_now_ns();
+
+/* Start new inspection */
+void dirwd_prof_begin(struct dirwd_prof_t* self);
+
+/* Record scanned directory, callers must serialize calls */
+void dirwd_prof_record(struct dirwd_prof_t* self, const char* path, const struct dirwd_prof_dir_stats_t* stats);
+
+/* Sum subtrees and select the slowest ones */
+void dirwd_prof_end(struct dirwd_prof_t* self);
+
+/* Write text report of the last inspection and histograms */
+bool dirwd_prof_write(const struct dirwd_prof_t* self, FILE* fout);
+
+/* Replace report file */
+bool dirwd_prof_dump(const struct dirwd_prof_t* self);
+
+#endif /* __DAEMON_DIRWD_PROF_H__ */
@@ -0,0 +1,188 @@
+/**
+ * @file dirwd_query.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog query socket served from published snapshots
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/syslog.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "../util/fsnap.h"
+#include "../util/fsnap_pub.h"
+#include "dirwd_ctl.h"
+#include "dirwd_query.h"
+
+static void dirwd_query_stat(const struct fsnap_gen_t* gen, const char* path, char* reply, size_t reply_size) {
+    const unsigned long long generation = (unsigned long long) gen->generation;
+    size_t idx = 0;
+    uint64_t summary = 0;
+
+    if (fsnap_find(gen->snap, path, &idx)) {
+        const size_t primary = fsnap_primary(gen->snap, idx);
+        snprintf(reply, reply_size, "FILE %llu %lld %lld", generation,
+            (long long) gen->snap->size[primary], (long long) gen->snap->mtime_ns[primary]);
+    } else if (fsnap_dir_summary(gen->snap, path, &summary)) {
+        snprintf(reply, reply_size, "DIR %llu %016llx", generation, (unsigned long long) summary);
+    } else {
+        snprintf(reply, reply_size, "NONE %llu", generation);
+    }
+}
+
+void dirwd_query_answer(struct fsnap_pub_t* pub, const char* line, char* reply, size_t reply_size) {
+    const size_t stat_len = strlen(DIRWD_QUERY_STAT_COMMAND);
+    const bool is_info = (strcmp(line, DIRWD_QUERY_INFO_COMMAND) == 0);
+    const bool is_stat = (strncmp(line, DIRWD_QUERY_STAT_COMMAND, stat_len) == 0) && (line[stat_len] == ' ');
+
+    if (!is_info && !is_stat) {
+        snprintf(reply, reply_size, "ERR unknown command");
+        return;
+    }
+
+    struct fsnap_gen_t* gen = fsnap_pub_acquire(pub);
+    if (gen == NULL) {
+        snprintf(reply, reply_size, "ERR no snapshot published yet");
+        return;
+    }
+
+    if (is_info) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        const int64_t now_ns = (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+
+        snprintf(reply, reply_size, "OK %llu %lu %lld", (unsigned long long) gen->generation,
+            fsnap_len(gen->snap), (long long) ((now_ns - gen->published_ns) / 1000000));
+    } else {
+        dirwd_query_stat(gen, line + stat_len + 1, reply, reply_size);
+    }
+
+    fsnap_pub_release(gen);
+}
+
+static void dirwd_query_handle(struct dirwd_query_t* self, int client) {
+    const struct timeval timeout = {
+        .tv_sec = 0,
+        .tv_usec = (suseconds_t) (DIRWD_QUERY_READ_TIMEOUT_MS * 1000),
+    };
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    /* Read one line, slow client gets whatever arrived within timeout */
+    char line[DIRWD_QUERY_LINE_SIZE];
+    size_t len = 0;
+
+    while (len + 1 < sizeof(line)) {
+        const ssize_t bytes = recv(client, line + len, sizeof(line) - 1 - len, 0);
+        if ((bytes < 0) && (errno == EINTR)) {
+            continue;
+        } else if (bytes <= 0) {
+            break;
+        }
+
+        len += (size_t) bytes;
+        if (memchr(line, '\n', len) != NULL) {
+            break;
+        }
+    }
+    line[len] = '\0';
+
+    char* p_newline = strpbrk(line, "\r\n");
+    if (p_newline != NULL) {
+        *p_newline = '\0';
+    }
+
+    char reply[DIRWD_QUERY_REPLY_SIZE];
+    dirwd_query_answer(self->pub, line, reply, sizeof(reply) - 1);
+    strcat(reply, "\n");
+
+    if (send(client, reply, strlen(reply), MSG_NOSIGNAL) < 0) {
+        syslog(LOG_DEBUG, "Failed to reply to query client: %s", strerror(errno));
+    }
+    close(client);
+}
+
+static void* dirwd_query_thread(void* arg) {
+    struct dirwd_query_t* self = (struct dirwd_query_t*) arg;
+
+    while (!atomic_load(&self->stop)) {
+        struct pollfd poll_fd = { .fd = self->fd, .events = POLLIN, .revents = 0 };
+        if (poll(&poll_fd, 1, DIRWD_QUERY_POLL_MS) <= 0) {
+            continue;
+        }
+
+        while (true) {
+            const int client = accept4(self->fd, NULL, NULL, SOCK_CLOEXEC);
+
+            if (client >= 0) {
+                dirwd_query_handle(self, client);
+            } else if (errno != EINTR) {
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                    syslog(LOG_ERR, "Failed to accept query connection: %s", strerror(errno));
+                }
+                break;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+struct dirwd_query_t* dirwd_query_open(struct fsnap_pub_t* pub, const struct dirwd_query_opts_t* opts) {
+    if ((pub == NULL) || (opts == NULL)) {
+        return NULL;
+    }
+
+    struct dirwd_ctl_socket_t socket_file = { 0, 0 };
+    const int fd = (opts->socket_path[0] != '\0') ? dirwd_ctl_listen(opts->socket_path, &socket_file) : -1;
+    if (fd < 0) {
+        syslog(LOG_ERR, "Failed to open query socket '%s'", opts->socket_path);
+        return NULL;
+    }
+
+    struct dirwd_query_t* new_query = (struct dirwd_query_t*) calloc(1, sizeof(struct dirwd_query_t));
+    new_query->opts = *opts;
+    new_query->fd = fd;
+    new_query->socket_file = socket_file;
+    new_query->pub = pub;
+    atomic_init(&new_query->stop, false);
+
+    const int err = pthread_create(&new_query->thread, NULL, dirwd_query_thread, new_query);
+    if (err != 0) {
+        syslog(LOG_ERR, "Failed to start query thread: %s", strerror(err));
+        dirwd_ctl_unlisten(fd, opts->socket_path, &socket_file);
+        free(new_query);
+        return NULL;
+    }
+
+    return new_query;
+}
+
+void dirwd_query_close(struct dirwd_query_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    struct dirwd_query_t* query = *self;
+
+    atomic_store(&query->stop, true);
+    pthread_join(query->thread, NULL);
+
+    dirwd_ctl_unlisten(query->fd, query->opts.socket_path, &query->socket_file);
+
+    free(query);
+    *self = NULL;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file dirwd_query.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog query socket served from published snapshots
+ *
+ * Daemon listens on a Unix stream socket for one command line per
+ * connection and answers it from the latest published snapshot on its own
+ * thread, so queries are answered while an inspection is running:
+ *
+ * 'INFO' - 'OK <generation> <entries> <age_ms>'
+ * 'STAT <path>' - 'FILE <generation> <size> <mtime_ns>',
+ *                 'DIR <generation> <subtree summary in hex>' or 'NONE <generation>'
+ *
+ * 'ERR <reason>' is returned for unknown commands and before the first
+ * snapshot is published.
+ */
+
+#ifndef __DAEMON_DIRWD_QUERY_H__
+#define __DAEMON_DIRWD_QUERY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "../util/fsnap_pub.h"
+#include "dirwd_ctl.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_QUERY_POLL_MS       ((int) 100) /* Longest wait for close */
+#define DIRWD_QUERY_READ_TIMEOUT_MS ((int64_t) 100)
+#define DIRWD_QUERY_LINE_SIZE     ((size_t) (PATH_MAX + 16))
+#define DIRWD_QUERY_REPLY_SIZE    ((size_t) 128)
+
+#define DIRWD_QUERY_INFO_COMMAND "INFO"
+#define DIRWD_QUERY_STAT_COMMAND "STAT"
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_query_opts_t {
+    char socket_path[108]; /* Empty if query socket is disabled, sun_path size */
+};
+
+struct dirwd_query_t {
+    struct dirwd_query_opts_t opts;
+    int fd; /* Listening socket */
+    struct dirwd_ctl_socket_t socket_file;
+    struct fsnap_pub_t* pub; /* Not owned, outlives the query thread */
+
+    pthread_t thread;
+    atomic_bool stop;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Listen on socket_path of opts and start serving thread. NULL on failure */
+struct dirwd_query_t* dirwd_query_open(struct fsnap_pub_t* pub, const struct dirwd_query_opts_t* opts);
+
+/* Stop serving thread, close socket and remove its file */
+void dirwd_query_close(struct dirwd_query_t** self);
+
+/* Answer command line from the latest published snapshot, reply has no newline */
+void dirwd_query_answer(struct fsnap_pub_t* pub, const char* line, char* reply, size_t reply_size);
+
+#endif /* __DAEMON_DIRWD_QUERY_H__ */
@@ -0,0 +1,677 @@
+/**
+ * @file dirwd_scan.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog parallel tree scanner
+ *
+ * Directories are processed from a shared work queue. Every worker scans
+ * one directory at a time into its own snapshot and queues subdirectories,
+ * worker snapshots are merged when the queue is drained. Directory
+ * identities (device, inode) are recorded, so bind mounts and symlink
+ * loops are scanned once. Which path of such directory is scanned first
+ * depends on thread timing, so every other path reaching it is kept and
+ * after the scan its files are moved below the lexicographically smallest
+ * one, which gives the same snapshot whatever the number of threads.
+ * Optional filter chooses per directory whether
+ * its files are recorded and whether its subtree is scanned at all.
+ *
+ * In inode order mode whole directory listing is read first and entries
+ * are stat'ed sorted by inode number, which follows inode table layout on
+ * ext4 and most other filesystems and turns random reads into sequential
+ * ones for large directories on cold cache.
+ *
+ * With visit callback files of every directory are collected into a
+ * per-worker snapshot and handed over when the directory is done, instead
+ * of being recorded in the result, so the whole tree is never held.
+ * Handed over files keep the path their directory was first queued by.
+ *
+ * With profiling enabled every directory is timed as a whole and its
+ * stat calls separately, readdir time is the rest. Directory records are
+ * passed to the profiler under scan lock together with its subdirectories.
+ *
+ * All filesystem access goes through backend operations, real filesystem
+ * unless scan options name another backend.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include "../util/fid_set.h"
+#include "dirwd_scan.h"
+
+#define DIRWD_SCAN_LISTING_DEFAULT_CAP ((size_t) 256)
+
+struct dirwd_scan_item_t {
+    char* path;
+    dirwd_scan_action_t action;
+};
+
+/* Directory identity reached by path */
+struct dirwd_scan_claim_t {
+    uint64_t dev;
+    uint64_t ino;
+    char* path;
+};
+
+struct dirwd_scan_claims_t {
+    size_t cap;
+    size_t len;
+    struct dirwd_scan_claim_t* buffer;
+};
+
+/* Directory reached by more than one path */
+struct dirwd_scan_alias_t {
+    const char* path; /* Scanned path */
+    size_t path_len;
+    char* smallest; /* Smallest path found so far */
+    size_t first; /* Other paths in sorted aliases */
+    size_t last;
+};
+
+struct dirwd_scan_t {
+    const struct dirwd_scan_opts_t* opts;
+    const struct dirwd_fs_ops_t* fs;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* Directories waiting to be scanned */
+    size_t cap;
+    size_t len;
+    struct dirwd_scan_item_t* queue;
+
+    /* Queued and in progress directories */
+    size_t pending;
+
+    /* Identities of queued directories */
+    struct fid_set_t* visited;
+    dev_t root_dev;
+
+    /* Queued directories own queue paths, aliases are paths of already queued ones */
+    struct dirwd_scan_claims_t claims;
+    struct dirwd_scan_claims_t aliases;
+};
+
+struct dirwd_scan_subdir_t {
+    char* path;
+    dev_t dev;
+    ino_t ino;
+};
+
+struct dirwd_scan_subdirs_t {
+    size_t cap;
+    size_t len;
+    struct dirwd_scan_subdir_t* buffer;
+};
+
+/* Directory listing read before stat in inode order mode */
+struct dirwd_scan_dirent_t {
+    ino_t ino;
+    size_t name_off;
+};
+
+struct dirwd_scan_listing_t {
+    size_t cap;
+    size_t len;
+    struct dirwd_scan_dirent_t* buffer;
+
+    size_t names_cap;
+    size_t names_len;
+    char* names;
+};
+
+struct dirwd_scan_worker_t {
+    struct dirwd_scan_t* scan;
+    struct fsnap_t* entries;
+    struct fsnap_t* files; /* Files of current directory with visit callback */
+    struct dirwd_scan_listing_t listing; /* Reused between directories */
+    pthread_t thread;
+};
+
+static void dirwd_scan_claims_push(struct dirwd_scan_claims_t* self, uint64_t dev, uint64_t ino, char* path) {
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? 16 : self->cap * 2;
+        self->buffer = (struct dirwd_scan_claim_t*) realloc(self->buffer,
+            self->cap * sizeof(struct dirwd_scan_claim_t));
+    }
+
+    self->buffer[self->len].dev = dev;
+    self->buffer[self->len].ino = ino;
+    self->buffer[self->len].path = path;
+    self->len++;
+}
+
+static void dirwd_scan_claims_clean(struct dirwd_scan_claims_t* self) {
+    for (size_t i = 0; i < self->len; i++) {
+        free(self->buffer[i].path);
+    }
+    free(self->buffer);
+}
+
+static int dirwd_scan_claim_cmp(const void* a, const void* b) {
+    const struct dirwd_scan_claim_t* a_claim = (const struct dirwd_scan_claim_t*) a;
+    const struct dirwd_scan_claim_t* b_claim = (const struct dirwd_scan_claim_t*) b;
+
+    if (a_claim->dev != b_claim->dev) {
+        return (a_claim->dev > b_claim->dev) - (a_claim->dev < b_claim->dev);
+    }
+    return (a_claim->ino > b_claim->ino) - (a_claim->ino < b_claim->ino);
+}
+
+/* Must be called under scan lock, takes ownership of path */
+static void dirwd_scan_queue_push(struct dirwd_scan_t* scan, char* path, uint64_t dev, uint64_t ino) {
+    const dirwd_scan_action_t action = (scan->opts->filter != NULL)
+        ? scan->opts->filter(scan->opts->filter_ctx, path)
+        : DIRWD_SCAN_FULL;
+
+    if (action == DIRWD_SCAN_SKIP) {
+        free(path);
+        return;
+    }
+
+    if (scan->len == scan->cap) {
+        scan->cap *= 2;
+        scan->queue = (struct dirwd_scan_item_t*) realloc(scan->queue,
+            scan->cap * sizeof(struct dirwd_scan_item_t));
+    }
+
+    scan->queue[scan->len].path = path;
+    scan->queue[scan->len].action = action;
+    scan->len++;
+    scan->pending++;
+    dirwd_scan_claims_push(&scan->claims, dev, ino, path);
+}
+
+/* Files of directory are not recorded, skip entries which can not be directories */
+static bool dirwd_scan_is_dir_candidate(const struct dirwd_scan_t* scan, unsigned char d_type) {
+    switch (d_type) {
+    case DT_DIR:
+    case DT_UNKNOWN:
+        return true;
+    case DT_LNK:
+        return scan->opts->follow_symlinks;
+    default:
+        return false;
+    }
+}
+
+static void dirwd_scan_subdirs_push(struct dirwd_scan_subdirs_t* self, const char* path, const struct stat* file_stat) {
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? 16 : self->cap * 2;
+        self->buffer = (struct dirwd_scan_subdir_t*) realloc(self->buffer,
+            self->cap * sizeof(struct dirwd_scan_subdir_t));
+    }
+
+    self->buffer[self->len].path = strdup(path);
+    self->buffer[self->len].dev = file_stat->st_dev;
+    self->buffer[self->len].ino = file_stat->st_ino;
+    self->len++;
+}
+
+/* Stat one directory entry, file_path_buffer holds directory path of path_len bytes */
+static void dirwd_scan_entry(
+    struct dirwd_scan_t* scan,
+    struct fsnap_t* entries,
+    void* dir,
+    char* file_path_buffer,
+    size_t path_len,
+    const char* name,
+    dirwd_scan_action_t action,
+    struct dirwd_scan_subdirs_t* subdirs,
+    struct dirwd_prof_dir_stats_t* stats
+)
+{
+    const int stat_flags = scan->opts->follow_symlinks ? 0 : AT_SYMLINK_NOFOLLOW;
+    struct stat file_stat;
+
+    /* Get file full path */
+    const size_t name_len = strlen(name);
+    if (path_len + name_len + 1 > PATH_MAX) {
+        syslog(LOG_ERR, "Path is too long: '%.*s%s'", (int) path_len, file_path_buffer, name);
+        if (stats != NULL) {
+            stats->errors++;
+        }
+        return;
+    }
+    memcpy(file_path_buffer + path_len, name, name_len + 1);
+
+    const uint64_t stat_start_ns = (stats != NULL) ? dirwd_prof_now_ns() : 0;
+
+    /* Get file metadata, dangling symlinks are recorded as links */
+    void* const fs_ctx = scan->opts->fs_ctx;
+    int stat_status = scan->fs->statat(fs_ctx, dir, name, &file_stat, stat_flags);
+    if ((stat_status != 0) && (stat_flags == 0) && ((errno == ENOENT) || (errno == ELOOP))) {
+        stat_status = scan->fs->statat(fs_ctx, dir, name, &file_stat, AT_SYMLINK_NOFOLLOW);
+    }
+
+    if (stats != NULL) {
+        stats->stat_ns += dirwd_prof_now_ns() - stat_start_ns;
+        stats->entries++;
+        stats->errors += (stat_status != 0) ? 1 : 0;
+    }
+
+    if (stat_status != 0) {
+        syslog(LOG_ERR,
+            "Failed to read metadata of file '%s': %s",
+            file_path_buffer,
+            strerror(errno)
+        );
+        return;
+    }
+
+    if (S_ISDIR(file_stat.st_mode)) {
+        if (scan->opts->one_fs && (file_stat.st_dev != scan->root_dev)) {
+            syslog(LOG_DEBUG, "Skipping directory on other filesystem '%s'", file_path_buffer);
+            return;
+        }
+
+        /* If file is directory - queue directory scan */
+        dirwd_scan_subdirs_push(subdirs, file_path_buffer, &file_stat);
+    } else if (action == DIRWD_SCAN_FULL) {
+        /* If file is not directory - insert file entry to the snapshot */
+        fsnap_push(entries, file_path_buffer, &file_stat);
+    }
+}
+
+static void dirwd_scan_listing_push(struct dirwd_scan_listing_t* self, const struct dirwd_fs_dirent_t* dir_entry) {
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? DIRWD_SCAN_LISTING_DEFAULT_CAP : self->cap * 2;
+        self->buffer = (struct dirwd_scan_dirent_t*) realloc(self->buffer,
+            self->cap * sizeof(struct dirwd_scan_dirent_t));
+    }
+
+    const size_t name_len = strlen(dir_entry->name) + 1;
+    if (self->names_len + name_len > self->names_cap) {
+        self->names_cap = (self->names_cap == 0) ? DIRWD_SCAN_LISTING_DEFAULT_CAP * 32 : self->names_cap;
+        while (self->names_len + name_len > self->names_cap) {
+            self->names_cap *= 2;
+        }
+        self->names = (char*) realloc(self->names, self->names_cap);
+    }
+    memcpy(self->names + self->names_len, dir_entry->name, name_len);
+
+    self->buffer[self->len].ino = (ino_t) dir_entry->ino;
+    self->buffer[self->len].name_off = self->names_len;
+    self->len++;
+    self->names_len += name_len;
+}
+
+static int dirwd_scan_dirent_cmp(const void* a, const void* b) {
+    const ino_t a_ino = ((const struct dirwd_scan_dirent_t*) a)->ino;
+    const ino_t b_ino = ((const struct dirwd_scan_dirent_t*) b)->ino;
+
+    return (a_ino > b_ino) - (a_ino < b_ino);
+}
+
+static void dirwd_scan_dir(
+    struct dirwd_scan_t* scan,
+    struct dirwd_scan_worker_t* worker,
+    const char* path,
+    dirwd_scan_action_t action
+)
+{
+    char file_path_buffer[PATH_MAX];
+    size_t path_len = strlen(path);
+    memcpy(file_path_buffer, path, path_len + 1);
+
+    if ((path_len > 0) && (file_path_buffer[path_len - 1] != '/')) {
+        file_path_buffer[path_len++] = '/';
+    }
+
+    struct dirwd_prof_t* const prof = scan->opts->prof;
+    struct dirwd_prof_dir_stats_t dir_stats = { 0, 0, 0, 0 };
+    struct dirwd_prof_dir_stats_t* const stats = (prof != NULL) ? &dir_stats : NULL;
+    const uint64_t start_ns = (prof != NULL) ? dirwd_prof_now_ns() : 0;
+
+    void* const fs_ctx = scan->opts->fs_ctx;
+    void* const dir = scan->fs->opendir(fs_ctx, path);
+
+    if (dir == NULL) {
+        syslog(LOG_ERR, "Failed to open directory '%s': %s", path, strerror(errno));
+
+        if (prof != NULL) {
+            dir_stats.readdir_ns = dirwd_prof_now_ns() - start_ns;
+            dir_stats.errors = 1;
+            pthread_mutex_lock(&scan->lock);
+            dirwd_prof_record(prof, path, &dir_stats);
+            pthread_mutex_unlock(&scan->lock);
+        }
+        return;
+    }
+
+    const bool inode_order = scan->opts->inode_order;
+    struct fsnap_t* const entries = (worker->files != NULL) ? worker->files : worker->entries;
+    struct dirwd_scan_listing_t* listing = &worker->listing;
+    struct dirwd_scan_subdirs_t subdirs = { 0, 0, NULL };
+    struct dirwd_fs_dirent_t dir_entry;
+
+    listing->len = 0;
+    listing->names_len = 0;
+
+    while (scan->fs->readdir(fs_ctx, dir, &dir_entry)) {
+        /* Check if entry is not . or .. directory */
+        const bool is_entry_current_dir = strcmp(dir_entry.name, ".") == 0;
+        const bool is_entry_parent_dir = strcmp(dir_entry.name, "..") == 0;
+        if (is_entry_current_dir || is_entry_parent_dir) {
+            continue;
+        }
+
+        if ((action == DIRWD_SCAN_DESCEND) && !dirwd_scan_is_dir_candidate(scan, dir_entry.type)) {
+            continue;
+        }
+
+        if (inode_order) {
+            dirwd_scan_listing_push(listing, &dir_entry);
+        } else {
+            dirwd_scan_entry(scan, entries, dir, file_path_buffer, path_len,
+                dir_entry.name, action, &subdirs, stats);
+        }
+    }
+
+    /* Inode order roughly follows inode table layout on disk */
+    if (inode_order) {
+        qsort(listing->buffer, listing->len, sizeof(struct dirwd_scan_dirent_t), dirwd_scan_dirent_cmp);
+
+        for (size_t i = 0; i < listing->len; i++) {
+            dirwd_scan_entry(scan, entries, dir, file_path_buffer, path_len,
+                listing->names + listing->buffer[i].name_off, action, &subdirs, stats);
+        }
+    }
+
+    scan->fs->closedir(fs_ctx, dir);
+
+    if (prof != NULL) {
+        const uint64_t total_ns = dirwd_prof_now_ns() - start_ns;
+        dir_stats.readdir_ns = (total_ns > dir_stats.stat_ns) ? total_ns - dir_stats.stat_ns : 0;
+    }
+
+    /* Queue is popped from the end, push in reverse to scan subdirectories in inode order */
+    pthread_mutex_lock(&scan->lock);
+    if (prof != NULL) {
+        dirwd_prof_record(prof, path, &dir_stats);
+    }
+    if ((worker->files != NULL) && (action == DIRWD_SCAN_FULL)) {
+        scan->opts->visit(scan->opts->visit_ctx, path, worker->files);
+    }
+
+    for (size_t k = 0; k < subdirs.len; k++) {
+        const struct dirwd_scan_subdir_t* subdir = &subdirs.buffer[inode_order ? subdirs.len - 1 - k : k];
+
+        const uint64_t dev = (uint64_t) subdir->dev;
+        const uint64_t ino = (uint64_t) subdir->ino;
+
+        if (fid_set_insert(scan->visited, dev, ino)) {
+            dirwd_scan_queue_push(scan, subdir->path, dev, ino);
+        } else {
+            syslog(LOG_DEBUG, "Skipping already visited directory '%s'", subdir->path);
+            dirwd_scan_claims_push(&scan->aliases, dev, ino, subdir->path);
+        }
+    }
+    pthread_cond_broadcast(&scan->cond);
+    pthread_mutex_unlock(&scan->lock);
+
+    fsnap_clear(worker->files);
+    free(subdirs.buffer);
+}
+
+static void* dirwd_scan_worker(void* arg) {
+    struct dirwd_scan_worker_t* worker = (struct dirwd_scan_worker_t*) arg;
+    struct dirwd_scan_t* scan = worker->scan;
+
+    pthread_mutex_lock(&scan->lock);
+    while (true) {
+        while ((scan->len == 0) && (scan->pending > 0)) {
+            pthread_cond_wait(&scan->cond, &scan->lock);
+        }
+
+        if (scan->len == 0) {
+            break;
+        }
+
+        const struct dirwd_scan_item_t item = scan->queue[--scan->len];
+        pthread_mutex_unlock(&scan->lock);
+
+        dirwd_scan_dir(scan, worker, item.path, item.action);
+
+        pthread_mutex_lock(&scan->lock);
+        scan->pending--;
+        if (scan->pending == 0) {
+            pthread_cond_broadcast(&scan->cond);
+        }
+    }
+    pthread_mutex_unlock(&scan->lock);
+
+    return NULL;
+}
+
+/* Check if path is strictly below directory dir of dir_len bytes */
+static bool dirwd_scan_is_below(const char* path, const char* dir, size_t dir_len) {
+    if ((dir_len == 0) || (strncmp(path, dir, dir_len) != 0)) {
+        return false;
+    }
+
+    return (dir[dir_len - 1] == '/') ? (path[dir_len] != '\0') : (path[dir_len] == '/');
+}
+
+/* Path with its deepest aliased ancestor replaced by smallest path of that ancestor */
+static char* dirwd_scan_alias_path(const struct dirwd_scan_alias_t* aliases, size_t len, const char* path) {
+    const struct dirwd_scan_alias_t* parent = NULL;
+
+    for (size_t i = 0; i < len; i++) {
+        if (((parent == NULL) || (aliases[i].path_len > parent->path_len))
+            && dirwd_scan_is_below(path, aliases[i].path, aliases[i].path_len)) {
+            parent = &aliases[i];
+        }
+    }
+
+    if (parent == NULL) {
+        return strdup(path);
+    }
+
+    const size_t smallest_len = strlen(parent->smallest);
+    const size_t rest_len = strlen(path + parent->path_len) + 1;
+    char* new_path = (char*) malloc(smallest_len + rest_len);
+    memcpy(new_path, parent->smallest, smallest_len);
+    memcpy(new_path + smallest_len, path + parent->path_len, rest_len);
+    return new_path;
+}
+
+static int dirwd_scan_alias_depth_cmp(const void* a, const void* b) {
+    const size_t a_len = ((const struct dirwd_scan_alias_t*) a)->path_len;
+    const size_t b_len = ((const struct dirwd_scan_alias_t*) b)->path_len;
+
+    return (a_len < b_len) - (a_len > b_len);
+}
+
+/* Move files of directories reached by several paths below their smallest path */
+static void dirwd_scan_resolve_aliases(struct dirwd_scan_t* scan, struct fsnap_t* entries) {
+    struct dirwd_scan_claims_t* const claims = &scan->claims;
+    struct dirwd_scan_claims_t* const others = &scan->aliases;
+
+    if ((others->len == 0) || (scan->opts->visit != NULL)) {
+        return;
+    }
+
+    qsort(claims->buffer, claims->len, sizeof(struct dirwd_scan_claim_t), dirwd_scan_claim_cmp);
+    qsort(others->buffer, others->len, sizeof(struct dirwd_scan_claim_t), dirwd_scan_claim_cmp);
+
+    /* Paths of aliased directories skipped by filter are not claimed and need nothing */
+    struct dirwd_scan_alias_t* aliases =
+        (struct dirwd_scan_alias_t*) malloc(others->len * sizeof(struct dirwd_scan_alias_t));
+    size_t len = 0;
+
+    for (size_t first = 0, last = 0; first < others->len; first = last) {
+        while ((last < others->len) && (dirwd_scan_claim_cmp(&others->buffer[first], &others->buffer[last]) == 0)) {
+            last++;
+        }
+
+        const struct dirwd_scan_claim_t* claim = (const struct dirwd_scan_claim_t*) bsearch(&others->buffer[first],
+            claims->buffer, claims->len, sizeof(struct dirwd_scan_claim_t), dirwd_scan_claim_cmp);
+        if (claim != NULL) {
+            aliases[len].path = claim->path;
+            aliases[len].path_len = strlen(claim->path);
+            aliases[len].smallest = strdup(claim->path);
+            aliases[len].first = first;
+            aliases[len].last = last;
+            len++;
+        }
+    }
+
+    /* Paths of nested aliased directories depend on the smallest paths of their ancestors, each round
+     * settles at least one more level and any loop only makes the path longer */
+    bool changed = true;
+    for (size_t round = 0; changed && (round <= len); round++) {
+        changed = false;
+
+        for (size_t i = 0; i < len; i++) {
+            for (size_t k = aliases[i].first; k <= aliases[i].last; k++) {
+                const char* path = (k < aliases[i].last) ? others->buffer[k].path : aliases[i].path;
+                char* new_path = dirwd_scan_alias_path(aliases, len, path);
+
+                if (strcmp(new_path, aliases[i].smallest) < 0) {
+                    free(aliases[i].smallest);
+                    aliases[i].smallest = new_path;
+                    changed = true;
+                } else {
+                    free(new_path);
+                }
+            }
+        }
+    }
+
+    /* Deepest directories first, so their files are not moved twice */
+    qsort(aliases, len, sizeof(struct dirwd_scan_alias_t), dirwd_scan_alias_depth_cmp);
+
+    for (size_t i = 0; i < len; i++) {
+        if (strcmp(aliases[i].smallest, aliases[i].path) != 0) {
+            syslog(LOG_DEBUG, "Recording directory '%s' as '%s'", aliases[i].path, aliases[i].smallest);
+            fsnap_rename_dir(entries, aliases[i].path, aliases[i].smallest);
+        }
+        free(aliases[i].smallest);
+    }
+    free(aliases);
+}
+
+void dirwd_scan_tree(struct fsnap_t* entries, const char* root, const struct dirwd_scan_opts_t* opts) {
+    if ((entries == NULL) || (root == NULL) || (opts == NULL)) {
+        return;
+    }
+
+    if (strlen(root) >= PATH_MAX) {
+        syslog(LOG_ERR, "Path is too long: '%s'", root);
+        return;
+    }
+
+    const struct dirwd_fs_ops_t* const fs = (opts->fs != NULL) ? opts->fs : dirwd_fs_posix();
+    struct stat root_stat;
+    if (fs->stat(opts->fs_ctx, root, &root_stat) != 0) {
+        syslog(LOG_ERR, "Failed to read metadata of directory '%s': %s", root, strerror(errno));
+        return;
+    }
+
+    struct dirwd_scan_t scan;
+    scan.opts = opts;
+    scan.fs = fs;
+    scan.visited = fid_set_new();
+    scan.root_dev = root_stat.st_dev;
+    fid_set_insert(scan.visited, (uint64_t) root_stat.st_dev, (uint64_t) root_stat.st_ino);
+    pthread_mutex_init(&scan.lock, NULL);
+    pthread_cond_init(&scan.cond, NULL);
+    scan.cap = DIRWD_SCAN_QUEUE_DEFAULT_CAP;
+    scan.len = 0;
+    scan.queue = (struct dirwd_scan_item_t*) malloc(scan.cap * sizeof(struct dirwd_scan_item_t));
+    scan.pending = 0;
+    memset(&scan.claims, 0, sizeof(struct dirwd_scan_claims_t));
+    memset(&scan.aliases, 0, sizeof(struct dirwd_scan_claims_t));
+    dirwd_scan_queue_push(&scan, strdup(root), (uint64_t) root_stat.st_dev, (uint64_t) root_stat.st_ino);
+
+    if (scan.pending == 0) {
+        /* Whole tree is skipped by filter */
+        free(scan.queue);
+        fid_set_drop(&scan.visited);
+        dirwd_scan_claims_clean(&scan.claims);
+        pthread_cond_destroy(&scan.cond);
+        pthread_mutex_destroy(&scan.lock);
+        return;
+    }
+
+    size_t threads = opts->threads;
+    if (threads == 0) {
+        threads = 1;
+    } else if (threads > DIRWD_SCAN_MAX_THREADS) {
+        threads = DIRWD_SCAN_MAX_THREADS;
+    }
+
+    struct dirwd_scan_worker_t workers[DIRWD_SCAN_MAX_THREADS];
+    size_t workers_started = 1;
+
+    /* Calling thread is the first worker and scans directly into result */
+    workers[0].scan = &scan;
+    workers[0].entries = entries;
+    workers[0].files = (opts->visit != NULL) ? fsnap_new() : NULL;
+    memset(&workers[0].listing, 0, sizeof(struct dirwd_scan_listing_t));
+
+    for (size_t i = 1; i < threads; i++) {
+        workers[i].scan = &scan;
+        workers[i].entries = fsnap_new();
+        workers[i].files = (opts->visit != NULL) ? fsnap_new() : NULL;
+        memset(&workers[i].listing, 0, sizeof(struct dirwd_scan_listing_t));
+
+        if (pthread_create(&workers[i].thread, NULL, dirwd_scan_worker, &workers[i]) != 0) {
+            syslog(LOG_ERR, "Failed to start scan thread: %s", strerror(errno));
+            fsnap_drop(&workers[i].entries);
+            fsnap_drop(&workers[i].files);
+            break;
+        }
+        workers_started++;
+    }
+
+    dirwd_scan_worker(&workers[0]);
+
+    for (size_t i = 1; i < workers_started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        fsnap_append(entries, workers[i].entries);
+        fsnap_drop(&workers[i].entries);
+    }
+
+    for (size_t i = 0; i < workers_started; i++) {
+        free(workers[i].listing.buffer);
+        free(workers[i].listing.names);
+        fsnap_drop(&workers[i].files);
+    }
+
+    dirwd_scan_resolve_aliases(&scan, entries);
+
+    free(scan.queue);
+    fid_set_drop(&scan.visited);
+    dirwd_scan_claims_clean(&scan.claims);
+    dirwd_scan_claims_clean(&scan.aliases);
+    pthread_cond_destroy(&scan.cond);
+    pthread_mutex_destroy(&scan.lock);
+}
+
+size_t dirwd_scan_default_threads() {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (cpus <= 0) {
+        return 1;
+    } else if ((size_t) cpus > DIRWD_SCAN_MAX_THREADS) {
+        return DIRWD_SCAN_MAX_THREADS;
+    }
+
+    return (size_t) cpus;
+}
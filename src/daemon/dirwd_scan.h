@@ -0,0 +1,62 @@
+/**
+ * @file dirwd_scan.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog parallel tree scanner
+ */
+
+#ifndef __DAEMON_DIRWD_SCAN_H__
+#define __DAEMON_DIRWD_SCAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../util/fsnap.h"
+#include "dirwd_prof.h"
+#include "dirwd_fs.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_SCAN_MAX_THREADS    ((size_t) 64)
+#define DIRWD_SCAN_QUEUE_DEFAULT_CAP ((size_t) 256)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Directory scan actions */
+#define DIRWD_SCAN_FULL    ((dirwd_scan_action_t) 0) /* Record files and descend */
+#define DIRWD_SCAN_DESCEND ((dirwd_scan_action_t) 1) /* Only descend into subdirectories */
+#define DIRWD_SCAN_SKIP    ((dirwd_scan_action_t) 2) /* Skip whole subtree */
+
+/* Structures ---------------------------------------------------------------*/
+
+typedef uint8_t dirwd_scan_action_t;
+
+/* Called under scan lock once for every directory before it is scanned */
+typedef dirwd_scan_action_t (*dirwd_scan_filter_t)(void* ctx, const char* path);
+
+/* Called under scan lock once for every fully scanned directory with snapshot of its files,
+ * entries may be moved out of the unsealed snapshot, it is cleared afterwards */
+typedef void (*dirwd_scan_visit_t)(void* ctx, const char* path, struct fsnap_t* files);
+
+struct dirwd_scan_opts_t {
+    size_t threads;
+    bool one_fs;            /* Do not descend into other filesystems */
+    bool follow_symlinks;   /* Follow symlinks or record them as links */
+    bool inode_order;       /* Read whole listing and stat entries in inode order */
+    dirwd_scan_filter_t filter; /* Optional, every directory is scanned fully if NULL */
+    void* filter_ctx;
+    dirwd_scan_visit_t visit; /* Optional, files are passed per directory instead of being recorded */
+    void* visit_ctx;
+    struct dirwd_prof_t* prof; /* Optional, directory timings are recorded if set */
+    const struct dirwd_fs_ops_t* fs; /* Optional, real filesystem if NULL */
+    void* fs_ctx;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Scan directory tree into unsealed snapshot, which stays empty with visit callback */
+void dirwd_scan_tree(struct fsnap_t* entries, const char* root, const struct dirwd_scan_opts_t* opts);
+
+size_t dirwd_scan_default_threads();
+
+#endif /* __DAEMON_DIRWD_SCAN_H__ */
@@ -8,20 +8,89 @@
 #include <string.h>
 #include <assert.h>
 
-#include "../util/fentry.h"
+#include "../util/fsnap.h"
+#include "../util/fsnap_pub.h"
 #include "dirwd_state.h"
 
-dirwd_status_t dirwd_state_set(struct dirwd_state_t* state, const char* target_dir, uint32_t timeout) {
+dirwd_status_t dirwd_state_set(
+    struct dirwd_state_t* state,
+    const char* target_dir,
+    uint32_t timeout,
+    const struct dirwd_scan_opts_t* scan_opts,
+    const struct dirwd_tier_opts_t* tier_opts,
+    const struct dirwd_fan_opts_t* fan_opts,
+    const struct dirwd_output_opts_t* output_opts,
+    const struct dirwd_prof_opts_t* prof_opts,
+    const struct dirwd_ctl_opts_t* ctl_opts,
+    const struct dirwd_chunk_opts_t* chunk_opts,
+    const struct dirwd_fprint_opts_t* fprint_opts,
+    const struct dirwd_query_opts_t* query_opts
+)
+{
     assert(state != NULL);
+    assert(scan_opts != NULL);
+    assert(tier_opts != NULL);
+    assert(fan_opts != NULL);
+    assert(output_opts != NULL);
+    assert(prof_opts != NULL);
+    assert(ctl_opts != NULL);
+    assert(chunk_opts != NULL);
+    assert(fprint_opts != NULL);
+    assert(query_opts != NULL);
 
     if ((target_dir == NULL) || (strlen(target_dir) == 0)) {
         return DIRWD_INVALID_CONFIG_TARGET_DIR;
     }
 
+    const dirwd_status_t status = dirwd_output_open(&state->output, output_opts);
+    if (status != DIRWD_SUCCESS) {
+        return status;
+    }
+
+    /* Start watching before the first scan, so no change is missed */
+    state->fan = NULL;
+    if (fan_opts->enabled) {
+        state->fan = dirwd_fan_open(target_dir, fan_opts);
+        if (state->fan == NULL) {
+            dirwd_output_close(&state->output);
+            return DIRWD_FAILED_TO_WATCH_TARGET_DIR;
+        }
+    }
+
+    state->ctl = NULL;
+    if (ctl_opts->socket_path[0] != '\0') {
+        state->ctl = dirwd_ctl_open(target_dir, ctl_opts);
+        if (state->ctl == NULL) {
+            dirwd_fan_close(&state->fan);
+            dirwd_output_close(&state->output);
+            return DIRWD_FAILED_TO_OPEN_CONTROL;
+        }
+    }
+
+    /* Queries are answered from the first published snapshot on */
+    state->pub = fsnap_pub_new();
+    state->query = NULL;
+    if (query_opts->socket_path[0] != '\0') {
+        state->query = dirwd_query_open(state->pub, query_opts);
+        if (state->query == NULL) {
+            fsnap_pub_drop(&state->pub);
+            dirwd_ctl_close(&state->ctl);
+            dirwd_fan_close(&state->fan);
+            dirwd_output_close(&state->output);
+            return DIRWD_FAILED_TO_OPEN_QUERY;
+        }
+    }
+
     state->target_dir = (char*) malloc((strlen(target_dir) + 1) * sizeof(char));
     strcpy(state->target_dir, target_dir);
-    state->entries = fentry_set_new();
+    state->entries = fsnap_new();
     state->timeout_sec = timeout;
+    state->scan_opts = *scan_opts;
+    state->tiers = tier_opts->enabled ? dirwd_tier_new(tier_opts) : NULL;
+    state->prof = prof_opts->enabled ? dirwd_prof_new(prof_opts) : NULL;
+    state->scan_opts.prof = state->prof;
+    state->chunks = chunk_opts->enabled ? dirwd_chunk_new(chunk_opts) : NULL;
+    state->fprint = fprint_opts->enabled ? dirwd_fprint_new(fprint_opts) : NULL;
 
     return DIRWD_SUCCESS;
 }
@@ -29,8 +98,24 @@ dirwd_status_t dirwd_state_set(struct dirwd_state_t* state, const char* target_d
 dirwd_status_t dirwd_state_clean(struct dirwd_state_t* state) {
     assert(state != NULL);
 
+    /* Query thread is the only reader, it stops before snapshots are freed */
+    dirwd_query_close(&state->query);
+    if ((state->pub == NULL) || (fsnap_pub_latest(state->pub) == NULL)) {
+        fsnap_drop(&state->entries);
+    }
+    state->entries = NULL;
+    fsnap_pub_drop(&state->pub);
+
     free(state->target_dir);
-    fentry_set_drop(&state->entries);
+    state->target_dir = NULL;
+    dirwd_tier_drop(&state->tiers);
+    dirwd_fan_close(&state->fan);
+    dirwd_prof_drop(&state->prof);
+    state->scan_opts.prof = NULL;
+    dirwd_ctl_close(&state->ctl);
+    dirwd_chunk_drop(&state->chunks);
+    dirwd_fprint_drop(&state->fprint);
+    dirwd_output_close(&state->output);
 
     return DIRWD_SUCCESS;
 }
\ No newline at end of file
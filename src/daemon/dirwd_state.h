@@ -12,7 +12,17 @@
 #include <sys/stat.h>
 
 #include "dirwd_status.h"
-#include "../util/fentry.h"
+#include "../util/fsnap.h"
+#include "../util/fsnap_pub.h"
+#include "dirwd_scan.h"
+#include "dirwd_tier.h"
+#include "dirwd_fan.h"
+#include "dirwd_output.h"
+#include "dirwd_prof.h"
+#include "dirwd_ctl.h"
+#include "dirwd_chunk.h"
+#include "dirwd_fprint.h"
+#include "dirwd_query.h"
 
 /* Define -------------------------------------------------------------------*/
 
@@ -22,14 +32,39 @@
 
 struct dirwd_state_t {
     char* target_dir;
-    struct fentry_set_t* entries;
+    struct fsnap_t* entries;    /* Baseline of next inspection, owned by pub once published */
+    struct fsnap_pub_t* pub;    /* Snapshots published for readers on other threads */
+    struct dirwd_query_t* query; /* NULL without query socket */
     uint16_t timeout_sec;
+    struct dirwd_scan_opts_t scan_opts;
+    struct dirwd_tier_t* tiers; /* NULL if every inspection scans whole tree */
+    struct dirwd_fan_t* fan;    /* NULL if changes are found by scanning only */
+    struct dirwd_output_t output;
+    struct dirwd_prof_t* prof;  /* NULL if scans are not profiled */
+    struct dirwd_ctl_t* ctl;    /* NULL without control socket */
+    struct dirwd_chunk_t* chunks; /* NULL if changed ranges are not tracked */
+    struct dirwd_fprint_t* fprint; /* NULL if snapshot of all files is kept */
 };
 
 /* Function definitions -----------------------------------------------------*/
 
-dirwd_status_t dirwd_state_set(struct dirwd_state_t* state, const char* target_dir, uint32_t timeout);
+/* Set up empty state, nothing is left open on failure */
+dirwd_status_t dirwd_state_set(
+    struct dirwd_state_t* state,
+    const char* target_dir,
+    uint32_t timeout,
+    const struct dirwd_scan_opts_t* scan_opts,
+    const struct dirwd_tier_opts_t* tier_opts,
+    const struct dirwd_fan_opts_t* fan_opts,
+    const struct dirwd_output_opts_t* output_opts,
+    const struct dirwd_prof_opts_t* prof_opts,
+    const struct dirwd_ctl_opts_t* ctl_opts,
+    const struct dirwd_chunk_opts_t* chunk_opts,
+    const struct dirwd_fprint_opts_t* fprint_opts,
+    const struct dirwd_query_opts_t* query_opts
+);
 
+/* Release state, freed pointers are set to NULL */
 dirwd_status_t dirwd_state_clean(struct dirwd_state_t* state);
 
 #endif /* __DAEMON_DIRWD_STATE_H__ */
\ No newline at end of file
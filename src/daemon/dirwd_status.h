@@ -21,8 +21,15 @@ typedef uint8_t dirwd_status_t;
 #define DIRWD_INVALID_CONFIG_TIMEOUT    ((dirwd_status_t) 14)
 #define DIRWD_INVALID_CONFIG_TARGET_DIR ((dirwd_status_t) 15)
 #define DIRWD_TARGET_NOT_DIR            ((dirwd_status_t) 16)
+#define DIRWD_INVALID_CONFIG_OPTION     ((dirwd_status_t) 17)
 
 #define DIRWD_FAILED_TO_OPEN_TARGET_DIR ((dirwd_status_t) 20)
 #define DIRWD_FAILED_TO_READ_TARGET_DIR ((dirwd_status_t) 21)
+#define DIRWD_FAILED_TO_WATCH_TARGET_DIR ((dirwd_status_t) 22)
+
+#define DIRWD_FAILED_TO_OPEN_RING       ((dirwd_status_t) 30)
+#define DIRWD_FAILED_TO_OPEN_JOURNAL    ((dirwd_status_t) 31)
+#define DIRWD_FAILED_TO_OPEN_CONTROL    ((dirwd_status_t) 32)
+#define DIRWD_FAILED_TO_OPEN_QUERY      ((dirwd_status_t) 33)
 
 #endif /* __DIRWD_STATUS_H__ */
\ No newline at end of file
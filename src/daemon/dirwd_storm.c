@@ -0,0 +1,154 @@
+/**
+ * @file dirwd_storm.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog event storm aggregation
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dirwd_storm.h"
+
+static int dirwd_storm_event_cmp(const void* a, const void* b) {
+    return strcmp(((const struct dirwd_storm_event_t*) a)->path, ((const struct dirwd_storm_event_t*) b)->path);
+}
+
+static size_t dirwd_storm_add_root(struct dirwd_storm_t* self, const char* dir, size_t dir_len) {
+    if (self->roots_len == self->roots_cap) {
+        self->roots_cap = (self->roots_cap == 0) ? DIRWD_STORM_DEFAULT_CAP : self->roots_cap * 2;
+        self->roots = (struct dirwd_storm_root_t*) realloc(self->roots,
+            self->roots_cap * sizeof(struct dirwd_storm_root_t));
+    }
+
+    struct dirwd_storm_root_t* root = &self->roots[self->roots_len];
+    root->dir = dir;
+    root->dir_len = dir_len;
+    root->count = 0;
+    root->bytes = 0;
+
+    return self->roots_len++;
+}
+
+/* Assign events [lo, hi) not assigned yet to new root */
+static void dirwd_storm_assign(
+    struct dirwd_storm_t* self,
+    const struct fsnap_t* snap,
+    size_t lo,
+    size_t hi,
+    size_t prefix_len
+)
+{
+    const size_t dir_len = (prefix_len > 0) ? prefix_len - 1 : 0;
+    const size_t root_idx = dirwd_storm_add_root(self, self->events[lo].path, dir_len);
+    struct dirwd_storm_root_t* root = &self->roots[root_idx];
+
+    for (size_t i = lo; i < hi; i++) {
+        struct dirwd_storm_event_t* event = &self->events[i];
+
+        if (event->root == DIRWD_STORM_NONE) {
+            event->root = root_idx;
+            root->count++;
+            root->bytes += snap->size[fsnap_primary(snap, event->idx)];
+        }
+    }
+}
+
+/* Events [lo, hi) are below directory with path of prefix_len bytes including trailing '/' */
+static void dirwd_storm_split(
+    struct dirwd_storm_t* self,
+    const struct fsnap_t* snap,
+    size_t lo,
+    size_t hi,
+    size_t prefix_len,
+    size_t threshold
+)
+{
+    if (hi - lo < threshold) {
+        return;
+    }
+
+    bool has_storm_subdir = false;
+    size_t i = lo;
+
+    while (i < hi) {
+        const char* path = self->events[i].path;
+        const char* p_slash = strchr(path + prefix_len, '/');
+
+        if (p_slash == NULL) {
+            i++;
+            continue;
+        }
+
+        /* Events below one subdirectory are contiguous */
+        const size_t sub_len = (size_t) (p_slash - path) + 1;
+        size_t j = i + 1;
+        while ((j < hi) && (strncmp(self->events[j].path, path, sub_len) == 0)) {
+            j++;
+        }
+
+        if (j - i >= threshold) {
+            has_storm_subdir = true;
+            dirwd_storm_split(self, snap, i, j, sub_len, threshold);
+        }
+
+        i = j;
+    }
+
+    if (!has_storm_subdir) {
+        dirwd_storm_assign(self, snap, lo, hi, prefix_len);
+        return;
+    }
+
+    /* Rest of the directory events */
+    size_t rest = 0;
+    size_t rest_lo = hi;
+    for (size_t k = lo; k < hi; k++) {
+        if (self->events[k].root == DIRWD_STORM_NONE) {
+            rest_lo = (rest == 0) ? k : rest_lo;
+            rest++;
+        }
+    }
+
+    if (rest >= threshold) {
+        dirwd_storm_assign(self, snap, rest_lo, hi, prefix_len);
+    }
+}
+
+void dirwd_storm_find(
+    struct dirwd_storm_t* self,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries,
+    size_t threshold
+)
+{
+    self->len = entries->len;
+    self->events = (struct dirwd_storm_event_t*) malloc((entries->len + 1) * sizeof(struct dirwd_storm_event_t));
+    self->roots_cap = 0;
+    self->roots_len = 0;
+    self->roots = NULL;
+
+    for (size_t i = 0; i < entries->len; i++) {
+        self->events[i].path = fsnap_path(snap, entries->buffer[i]);
+        self->events[i].idx = entries->buffer[i];
+        self->events[i].root = DIRWD_STORM_NONE;
+    }
+
+    if ((threshold == 0) || (entries->len < threshold)) {
+        return;
+    }
+
+    qsort(self->events, self->len, sizeof(struct dirwd_storm_event_t), dirwd_storm_event_cmp);
+    dirwd_storm_split(self, snap, 0, self->len, 0, threshold);
+}
+
+void dirwd_storm_clean(struct dirwd_storm_t* self) {
+    free(self->events);
+    free(self->roots);
+    self->events = NULL;
+    self->roots = NULL;
+    self->len = 0;
+    self->roots_len = 0;
+    self->roots_cap = 0;
+}
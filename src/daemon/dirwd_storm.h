@@ -0,0 +1,68 @@
+/**
+ * @file dirwd_storm.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog event storm aggregation
+ *
+ * Events of one type are sorted by path, so events below any directory
+ * form a contiguous range. Directory with at least threshold events below
+ * it and no subdirectory reaching the threshold is a storm root and all
+ * its events are summarized. If some subdirectories reach the threshold
+ * they are split recursively, the rest of the directory events form
+ * another root only if they reach the threshold themselves. Everything
+ * else is reported one event at a time.
+ */
+
+#ifndef __DAEMON_DIRWD_STORM_H__
+#define __DAEMON_DIRWD_STORM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../util/fsnap.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_STORM_NONE ((size_t) -1)
+
+#define DIRWD_STORM_MAX_THRESHOLD ((size_t) 1000000000)
+#define DIRWD_STORM_DEFAULT_CAP   ((size_t) 16)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_storm_event_t {
+    const char* path;
+    size_t idx;  /* Snapshot entry */
+    size_t root; /* Storm root index, DIRWD_STORM_NONE if reported alone */
+};
+
+struct dirwd_storm_root_t {
+    const char* dir; /* Points into path of one of its events */
+    size_t dir_len;  /* Without trailing '/', zero for "/" */
+    size_t count;
+    int64_t bytes;
+};
+
+struct dirwd_storm_t {
+    size_t len;
+    struct dirwd_storm_event_t* events; /* Sorted by path */
+
+    size_t roots_cap;
+    size_t roots_len;
+    struct dirwd_storm_root_t* roots;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Group entries of snapshot into storm roots, threshold must be positive */
+void dirwd_storm_find(
+    struct dirwd_storm_t* self,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries,
+    size_t threshold
+);
+
+void dirwd_storm_clean(struct dirwd_storm_t* self);
+
+#endif /* __DAEMON_DIRWD_STORM_H__ */
@@ -0,0 +1,296 @@
+/**
+ * @file dirwd_tier.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog adaptive scan frequency tiers
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/syslog.h>
+
+#include "dirwd_tier.h"
+
+static struct dirwd_tier_dir_t* dirwd_tier_find(const struct dirwd_tier_t* self, uint64_t hash) {
+    return (struct dirwd_tier_dir_t*) dir_table_find(&self->dirs, hash);
+}
+
+/* Hash of directory containing path of length len */
+static bool dirwd_tier_parent_hash(const char* path, size_t len, uint64_t* hash) {
+    while ((len > 0) && (path[len - 1] != '/')) {
+        len--;
+    }
+
+    if (len == 0) {
+        return false;
+    }
+
+    *hash = fsnap_hash_update(FSNAP_HASH_INIT, path, len - 1);
+    return true;
+}
+
+static size_t dirwd_tier_interval(const struct dirwd_tier_t* self, uint8_t tier) {
+    switch (tier) {
+    case DIRWD_TIER_HOT:
+        return 1;
+    case DIRWD_TIER_WARM:
+        return self->opts.warm_ticks;
+    default:
+        return self->opts.cold_ticks;
+    }
+}
+
+struct dirwd_tier_t* dirwd_tier_new(const struct dirwd_tier_opts_t* opts) {
+    if (opts == NULL) {
+        return NULL;
+    }
+
+    struct dirwd_tier_t* new_tier = (struct dirwd_tier_t*) calloc(1, sizeof(struct dirwd_tier_t));
+    new_tier->opts = *opts;
+    dir_table_init(&new_tier->dirs, sizeof(struct dirwd_tier_dir_t), DIRWD_TIER_DEFAULT_CAP);
+
+    return new_tier;
+}
+
+void dirwd_tier_drop(struct dirwd_tier_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    dir_table_clean(&(*self)->dirs);
+    free(*self);
+    *self = NULL;
+}
+
+void dirwd_tier_begin(struct dirwd_tier_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    self->tick++;
+    self->dirs_full = 0;
+    self->dirs_descend = 0;
+    self->dirs_skip = 0;
+    self->entries_carried = 0;
+}
+
+dirwd_scan_action_t dirwd_tier_filter(void* ctx, const char* path) {
+    struct dirwd_tier_t* self = (struct dirwd_tier_t*) ctx;
+    const size_t len = dir_table_trim(path, strlen(path));
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, path, len);
+
+    dirwd_scan_action_t action = DIRWD_SCAN_FULL;
+    struct dirwd_tier_dir_t* dir = dirwd_tier_find(self, hash);
+
+    if (dir == NULL) {
+        /* New directories start hot */
+        dir = (struct dirwd_tier_dir_t*) dir_table_insert(&self->dirs, hash);
+        dir->tier = DIRWD_TIER_HOT;
+        if (!dirwd_tier_parent_hash(path, len, &dir->parent_hash)) {
+            dir->parent_hash = hash;
+        }
+    } else if (dir->due_tick > self->tick) {
+        action = (dir->subtree_due_tick > self->tick) ? DIRWD_SCAN_SKIP : DIRWD_SCAN_DESCEND;
+    }
+
+    dir->seen_tick = self->tick;
+    dir->action = action;
+
+    if (action == DIRWD_SCAN_FULL) {
+        self->dirs_full++;
+    } else if (action == DIRWD_SCAN_DESCEND) {
+        self->dirs_descend++;
+    } else {
+        self->dirs_skip++;
+    }
+
+    return action;
+}
+
+/* Entry is carried if its directory was descended only or any ancestor was skipped */
+static bool dirwd_tier_is_carried(const struct dirwd_tier_t* self, const char* path) {
+    const char* p_last = strrchr(path, '/');
+    const char* p_prev = path;
+    uint64_t hash = FSNAP_HASH_INIT;
+
+    for (const char* p = strchr(path, '/'); p != NULL; p = strchr(p + 1, '/')) {
+        hash = fsnap_hash_update(hash, p_prev, (size_t) (p - p_prev));
+        p_prev = p;
+
+        const struct dirwd_tier_dir_t* dir = dirwd_tier_find(self, hash);
+        if ((dir == NULL) || (dir->seen_tick != self->tick)) {
+            continue;
+        }
+
+        if (dir->action == DIRWD_SCAN_SKIP) {
+            return true;
+        } else if (p == p_last) {
+            return dir->action == DIRWD_SCAN_DESCEND;
+        }
+    }
+
+    return false;
+}
+
+void dirwd_tier_carry(struct dirwd_tier_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap) {
+    if ((self == NULL) || (old_snap == NULL) || (new_snap == NULL)) {
+        return;
+    }
+
+    if (self->dirs_descend + self->dirs_skip == 0) {
+        return;
+    }
+
+    const size_t old_len = fsnap_len(old_snap);
+    for (size_t i = 0; i < old_len; i++) {
+        if (dirwd_tier_is_carried(self, fsnap_path(old_snap, i))) {
+            fsnap_push_copy(new_snap, old_snap, i);
+            self->entries_carried++;
+        }
+    }
+}
+
+static void dirwd_tier_mark_changed(struct dirwd_tier_t* self, const char* path) {
+    uint64_t hash = 0;
+    if (!dirwd_tier_parent_hash(path, strlen(path), &hash)) {
+        return;
+    }
+
+    struct dirwd_tier_dir_t* dir = dirwd_tier_find(self, hash);
+    if (dir != NULL) {
+        dir->changed_tick = self->tick;
+    }
+}
+
+static void dirwd_tier_mark_events(
+    struct dirwd_tier_t* self,
+    const struct fsnap_t* snap,
+    const struct fsnap_idx_vec_t* entries
+)
+{
+    for (size_t i = 0; i < entries->len; i++) {
+        dirwd_tier_mark_changed(self, fsnap_path(snap, entries->buffer[i]));
+    }
+}
+
+/*
+ * Directory which was not reached is kept only if it is inside skipped
+ * subtree, otherwise its parent was read and the directory is gone.
+ */
+static bool dirwd_tier_is_alive(const void* ctx, const void* elem) {
+    const struct dirwd_tier_t* self = (const struct dirwd_tier_t*) ctx;
+    const struct dirwd_tier_dir_t* dir = (const struct dirwd_tier_dir_t*) elem;
+
+    for (size_t depth = 0; depth < PATH_MAX; depth++) {
+        if (dir->seen_tick == self->tick) {
+            return (depth == 0) || (dir->action == DIRWD_SCAN_SKIP);
+        }
+
+        if (dir->parent_hash == dir->key.hash) {
+            return false;
+        }
+
+        dir = dirwd_tier_find(self, dir->parent_hash);
+        if (dir == NULL) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void dirwd_tier_update(
+    struct dirwd_tier_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+)
+{
+    if ((self == NULL) || (old_snap == NULL) || (new_snap == NULL) || (diff == NULL)) {
+        return;
+    }
+
+    dirwd_tier_mark_events(self, new_snap, &diff->new_entries);
+    dirwd_tier_mark_events(self, old_snap, &diff->deleted_entries);
+    dirwd_tier_mark_events(self, new_snap, &diff->modified_entries);
+
+    /* Reschedule directories which were scanned */
+    for (size_t i = 0; i < self->dirs.cap; i++) {
+        struct dirwd_tier_dir_t* dir = (struct dirwd_tier_dir_t*) dir_table_at(&self->dirs, i);
+        if ((dir == NULL) || (dir->seen_tick != self->tick) || (dir->action != DIRWD_SCAN_FULL)) {
+            continue;
+        }
+
+        if (dir->changed_tick == self->tick) {
+            dir->tier = DIRWD_TIER_HOT;
+            dir->quiet_scans = 0;
+        } else if (++dir->quiet_scans >= DIRWD_TIER_DEMOTE_SCANS) {
+            if (dir->tier < DIRWD_TIER_COLD) {
+                dir->tier++;
+            }
+            dir->quiet_scans = 0;
+        }
+
+        dir->due_tick = self->tick + dirwd_tier_interval(self, dir->tier);
+    }
+
+    dir_table_rebuild(&self->dirs, self->dirs.cap, dirwd_tier_is_alive, self);
+
+    /* Propagate earliest due tick to ancestors */
+    for (size_t i = 0; i < self->dirs.cap; i++) {
+        struct dirwd_tier_dir_t* dir = (struct dirwd_tier_dir_t*) dir_table_at(&self->dirs, i);
+        if (dir != NULL) {
+            dir->subtree_due_tick = dir->due_tick;
+        }
+    }
+
+    size_t tier_len[3] = { 0, 0, 0 };
+
+    for (size_t i = 0; i < self->dirs.cap; i++) {
+        const struct dirwd_tier_dir_t* dir = (const struct dirwd_tier_dir_t*) dir_table_at(&self->dirs, i);
+        if (dir == NULL) {
+            continue;
+        }
+
+        tier_len[dir->tier]++;
+
+        const uint64_t due_tick = dir->due_tick;
+        struct dirwd_tier_dir_t* parent = dirwd_tier_find(self, dir->parent_hash);
+
+        while ((parent != NULL) && (parent->subtree_due_tick > due_tick)) {
+            parent->subtree_due_tick = due_tick;
+            parent = dirwd_tier_find(self, parent->parent_hash);
+        }
+    }
+
+    syslog(LOG_DEBUG,
+        "Scan tiers: %zu hot, %zu warm, %zu cold directories; "
+        "%zu scanned, %zu descended, %zu skipped, %zu entries carried over",
+        tier_len[DIRWD_TIER_HOT],
+        tier_len[DIRWD_TIER_WARM],
+        tier_len[DIRWD_TIER_COLD],
+        self->dirs_full,
+        self->dirs_descend,
+        self->dirs_skip,
+        self->entries_carried
+    );
+}
+
+bool dirwd_tier_get(const struct dirwd_tier_t* self, const char* path, uint8_t* tier) {
+    if ((self == NULL) || (path == NULL) || (tier == NULL)) {
+        return false;
+    }
+
+    const size_t len = dir_table_trim(path, strlen(path));
+    const struct dirwd_tier_dir_t* dir = dirwd_tier_find(self, fsnap_hash_update(FSNAP_HASH_INIT, path, len));
+
+    if (dir == NULL) {
+        return false;
+    }
+
+    *tier = dir->tier;
+    return true;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file dirwd_tier.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog adaptive scan frequency tiers
+ *
+ * Every directory is assigned to hot, warm or cold tier by its change
+ * history. Hot directories are scanned on every inspection, warm and cold
+ * ones every warm_ticks and cold_ticks inspections. Directory is promoted
+ * to hot tier on any observed change and demoted one tier after
+ * DIRWD_TIER_DEMOTE_SCANS quiet scans. Subtrees with nothing due are not
+ * read at all, their entries are carried over from the previous snapshot.
+ */
+
+#ifndef __DAEMON_DIRWD_TIER_H__
+#define __DAEMON_DIRWD_TIER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../util/dir_table.h"
+#include "../util/fsnap.h"
+#include "dirwd_scan.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_TIER_HOT  ((uint8_t) 0)
+#define DIRWD_TIER_WARM ((uint8_t) 1)
+#define DIRWD_TIER_COLD ((uint8_t) 2)
+
+#define DIRWD_TIER_DEMOTE_SCANS       ((uint32_t) 4)
+#define DIRWD_TIER_WARM_TICKS_DEFAULT ((size_t) 8)
+#define DIRWD_TIER_COLD_TICKS_DEFAULT ((size_t) 64)
+#define DIRWD_TIER_MAX_TICKS          ((size_t) 65536)
+#define DIRWD_TIER_DEFAULT_CAP        ((size_t) 256)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_tier_opts_t {
+    bool enabled;
+    size_t warm_ticks;
+    size_t cold_ticks;
+};
+
+struct dirwd_tier_dir_t {
+    struct dir_key_t key;
+    uint64_t parent_hash;
+    uint64_t seen_tick;         /* Last inspection directory was reached */
+    uint64_t changed_tick;      /* Last inspection change was observed */
+    uint64_t due_tick;          /* Next inspection files must be scanned */
+    uint64_t subtree_due_tick;  /* Earliest due tick in subtree */
+    uint32_t quiet_scans;
+    uint8_t tier;
+    dirwd_scan_action_t action; /* Action taken at seen_tick */
+};
+
+struct dirwd_tier_t {
+    struct dirwd_tier_opts_t opts;
+    uint64_t tick;
+
+    struct dir_table_t dirs; /* Known directories */
+
+    /* Current inspection statistics */
+    size_t dirs_full;
+    size_t dirs_descend;
+    size_t dirs_skip;
+    size_t entries_carried;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct dirwd_tier_t* dirwd_tier_new(const struct dirwd_tier_opts_t* opts);
+
+void dirwd_tier_drop(struct dirwd_tier_t** self);
+
+/* Start new inspection */
+void dirwd_tier_begin(struct dirwd_tier_t* self);
+
+/* Scan filter, ctx is struct dirwd_tier_t* */
+dirwd_scan_action_t dirwd_tier_filter(void* ctx, const char* path);
+
+/* Copy entries of directories which were not scanned from old to unsealed new snapshot */
+void dirwd_tier_carry(struct dirwd_tier_t* self, const struct fsnap_t* old_snap, struct fsnap_t* new_snap);
+
+/* Learn from inspection changes and schedule next scans */
+void dirwd_tier_update(
+    struct dirwd_tier_t* self,
+    const struct fsnap_t* old_snap,
+    const struct fsnap_t* new_snap,
+    const struct fsnap_diff_t* diff
+);
+
+/* Tier of directory, false if directory is unknown */
+bool dirwd_tier_get(const struct dirwd_tier_t* self, const char* path, uint8_t* tier);
+
+#endif /* __DAEMON_DIRWD_TIER_H__ */
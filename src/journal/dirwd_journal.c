@@ -0,0 +1,574 @@
+/**
+ * @file dirwd_journal.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog sequenced change journal
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "../util/fsnap.h"
+#include "dirwd_journal.h"
+
+#define DIRWD_JOURNAL_SEQ_DIGITS 20
+
+/* Segments ---------------------------------------------------------------- */
+
+static void dirwd_journal_segments_push(struct dirwd_journal_segments_t* self, uint64_t first_seq, size_t bytes) {
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? DIRWD_JOURNAL_SEGMENTS_DEFAULT_CAP : self->cap * 2;
+        self->buffer = (struct dirwd_journal_segment_t*) realloc(self->buffer,
+            self->cap * sizeof(struct dirwd_journal_segment_t));
+    }
+
+    self->buffer[self->len].first_seq = first_seq;
+    self->buffer[self->len].bytes = bytes;
+    self->len++;
+}
+
+static void dirwd_journal_segments_clean(struct dirwd_journal_segments_t* self) {
+    free(self->buffer);
+    memset(self, 0, sizeof(struct dirwd_journal_segments_t));
+}
+
+static int dirwd_journal_segment_cmp(const void* a, const void* b) {
+    const uint64_t a_seq = ((const struct dirwd_journal_segment_t*) a)->first_seq;
+    const uint64_t b_seq = ((const struct dirwd_journal_segment_t*) b)->first_seq;
+
+    return (a_seq > b_seq) - (a_seq < b_seq);
+}
+
+static bool dirwd_journal_file_path(const char* dir, uint64_t first_seq, const char* ext, char* path) {
+    const int len = snprintf(path, PATH_MAX, "%s/%0*" PRIu64 ".%s", dir, DIRWD_JOURNAL_SEQ_DIGITS, first_seq, ext);
+    return (len > 0) && (len < PATH_MAX);
+}
+
+static size_t dirwd_journal_file_size(const char* dir, uint64_t first_seq, const char* ext) {
+    char path[PATH_MAX];
+    struct stat file_stat;
+
+    if (!dirwd_journal_file_path(dir, first_seq, ext, path) || (stat(path, &file_stat) != 0)) {
+        return 0;
+    }
+
+    return (size_t) file_stat.st_size;
+}
+
+/* Parse "<20 digits>.seg" segment file name */
+static bool dirwd_journal_parse_name(const char* name, uint64_t* first_seq) {
+    if ((strlen(name) != DIRWD_JOURNAL_SEQ_DIGITS + 4) || (strcmp(name + DIRWD_JOURNAL_SEQ_DIGITS, ".seg") != 0)) {
+        return false;
+    }
+
+    uint64_t seq = 0;
+    for (size_t i = 0; i < DIRWD_JOURNAL_SEQ_DIGITS; i++) {
+        if ((name[i] < '0') || (name[i] > '9')) {
+            return false;
+        }
+        seq = seq * 10 + (uint64_t) (name[i] - '0');
+    }
+
+    *first_seq = seq;
+    return seq > 0;
+}
+
+static bool dirwd_journal_list(const char* dir, struct dirwd_journal_segments_t* segments) {
+    DIR* const journal_dir = opendir(dir);
+    if (journal_dir == NULL) {
+        return false;
+    }
+
+    struct dirent* dir_entry = NULL;
+    uint64_t first_seq = 0;
+
+    while ((dir_entry = readdir(journal_dir)) != NULL) {
+        if (dirwd_journal_parse_name(dir_entry->d_name, &first_seq)) {
+            dirwd_journal_segments_push(segments,
+                first_seq,
+                dirwd_journal_file_size(dir, first_seq, "seg") + dirwd_journal_file_size(dir, first_seq, "idx")
+            );
+        }
+    }
+
+    closedir(journal_dir);
+
+    if (segments->len > 1) {
+        qsort(segments->buffer, segments->len, sizeof(struct dirwd_journal_segment_t), dirwd_journal_segment_cmp);
+    }
+
+    return true;
+}
+
+/* Records ----------------------------------------------------------------- */
+
+static uint64_t dirwd_journal_check(const struct dirwd_journal_record_t* record, const char* path) {
+    struct dirwd_journal_record_t header = *record;
+    header.check = 0;
+
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, (const char*) &header, sizeof(header));
+    return fsnap_hash_update(hash, path, record->path_len);
+}
+
+/* Read and verify one record, path buffer must hold PATH_MAX bytes */
+static bool dirwd_journal_read_record(FILE* fin, struct dirwd_journal_record_t* record, char* path) {
+    if (fread(record, sizeof(struct dirwd_journal_record_t), 1, fin) != 1) {
+        return false;
+    }
+
+    if ((record->path_len >= PATH_MAX) || (fread(path, 1, record->path_len, fin) != record->path_len)) {
+        return false;
+    }
+    path[record->path_len] = '\0';
+
+    return record->check == dirwd_journal_check(record, path);
+}
+
+static bool dirwd_journal_read_header(FILE* segment, uint64_t first_seq) {
+    struct dirwd_journal_segment_header_t header;
+
+    return (fread(&header, sizeof(header), 1, segment) == 1)
+        && (memcmp(header.magic, DIRWD_JOURNAL_MAGIC, sizeof(header.magic)) == 0)
+        && (header.version == DIRWD_JOURNAL_VERSION)
+        && (header.first_seq == first_seq);
+}
+
+static FILE* dirwd_journal_open_segment(const char* dir, uint64_t first_seq, const char* mode) {
+    char path[PATH_MAX];
+    if (!dirwd_journal_file_path(dir, first_seq, "seg", path)) {
+        return NULL;
+    }
+
+    FILE* const segment = fopen(path, mode);
+    if (segment == NULL) {
+        return NULL;
+    }
+
+    if (!dirwd_journal_read_header(segment, first_seq)) {
+        fclose(segment);
+        return NULL;
+    }
+
+    return segment;
+}
+
+/* Check if segment file can be read, but its header is short or invalid */
+static bool dirwd_journal_is_torn(const char* dir, uint64_t first_seq) {
+    char path[PATH_MAX];
+    if (!dirwd_journal_file_path(dir, first_seq, "seg", path)) {
+        return false;
+    }
+
+    FILE* const segment = fopen(path, "rb");
+    if (segment == NULL) {
+        return false;
+    }
+
+    const bool is_torn = !dirwd_journal_read_header(segment, first_seq);
+    fclose(segment);
+    return is_torn;
+}
+
+/* Writer ------------------------------------------------------------------ */
+
+static bool dirwd_journal_start_segment(struct dirwd_journal_t* self) {
+    char segment_path[PATH_MAX];
+    char index_path[PATH_MAX];
+    struct dirwd_journal_segment_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DIRWD_JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = DIRWD_JOURNAL_VERSION;
+    header.first_seq = self->next_seq;
+
+    if (!dirwd_journal_file_path(self->dir, self->next_seq, "seg", segment_path)
+        || !dirwd_journal_file_path(self->dir, self->next_seq, "idx", index_path))
+    {
+        return false;
+    }
+
+    self->segment = fopen(segment_path, "wb");
+    self->index = fopen(index_path, "wb");
+
+    if ((self->segment == NULL) || (self->index == NULL)
+        || (fwrite(&header, sizeof(header), 1, self->segment) != 1) || (fflush(self->segment) != 0))
+    {
+        /* No half-created segment is left open or on disk, only files created here are removed */
+        if (self->segment != NULL) {
+            fclose(self->segment);
+            unlink(segment_path);
+            self->segment = NULL;
+        }
+        if (self->index != NULL) {
+            fclose(self->index);
+            unlink(index_path);
+            self->index = NULL;
+        }
+        return false;
+    }
+
+    self->segment_len = sizeof(header);
+    self->segment_records = 0;
+    dirwd_journal_segments_push(&self->segments, self->next_seq, sizeof(header));
+
+    return true;
+}
+
+/*
+ * Truncate torn tail of the last segment, rebuild its index and reopen it for appending.
+ * Crash while a segment was started leaves it without complete header, such segment holds
+ * no records: it is removed and the previous segment is recovered instead.
+ */
+static bool dirwd_journal_recover(struct dirwd_journal_t* self) {
+    struct dirwd_journal_segment_t* last = &self->segments.buffer[self->segments.len - 1];
+    FILE* const segment = dirwd_journal_open_segment(self->dir, last->first_seq, "r+b");
+    char path[PATH_MAX];
+
+    if ((segment == NULL) && dirwd_journal_is_torn(self->dir, last->first_seq)) {
+        if (dirwd_journal_file_path(self->dir, last->first_seq, "idx", path)) {
+            unlink(path);
+        }
+        if (!dirwd_journal_file_path(self->dir, last->first_seq, "seg", path) || (unlink(path) != 0)) {
+            return false;
+        }
+
+        /* Sequence numbers continue from the removed segment if no previous one is left */
+        self->next_seq = last->first_seq;
+        self->segments.len--;
+        return (self->segments.len == 0) ? dirwd_journal_start_segment(self) : dirwd_journal_recover(self);
+    } else if (segment == NULL) {
+        return false;
+    }
+
+    if (!dirwd_journal_file_path(self->dir, last->first_seq, "idx", path) || ((self->index = fopen(path, "wb")) == NULL)) {
+        fclose(segment);
+        return false;
+    }
+
+    struct dirwd_journal_record_t record;
+    char* const record_path = (char*) malloc(PATH_MAX);
+    size_t valid_len = sizeof(struct dirwd_journal_segment_header_t);
+    uint64_t records = 0;
+
+    while (dirwd_journal_read_record(segment, &record, record_path) && (record.seq == last->first_seq + records)) {
+        if (records % DIRWD_JOURNAL_INDEX_STRIDE == 0) {
+            const struct dirwd_journal_index_entry_t entry = { .seq = record.seq, .offset = valid_len };
+            fwrite(&entry, sizeof(entry), 1, self->index);
+        }
+
+        valid_len += sizeof(record) + record.path_len;
+        records++;
+    }
+
+    free(record_path);
+
+    const bool is_truncated = (fflush(segment) == 0) && (ftruncate(fileno(segment), (off_t) valid_len) == 0);
+    fclose(segment);
+
+    if (!is_truncated || !dirwd_journal_file_path(self->dir, last->first_seq, "seg", path)
+        || ((self->segment = fopen(path, "ab")) == NULL))
+    {
+        return false;
+    }
+
+    self->segment_len = valid_len;
+    self->segment_records = records;
+    self->next_seq = last->first_seq + records;
+    last->bytes = valid_len + (size_t) ((records + DIRWD_JOURNAL_INDEX_STRIDE - 1) / DIRWD_JOURNAL_INDEX_STRIDE)
+        * sizeof(struct dirwd_journal_index_entry_t);
+
+    return true;
+}
+
+struct dirwd_journal_t* dirwd_journal_open(const char* dir, size_t segment_bytes, size_t retain_bytes) {
+    if ((dir == NULL) || (strlen(dir) >= PATH_MAX - DIRWD_JOURNAL_SEQ_DIGITS - 8)) {
+        return NULL;
+    }
+
+    if ((mkdir(dir, 0755) != 0) && (errno != EEXIST)) {
+        return NULL;
+    }
+
+    struct dirwd_journal_t* journal = (struct dirwd_journal_t*) calloc(1, sizeof(struct dirwd_journal_t));
+    strcpy(journal->dir, dir);
+    journal->segment_bytes = segment_bytes;
+    journal->retain_bytes = retain_bytes;
+    journal->next_seq = 1;
+
+    const bool is_open = dirwd_journal_list(dir, &journal->segments)
+        && ((journal->segments.len == 0) ? dirwd_journal_start_segment(journal) : dirwd_journal_recover(journal));
+
+    if (!is_open) {
+        dirwd_journal_close(&journal);
+        return NULL;
+    }
+
+    return journal;
+}
+
+void dirwd_journal_close(struct dirwd_journal_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    if ((*self)->segment != NULL) {
+        fclose((*self)->segment);
+    }
+    if ((*self)->index != NULL) {
+        fclose((*self)->index);
+    }
+
+    dirwd_journal_segments_clean(&(*self)->segments);
+    free(*self);
+    *self = NULL;
+}
+
+static bool dirwd_journal_sync(struct dirwd_journal_t* self) {
+    /* Index entries must never point past flushed records */
+    return (fflush(self->segment) == 0)
+        && (fdatasync(fileno(self->segment)) == 0)
+        && (fflush(self->index) == 0);
+}
+
+static bool dirwd_journal_roll(struct dirwd_journal_t* self) {
+    const bool is_synced = dirwd_journal_sync(self) && (fdatasync(fileno(self->index)) == 0);
+
+    fclose(self->segment);
+    fclose(self->index);
+    self->segment = NULL;
+    self->index = NULL;
+
+    return is_synced && dirwd_journal_start_segment(self);
+}
+
+uint64_t dirwd_journal_append(struct dirwd_journal_t* self, uint32_t type, const char* path, int64_t size, int64_t mtime_ns) {
+    if ((self == NULL) || (path == NULL)) {
+        return 0;
+    }
+
+    /* Segment could not be started on last roll, try again */
+    if ((self->segment == NULL) && !dirwd_journal_start_segment(self)) {
+        return 0;
+    }
+
+    if ((self->segment_len >= self->segment_bytes) && (self->segment_records > 0) && !dirwd_journal_roll(self)) {
+        return 0;
+    }
+
+    struct dirwd_journal_record_t record;
+    record.path_len = (uint32_t) strnlen(path, PATH_MAX - 1);
+    record.type = type;
+    record.seq = self->next_seq;
+    record.size = size;
+    record.mtime_ns = mtime_ns;
+    record.check = dirwd_journal_check(&record, path);
+
+    if (self->segment_records % DIRWD_JOURNAL_INDEX_STRIDE == 0) {
+        const struct dirwd_journal_index_entry_t entry = { .seq = record.seq, .offset = self->segment_len };
+        if (fwrite(&entry, sizeof(entry), 1, self->index) != 1) {
+            return 0;
+        }
+        self->segments.buffer[self->segments.len - 1].bytes += sizeof(entry);
+    }
+
+    if ((fwrite(&record, sizeof(record), 1, self->segment) != 1)
+        || (fwrite(path, 1, record.path_len, self->segment) != record.path_len))
+    {
+        return 0;
+    }
+
+    const size_t record_len = sizeof(record) + record.path_len;
+    self->segment_len += record_len;
+    self->segment_records++;
+    self->segments.buffer[self->segments.len - 1].bytes += record_len;
+
+    return self->next_seq++;
+}
+
+bool dirwd_journal_commit(struct dirwd_journal_t* self) {
+    if ((self == NULL) || (self->segment == NULL) || !dirwd_journal_sync(self)) {
+        return false;
+    }
+
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < self->segments.len; i++) {
+        total_bytes += self->segments.buffer[i].bytes;
+    }
+
+    /* Remove oldest segments, active segment is always kept */
+    size_t removed = 0;
+    char path[PATH_MAX];
+
+    while ((total_bytes > self->retain_bytes) && (removed + 1 < self->segments.len)) {
+        const struct dirwd_journal_segment_t* oldest = &self->segments.buffer[removed];
+
+        if (dirwd_journal_file_path(self->dir, oldest->first_seq, "seg", path)) {
+            unlink(path);
+        }
+        if (dirwd_journal_file_path(self->dir, oldest->first_seq, "idx", path)) {
+            unlink(path);
+        }
+
+        total_bytes -= oldest->bytes;
+        removed++;
+    }
+
+    if (removed > 0) {
+        self->segments.len -= removed;
+        memmove(self->segments.buffer, self->segments.buffer + removed,
+            self->segments.len * sizeof(struct dirwd_journal_segment_t));
+    }
+
+    return true;
+}
+
+/* Reader ------------------------------------------------------------------ */
+
+/* Offset of the last indexed record with sequence number not greater than seq */
+static long dirwd_journal_index_seek(const char* dir, uint64_t first_seq, uint64_t seq) {
+    char path[PATH_MAX];
+    long offset = (long) sizeof(struct dirwd_journal_segment_header_t);
+
+    if (!dirwd_journal_file_path(dir, first_seq, "idx", path)) {
+        return offset;
+    }
+
+    FILE* const index = fopen(path, "rb");
+    if (index == NULL) {
+        return offset;
+    }
+
+    fseek(index, 0, SEEK_END);
+    const size_t entries_len = (size_t) ftell(index) / sizeof(struct dirwd_journal_index_entry_t);
+    struct dirwd_journal_index_entry_t* entries = (struct dirwd_journal_index_entry_t*) malloc(
+        (entries_len + 1) * sizeof(struct dirwd_journal_index_entry_t));
+
+    fseek(index, 0, SEEK_SET);
+    const size_t read_len = fread(entries, sizeof(struct dirwd_journal_index_entry_t), entries_len, index);
+    fclose(index);
+
+    /* Binary search for the last entry with entry seq <= seq */
+    size_t lo = 0;
+    size_t hi = read_len;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].seq <= seq) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo > 0) {
+        offset = (long) entries[lo - 1].offset;
+    }
+
+    free(entries);
+    return offset;
+}
+
+int dirwd_journal_cursor_open(struct dirwd_journal_cursor_t* self, const char* dir, uint64_t since) {
+    if ((self == NULL) || (dir == NULL) || (strlen(dir) >= PATH_MAX - DIRWD_JOURNAL_SEQ_DIGITS - 8)) {
+        return DIRWD_JOURNAL_ERROR;
+    }
+
+    memset(self, 0, sizeof(struct dirwd_journal_cursor_t));
+    strcpy(self->dir, dir);
+    self->since = since;
+
+    if (!dirwd_journal_list(dir, &self->segments)) {
+        return DIRWD_JOURNAL_ERROR;
+    }
+
+    if (self->segments.len == 0) {
+        return DIRWD_JOURNAL_OK;
+    }
+
+    /* Segment list is kept, so the caller can query the oldest sequence number */
+    if ((since > 0) && (since + 1 < self->segments.buffer[0].first_seq)) {
+        return DIRWD_JOURNAL_GAP;
+    }
+
+    /* Last segment starting at or before the first wanted record */
+    size_t segment_idx = 0;
+    while ((segment_idx + 1 < self->segments.len) && (self->segments.buffer[segment_idx + 1].first_seq <= since + 1)) {
+        segment_idx++;
+    }
+
+    const uint64_t first_seq = self->segments.buffer[segment_idx].first_seq;
+    self->segment_idx = segment_idx;
+    self->segment = dirwd_journal_open_segment(dir, first_seq, "rb");
+
+    if (self->segment == NULL) {
+        dirwd_journal_cursor_close(self);
+        return DIRWD_JOURNAL_ERROR;
+    }
+
+    fseek(self->segment, dirwd_journal_index_seek(dir, first_seq, since + 1), SEEK_SET);
+    return DIRWD_JOURNAL_OK;
+}
+
+void dirwd_journal_cursor_close(struct dirwd_journal_cursor_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    if (self->segment != NULL) {
+        fclose(self->segment);
+        self->segment = NULL;
+    }
+
+    dirwd_journal_segments_clean(&self->segments);
+}
+
+bool dirwd_journal_cursor_next(struct dirwd_journal_cursor_t* self, struct dirwd_journal_event_t* event) {
+    if ((self == NULL) || (event == NULL)) {
+        return false;
+    }
+
+    struct dirwd_journal_record_t record;
+
+    while (self->segment != NULL) {
+        if (dirwd_journal_read_record(self->segment, &record, event->path)) {
+            if (record.seq <= self->since) {
+                continue;
+            }
+
+            event->seq = record.seq;
+            event->type = record.type;
+            event->size = record.size;
+            event->mtime_ns = record.mtime_ns;
+            self->since = record.seq;
+            return true;
+        }
+
+        /* End of segment or torn tail being written, continue with the next segment */
+        fclose(self->segment);
+        self->segment = NULL;
+
+        if (self->segment_idx + 1 < self->segments.len) {
+            self->segment_idx++;
+            self->segment = dirwd_journal_open_segment(self->dir, self->segments.buffer[self->segment_idx].first_seq, "rb");
+        }
+    }
+
+    return false;
+}
+
+uint64_t dirwd_journal_cursor_oldest(const struct dirwd_journal_cursor_t* self) {
+    if ((self == NULL) || (self->segments.len == 0)) {
+        return 0;
+    }
+
+    return self->segments.buffer[0].first_seq;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file dirwd_journal.h
+ * @date 18 Oct 2026
+ * @brief Directory watchdog sequenced change journal
+ *
+ * Journal is a directory of append-only segment files. Every event gets
+ * a sequence number one greater than the previous one, segment file name
+ * is the sequence number of its first record. Each segment has a sparse
+ * index file with offset of every DIRWD_JOURNAL_INDEX_STRIDE-th record,
+ * so reading from sequence N seeks close to N and scans forward. Oldest
+ * segments are removed when journal size exceeds retention limit.
+ *
+ * Records are checksummed, torn tail left by a crash is truncated when
+ * the journal is opened for writing and treated as end by readers.
+ */
+
+#ifndef __JOURNAL_DIRWD_JOURNAL_H__
+#define __JOURNAL_DIRWD_JOURNAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <limits.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define DIRWD_JOURNAL_MAGIC   "DWJSEG01"
+#define DIRWD_JOURNAL_VERSION ((uint32_t) 1)
+
+#define DIRWD_JOURNAL_INDEX_STRIDE ((uint64_t) 64)
+#define DIRWD_JOURNAL_SEGMENT_BYTES_DEFAULT ((size_t) 16 * 1024 * 1024)
+#define DIRWD_JOURNAL_RETAIN_BYTES_DEFAULT  ((size_t) 256 * 1024 * 1024)
+#define DIRWD_JOURNAL_SEGMENTS_DEFAULT_CAP  ((size_t) 16)
+
+/* Cursor results */
+#define DIRWD_JOURNAL_OK    0
+#define DIRWD_JOURNAL_GAP   1 /* Requested records were removed by retention */
+#define DIRWD_JOURNAL_ERROR 2
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct dirwd_journal_segment_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t first_seq;
+};
+
+/* Record header, followed by path_len bytes of path */
+struct dirwd_journal_record_t {
+    uint32_t path_len;
+    uint32_t type;
+    uint64_t seq;
+    int64_t size;
+    int64_t mtime_ns;
+    uint64_t check; /* Hash of header with zero check and path */
+};
+
+struct dirwd_journal_index_entry_t {
+    uint64_t seq;
+    uint64_t offset;
+};
+
+struct dirwd_journal_segment_t {
+    uint64_t first_seq;
+    size_t bytes; /* Segment and index file size */
+};
+
+struct dirwd_journal_segments_t {
+    size_t cap;
+    size_t len;
+    struct dirwd_journal_segment_t* buffer; /* Sorted by first_seq */
+};
+
+struct dirwd_journal_t {
+    char dir[PATH_MAX];
+    size_t segment_bytes;
+    size_t retain_bytes;
+
+    struct dirwd_journal_segments_t segments;
+
+    /* Active segment, both streams are NULL after it failed to start */
+    FILE* segment;
+    FILE* index;
+    size_t segment_len;
+    uint64_t segment_records;
+
+    uint64_t next_seq;
+};
+
+struct dirwd_journal_event_t {
+    uint64_t seq;
+    uint32_t type;
+    int64_t size;
+    int64_t mtime_ns;
+    char path[PATH_MAX];
+};
+
+struct dirwd_journal_cursor_t {
+    char dir[PATH_MAX];
+    struct dirwd_journal_segments_t segments;
+    size_t segment_idx;
+    FILE* segment;
+    uint64_t since;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Open journal for appending, directory is created if missing */
+struct dirwd_journal_t* dirwd_journal_open(const char* dir, size_t segment_bytes, size_t retain_bytes);
+
+void dirwd_journal_close(struct dirwd_journal_t** self);
+
+/* Returns sequence number of appended record, 0 on failure */
+uint64_t dirwd_journal_append(struct dirwd_journal_t* self, uint32_t type, const char* path, int64_t size, int64_t mtime_ns);
+
+/* Make appended records durable and apply retention */
+bool dirwd_journal_commit(struct dirwd_journal_t* self);
+
+/* Position cursor after record with sequence number since, 0 reads from the oldest record.
+ * Cursor must be closed unless DIRWD_JOURNAL_ERROR is returned */
+int dirwd_journal_cursor_open(struct dirwd_journal_cursor_t* self, const char* dir, uint64_t since);
+
+void dirwd_journal_cursor_close(struct dirwd_journal_cursor_t* self);
+
+/* Returns false at end of journal */
+bool dirwd_journal_cursor_next(struct dirwd_journal_cursor_t* self, struct dirwd_journal_event_t* event);
+
+/* Sequence number of the oldest retained record, 0 if journal is empty */
+uint64_t dirwd_journal_cursor_oldest(const struct dirwd_journal_cursor_t* self);
+
+#endif /* __JOURNAL_DIRWD_JOURNAL_H__ */
@@ -17,8 +17,14 @@
 
 #include "config.h"
 #include "daemon/dirwd.h"
+#include "cli/dirwd_cli.h"
+
+int main(int argc, char** argv) {
+	/* Run one-shot foreground command if any */
+	if (argc > 1) {
+		return dirwd_cli_exec(argc, argv);
+	}
 
-int main() {
 	/* Open syslog */
 	openlog(DIRWD_SYSLOG_IDENT, LOG_PID, LOG_USER);
 
@@ -63,6 +69,7 @@ int main() {
 	/* Set signal handlers */
 	signal(SIGTERM, dirwd_sigterm_handler);
 	signal(SIGHUP, dirwd_sighup_handler);
+	signal(SIGUSR1, dirwd_sigusr1_handler);
 	syslog(LOG_DEBUG, "Daemon signal handlers are set");
 
 	syslog(LOG_INFO, "Deamon started successfully");
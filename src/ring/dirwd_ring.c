@@ -0,0 +1,341 @@
+/**
+ * @file dirwd_ring.c
+ * @date 18 Oct 2026
+ * @brief Directory watchdog shared memory event ring
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <limits.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "dirwd_ring.h"
+
+/* Counters are shared between processes, they must not be emulated with locks */
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64-bit atomics must be lock free");
+_Static_assert(sizeof(struct dirwd_ring_header_t) == 128, "Ring header layout");
+_Static_assert(sizeof(struct dirwd_ring_slot_t) == DIRWD_RING_SLOT_SIZE, "Ring slot layout");
+
+static size_t dirwd_ring_map_len(size_t slot_count) {
+    return sizeof(struct dirwd_ring_header_t) + slot_count * sizeof(struct dirwd_ring_slot_t);
+}
+
+static bool dirwd_ring_is_valid(const struct dirwd_ring_header_t* header, size_t file_len) {
+    return (memcmp(header->magic, DIRWD_RING_MAGIC, sizeof(header->magic)) == 0)
+        && (header->version == DIRWD_RING_VERSION)
+        && (header->slot_size == DIRWD_RING_SLOT_SIZE)
+        && (header->slot_count >= DIRWD_RING_MIN_SLOTS)
+        && (header->slot_count <= DIRWD_RING_MAX_SLOTS)
+        && ((header->slot_count & (header->slot_count - 1)) == 0)
+        && (dirwd_ring_map_len(header->slot_count) == file_len);
+}
+
+static uint64_t dirwd_ring_new_instance(uint64_t prev_instance) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    uint64_t instance = ((uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec) ^ ((uint64_t) getpid() << 48);
+    if (instance == prev_instance) {
+        instance++;
+    }
+
+    return instance;
+}
+
+/* Map existing ring, returns true if it can be continued */
+static bool dirwd_ring_reuse(struct dirwd_ring_t* ring, const char* path, size_t slot_count) {
+    const int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if ((fstat(fd, &file_stat) != 0) || ((size_t) file_stat.st_size < sizeof(struct dirwd_ring_header_t))) {
+        close(fd);
+        return false;
+    }
+
+    const size_t map_len = (size_t) file_stat.st_size;
+    void* const map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    ring->fd = fd;
+    ring->map_len = map_len;
+    ring->header = (struct dirwd_ring_header_t*) map;
+    ring->slots = (struct dirwd_ring_slot_t*) ((char*) map + sizeof(struct dirwd_ring_header_t));
+
+    return dirwd_ring_is_valid(ring->header, map_len) && (ring->header->slot_count == slot_count);
+}
+
+static bool dirwd_ring_create(struct dirwd_ring_t* ring, const char* path, size_t slot_count, uint64_t prev_instance) {
+    const size_t map_len = dirwd_ring_map_len(slot_count);
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    if (ftruncate(fd, (off_t) map_len) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* const map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    ring->fd = fd;
+    ring->map_len = map_len;
+    ring->header = (struct dirwd_ring_header_t*) map;
+    ring->slots = (struct dirwd_ring_slot_t*) ((char*) map + sizeof(struct dirwd_ring_header_t));
+    ring->head = 0;
+
+    /* File is not visible to readers yet, slots are zeroed by ftruncate */
+    memcpy(ring->header->magic, DIRWD_RING_MAGIC, sizeof(ring->header->magic));
+    ring->header->version = DIRWD_RING_VERSION;
+    ring->header->slot_size = DIRWD_RING_SLOT_SIZE;
+    ring->header->slot_count = slot_count;
+    ring->header->instance = dirwd_ring_new_instance(prev_instance);
+    atomic_store_explicit(&ring->header->head, 0, memory_order_release);
+
+    return true;
+}
+
+struct dirwd_ring_t* dirwd_ring_open(const char* path, size_t slot_count) {
+    if ((path == NULL) || (slot_count < DIRWD_RING_MIN_SLOTS) || (slot_count > DIRWD_RING_MAX_SLOTS)
+        || ((slot_count & (slot_count - 1)) != 0))
+    {
+        return NULL;
+    }
+
+    struct dirwd_ring_t* ring = (struct dirwd_ring_t*) calloc(1, sizeof(struct dirwd_ring_t));
+    ring->fd = -1;
+
+    /* Continue sequence of existing ring, readers keep their position */
+    if (dirwd_ring_reuse(ring, path, slot_count)) {
+        ring->head = atomic_load_explicit(&ring->header->head, memory_order_acquire);
+        return ring;
+    }
+
+    struct dirwd_ring_t old_ring = *ring;
+    char tmp_path[PATH_MAX];
+
+    const bool is_created = (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) < (int) sizeof(tmp_path))
+        && dirwd_ring_create(ring, tmp_path, slot_count, (old_ring.header != NULL) ? old_ring.header->instance : 0);
+
+    if (is_created && (rename(tmp_path, path) != 0)) {
+        unlink(tmp_path);
+        munmap(ring->header, ring->map_len);
+        close(ring->fd);
+        ring->header = NULL;
+    }
+
+    /* Readers of replaced ring see stale magic and reopen the path */
+    if (old_ring.header != NULL) {
+        if (is_created && (ring->header != NULL) && dirwd_ring_is_valid(old_ring.header, old_ring.map_len)) {
+            memset(old_ring.header->magic, 0, sizeof(old_ring.header->magic));
+        }
+        munmap(old_ring.header, old_ring.map_len);
+    }
+    if (old_ring.fd >= 0) {
+        close(old_ring.fd);
+    }
+
+    if (!is_created || (ring->header == NULL)) {
+        free(ring);
+        return NULL;
+    }
+
+    return ring;
+}
+
+void dirwd_ring_close(struct dirwd_ring_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    munmap((*self)->header, (*self)->map_len);
+    close((*self)->fd);
+    free(*self);
+    *self = NULL;
+}
+
+void dirwd_ring_publish(struct dirwd_ring_t* self, uint32_t type, const char* path, int64_t size, int64_t mtime_ns) {
+    if ((self == NULL) || (path == NULL)) {
+        return;
+    }
+
+    const uint64_t seq = self->head + 1;
+    struct dirwd_ring_slot_t* slot = &self->slots[seq & (self->header->slot_count - 1)];
+
+    atomic_store_explicit(&slot->head.lock, 2 * seq - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    size_t path_len = strlen(path);
+    slot->head.flags = 0;
+    if (path_len > DIRWD_RING_PATH_CAP) {
+        path_len = DIRWD_RING_PATH_CAP;
+        slot->head.flags |= DIRWD_RING_TRUNCATED;
+    }
+
+    slot->head.type = type;
+    slot->head.size = size;
+    slot->head.mtime_ns = mtime_ns;
+    slot->head.path_len = (uint32_t) path_len;
+    memcpy(slot->path, path, path_len);
+
+    atomic_store_explicit(&slot->head.lock, 2 * seq, memory_order_release);
+    atomic_store_explicit(&self->header->head, seq, memory_order_release);
+    self->head = seq;
+}
+
+static uint64_t dirwd_ring_oldest(uint64_t head, uint64_t slot_count) {
+    return (head > slot_count) ? head - slot_count + 1 : 1;
+}
+
+bool dirwd_ring_reader_open(struct dirwd_ring_reader_t* self, const char* path, bool from_oldest) {
+    if ((self == NULL) || (path == NULL)) {
+        return false;
+    }
+
+    memset(self, 0, sizeof(struct dirwd_ring_reader_t));
+    self->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (self->fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if ((fstat(self->fd, &file_stat) != 0) || ((size_t) file_stat.st_size < sizeof(struct dirwd_ring_header_t))) {
+        close(self->fd);
+        return false;
+    }
+
+    self->map_len = (size_t) file_stat.st_size;
+    void* const map = mmap(NULL, self->map_len, PROT_READ, MAP_SHARED, self->fd, 0);
+    if (map == MAP_FAILED) {
+        close(self->fd);
+        return false;
+    }
+
+    self->header = (const struct dirwd_ring_header_t*) map;
+    self->slots = (const struct dirwd_ring_slot_t*) ((const char*) map + sizeof(struct dirwd_ring_header_t));
+
+    if (!dirwd_ring_is_valid(self->header, self->map_len)) {
+        dirwd_ring_reader_close(self);
+        return false;
+    }
+
+    atomic_thread_fence(memory_order_acquire);
+    self->instance = self->header->instance;
+
+    const uint64_t head = atomic_load_explicit(&self->header->head, memory_order_acquire);
+    self->next = from_oldest ? dirwd_ring_oldest(head, self->header->slot_count) : head + 1;
+
+    return true;
+}
+
+void dirwd_ring_reader_close(struct dirwd_ring_reader_t* self) {
+    if ((self == NULL) || (self->header == NULL)) {
+        return;
+    }
+
+    munmap((void*) self->header, self->map_len);
+    close(self->fd);
+    self->header = NULL;
+    self->slots = NULL;
+}
+
+/* Slot holds newer event, skip to the oldest event which is not overwritten yet */
+static int dirwd_ring_overrun(struct dirwd_ring_reader_t* self, uint64_t lock) {
+    const uint64_t slot_seq = (lock + 1) / 2;
+    const uint64_t oldest = dirwd_ring_oldest(slot_seq, self->header->slot_count);
+
+    if (oldest <= self->next) {
+        /* Slot is older than published head, ring is inconsistent */
+        return DIRWD_RING_EMPTY;
+    }
+
+    self->lost += oldest - self->next;
+    self->next = oldest;
+    return DIRWD_RING_OVERRUN;
+}
+
+int dirwd_ring_read(struct dirwd_ring_reader_t* self, struct dirwd_ring_event_t* event) {
+    if ((self == NULL) || (self->header == NULL) || (event == NULL)) {
+        return DIRWD_RING_EMPTY;
+    }
+
+    const uint64_t slot_count = self->header->slot_count;
+
+    if (memcmp(self->header->magic, DIRWD_RING_MAGIC, sizeof(self->header->magic)) != 0) {
+        return DIRWD_RING_STALE;
+    }
+
+    const uint64_t head = atomic_load_explicit(&self->header->head, memory_order_acquire);
+    if (self->next > head) {
+        return DIRWD_RING_EMPTY;
+    }
+
+    const uint64_t oldest = dirwd_ring_oldest(head, slot_count);
+    if (self->next < oldest) {
+        self->lost += oldest - self->next;
+        self->next = oldest;
+        return DIRWD_RING_OVERRUN;
+    }
+
+    const struct dirwd_ring_slot_t* slot = &self->slots[self->next & (slot_count - 1)];
+    const uint64_t lock_before = atomic_load_explicit(&slot->head.lock, memory_order_acquire);
+
+    if (lock_before != 2 * self->next) {
+        return dirwd_ring_overrun(self, lock_before);
+    }
+
+    const uint32_t path_len = slot->head.path_len;
+    event->type = slot->head.type;
+    event->flags = slot->head.flags;
+    event->size = slot->head.size;
+    event->mtime_ns = slot->head.mtime_ns;
+    memcpy(event->path, slot->path, (path_len <= DIRWD_RING_PATH_CAP) ? path_len : DIRWD_RING_PATH_CAP);
+
+    atomic_thread_fence(memory_order_acquire);
+    const uint64_t lock_after = atomic_load_explicit(&slot->head.lock, memory_order_relaxed);
+
+    if (lock_after != lock_before) {
+        return dirwd_ring_overrun(self, lock_after);
+    }
+
+    event->path[(path_len <= DIRWD_RING_PATH_CAP) ? path_len : DIRWD_RING_PATH_CAP] = '\0';
+    event->seq = self->next++;
+
+    return DIRWD_RING_EVENT;
+}
+
+const char* dirwd_ring_type_name(uint32_t type) {
+    switch (type) {
+    case DIRWD_RING_NEW:
+        return "NEW";
+    case DIRWD_RING_DELETED:
+        return "DELETED";
+    case DIRWD_RING_MODIFIED:
+        return "MODIFIED";
+    default:
+        return "UNKNOWN";
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file detail_files.c
+ * @date 18 Oct 2026
+ * @brief Retention of per-inspection detail files in a directory
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "detail_files.h"
+
+/* Detail file found in directory */
+struct detail_files_entry_t {
+    long long sec;
+    long nsec;
+    char* path;
+};
+
+static int detail_files_compare(const void* lhs, const void* rhs) {
+    const struct detail_files_entry_t* lhs_entry = (const struct detail_files_entry_t*) lhs;
+    const struct detail_files_entry_t* rhs_entry = (const struct detail_files_entry_t*) rhs;
+
+    if (lhs_entry->sec != rhs_entry->sec) {
+        return (lhs_entry->sec < rhs_entry->sec) ? -1 : 1;
+    } else if (lhs_entry->nsec != rhs_entry->nsec) {
+        return (lhs_entry->nsec < rhs_entry->nsec) ? -1 : 1;
+    }
+
+    return strcmp(lhs_entry->path, rhs_entry->path);
+}
+
+/* Creation time from '<prefix><sec>-<nsec>.tsv' name */
+static bool detail_files_parse(const char* name, const char* prefix, long long* sec, long* nsec) {
+    const size_t prefix_len = strlen(prefix);
+    int end = -1;
+
+    if ((strncmp(name, prefix, prefix_len) != 0)
+        || (sscanf(name + prefix_len, "%lld-%ld.tsv%n", sec, nsec, &end) != 2))
+    {
+        return false;
+    }
+
+    return (end > 0) && (name[prefix_len + (size_t) end] == '\0');
+}
+
+void detail_files_init(struct detail_files_t* self, const char* dir, const char* prefix, size_t cap) {
+    self->cap = cap;
+    self->len = 0;
+    self->paths = (char**) malloc(cap * sizeof(char*));
+
+    DIR* const detail_dir = opendir(dir);
+    if (detail_dir == NULL) {
+        return;
+    }
+
+    size_t entries_cap = 16;
+    size_t entries_len = 0;
+    struct detail_files_entry_t* entries = (struct detail_files_entry_t*) malloc(
+        entries_cap * sizeof(struct detail_files_entry_t));
+
+    struct dirent* dir_entry = NULL;
+    char path[PATH_MAX];
+    long long sec = 0;
+    long nsec = 0;
+
+    while ((dir_entry = readdir(detail_dir)) != NULL) {
+        if (!detail_files_parse(dir_entry->d_name, prefix, &sec, &nsec)
+            || (snprintf(path, sizeof(path), "%s/%s", dir, dir_entry->d_name) >= (int) sizeof(path)))
+        {
+            continue;
+        }
+
+        if (entries_len == entries_cap) {
+            entries_cap *= 2;
+            entries = (struct detail_files_entry_t*) realloc(entries, entries_cap * sizeof(struct detail_files_entry_t));
+        }
+        entries[entries_len].sec = sec;
+        entries[entries_len].nsec = nsec;
+        entries[entries_len].path = strdup(path);
+        entries_len++;
+    }
+
+    closedir(detail_dir);
+    qsort(entries, entries_len, sizeof(struct detail_files_entry_t), detail_files_compare);
+
+    /* Newest files are listed, older ones removed */
+    const size_t removed = (entries_len > cap) ? entries_len - cap : 0;
+    for (size_t i = 0; i < entries_len; i++) {
+        if (i < removed) {
+            unlink(entries[i].path);
+            free(entries[i].path);
+        } else {
+            self->paths[self->len++] = entries[i].path;
+        }
+    }
+
+    free(entries);
+}
+
+void detail_files_clean(struct detail_files_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < self->len; i++) {
+        free(self->paths[i]);
+    }
+
+    free(self->paths);
+    self->paths = NULL;
+    self->len = 0;
+    self->cap = 0;
+}
+
+void detail_files_push(struct detail_files_t* self, const char* path) {
+    if (self->cap == 0) {
+        return;
+    }
+
+    if (self->len == self->cap) {
+        unlink(self->paths[0]);
+        free(self->paths[0]);
+        memmove(self->paths, self->paths + 1, (self->cap - 1) * sizeof(char*));
+        self->len--;
+    }
+
+    self->paths[self->len++] = strdup(path);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file detail_files.h
+ * @date 18 Oct 2026
+ * @brief Retention of per-inspection detail files in a directory
+ *
+ * Detail files are named '<prefix><sec>-<nsec>.tsv' by their creation
+ * time. Files left by earlier runs are listed when the list is set up, so
+ * the limit holds for the directory and not only for one daemon run.
+ */
+
+#ifndef __UTIL_DETAIL_FILES_H__
+#define __UTIL_DETAIL_FILES_H__
+
+#include <stddef.h>
+
+/* Define -------------------------------------------------------------------*/
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct detail_files_t {
+    size_t cap; /* Files kept */
+    size_t len;
+    char** paths; /* Oldest first */
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* List existing detail files of dir, all but the newest cap ones are removed */
+void detail_files_init(struct detail_files_t* self, const char* dir, const char* prefix, size_t cap);
+
+/* Forget listed files, files are kept on disk */
+void detail_files_clean(struct detail_files_t* self);
+
+/* Add newly created file, oldest file is removed when cap files are listed */
+void detail_files_push(struct detail_files_t* self, const char* path);
+
+#endif /* __UTIL_DETAIL_FILES_H__ */
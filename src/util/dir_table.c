@@ -0,0 +1,113 @@
+/**
+ * @file dir_table.c
+ * @date 18 Oct 2026
+ * @brief Open addressing table of directories keyed by path hash
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dir_table.h"
+
+static size_t dir_table_slot_hash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+static struct dir_key_t* dir_table_key(unsigned char* buffer, size_t elem_size, size_t slot) {
+    return (struct dir_key_t*) (buffer + slot * elem_size);
+}
+
+/* Slot of directory or first free slot of its probe sequence */
+static size_t dir_table_slot(unsigned char* buffer, size_t elem_size, size_t cap, uint64_t hash) {
+    const size_t mask = cap - 1;
+    size_t slot = dir_table_slot_hash(hash) & mask;
+
+    while (dir_table_key(buffer, elem_size, slot)->used && (dir_table_key(buffer, elem_size, slot)->hash != hash)) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void dir_table_init(struct dir_table_t* self, size_t elem_size, size_t cap) {
+    self->elem_size = elem_size;
+    self->cap = cap;
+    self->len = 0;
+    self->buffer = (unsigned char*) calloc(cap, elem_size);
+}
+
+void dir_table_clean(struct dir_table_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    free(self->buffer);
+    self->buffer = NULL;
+    self->cap = 0;
+    self->len = 0;
+}
+
+void* dir_table_at(const struct dir_table_t* self, size_t slot) {
+    struct dir_key_t* key = dir_table_key(self->buffer, self->elem_size, slot);
+    return key->used ? key : NULL;
+}
+
+void* dir_table_find(const struct dir_table_t* self, uint64_t hash) {
+    return dir_table_at(self, dir_table_slot(self->buffer, self->elem_size, self->cap, hash));
+}
+
+void* dir_table_insert(struct dir_table_t* self, uint64_t hash) {
+    /* Keep load factor below 1/2 */
+    if (2 * (self->len + 1) > self->cap) {
+        dir_table_rebuild(self, self->cap * 2, NULL, NULL);
+    }
+
+    struct dir_key_t* key = dir_table_key(self->buffer, self->elem_size,
+        dir_table_slot(self->buffer, self->elem_size, self->cap, hash));
+    if (!key->used) {
+        key->hash = hash;
+        key->used = true;
+        self->len++;
+    }
+
+    return key;
+}
+
+void dir_table_rebuild(struct dir_table_t* self, size_t cap, bool (*keep)(const void* ctx, const void* elem), const void* ctx) {
+    unsigned char* buffer = (unsigned char*) calloc(cap, self->elem_size);
+    size_t len = 0;
+
+    for (size_t i = 0; i < self->cap; i++) {
+        const struct dir_key_t* key = (const struct dir_key_t*) dir_table_at(self, i);
+        if ((key != NULL) && ((keep == NULL) || keep(ctx, key))) {
+            memcpy(dir_table_key(buffer, self->elem_size, dir_table_slot(buffer, self->elem_size, cap, key->hash)),
+                key, self->elem_size);
+            len++;
+        }
+    }
+
+    free(self->buffer);
+    self->buffer = buffer;
+    self->cap = cap;
+    self->len = len;
+}
+
+void dir_table_clear(struct dir_table_t* self) {
+    if (self->len > 0) {
+        memset(self->buffer, 0, self->cap * self->elem_size);
+    }
+    self->len = 0;
+}
+
+size_t dir_table_trim(const char* path, size_t len) {
+    while ((len > 0) && (path[len - 1] == '/')) {
+        len--;
+    }
+
+    return len;
+}
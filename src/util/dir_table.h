@@ -0,0 +1,62 @@
+/**
+ * @file dir_table.h
+ * @date 18 Oct 2026
+ * @brief Open addressing table of directories keyed by path hash
+ *
+ * Elements are structures of fixed size starting with struct dir_key_t,
+ * free slots are zeroed. Directory paths are hashed without trailing '/'.
+ */
+
+#ifndef __UTIL_DIR_TABLE_H__
+#define __UTIL_DIR_TABLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Define -------------------------------------------------------------------*/
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+/* First member of every element */
+struct dir_key_t {
+    uint64_t hash; /* Directory path hash without trailing '/' */
+    bool used;
+};
+
+/* Capacity is power of two */
+struct dir_table_t {
+    size_t elem_size;
+    size_t cap;
+    size_t len;
+    unsigned char* buffer;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+/* Capacity must be power of two */
+void dir_table_init(struct dir_table_t* self, size_t elem_size, size_t cap);
+
+void dir_table_clean(struct dir_table_t* self);
+
+/* Element in slot, NULL if slot is free */
+void* dir_table_at(const struct dir_table_t* self, size_t slot);
+
+/* NULL if directory is not in the table */
+void* dir_table_find(const struct dir_table_t* self, uint64_t hash);
+
+/* Element of directory, added zeroed if it is not in the table */
+void* dir_table_insert(struct dir_table_t* self, uint64_t hash);
+
+/* Move elements accepted by keep (all if NULL) to new table of cap slots */
+void dir_table_rebuild(struct dir_table_t* self, size_t cap, bool (*keep)(const void* ctx, const void* elem), const void* ctx);
+
+/* Remove all elements, capacity is kept */
+void dir_table_clear(struct dir_table_t* self);
+
+/* Length of path without trailing '/', root "/" becomes empty string */
+size_t dir_table_trim(const char* path, size_t len);
+
+#endif /* __UTIL_DIR_TABLE_H__ */
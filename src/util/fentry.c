@@ -100,6 +100,8 @@ void fentry_set_drop(struct fentry_set_t** self) {
         fentry_drop(&(*self)->buffer[i]);
     }
     free((*self)->buffer);
+    free(*self);
+    *self = NULL;
 }
 
 void fentry_set_insert(struct fentry_set_t* self, struct fentry_t* entry) {
@@ -133,8 +135,8 @@ void fentry_set_remove(struct fentry_set_t* self, const char* file_name) {
 
         if (strcmp(entry->file_name, file_name) == 0) {
             fentry_drop(&entry);
-            for (size_t j = i; j < self->len; j++) {
-                self->buffer[j] = self->buffer[j + 1]; 
+            for (size_t j = i; j + 1 < self->len; j++) {
+                self->buffer[j] = self->buffer[j + 1];
             }
 
             self->buffer[self->len - 1] = NULL;
@@ -0,0 +1,113 @@
+/**
+ * @file fid_set.c
+ * @date 18 Oct 2026
+ * @brief Set of file identities (device, inode)
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fid_set.h"
+
+static size_t fid_hash(uint64_t dev, uint64_t ino) {
+    uint64_t hash = ino ^ (dev * 0x9e3779b97f4a7c15ULL);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+/* Slot of identity or first free slot of its probe sequence */
+static size_t fid_set_slot(const struct fid_set_t* self, uint64_t dev, uint64_t ino) {
+    const size_t mask = self->cap - 1;
+    size_t slot = fid_hash(dev, ino) & mask;
+
+    while (self->buffer[slot].used
+        && ((self->buffer[slot].dev != dev) || (self->buffer[slot].ino != ino)))
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void fid_set_grow(struct fid_set_t* self) {
+    struct fid_t* old_buffer = self->buffer;
+    const size_t old_cap = self->cap;
+
+    self->cap *= 2;
+    self->buffer = (struct fid_t*) calloc(self->cap, sizeof(struct fid_t));
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_buffer[i].used) {
+            self->buffer[fid_set_slot(self, old_buffer[i].dev, old_buffer[i].ino)] = old_buffer[i];
+        }
+    }
+
+    free(old_buffer);
+}
+
+struct fid_set_t* fid_set_new() {
+    struct fid_set_t* new_set = (struct fid_set_t*) malloc(sizeof(struct fid_set_t));
+    new_set->cap = FID_SET_DEFAULT_CAP;
+    new_set->len = 0;
+    new_set->buffer = (struct fid_t*) calloc(new_set->cap, sizeof(struct fid_t));
+
+    return new_set;
+}
+
+void fid_set_drop(struct fid_set_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    free((*self)->buffer);
+    free(*self);
+    *self = NULL;
+}
+
+bool fid_set_insert(struct fid_set_t* self, uint64_t dev, uint64_t ino) {
+    if (self == NULL) {
+        return false;
+    }
+
+    /* Keep load factor below 1/2 */
+    if (2 * (self->len + 1) > self->cap) {
+        fid_set_grow(self);
+    }
+
+    struct fid_t* fid = &self->buffer[fid_set_slot(self, dev, ino)];
+    if (fid->used) {
+        return false;
+    }
+
+    fid->dev = dev;
+    fid->ino = ino;
+    fid->used = true;
+    self->len++;
+
+    return true;
+}
+
+bool fid_set_contains(const struct fid_set_t* self, uint64_t dev, uint64_t ino) {
+    if (self == NULL) {
+        return false;
+    }
+
+    return self->buffer[fid_set_slot(self, dev, ino)].used;
+}
+
+void fid_set_clear(struct fid_set_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    memset(self->buffer, 0, self->cap * sizeof(struct fid_t));
+    self->len = 0;
+}
+
+size_t fid_set_len(const struct fid_set_t* self) {
+    return (self != NULL) ? self->len : 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file fid_set.h
+ * @date 18 Oct 2026
+ * @brief Set of file identities (device, inode)
+ */
+
+#ifndef __UTIL_FID_SET_H__
+#define __UTIL_FID_SET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define FID_SET_DEFAULT_CAP ((size_t) 64)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct fid_t {
+    uint64_t dev;
+    uint64_t ino;
+    bool used;
+};
+
+/* Open addressing hash set, capacity is power of two */
+struct fid_set_t {
+    size_t cap;
+    size_t len;
+    struct fid_t* buffer;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct fid_set_t* fid_set_new();
+
+void fid_set_drop(struct fid_set_t** self);
+
+/* Returns false if identity is already in the set */
+bool fid_set_insert(struct fid_set_t* self, uint64_t dev, uint64_t ino);
+
+bool fid_set_contains(const struct fid_set_t* self, uint64_t dev, uint64_t ino);
+
+void fid_set_clear(struct fid_set_t* self);
+
+size_t fid_set_len(const struct fid_set_t* self);
+
+#endif /* __UTIL_FID_SET_H__ */
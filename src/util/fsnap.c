@@ -0,0 +1,1489 @@
+/**
+ * @file fsnap.c
+ * @date 18 Oct 2026
+ * @brief Column-oriented file tree snapshot
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "fsnap.h"
+
+#define FNV_PRIME        ((uint64_t) 0x100000001b3ULL)
+
+#define FSNAP_DIR_NONE    SIZE_MAX
+#define FSNAP_DIR_MAP_MIN ((size_t) 64)
+
+struct fsnap_sort_pair_t {
+    uint64_t hash;
+    size_t idx;
+};
+
+/* Directories collected while building the index, ids are in discovery order */
+struct fsnap_dir_build_t {
+    const char* paths;
+    size_t cap;
+    size_t len;
+    uint64_t* hash;
+    size_t* path_off; /* Directory path is a prefix of some entry path */
+    size_t* path_len;
+    size_t* parent;
+
+    /* Open addressing map from path hash to id */
+    size_t map_cap;
+    size_t* map;
+};
+
+static void fsnap_reserve(struct fsnap_t* self, size_t cap) {
+    if (cap <= self->cap) {
+        return;
+    }
+
+    self->path_hash = (uint64_t*) realloc(self->path_hash, cap * sizeof(uint64_t));
+    self->size = (int64_t*) realloc(self->size, cap * sizeof(int64_t));
+    self->mtime_ns = (int64_t*) realloc(self->mtime_ns, cap * sizeof(int64_t));
+    self->ino = (uint64_t*) realloc(self->ino, cap * sizeof(uint64_t));
+    self->path_off = (size_t*) realloc(self->path_off, cap * sizeof(size_t));
+    self->cap = cap;
+}
+
+uint64_t fsnap_hash_path(const char* path) {
+    return fsnap_hash_update(FSNAP_HASH_INIT, path, strlen(path));
+}
+
+uint64_t fsnap_hash_update(uint64_t hash, const char* data, size_t len) {
+    const unsigned char* p = (const unsigned char*) data;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint64_t) p[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+struct fsnap_t* fsnap_new() {
+    struct fsnap_t* new_snap = (struct fsnap_t*) calloc(1, sizeof(struct fsnap_t));
+    new_snap->sorted = true;
+    fsnap_reserve(new_snap, FSNAP_DEFAULT_CAP);
+
+    new_snap->paths_cap = FSNAP_PATHS_DEFAULT_CAP;
+    new_snap->paths = (char*) malloc(new_snap->paths_cap * sizeof(char));
+
+    return new_snap;
+}
+
+void fsnap_drop(struct fsnap_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    free((*self)->path_hash);
+    free((*self)->size);
+    free((*self)->mtime_ns);
+    free((*self)->ino);
+    free((*self)->path_off);
+    free((*self)->paths);
+    free((*self)->links);
+    free((*self)->alias_hash);
+    free((*self)->alias_path_off);
+    free((*self)->alias_target);
+    free((*self)->dir_hash);
+    free((*self)->dir_path_off);
+    free((*self)->dir_path_len);
+    free((*self)->dir_summary);
+    free((*self)->dir_entry_off);
+    free((*self)->dir_alias_off);
+    free((*self)->dir_sub_off);
+    free((*self)->dir_subs);
+    free(*self);
+    *self = NULL;
+}
+
+static void fsnap_push_link(struct fsnap_t* self, uint64_t dev, uint64_t ino, size_t idx) {
+    if (self->links_len == self->links_cap) {
+        self->links_cap = (self->links_cap == 0) ? FSNAP_IDX_VEC_DEFAULT_CAP : self->links_cap * 2;
+        self->links = (struct fsnap_link_t*) realloc(self->links, self->links_cap * sizeof(struct fsnap_link_t));
+    }
+
+    self->links[self->links_len].dev = dev;
+    self->links[self->links_len].ino = ino;
+    self->links[self->links_len].idx = idx;
+    self->links_len++;
+}
+
+static size_t fsnap_push_meta(struct fsnap_t* self, const char* path, int64_t size, int64_t mtime_ns, uint64_t ino) {
+    if (self->len == self->cap) {
+        fsnap_reserve(self, self->cap * 2);
+    }
+
+    const size_t path_len = strlen(path) + 1;
+    if (self->paths_len + path_len > self->paths_cap) {
+        while (self->paths_len + path_len > self->paths_cap) {
+            self->paths_cap *= 2;
+        }
+        self->paths = (char*) realloc(self->paths, self->paths_cap * sizeof(char));
+    }
+    memcpy(self->paths + self->paths_len, path, path_len);
+
+    const size_t idx = self->len++;
+    self->path_hash[idx] = fsnap_hash_path(path);
+    self->size[idx] = size;
+    self->mtime_ns[idx] = mtime_ns;
+    self->ino[idx] = ino;
+    self->path_off[idx] = self->paths_len;
+
+    self->paths_len += path_len;
+    self->sorted = false;
+
+    return idx;
+}
+
+void fsnap_push(struct fsnap_t* self, const char* path, const struct stat* file_stat) {
+    if ((self == NULL) || (path == NULL) || (file_stat == NULL)) {
+        return;
+    }
+
+    const size_t idx = fsnap_push_meta(self,
+        path,
+        (int64_t) file_stat->st_size,
+        (int64_t) file_stat->st_mtim.tv_sec * 1000000000LL + (int64_t) file_stat->st_mtim.tv_nsec,
+        (uint64_t) file_stat->st_ino
+    );
+
+    if (!S_ISDIR(file_stat->st_mode) && (file_stat->st_nlink > 1)) {
+        fsnap_push_link(self, (uint64_t) file_stat->st_dev, (uint64_t) file_stat->st_ino, idx);
+    }
+}
+
+void fsnap_push_copy(struct fsnap_t* self, const struct fsnap_t* src, size_t idx) {
+    if ((self == NULL) || (src == NULL) || (idx >= fsnap_len(src))) {
+        return;
+    }
+
+    const size_t primary = fsnap_primary(src, idx);
+    fsnap_push_meta(self, fsnap_path(src, idx), src->size[primary], src->mtime_ns[primary], src->ino[primary]);
+}
+
+void fsnap_append(struct fsnap_t* self, struct fsnap_t* other) {
+    if ((self == NULL) || (other == NULL) || (other->len == 0)) {
+        return;
+    }
+
+    size_t cap = self->cap;
+    while (cap < self->len + other->len) {
+        cap *= 2;
+    }
+    fsnap_reserve(self, cap);
+
+    if (self->paths_len + other->paths_len > self->paths_cap) {
+        while (self->paths_len + other->paths_len > self->paths_cap) {
+            self->paths_cap *= 2;
+        }
+        self->paths = (char*) realloc(self->paths, self->paths_cap * sizeof(char));
+    }
+
+    const size_t len = self->len;
+    memcpy(self->path_hash + len, other->path_hash, other->len * sizeof(uint64_t));
+    memcpy(self->size + len, other->size, other->len * sizeof(int64_t));
+    memcpy(self->mtime_ns + len, other->mtime_ns, other->len * sizeof(int64_t));
+    memcpy(self->ino + len, other->ino, other->len * sizeof(uint64_t));
+    for (size_t i = 0; i < other->len; i++) {
+        self->path_off[len + i] = other->path_off[i] + self->paths_len;
+    }
+    memcpy(self->paths + self->paths_len, other->paths, other->paths_len);
+
+    for (size_t i = 0; i < other->links_len; i++) {
+        fsnap_push_link(self, other->links[i].dev, other->links[i].ino, other->links[i].idx + len);
+    }
+
+    self->len += other->len;
+    self->paths_len += other->paths_len;
+    self->sorted = false;
+
+    other->len = 0;
+    other->paths_len = 0;
+    other->links_len = 0;
+    other->dir_len = 0;
+    other->sorted = true;
+}
+
+void fsnap_rename_dir(struct fsnap_t* self, const char* from, const char* to) {
+    if ((self == NULL) || (from == NULL) || (to == NULL)) {
+        return;
+    }
+
+    const size_t from_len = strlen(from);
+    const size_t to_len = strlen(to);
+
+    for (size_t i = 0; i < self->len; i++) {
+        const size_t off = self->path_off[i];
+        if ((strncmp(self->paths + off, from, from_len) != 0) || (self->paths[off + from_len] != '/')) {
+            continue;
+        }
+
+        /* New path is appended, old one is left unused in the pool */
+        const size_t rest_len = strlen(self->paths + off + from_len) + 1;
+        if (self->paths_len + to_len + rest_len > self->paths_cap) {
+            while (self->paths_len + to_len + rest_len > self->paths_cap) {
+                self->paths_cap *= 2;
+            }
+            self->paths = (char*) realloc(self->paths, self->paths_cap * sizeof(char));
+        }
+        memcpy(self->paths + self->paths_len, to, to_len);
+        memcpy(self->paths + self->paths_len + to_len, self->paths + off + from_len, rest_len);
+
+        self->path_off[i] = self->paths_len;
+        self->path_hash[i] = fsnap_hash_path(self->paths + self->paths_len);
+        self->paths_len += to_len + rest_len;
+        self->sorted = false;
+    }
+}
+
+static void fsnap_radix_sort(struct fsnap_sort_pair_t* pairs, size_t len) {
+    if (len == 0) {
+        return;
+    }
+
+    struct fsnap_sort_pair_t* tmp =
+        (struct fsnap_sort_pair_t*) malloc(len * sizeof(struct fsnap_sort_pair_t));
+    struct fsnap_sort_pair_t* src = pairs;
+    struct fsnap_sort_pair_t* dst = tmp;
+
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        size_t count[256] = { 0 };
+
+        for (size_t i = 0; i < len; i++) {
+            count[(src[i].hash >> shift) & 0xFF]++;
+        }
+
+        /* Skip pass if all keys share this byte */
+        if (count[(src[0].hash >> shift) & 0xFF] == len) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; b++) {
+            const size_t c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0; i < len; i++) {
+            dst[count[(src[i].hash >> shift) & 0xFF]++] = src[i];
+        }
+
+        struct fsnap_sort_pair_t* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != pairs) {
+        memcpy(pairs, src, len * sizeof(struct fsnap_sort_pair_t));
+    }
+
+    free(tmp);
+}
+
+static void fsnap_gather_u64(uint64_t** column, const size_t* perm, size_t len, size_t cap) {
+    uint64_t* gathered = (uint64_t*) malloc(cap * sizeof(uint64_t));
+    for (size_t i = 0; i < len; i++) {
+        gathered[i] = (*column)[perm[i]];
+    }
+    free(*column);
+    *column = gathered;
+}
+
+static void fsnap_gather_i64(int64_t** column, const size_t* perm, size_t len, size_t cap) {
+    int64_t* gathered = (int64_t*) malloc(cap * sizeof(int64_t));
+    for (size_t i = 0; i < len; i++) {
+        gathered[i] = (*column)[perm[i]];
+    }
+    free(*column);
+    *column = gathered;
+}
+
+static void fsnap_gather_idx(size_t** column, const size_t* perm, size_t len, size_t cap) {
+    size_t* gathered = (size_t*) malloc(cap * sizeof(size_t));
+    for (size_t i = 0; i < len; i++) {
+        gathered[i] = (*column)[perm[i]];
+    }
+    free(*column);
+    *column = gathered;
+}
+
+static int fsnap_link_cmp(const void* a, const void* b) {
+    const struct fsnap_link_t* link_a = (const struct fsnap_link_t*) a;
+    const struct fsnap_link_t* link_b = (const struct fsnap_link_t*) b;
+
+    if (link_a->dev != link_b->dev) {
+        return (link_a->dev < link_b->dev) ? -1 : 1;
+    } else if (link_a->ino != link_b->ino) {
+        return (link_a->ino < link_b->ino) ? -1 : 1;
+    } else if (link_a->idx != link_b->idx) {
+        return (link_a->idx < link_b->idx) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/* Move non-primary paths of hard linked inodes from columns to aliases */
+static void fsnap_fold_links(struct fsnap_t* self, const size_t* perm, size_t perm_len) {
+    /* Map pushed index to sorted index */
+    size_t* sorted_idx = (size_t*) malloc(self->len * sizeof(size_t));
+    for (size_t i = 0; i < self->len; i++) {
+        sorted_idx[i] = SIZE_MAX;
+    }
+    for (size_t i = 0; i < perm_len; i++) {
+        sorted_idx[perm[i]] = i;
+    }
+
+    size_t links_len = 0;
+    for (size_t i = 0; i < self->links_len; i++) {
+        const size_t idx = sorted_idx[self->links[i].idx];
+        if (idx != SIZE_MAX) {
+            self->links[links_len] = self->links[i];
+            self->links[links_len].idx = idx;
+            links_len++;
+        }
+    }
+    free(sorted_idx);
+    self->links_len = 0;
+
+    qsort(self->links, links_len, sizeof(struct fsnap_link_t), fsnap_link_cmp);
+
+    /* Primary is the first path of inode in hash order */
+    size_t* target = (size_t*) malloc(perm_len * sizeof(size_t));
+    size_t alias_len = 0;
+    for (size_t i = 0; i < perm_len; i++) {
+        target[i] = SIZE_MAX;
+    }
+    for (size_t i = 1; i < links_len; i++) {
+        const struct fsnap_link_t* prev = &self->links[i - 1];
+        const struct fsnap_link_t* link = &self->links[i];
+
+        if ((link->dev == prev->dev) && (link->ino == prev->ino)) {
+            target[link->idx] = (target[prev->idx] == SIZE_MAX) ? prev->idx : target[prev->idx];
+            alias_len++;
+        }
+    }
+
+    if (alias_len == 0) {
+        free(target);
+        self->len = perm_len;
+        return;
+    }
+
+    /* Compact columns, aliases keep hash order */
+    size_t* new_idx = (size_t*) malloc(perm_len * sizeof(size_t));
+    self->alias_hash = (uint64_t*) malloc(alias_len * sizeof(uint64_t));
+    self->alias_path_off = (size_t*) malloc(alias_len * sizeof(size_t));
+    self->alias_target = (size_t*) malloc(alias_len * sizeof(size_t));
+    self->alias_len = alias_len;
+
+    size_t len = 0;
+    size_t alias_idx = 0;
+    for (size_t i = 0; i < perm_len; i++) {
+        if (target[i] != SIZE_MAX) {
+            self->alias_hash[alias_idx] = self->path_hash[i];
+            self->alias_path_off[alias_idx] = self->path_off[i];
+            self->alias_target[alias_idx] = target[i];
+            alias_idx++;
+            continue;
+        }
+
+        new_idx[i] = len;
+        self->path_hash[len] = self->path_hash[i];
+        self->size[len] = self->size[i];
+        self->mtime_ns[len] = self->mtime_ns[i];
+        self->ino[len] = self->ino[i];
+        self->path_off[len] = self->path_off[i];
+        len++;
+    }
+
+    for (size_t i = 0; i < alias_len; i++) {
+        self->alias_target[i] = new_idx[self->alias_target[i]];
+    }
+
+    free(new_idx);
+    free(target);
+    self->len = len;
+}
+
+/* Directory index ----------------------------------------------------------*/
+
+static uint64_t fsnap_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* Summaries are sums of mixed terms, so they do not depend on entry order */
+static uint64_t fsnap_entry_term(uint64_t path_hash, int64_t size, int64_t mtime_ns) {
+    return fsnap_mix(path_hash ^ fsnap_mix((uint64_t) size ^ fsnap_mix((uint64_t) mtime_ns)));
+}
+
+static uint64_t fsnap_dir_term(uint64_t dir_hash, uint64_t summary) {
+    return fsnap_mix(summary + fsnap_mix(~dir_hash));
+}
+
+/* Length of parent directory prefix, 0 for top level paths */
+static size_t fsnap_parent_len(const char* path, size_t len) {
+    while ((len > 0) && (path[len - 1] != '/')) {
+        len--;
+    }
+
+    return (len > 0) ? len - 1 : 0;
+}
+
+static uint64_t fsnap_entry_hash(const struct fsnap_t* self, size_t idx) {
+    return (idx < self->len) ? self->path_hash[idx] : self->alias_hash[idx - self->len];
+}
+
+/* Order entries by path hash, then by path */
+static int fsnap_entry_cmp(const struct fsnap_t* a, size_t a_idx, const struct fsnap_t* b, size_t b_idx) {
+    const uint64_t a_hash = fsnap_entry_hash(a, a_idx);
+    const uint64_t b_hash = fsnap_entry_hash(b, b_idx);
+
+    if (a_hash != b_hash) {
+        return (a_hash < b_hash) ? -1 : 1;
+    }
+
+    return strcmp(fsnap_path(a, a_idx), fsnap_path(b, b_idx));
+}
+
+/* Order directory paths of equal hash */
+static int fsnap_dir_path_cmp(const char* a, size_t a_len, const char* b, size_t b_len) {
+    const int cmp = memcmp(a, b, (a_len < b_len) ? a_len : b_len);
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+/* Order directories by path hash, then by path */
+static int fsnap_dir_cmp(const struct fsnap_t* a, size_t a_pos, const struct fsnap_t* b, size_t b_pos) {
+    if (a->dir_hash[a_pos] != b->dir_hash[b_pos]) {
+        return (a->dir_hash[a_pos] < b->dir_hash[b_pos]) ? -1 : 1;
+    }
+
+    return fsnap_dir_path_cmp(a->paths + a->dir_path_off[a_pos], a->dir_path_len[a_pos],
+        b->paths + b->dir_path_off[b_pos], b->dir_path_len[b_pos]);
+}
+
+static void fsnap_clear_dirs(struct fsnap_t* self) {
+    free(self->dir_hash);
+    free(self->dir_path_off);
+    free(self->dir_path_len);
+    free(self->dir_summary);
+    free(self->dir_entry_off);
+    free(self->dir_alias_off);
+    free(self->dir_sub_off);
+    free(self->dir_subs);
+
+    self->dir_len = 0;
+    self->dir_hash = NULL;
+    self->dir_path_off = NULL;
+    self->dir_path_len = NULL;
+    self->dir_summary = NULL;
+    self->dir_entry_off = NULL;
+    self->dir_alias_off = NULL;
+    self->dir_sub_off = NULL;
+    self->dir_subs = NULL;
+}
+
+static void fsnap_dir_map_insert(struct fsnap_dir_build_t* self, size_t id) {
+    size_t slot = fsnap_mix(self->hash[id]) & (self->map_cap - 1);
+
+    while (self->map[slot] != FSNAP_DIR_NONE) {
+        slot = (slot + 1) & (self->map_cap - 1);
+    }
+    self->map[slot] = id;
+}
+
+/* Find directory by path hash and path or add it */
+static size_t fsnap_dir_get(struct fsnap_dir_build_t* self, uint64_t hash, size_t path_off, size_t path_len) {
+    size_t slot = fsnap_mix(hash) & (self->map_cap - 1);
+
+    while (self->map[slot] != FSNAP_DIR_NONE) {
+        const size_t id = self->map[slot];
+        if ((self->hash[id] == hash) && (self->path_len[id] == path_len)
+            && (memcmp(self->paths + self->path_off[id], self->paths + path_off, path_len) == 0))
+        {
+            return id;
+        }
+        slot = (slot + 1) & (self->map_cap - 1);
+    }
+
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? FSNAP_DIR_MAP_MIN : self->cap * 2;
+        self->hash = (uint64_t*) realloc(self->hash, self->cap * sizeof(uint64_t));
+        self->path_off = (size_t*) realloc(self->path_off, self->cap * sizeof(size_t));
+        self->path_len = (size_t*) realloc(self->path_len, self->cap * sizeof(size_t));
+        self->parent = (size_t*) realloc(self->parent, self->cap * sizeof(size_t));
+    }
+
+    const size_t id = self->len++;
+    self->hash[id] = hash;
+    self->path_off[id] = path_off;
+    self->path_len[id] = path_len;
+    self->parent[id] = FSNAP_DIR_NONE;
+    self->map[slot] = id;
+
+    /* Keep load factor below 1/2 */
+    if (self->len * 2 > self->map_cap) {
+        self->map_cap *= 2;
+        self->map = (size_t*) realloc(self->map, self->map_cap * sizeof(size_t));
+        for (size_t i = 0; i < self->map_cap; i++) {
+            self->map[i] = FSNAP_DIR_NONE;
+        }
+        for (size_t i = 0; i < self->len; i++) {
+            fsnap_dir_map_insert(self, i);
+        }
+    }
+
+    return id;
+}
+
+static size_t fsnap_entry_path_off(const struct fsnap_t* self, size_t idx) {
+    return (idx < self->len) ? self->path_off[idx] : self->alias_path_off[idx - self->len];
+}
+
+static int fsnap_dir_depth_cmp(const void* a, const void* b) {
+    const struct fsnap_sort_pair_t* pair_a = (const struct fsnap_sort_pair_t*) a;
+    const struct fsnap_sort_pair_t* pair_b = (const struct fsnap_sort_pair_t*) b;
+
+    /* Longer paths first, so children are summed before their parents */
+    return (pair_a->hash < pair_b->hash) - (pair_a->hash > pair_b->hash);
+}
+
+/* Build directory index and group columns by directory, entries must be in hash order inside directory */
+static void fsnap_index_dirs(struct fsnap_t* self) {
+    fsnap_clear_dirs(self);
+
+    const size_t len = fsnap_len(self);
+    if (len == 0) {
+        return;
+    }
+
+    struct fsnap_dir_build_t build;
+    memset(&build, 0, sizeof(struct fsnap_dir_build_t));
+    build.paths = self->paths;
+    build.map_cap = FSNAP_DIR_MAP_MIN;
+    build.map = (size_t*) malloc(build.map_cap * sizeof(size_t));
+    for (size_t k = 0; k < build.map_cap; k++) {
+        build.map[k] = FSNAP_DIR_NONE;
+    }
+
+    /* Parent directory of primary entries, then of aliases */
+    size_t* entry_dir = (size_t*) malloc(len * sizeof(size_t));
+    for (size_t k = 0; k < len; k++) {
+        const size_t path_off = fsnap_entry_path_off(self, k);
+        const char* path = self->paths + path_off;
+        const size_t parent_len = fsnap_parent_len(path, strlen(path));
+
+        entry_dir[k] = fsnap_dir_get(&build, fsnap_hash_update(FSNAP_HASH_INIT, path, parent_len), path_off, parent_len);
+    }
+
+    /* Add ancestors of all directories, list grows while iterating */
+    for (size_t id = 0; id < build.len; id++) {
+        if (build.path_len[id] == 0) {
+            continue;
+        }
+
+        const char* path = self->paths + build.path_off[id];
+        const size_t parent_len = fsnap_parent_len(path, build.path_len[id]);
+        const size_t parent = fsnap_dir_get(&build,
+            fsnap_hash_update(FSNAP_HASH_INIT, path, parent_len),
+            build.path_off[id],
+            parent_len
+        );
+
+        build.parent[id] = parent;
+    }
+
+    /* Sort directories by hash, then order hash collision runs by path */
+    const size_t dir_len = build.len;
+    struct fsnap_sort_pair_t* pairs = (struct fsnap_sort_pair_t*) malloc(dir_len * sizeof(struct fsnap_sort_pair_t));
+    for (size_t id = 0; id < dir_len; id++) {
+        pairs[id].hash = build.hash[id];
+        pairs[id].idx = id;
+    }
+    fsnap_radix_sort(pairs, dir_len);
+
+    for (size_t pos = 1; pos < dir_len; pos++) {
+        const struct fsnap_sort_pair_t pair = pairs[pos];
+        size_t k = pos;
+
+        while ((k > 0) && (pairs[k - 1].hash == pair.hash)
+            && (fsnap_dir_path_cmp(self->paths + build.path_off[pairs[k - 1].idx], build.path_len[pairs[k - 1].idx],
+                self->paths + build.path_off[pair.idx], build.path_len[pair.idx]) > 0))
+        {
+            pairs[k] = pairs[k - 1];
+            k--;
+        }
+        pairs[k] = pair;
+    }
+
+    size_t* rank = (size_t*) malloc(dir_len * sizeof(size_t));
+    self->dir_len = dir_len;
+    self->dir_hash = (uint64_t*) malloc(dir_len * sizeof(uint64_t));
+    self->dir_path_off = (size_t*) malloc(dir_len * sizeof(size_t));
+    self->dir_path_len = (size_t*) malloc(dir_len * sizeof(size_t));
+    self->dir_summary = (uint64_t*) calloc(dir_len, sizeof(uint64_t));
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        rank[pairs[pos].idx] = pos;
+        self->dir_hash[pos] = pairs[pos].hash;
+        self->dir_path_off[pos] = build.path_off[pairs[pos].idx];
+        self->dir_path_len[pos] = build.path_len[pairs[pos].idx];
+    }
+
+    /* Children and subdirectories, counting sort keeps hash order inside directory */
+    self->dir_entry_off = (size_t*) calloc(dir_len + 1, sizeof(size_t));
+    self->dir_alias_off = (size_t*) calloc(dir_len + 1, sizeof(size_t));
+    self->dir_sub_off = (size_t*) calloc(dir_len + 1, sizeof(size_t));
+    self->dir_subs = (size_t*) malloc(dir_len * sizeof(size_t));
+
+    for (size_t k = 0; k < len; k++) {
+        size_t* off = (k < self->len) ? self->dir_entry_off : self->dir_alias_off;
+        off[rank[entry_dir[k]] + 1]++;
+    }
+    for (size_t id = 0; id < dir_len; id++) {
+        if (build.parent[id] != FSNAP_DIR_NONE) {
+            self->dir_sub_off[rank[build.parent[id]] + 1]++;
+        }
+    }
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        self->dir_entry_off[pos + 1] += self->dir_entry_off[pos];
+        self->dir_alias_off[pos + 1] += self->dir_alias_off[pos];
+        self->dir_sub_off[pos + 1] += self->dir_sub_off[pos];
+    }
+
+    /* Position of primary entries and aliases once grouped by directory */
+    size_t* fill = (size_t*) malloc((dir_len + 1) * sizeof(size_t));
+    size_t* grouped = (size_t*) malloc(len * sizeof(size_t));
+    bool is_grouped = true;
+
+    memcpy(fill, self->dir_entry_off, dir_len * sizeof(size_t));
+    for (size_t k = 0; k < self->len; k++) {
+        grouped[k] = fill[rank[entry_dir[k]]]++;
+        is_grouped = is_grouped && (grouped[k] == k);
+    }
+    memcpy(fill, self->dir_alias_off, dir_len * sizeof(size_t));
+    for (size_t k = self->len; k < len; k++) {
+        grouped[k] = fill[rank[entry_dir[k]]]++;
+        is_grouped = is_grouped && (grouped[k] == k - self->len);
+    }
+
+    /* Read snapshots are grouped already */
+    if (!is_grouped) {
+        size_t* perm = entry_dir;
+
+        for (size_t k = 0; k < self->len; k++) {
+            perm[grouped[k]] = k;
+        }
+        fsnap_gather_u64(&self->path_hash, perm, self->len, self->cap);
+        fsnap_gather_i64(&self->size, perm, self->len, self->cap);
+        fsnap_gather_i64(&self->mtime_ns, perm, self->len, self->cap);
+        fsnap_gather_u64(&self->ino, perm, self->len, self->cap);
+        fsnap_gather_idx(&self->path_off, perm, self->len, self->cap);
+
+        if (self->alias_len > 0) {
+            for (size_t k = 0; k < self->alias_len; k++) {
+                perm[grouped[self->len + k]] = k;
+                self->alias_target[k] = grouped[self->alias_target[k]];
+            }
+            fsnap_gather_u64(&self->alias_hash, perm, self->alias_len, self->alias_len);
+            fsnap_gather_idx(&self->alias_path_off, perm, self->alias_len, self->alias_len);
+            fsnap_gather_idx(&self->alias_target, perm, self->alias_len, self->alias_len);
+        }
+    }
+
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        for (size_t k = self->dir_entry_off[pos]; k < self->dir_entry_off[pos + 1]; k++) {
+            self->dir_summary[pos] += fsnap_entry_term(self->path_hash[k], self->size[k], self->mtime_ns[k]);
+        }
+        for (size_t k = self->dir_alias_off[pos]; k < self->dir_alias_off[pos + 1]; k++) {
+            const size_t primary = self->alias_target[k];
+            self->dir_summary[pos] += fsnap_entry_term(self->alias_hash[k], self->size[primary], self->mtime_ns[primary]);
+        }
+    }
+
+    memcpy(fill, self->dir_sub_off, dir_len * sizeof(size_t));
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        const size_t parent = build.parent[pairs[pos].idx];
+        if (parent != FSNAP_DIR_NONE) {
+            self->dir_subs[fill[rank[parent]]++] = pos;
+        }
+    }
+
+    /* Fold summaries bottom-up, parent path is always shorter than child path */
+    size_t* parent_pos = fill;
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        const size_t parent = build.parent[pairs[pos].idx];
+        parent_pos[pos] = (parent != FSNAP_DIR_NONE) ? rank[parent] : FSNAP_DIR_NONE;
+    }
+    for (size_t pos = 0; pos < dir_len; pos++) {
+        pairs[pos].hash = build.path_len[pairs[pos].idx];
+        pairs[pos].idx = pos;
+    }
+    qsort(pairs, dir_len, sizeof(struct fsnap_sort_pair_t), fsnap_dir_depth_cmp);
+
+    for (size_t k = 0; k < dir_len; k++) {
+        const size_t pos = pairs[k].idx;
+        if (parent_pos[pos] != FSNAP_DIR_NONE) {
+            self->dir_summary[parent_pos[pos]] += fsnap_dir_term(self->dir_hash[pos], self->dir_summary[pos]);
+        }
+    }
+
+    free(grouped);
+    free(fill);
+    free(rank);
+    free(pairs);
+    free(entry_dir);
+    free(build.hash);
+    free(build.path_off);
+    free(build.path_len);
+    free(build.parent);
+    free(build.map);
+}
+
+void fsnap_seal(struct fsnap_t* self) {
+    if ((self == NULL) || self->sorted) {
+        return;
+    }
+
+    const size_t len = self->len;
+    struct fsnap_sort_pair_t* pairs =
+        (struct fsnap_sort_pair_t*) malloc(len * sizeof(struct fsnap_sort_pair_t));
+
+    for (size_t i = 0; i < len; i++) {
+        pairs[i].hash = self->path_hash[i];
+        pairs[i].idx = i;
+    }
+
+    fsnap_radix_sort(pairs, len);
+
+    /* Order hash collision runs by path and drop duplicate paths */
+    size_t* perm = (size_t*) malloc(len * sizeof(size_t));
+    size_t perm_len = 0;
+
+    for (size_t i = 0; i < len;) {
+        size_t run_end = i + 1;
+        while ((run_end < len) && (pairs[run_end].hash == pairs[i].hash)) {
+            run_end++;
+        }
+
+        const size_t run_start = perm_len;
+        for (size_t k = i; k < run_end; k++) {
+            const char* path = self->paths + self->path_off[pairs[k].idx];
+            size_t pos = perm_len;
+            bool is_duplicate = false;
+
+            while (pos > run_start) {
+                const int cmp = strcmp(self->paths + self->path_off[perm[pos - 1]], path);
+                if (cmp == 0) {
+                    is_duplicate = true;
+                    break;
+                } else if (cmp < 0) {
+                    break;
+                }
+                pos--;
+            }
+
+            if (is_duplicate) {
+                continue;
+            }
+
+            memmove(&perm[pos + 1], &perm[pos], (perm_len - pos) * sizeof(size_t));
+            perm[pos] = pairs[k].idx;
+            perm_len++;
+        }
+
+        i = run_end;
+    }
+
+    free(pairs);
+
+    fsnap_gather_u64(&self->path_hash, perm, perm_len, self->cap);
+    fsnap_gather_i64(&self->size, perm, perm_len, self->cap);
+    fsnap_gather_i64(&self->mtime_ns, perm, perm_len, self->cap);
+    fsnap_gather_u64(&self->ino, perm, perm_len, self->cap);
+    fsnap_gather_idx(&self->path_off, perm, perm_len, self->cap);
+
+    if (self->links_len > 0) {
+        fsnap_fold_links(self, perm, perm_len);
+    } else {
+        self->len = perm_len;
+    }
+
+    free(perm);
+    self->sorted = true;
+
+    fsnap_index_dirs(self);
+}
+
+void fsnap_clear(struct fsnap_t* self) {
+    if (self == NULL) {
+        return;
+    }
+
+    free(self->alias_hash);
+    free(self->alias_path_off);
+    free(self->alias_target);
+    self->alias_len = 0;
+    self->alias_hash = NULL;
+    self->alias_path_off = NULL;
+    self->alias_target = NULL;
+    fsnap_clear_dirs(self);
+
+    self->len = 0;
+    self->paths_len = 0;
+    self->links_len = 0;
+    self->sorted = true;
+}
+
+void fsnap_shrink(struct fsnap_t* self) {
+    if ((self == NULL) || !self->sorted) {
+        return;
+    }
+
+    const size_t cap = (self->len > 0) ? self->len : 1;
+    self->path_hash = (uint64_t*) realloc(self->path_hash, cap * sizeof(uint64_t));
+    self->size = (int64_t*) realloc(self->size, cap * sizeof(int64_t));
+    self->mtime_ns = (int64_t*) realloc(self->mtime_ns, cap * sizeof(int64_t));
+    self->ino = (uint64_t*) realloc(self->ino, cap * sizeof(uint64_t));
+    self->path_off = (size_t*) realloc(self->path_off, cap * sizeof(size_t));
+    self->cap = cap;
+
+    self->paths_cap = (self->paths_len > 0) ? self->paths_len : 1;
+    self->paths = (char*) realloc(self->paths, self->paths_cap * sizeof(char));
+
+    free(self->links);
+    self->links = NULL;
+    self->links_cap = 0;
+    self->links_len = 0;
+}
+
+size_t fsnap_len(const struct fsnap_t* self) {
+    return (self != NULL) ? (self->len + self->alias_len) : 0;
+}
+
+size_t fsnap_primary(const struct fsnap_t* self, size_t idx) {
+    return (idx < self->len) ? idx : self->alias_target[idx - self->len];
+}
+
+const char* fsnap_path(const struct fsnap_t* self, size_t idx) {
+    if ((self == NULL) || (idx >= self->len + self->alias_len)) {
+        return NULL;
+    }
+
+    const size_t path_off = (idx < self->len)
+        ? self->path_off[idx]
+        : self->alias_path_off[idx - self->len];
+    return self->paths + path_off;
+}
+
+/* Find path in [start, end) of hash sorted column */
+static bool fsnap_search(
+    const char* paths,
+    const uint64_t* hashes,
+    const size_t* path_offs,
+    size_t start,
+    size_t end,
+    uint64_t hash,
+    const char* path,
+    size_t* idx
+)
+{
+    size_t lo = start;
+    size_t hi = end;
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (hashes[mid] < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (; (lo < end) && (hashes[lo] == hash); lo++) {
+        if (strcmp(paths + path_offs[lo], path) == 0) {
+            *idx = lo;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Find directory by first dir_len bytes of path */
+static bool fsnap_find_dir(const struct fsnap_t* self, const char* dir, size_t dir_len, size_t* pos) {
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, dir, dir_len);
+    size_t lo = 0;
+    size_t hi = self->dir_len;
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (self->dir_hash[mid] < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (; (lo < self->dir_len) && (self->dir_hash[lo] == hash); lo++) {
+        if ((self->dir_path_len[lo] == dir_len) && (memcmp(self->paths + self->dir_path_off[lo], dir, dir_len) == 0)) {
+            *pos = lo;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool fsnap_find(const struct fsnap_t* self, const char* path, size_t* idx) {
+    if ((self == NULL) || (path == NULL) || !self->sorted) {
+        return false;
+    }
+
+    /* Entry is looked up among children of its parent directory */
+    const size_t path_len = strlen(path);
+    size_t pos = 0;
+    if (!fsnap_find_dir(self, path, fsnap_parent_len(path, path_len), &pos)) {
+        return false;
+    }
+
+    const uint64_t hash = fsnap_hash_update(FSNAP_HASH_INIT, path, path_len);
+    size_t found_idx = 0;
+
+    if (!fsnap_search(self->paths, self->path_hash, self->path_off,
+        self->dir_entry_off[pos], self->dir_entry_off[pos + 1], hash, path, &found_idx))
+    {
+        if (!fsnap_search(self->paths, self->alias_hash, self->alias_path_off,
+            self->dir_alias_off[pos], self->dir_alias_off[pos + 1], hash, path, &found_idx))
+        {
+            return false;
+        }
+        found_idx += self->len;
+    }
+
+    if (idx != NULL) {
+        *idx = found_idx;
+    }
+    return true;
+}
+
+void fsnap_idx_vec_push(struct fsnap_idx_vec_t* self, size_t idx) {
+    if (self->len == self->cap) {
+        self->cap = (self->cap == 0) ? FSNAP_IDX_VEC_DEFAULT_CAP : self->cap * 2;
+        self->buffer = (size_t*) realloc(self->buffer, self->cap * sizeof(size_t));
+    }
+
+    self->buffer[self->len++] = idx;
+}
+
+static bool fsnap_meta_equals(const struct fsnap_t* old_snap, size_t old_idx, const struct fsnap_t* new_snap, size_t new_idx) {
+    const size_t old_primary = fsnap_primary(old_snap, old_idx);
+    const size_t new_primary = fsnap_primary(new_snap, new_idx);
+
+    return (old_snap->size[old_primary] == new_snap->size[new_primary])
+        && (old_snap->mtime_ns[old_primary] == new_snap->mtime_ns[new_primary]);
+}
+
+bool fsnap_dir_summary(const struct fsnap_t* self, const char* dir, uint64_t* summary) {
+    if ((self == NULL) || (dir == NULL) || !self->sorted) {
+        return false;
+    }
+
+    /* Trailing slashes are ignored */
+    size_t dir_len = strlen(dir);
+    while ((dir_len > 0) && (dir[dir_len - 1] == '/')) {
+        dir_len--;
+    }
+
+    size_t pos = 0;
+    if (!fsnap_find_dir(self, dir, dir_len, &pos)) {
+        return false;
+    }
+
+    if (summary != NULL) {
+        *summary = self->dir_summary[pos];
+    }
+    return true;
+}
+
+bool fsnap_subtree_changed(const struct fsnap_t* old_snap, const struct fsnap_t* new_snap, const char* dir) {
+    uint64_t old_summary = 0;
+    uint64_t new_summary = 0;
+    const bool in_old = fsnap_dir_summary(old_snap, dir, &old_summary);
+    const bool in_new = fsnap_dir_summary(new_snap, dir, &new_summary);
+
+    return (in_old != in_new) || (old_summary != new_summary);
+}
+
+/* Check if entry shares its path hash with a neighbour inside [start, end) */
+static bool fsnap_is_collision(const uint64_t* hashes, size_t start, size_t end, size_t idx) {
+    return ((idx + 1 < end) && (hashes[idx + 1] == hashes[idx]))
+        || ((idx > start) && (hashes[idx - 1] == hashes[idx]));
+}
+
+/* Compare size and mtime columns of matched run, push indices of differing entries */
+static void fsnap_diff_run(
+    const struct fsnap_t* old_snap,
+    size_t old_start,
+    const struct fsnap_t* new_snap,
+    size_t new_start,
+    size_t run_len,
+    struct fsnap_idx_vec_t* modified
+)
+{
+    const int64_t* old_size = old_snap->size + old_start;
+    const int64_t* new_size = new_snap->size + new_start;
+    const int64_t* old_mtime = old_snap->mtime_ns + old_start;
+    const int64_t* new_mtime = new_snap->mtime_ns + new_start;
+    size_t k = 0;
+
+#if defined(__AVX2__)
+    for (; k + 4 <= run_len; k += 4) {
+        const __m256i size_eq = _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i*) (old_size + k)),
+            _mm256_loadu_si256((const __m256i*) (new_size + k))
+        );
+        const __m256i mtime_eq = _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i*) (old_mtime + k)),
+            _mm256_loadu_si256((const __m256i*) (new_mtime + k))
+        );
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_and_si256(size_eq, mtime_eq)));
+
+        if (mask != 0xF) {
+            for (size_t lane = 0; lane < 4; lane++) {
+                if ((mask & (1 << lane)) == 0) {
+                    fsnap_idx_vec_push(modified, new_start + k + lane);
+                }
+            }
+        }
+    }
+#elif defined(__SSE2__)
+    /* SSE2 has no 64-bit compare, both 32-bit halves must match */
+    for (; k + 2 <= run_len; k += 2) {
+        const __m128i size_eq = _mm_cmpeq_epi32(
+            _mm_loadu_si128((const __m128i*) (old_size + k)),
+            _mm_loadu_si128((const __m128i*) (new_size + k))
+        );
+        const __m128i mtime_eq = _mm_cmpeq_epi32(
+            _mm_loadu_si128((const __m128i*) (old_mtime + k)),
+            _mm_loadu_si128((const __m128i*) (new_mtime + k))
+        );
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(size_eq, mtime_eq)));
+
+        if (mask != 0xF) {
+            if ((mask & 0x3) != 0x3) {
+                fsnap_idx_vec_push(modified, new_start + k);
+            }
+            if ((mask & 0xC) != 0xC) {
+                fsnap_idx_vec_push(modified, new_start + k + 1);
+            }
+        }
+    }
+#endif
+
+    for (; k < run_len; k++) {
+        if ((old_size[k] != new_size[k]) || (old_mtime[k] != new_mtime[k])) {
+            fsnap_idx_vec_push(modified, new_start + k);
+        }
+    }
+}
+
+/* Merge primary children of directory pair, matched runs of unique hashes are compared column-wise */
+static void fsnap_diff_primaries(
+    const struct fsnap_t* old_snap,
+    size_t old_start,
+    size_t old_end,
+    const struct fsnap_t* new_snap,
+    size_t new_start,
+    size_t new_end,
+    struct fsnap_diff_t* diff
+)
+{
+    size_t i = old_start;
+    size_t j = new_start;
+
+    while ((i < old_end) && (j < new_end)) {
+        const uint64_t old_hash = old_snap->path_hash[i];
+        const uint64_t new_hash = new_snap->path_hash[j];
+
+        if (old_hash < new_hash) {
+            fsnap_idx_vec_push(&diff->deleted_entries, i++);
+            continue;
+        } else if (old_hash > new_hash) {
+            fsnap_idx_vec_push(&diff->new_entries, j++);
+            continue;
+        }
+
+        /* Hash collision run is ordered by path */
+        if (fsnap_is_collision(old_snap->path_hash, old_start, old_end, i)
+            || fsnap_is_collision(new_snap->path_hash, new_start, new_end, j))
+        {
+            const int cmp = strcmp(fsnap_path(old_snap, i), fsnap_path(new_snap, j));
+
+            if (cmp < 0) {
+                fsnap_idx_vec_push(&diff->deleted_entries, i++);
+            } else if (cmp > 0) {
+                fsnap_idx_vec_push(&diff->new_entries, j++);
+            } else {
+                fsnap_diff_run(old_snap, i++, new_snap, j++, 1, &diff->modified_entries);
+            }
+            continue;
+        }
+
+        /* Extend run of matched unique hashes */
+        size_t run_len = 1;
+        while ((i + run_len < old_end) && (j + run_len < new_end)
+            && (old_snap->path_hash[i + run_len] == new_snap->path_hash[j + run_len])
+            && !fsnap_is_collision(old_snap->path_hash, old_start, old_end, i + run_len)
+            && !fsnap_is_collision(new_snap->path_hash, new_start, new_end, j + run_len))
+        {
+            run_len++;
+        }
+
+        fsnap_diff_run(old_snap, i, new_snap, j, run_len, &diff->modified_entries);
+        i += run_len;
+        j += run_len;
+    }
+
+    for (; i < old_end; i++) {
+        fsnap_idx_vec_push(&diff->deleted_entries, i);
+    }
+    for (; j < new_end; j++) {
+        fsnap_idx_vec_push(&diff->new_entries, j);
+    }
+}
+
+/* Merge hard link aliases of directory pair */
+static void fsnap_diff_aliases(
+    const struct fsnap_t* old_snap,
+    size_t old_start,
+    size_t old_end,
+    const struct fsnap_t* new_snap,
+    size_t new_start,
+    size_t new_end,
+    struct fsnap_diff_t* diff
+)
+{
+    size_t i = old_snap->len + old_start;
+    size_t j = new_snap->len + new_start;
+    old_end += old_snap->len;
+    new_end += new_snap->len;
+
+    while ((i < old_end) && (j < new_end)) {
+        const int cmp = fsnap_entry_cmp(old_snap, i, new_snap, j);
+
+        if (cmp < 0) {
+            fsnap_idx_vec_push(&diff->deleted_entries, i++);
+        } else if (cmp > 0) {
+            fsnap_idx_vec_push(&diff->new_entries, j++);
+        } else {
+            if (!fsnap_meta_equals(old_snap, i, new_snap, j)) {
+                fsnap_idx_vec_push(&diff->modified_entries, j);
+            }
+            i++;
+            j++;
+        }
+    }
+
+    for (; i < old_end; i++) {
+        fsnap_idx_vec_push(&diff->deleted_entries, i);
+    }
+    for (; j < new_end; j++) {
+        fsnap_idx_vec_push(&diff->new_entries, j);
+    }
+}
+
+/*
+ * Path may be primary in one snapshot and alias in the other: pair deleted
+ * entries of [deleted_start, deleted_end) with new entries of [new_start,
+ * new_end) by path, both ranges are in (hash, path) order. Paired entries
+ * are marked with SIZE_MAX.
+ */
+static void fsnap_diff_links(
+    const struct fsnap_t* old_snap,
+    size_t deleted_start,
+    size_t deleted_end,
+    const struct fsnap_t* new_snap,
+    size_t new_start,
+    size_t new_end,
+    struct fsnap_diff_t* diff
+)
+{
+    size_t* deleted = diff->deleted_entries.buffer;
+    size_t* added = diff->new_entries.buffer;
+    size_t i = deleted_start;
+    size_t j = new_start;
+
+    while ((i < deleted_end) && (j < new_end)) {
+        const int cmp = fsnap_entry_cmp(old_snap, deleted[i], new_snap, added[j]);
+
+        if (cmp < 0) {
+            i++;
+        } else if (cmp > 0) {
+            j++;
+        } else {
+            if (!fsnap_meta_equals(old_snap, deleted[i], new_snap, added[j])) {
+                fsnap_idx_vec_push(&diff->modified_entries, added[j]);
+            }
+            deleted[i++] = SIZE_MAX;
+            added[j++] = SIZE_MAX;
+        }
+    }
+}
+
+/* Drop entries marked by fsnap_diff_links from start on */
+static void fsnap_idx_vec_compact(struct fsnap_idx_vec_t* self, size_t start) {
+    size_t kept = start;
+
+    for (size_t i = start; i < self->len; i++) {
+        if (self->buffer[i] != SIZE_MAX) {
+            self->buffer[kept++] = self->buffer[i];
+        }
+    }
+    self->len = kept;
+}
+
+/* Merge children of directory pair, either directory may be missing */
+static void fsnap_diff_entries(
+    const struct fsnap_t* old_snap,
+    size_t old_dir,
+    const struct fsnap_t* new_snap,
+    size_t new_dir,
+    struct fsnap_diff_t* diff
+)
+{
+    const bool has_old = (old_dir != FSNAP_DIR_NONE);
+    const bool has_new = (new_dir != FSNAP_DIR_NONE);
+    const size_t deleted_start = diff->deleted_entries.len;
+    const size_t new_start = diff->new_entries.len;
+
+    fsnap_diff_primaries(old_snap,
+        has_old ? old_snap->dir_entry_off[old_dir] : 0,
+        has_old ? old_snap->dir_entry_off[old_dir + 1] : 0,
+        new_snap,
+        has_new ? new_snap->dir_entry_off[new_dir] : 0,
+        has_new ? new_snap->dir_entry_off[new_dir + 1] : 0,
+        diff
+    );
+
+    const size_t old_alias_start = has_old ? old_snap->dir_alias_off[old_dir] : 0;
+    const size_t old_alias_end = has_old ? old_snap->dir_alias_off[old_dir + 1] : 0;
+    const size_t new_alias_start = has_new ? new_snap->dir_alias_off[new_dir] : 0;
+    const size_t new_alias_end = has_new ? new_snap->dir_alias_off[new_dir + 1] : 0;
+
+    if ((old_alias_start == old_alias_end) && (new_alias_start == new_alias_end)) {
+        return;
+    }
+
+    const size_t deleted_mid = diff->deleted_entries.len;
+    const size_t new_mid = diff->new_entries.len;
+
+    fsnap_diff_aliases(old_snap, old_alias_start, old_alias_end, new_snap, new_alias_start, new_alias_end, diff);
+
+    /* Deleted primary entries against new aliases, deleted aliases against new primary entries */
+    fsnap_diff_links(old_snap, deleted_start, deleted_mid, new_snap, new_mid, diff->new_entries.len, diff);
+    fsnap_diff_links(old_snap, deleted_mid, diff->deleted_entries.len, new_snap, new_start, new_mid, diff);
+    fsnap_idx_vec_compact(&diff->deleted_entries, deleted_start);
+    fsnap_idx_vec_compact(&diff->new_entries, new_start);
+}
+
+void fsnap_diff(const struct fsnap_t* old_snap, const struct fsnap_t* new_snap, struct fsnap_diff_t* diff) {
+    if ((old_snap == NULL) || (new_snap == NULL) || (diff == NULL)) {
+        return;
+    }
+
+    memset(diff, 0, sizeof(struct fsnap_diff_t));
+
+    /* Stack of directory pairs with the same path, starting from top level */
+    struct fsnap_idx_vec_t stack;
+    memset(&stack, 0, sizeof(struct fsnap_idx_vec_t));
+
+    size_t old_dir = FSNAP_DIR_NONE;
+    size_t new_dir = FSNAP_DIR_NONE;
+    fsnap_find_dir(old_snap, "", 0, &old_dir);
+    fsnap_find_dir(new_snap, "", 0, &new_dir);
+
+    if ((old_dir != FSNAP_DIR_NONE) || (new_dir != FSNAP_DIR_NONE)) {
+        fsnap_idx_vec_push(&stack, old_dir);
+        fsnap_idx_vec_push(&stack, new_dir);
+    }
+
+    while (stack.len > 0) {
+        new_dir = stack.buffer[--stack.len];
+        old_dir = stack.buffer[--stack.len];
+
+        if ((old_dir != FSNAP_DIR_NONE) && (new_dir != FSNAP_DIR_NONE)
+            && (old_snap->dir_summary[old_dir] == new_snap->dir_summary[new_dir]))
+        {
+            continue;
+        }
+
+        fsnap_diff_entries(old_snap, old_dir, new_snap, new_dir, diff);
+
+        /* Pair subdirectories by path hash, then path */
+        size_t i = (old_dir != FSNAP_DIR_NONE) ? old_snap->dir_sub_off[old_dir] : 0;
+        size_t j = (new_dir != FSNAP_DIR_NONE) ? new_snap->dir_sub_off[new_dir] : 0;
+        const size_t old_end = (old_dir != FSNAP_DIR_NONE) ? old_snap->dir_sub_off[old_dir + 1] : 0;
+        const size_t new_end = (new_dir != FSNAP_DIR_NONE) ? new_snap->dir_sub_off[new_dir + 1] : 0;
+
+        while ((i < old_end) || (j < new_end)) {
+            const int cmp = (i == old_end) ? 1
+                : (j == new_end) ? -1
+                : fsnap_dir_cmp(old_snap, old_snap->dir_subs[i], new_snap, new_snap->dir_subs[j]);
+
+            fsnap_idx_vec_push(&stack, (cmp <= 0) ? old_snap->dir_subs[i++] : FSNAP_DIR_NONE);
+            fsnap_idx_vec_push(&stack, (cmp >= 0) ? new_snap->dir_subs[j++] : FSNAP_DIR_NONE);
+        }
+    }
+
+    free(stack.buffer);
+}
+
+void fsnap_diff_clean(struct fsnap_diff_t* diff) {
+    if (diff == NULL) {
+        return;
+    }
+
+    free(diff->new_entries.buffer);
+    free(diff->deleted_entries.buffer);
+    free(diff->modified_entries.buffer);
+    memset(diff, 0, sizeof(struct fsnap_diff_t));
+}
+
+/* Index columns are stored as 64-bit values */
+static bool fsnap_write_idx_column(const size_t* column, size_t len, FILE* fout) {
+    for (size_t i = 0; i < len; i++) {
+        const uint64_t value = (uint64_t) column[i];
+        if (fwrite(&value, sizeof(uint64_t), 1, fout) != 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Read index column, all values must be less than limit */
+static bool fsnap_read_idx_column(size_t* column, size_t len, size_t limit, FILE* fin) {
+    for (size_t i = 0; i < len; i++) {
+        uint64_t value = 0;
+        if ((fread(&value, sizeof(uint64_t), 1, fin) != 1) || (value >= (uint64_t) limit)) {
+            return false;
+        }
+        column[i] = (size_t) value;
+    }
+
+    return true;
+}
+
+bool fsnap_write(const struct fsnap_t* self, FILE* fout) {
+    if ((self == NULL) || (fout == NULL) || !self->sorted) {
+        return false;
+    }
+
+    struct fsnap_file_header_t header;
+    memset(&header, 0, sizeof(struct fsnap_file_header_t));
+    memcpy(header.magic, FSNAP_FILE_MAGIC, sizeof(header.magic));
+    header.version = FSNAP_FILE_VERSION;
+    header.len = self->len;
+    header.paths_len = self->paths_len;
+    header.alias_len = self->alias_len;
+
+    const size_t len = self->len;
+    const size_t alias_len = self->alias_len;
+
+    return (fwrite(&header, sizeof(header), 1, fout) == 1)
+        && (fwrite(self->path_hash, sizeof(uint64_t), len, fout) == len)
+        && (fwrite(self->size, sizeof(int64_t), len, fout) == len)
+        && (fwrite(self->mtime_ns, sizeof(int64_t), len, fout) == len)
+        && (fwrite(self->ino, sizeof(uint64_t), len, fout) == len)
+        && fsnap_write_idx_column(self->path_off, len, fout)
+        && (fwrite(self->paths, sizeof(char), self->paths_len, fout) == self->paths_len)
+        && ((alias_len == 0)
+            || ((fwrite(self->alias_hash, sizeof(uint64_t), alias_len, fout) == alias_len)
+                && fsnap_write_idx_column(self->alias_path_off, alias_len, fout)
+                && fsnap_write_idx_column(self->alias_target, alias_len, fout)));
+}
+
+struct fsnap_t* fsnap_read(FILE* fin) {
+    if (fin == NULL) {
+        return NULL;
+    }
+
+    struct fsnap_file_header_t header;
+    if ((fread(&header, sizeof(header), 1, fin) != 1)
+        || (memcmp(header.magic, FSNAP_FILE_MAGIC, sizeof(header.magic)) != 0)
+        || (header.version != FSNAP_FILE_VERSION))
+    {
+        return NULL;
+    }
+
+    struct fsnap_t* snap = fsnap_new();
+    const size_t len = (size_t) header.len;
+    const size_t paths_len = (size_t) header.paths_len;
+    const size_t alias_len = (size_t) header.alias_len;
+
+    size_t cap = snap->cap;
+    while (cap < len) {
+        cap *= 2;
+    }
+    fsnap_reserve(snap, cap);
+
+    if (paths_len > snap->paths_cap) {
+        snap->paths_cap = paths_len;
+        snap->paths = (char*) realloc(snap->paths, snap->paths_cap * sizeof(char));
+    }
+
+    snap->alias_len = alias_len;
+    snap->alias_hash = (uint64_t*) malloc((alias_len + 1) * sizeof(uint64_t));
+    snap->alias_path_off = (size_t*) malloc((alias_len + 1) * sizeof(size_t));
+    snap->alias_target = (size_t*) malloc((alias_len + 1) * sizeof(size_t));
+
+    bool is_read = (fread(snap->path_hash, sizeof(uint64_t), len, fin) == len)
+        && (fread(snap->size, sizeof(int64_t), len, fin) == len)
+        && (fread(snap->mtime_ns, sizeof(int64_t), len, fin) == len)
+        && (fread(snap->ino, sizeof(uint64_t), len, fin) == len)
+        && fsnap_read_idx_column(snap->path_off, len, paths_len, fin)
+        && (fread(snap->paths, sizeof(char), paths_len, fin) == paths_len)
+        && (fread(snap->alias_hash, sizeof(uint64_t), alias_len, fin) == alias_len)
+        && fsnap_read_idx_column(snap->alias_path_off, alias_len, paths_len, fin)
+        && fsnap_read_idx_column(snap->alias_target, alias_len, len, fin);
+
+    /* Path pool must be terminated */
+    if (is_read && (paths_len > 0) && (snap->paths[paths_len - 1] != '\0')) {
+        is_read = false;
+    }
+
+    if (!is_read) {
+        fsnap_drop(&snap);
+        return NULL;
+    }
+
+    snap->len = len;
+    snap->paths_len = paths_len;
+    snap->sorted = true;
+    fsnap_index_dirs(snap);
+    return snap;
+}
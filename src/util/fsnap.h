@@ -0,0 +1,177 @@
+/**
+ * @file fsnap.h
+ * @date 18 Oct 2026
+ * @brief Column-oriented file tree snapshot
+ *
+ * Snapshot keeps file metadata in contiguous columns. Sealed snapshot has
+ * children of each directory next to each other, sorted by path hash, so
+ * children of the same directory in two snapshots are compared with a single
+ * merge pass over matched runs of the size and mtime columns. Entries are
+ * identified by 64-bit path hash, paths are only compared on hash collision
+ * inside one snapshot.
+ *
+ * Hard linked files are stored once: extra paths of the same inode are kept
+ * as aliases of the primary entry. Entry indices in [0, len) refer to primary
+ * entries, indices in [len, len + alias_len) refer to aliases.
+ *
+ * Sealed snapshot also has a directory index: every parent path of an entry
+ * (and all its ancestors, up to the empty top level path) with its children,
+ * subdirectories and a summary hash of metadata of all entries below it.
+ * Equal summaries mean equal subtrees, so diff descends only into changed
+ * directories. Directories are keyed by path hash, their paths are compared
+ * on hash collision as for entries.
+ */
+
+#ifndef __UTIL_FSNAP_H__
+#define __UTIL_FSNAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <sys/stat.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define FSNAP_DEFAULT_CAP       ((size_t) 1024)
+#define FSNAP_PATHS_DEFAULT_CAP ((size_t) 65536)
+#define FSNAP_IDX_VEC_DEFAULT_CAP ((size_t) 64)
+
+#define FSNAP_HASH_INIT ((uint64_t) 0xcbf29ce484222325ULL)
+
+#define FSNAP_FILE_MAGIC   "DWSNAP01"
+#define FSNAP_FILE_VERSION ((uint32_t) 2)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct fsnap_link_t {
+    uint64_t dev;
+    uint64_t ino;
+    size_t idx;
+};
+
+struct fsnap_t {
+    size_t cap;
+    size_t len;
+    bool sorted;
+
+    /* Columns */
+    uint64_t* path_hash;
+    int64_t* size;
+    int64_t* mtime_ns;
+    uint64_t* ino;
+    size_t* path_off;
+
+    /* Path string pool */
+    size_t paths_cap;
+    size_t paths_len;
+    char* paths;
+
+    /* Hard link candidates of unsealed snapshot */
+    size_t links_cap;
+    size_t links_len;
+    struct fsnap_link_t* links;
+
+    /* Extra hard link paths, grouped by directory as columns */
+    size_t alias_len;
+    uint64_t* alias_hash;
+    size_t* alias_path_off;
+    size_t* alias_target;
+
+    /* Directory index of sealed snapshot, sorted by directory path hash, then path */
+    size_t dir_len;
+    uint64_t* dir_hash;
+    size_t* dir_path_off;  /* Directory path is the first dir_path_len[i] bytes of a pool path */
+    size_t* dir_path_len;
+    uint64_t* dir_summary;
+    size_t* dir_entry_off; /* Primary entries of directory i are [dir_entry_off[i], dir_entry_off[i + 1]) */
+    size_t* dir_alias_off; /* Aliases of directory i are len + [dir_alias_off[i], dir_alias_off[i + 1]) */
+    size_t* dir_sub_off;   /* Subdirectories of directory i are dir_subs[dir_sub_off[i], dir_sub_off[i + 1]) */
+    size_t* dir_subs;      /* Directory indices */
+};
+
+/* Snapshot file header, followed by columns and path pool in native byte order */
+struct fsnap_file_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t len;
+    uint64_t paths_len;
+    uint64_t alias_len;
+};
+
+struct fsnap_idx_vec_t {
+    size_t cap;
+    size_t len;
+    size_t* buffer;
+};
+
+struct fsnap_diff_t {
+    struct fsnap_idx_vec_t new_entries;      /* Indices into the new snapshot */
+    struct fsnap_idx_vec_t deleted_entries;  /* Indices into the old snapshot */
+    struct fsnap_idx_vec_t modified_entries; /* Indices into the new snapshot */
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+uint64_t fsnap_hash_path(const char* path);
+
+/* Extend path hash with len bytes, fsnap_hash_path(p) == fsnap_hash_update(FSNAP_HASH_INIT, p, strlen(p)) */
+uint64_t fsnap_hash_update(uint64_t hash, const char* data, size_t len);
+
+struct fsnap_t* fsnap_new();
+
+void fsnap_drop(struct fsnap_t** self);
+
+void fsnap_push(struct fsnap_t* self, const char* path, const struct stat* file_stat);
+
+/* Copy entry of other snapshot, hard link aliases are copied as primary entries */
+void fsnap_push_copy(struct fsnap_t* self, const struct fsnap_t* src, size_t idx);
+
+/* Move all entries of other to self, other is left empty */
+void fsnap_append(struct fsnap_t* self, struct fsnap_t* other);
+
+/* Move entries below directory from to directory to, snapshot must not be sealed */
+void fsnap_rename_dir(struct fsnap_t* self, const char* from, const char* to);
+
+/* Remove all entries, allocated columns and path pool are kept */
+void fsnap_clear(struct fsnap_t* self);
+
+/* Release unused capacity of sealed snapshot which is kept for long */
+void fsnap_shrink(struct fsnap_t* self);
+
+/* Group entries by directory sorted by path hash, drop duplicate paths and fold hard links */
+void fsnap_seal(struct fsnap_t* self);
+
+/* Number of paths including hard link aliases */
+size_t fsnap_len(const struct fsnap_t* self);
+
+/* Index of primary entry holding metadata of entry */
+size_t fsnap_primary(const struct fsnap_t* self, size_t idx);
+
+const char* fsnap_path(const struct fsnap_t* self, size_t idx);
+
+bool fsnap_find(const struct fsnap_t* self, const char* path, size_t* idx);
+
+/* Summary hash of all entries below directory, false if snapshot has no entries below it */
+bool fsnap_dir_summary(const struct fsnap_t* self, const char* dir, uint64_t* summary);
+
+/* Check if anything below directory differs, both snapshots must be sealed */
+bool fsnap_subtree_changed(const struct fsnap_t* old_snap, const struct fsnap_t* new_snap, const char* dir);
+
+/* Both snapshots must be sealed, unchanged subtrees are skipped */
+void fsnap_diff(const struct fsnap_t* old_snap, const struct fsnap_t* new_snap, struct fsnap_diff_t* diff);
+
+void fsnap_diff_clean(struct fsnap_diff_t* diff);
+
+/* Snapshot must be sealed */
+bool fsnap_write(const struct fsnap_t* self, FILE* fout);
+
+struct fsnap_t* fsnap_read(FILE* fin);
+
+void fsnap_idx_vec_push(struct fsnap_idx_vec_t* self, size_t idx);
+
+#endif /* __UTIL_FSNAP_H__ */
@@ -0,0 +1,154 @@
+/**
+ * @file fsnap_pub.c
+ * @date 18 Oct 2026
+ * @brief Generation-based publishing of sealed snapshots
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <time.h>
+
+#include "fsnap.h"
+#include "fsnap_pub.h"
+
+/* All atomics use sequentially consistent order: reclaim reads hazard slots
+ * before reference counts, acquire publishes its hazard before it checks the
+ * current pointer again, both rely on a single total order of these accesses */
+
+static void fsnap_pub_free_gen(struct fsnap_gen_t* gen) {
+    fsnap_drop(&gen->snap);
+    free(gen);
+}
+
+static bool fsnap_pub_is_hazard(struct fsnap_pub_t* self, const struct fsnap_gen_t* gen) {
+    for (size_t i = 0; i < FSNAP_PUB_HAZARDS; i++) {
+        if (atomic_load(&self->hazards[i]) == gen) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+struct fsnap_pub_t* fsnap_pub_new() {
+    struct fsnap_pub_t* new_pub = (struct fsnap_pub_t*) calloc(1, sizeof(struct fsnap_pub_t));
+
+    atomic_init(&new_pub->current, NULL);
+    for (size_t i = 0; i < FSNAP_PUB_HAZARDS; i++) {
+        atomic_init(&new_pub->hazards[i], NULL);
+    }
+
+    return new_pub;
+}
+
+void fsnap_pub_drop(struct fsnap_pub_t** self) {
+    if ((self == NULL) || (*self == NULL)) {
+        return;
+    }
+
+    struct fsnap_pub_t* pub = *self;
+    struct fsnap_gen_t* current = atomic_load(&pub->current);
+    if (current != NULL) {
+        fsnap_pub_free_gen(current);
+    }
+
+    while (pub->retired != NULL) {
+        struct fsnap_gen_t* gen = pub->retired;
+        pub->retired = gen->next_retired;
+        fsnap_pub_free_gen(gen);
+    }
+
+    free(pub);
+    *self = NULL;
+}
+
+uint64_t fsnap_pub_publish(struct fsnap_pub_t* self, struct fsnap_t* snap) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    struct fsnap_gen_t* gen = (struct fsnap_gen_t*) calloc(1, sizeof(struct fsnap_gen_t));
+    gen->snap = snap;
+    gen->generation = ++self->generation;
+    gen->published_ns = (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+    atomic_init(&gen->refs, 0);
+
+    struct fsnap_gen_t* old_gen = atomic_exchange(&self->current, gen);
+    if (old_gen != NULL) {
+        old_gen->next_retired = self->retired;
+        self->retired = old_gen;
+        self->retired_len++;
+    }
+
+    fsnap_pub_reclaim(self);
+    return gen->generation;
+}
+
+const struct fsnap_t* fsnap_pub_latest(const struct fsnap_pub_t* self) {
+    /* Only the writer changes current, its own load needs no ordering */
+    struct fsnap_gen_t* gen = atomic_load_explicit(&((struct fsnap_pub_t*) self)->current, memory_order_relaxed);
+    return (gen != NULL) ? gen->snap : NULL;
+}
+
+size_t fsnap_pub_reclaim(struct fsnap_pub_t* self) {
+    struct fsnap_gen_t** p_link = &self->retired;
+
+    while (*p_link != NULL) {
+        struct fsnap_gen_t* gen = *p_link;
+
+        /* Reader which took its reference after this check had announced the generation before */
+        if (!fsnap_pub_is_hazard(self, gen) && (atomic_load(&gen->refs) == 0)) {
+            *p_link = gen->next_retired;
+            self->retired_len--;
+            fsnap_pub_free_gen(gen);
+        } else {
+            p_link = &gen->next_retired;
+        }
+    }
+
+    return self->retired_len;
+}
+
+struct fsnap_gen_t* fsnap_pub_acquire(struct fsnap_pub_t* self) {
+    while (true) {
+        struct fsnap_gen_t* gen = atomic_load(&self->current);
+        if (gen == NULL) {
+            return NULL;
+        }
+
+        /* Slots are held for a few instructions only, all of them busy is rare */
+        size_t slot = FSNAP_PUB_HAZARDS;
+        for (size_t i = 0; (i < FSNAP_PUB_HAZARDS) && (slot == FSNAP_PUB_HAZARDS); i++) {
+            struct fsnap_gen_t* expected = NULL;
+            if (atomic_compare_exchange_strong(&self->hazards[i], &expected, gen)) {
+                slot = i;
+            }
+        }
+
+        if (slot == FSNAP_PUB_HAZARDS) {
+            sched_yield();
+            continue;
+        }
+
+        /* Still current after announcing it, so it was not retired before reclaim could see the hazard */
+        const bool is_current = (atomic_load(&self->current) == gen);
+        if (is_current) {
+            atomic_fetch_add(&gen->refs, 1);
+        }
+        atomic_store(&self->hazards[slot], NULL);
+
+        if (is_current) {
+            return gen;
+        }
+    }
+}
+
+void fsnap_pub_release(struct fsnap_gen_t* gen) {
+    if (gen != NULL) {
+        atomic_fetch_sub(&gen->refs, 1);
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file fsnap_pub.h
+ * @date 18 Oct 2026
+ * @brief Generation-based publishing of sealed snapshots
+ *
+ * One writer publishes sealed snapshots, any number of reader threads take
+ * the latest one without locks. Published snapshot is never modified, each
+ * publish installs a new generation with a single atomic pointer swap and
+ * retires the previous one.
+ *
+ * Readers hold reference counts. Between loading the current pointer and
+ * incrementing its count a reader announces the generation in a hazard slot,
+ * so the writer does not free it in that window. Only the writer frees
+ * retired generations: on publish or reclaim, once no hazard slot holds
+ * them and their count is zero. Readers therefore never wait for the
+ * writer, the writer never waits for readers.
+ */
+
+#ifndef __UTIL_FSNAP_PUB_H__
+#define __UTIL_FSNAP_PUB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "fsnap.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define FSNAP_PUB_HAZARDS ((size_t) 64)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct fsnap_gen_t {
+    struct fsnap_t* snap; /* Sealed, read only */
+    uint64_t generation;  /* 1 for the first published snapshot */
+    int64_t published_ns; /* Realtime clock */
+    _Atomic size_t refs;  /* Reader references */
+    struct fsnap_gen_t* next_retired;
+};
+
+struct fsnap_pub_t {
+    _Atomic(struct fsnap_gen_t*) current;
+    _Atomic(struct fsnap_gen_t*) hazards[FSNAP_PUB_HAZARDS];
+
+    /* Writer side */
+    uint64_t generation;
+    size_t retired_len;
+    struct fsnap_gen_t* retired;
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+struct fsnap_pub_t* fsnap_pub_new();
+
+/* Free all generations, no reader may use them anymore */
+void fsnap_pub_drop(struct fsnap_pub_t** self);
+
+/* Writer: publish sealed snapshot, which is owned by publisher from now on. Returns its generation */
+uint64_t fsnap_pub_publish(struct fsnap_pub_t* self, struct fsnap_t* snap);
+
+/* Writer: latest published snapshot without reference, NULL before first publish */
+const struct fsnap_t* fsnap_pub_latest(const struct fsnap_pub_t* self);
+
+/* Writer: free retired generations without readers, returns number still retained */
+size_t fsnap_pub_reclaim(struct fsnap_pub_t* self);
+
+/* Reader: reference to latest generation, NULL before first publish. Must be released */
+struct fsnap_gen_t* fsnap_pub_acquire(struct fsnap_pub_t* self);
+
+/* Reader: drop reference, generation is freed later by the writer */
+void fsnap_pub_release(struct fsnap_gen_t* gen);
+
+#endif /* __UTIL_FSNAP_PUB_H__ */
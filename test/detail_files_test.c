@@ -0,0 +1,79 @@
+/**
+ * @file detail_files_test.c
+ * @date 18 Oct 2026
+ * @brief Detail file retention tests on temporary directory
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <unistd.h>
+
+#include "test.h"
+#include "tree.h"
+#include "../src/util/detail_files.h"
+
+static bool file_exists(const struct tree_t* tree, const char* name) {
+    char path[PATH_MAX];
+    return tree_path(tree, name, path) && (access(path, F_OK) == 0);
+}
+
+static void test_detail_files_init() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "detail_files")) {
+        return;
+    }
+
+    /* Files of earlier runs, the longer second count is newer */
+    tree_write(&tree, "storm-999999999-000000005.tsv", "");
+    tree_write(&tree, "storm-1000000000-000000001.tsv", "");
+    tree_write(&tree, "storm-1000000000-000000002.tsv", "");
+    tree_write(&tree, "storm-1000000001-000000000.tsv", "");
+    tree_write(&tree, "storm-1000000001.tsv", "");
+    tree_write(&tree, "delta-1-000000000.tsv", "");
+    tree_write(&tree, "storm-1-000000000.tsv.tmp", "");
+
+    struct detail_files_t files;
+    detail_files_init(&files, tree.root, "storm-", 3);
+    TEST_ASSERT(files.len == 3);
+    TEST_ASSERT(!file_exists(&tree, "storm-999999999-000000005.tsv"));
+    TEST_ASSERT(file_exists(&tree, "storm-1000000000-000000001.tsv"));
+
+    /* Other files are left alone */
+    TEST_ASSERT(file_exists(&tree, "storm-1000000001.tsv"));
+    TEST_ASSERT(file_exists(&tree, "delta-1-000000000.tsv"));
+    TEST_ASSERT(file_exists(&tree, "storm-1-000000000.tsv.tmp"));
+
+    /* Oldest listed file makes room for the new one */
+    char path[PATH_MAX];
+    tree_write(&tree, "storm-1000000002-000000000.tsv", "");
+    TEST_ASSERT(tree_path(&tree, "storm-1000000002-000000000.tsv", path));
+    detail_files_push(&files, path);
+    TEST_ASSERT(files.len == 3);
+    TEST_ASSERT(!file_exists(&tree, "storm-1000000000-000000001.tsv"));
+    TEST_ASSERT(file_exists(&tree, "storm-1000000000-000000002.tsv"));
+    TEST_ASSERT(strcmp(files.paths[2], path) == 0);
+
+    detail_files_clean(&files);
+    TEST_ASSERT((files.paths == NULL) && (files.len == 0));
+    TEST_ASSERT(file_exists(&tree, "storm-1000000002-000000000.tsv"));
+
+    /* Missing directory lists nothing */
+    TEST_ASSERT(tree_path(&tree, "missing", path));
+    detail_files_init(&files, path, "storm-", 3);
+    TEST_ASSERT(files.len == 0);
+    detail_files_clean(&files);
+
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_detail_files_init);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
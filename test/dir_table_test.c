@@ -0,0 +1,89 @@
+/**
+ * @file dir_table_test.c
+ * @date 18 Oct 2026
+ * @brief Directory table correctness tests
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "test.h"
+#include "../src/util/dir_table.h"
+
+struct test_dir_t {
+    struct dir_key_t key;
+    uint64_t value;
+};
+
+static bool test_dir_is_even(const void* ctx, const void* elem) {
+    (void) ctx;
+    return (((const struct test_dir_t*) elem)->value % 2) == 0;
+}
+
+static void test_dir_table_insert_grow() {
+    struct dir_table_t table;
+    dir_table_init(&table, sizeof(struct test_dir_t), 4);
+
+    const uint64_t count = 1000;
+    for (uint64_t i = 0; i < count; i++) {
+        struct test_dir_t* dir = (struct test_dir_t*) dir_table_insert(&table, i * 7);
+        TEST_ASSERT((dir->key.hash == i * 7) && (dir->value == 0));
+        dir->value = i;
+    }
+
+    TEST_ASSERT(table.len == count);
+    TEST_ASSERT(2 * table.len <= table.cap);
+
+    /* Existing element is returned as is */
+    TEST_ASSERT(((struct test_dir_t*) dir_table_insert(&table, 7))->value == 1);
+    TEST_ASSERT(table.len == count);
+
+    for (uint64_t i = 0; i < count; i++) {
+        const struct test_dir_t* dir = (const struct test_dir_t*) dir_table_find(&table, i * 7);
+        TEST_ASSERT((dir != NULL) && (dir->value == i));
+    }
+    TEST_ASSERT(dir_table_find(&table, 3) == NULL);
+
+    dir_table_clean(&table);
+    TEST_ASSERT((table.buffer == NULL) && (table.len == 0));
+}
+
+static void test_dir_table_rebuild_clear() {
+    struct dir_table_t table;
+    dir_table_init(&table, sizeof(struct test_dir_t), 16);
+
+    for (uint64_t i = 0; i < 6; i++) {
+        ((struct test_dir_t*) dir_table_insert(&table, i))->value = i;
+    }
+
+    dir_table_rebuild(&table, table.cap, test_dir_is_even, NULL);
+    TEST_ASSERT(table.len == 3);
+    TEST_ASSERT((dir_table_find(&table, 4) != NULL) && (dir_table_find(&table, 5) == NULL));
+
+    size_t used = 0;
+    for (size_t i = 0; i < table.cap; i++) {
+        used += (dir_table_at(&table, i) != NULL) ? 1 : 0;
+    }
+    TEST_ASSERT(used == 3);
+
+    dir_table_clear(&table);
+    TEST_ASSERT((table.len == 0) && (dir_table_find(&table, 4) == NULL));
+    TEST_ASSERT(((struct test_dir_t*) dir_table_insert(&table, 4))->value == 0);
+
+    dir_table_clean(&table);
+}
+
+static void test_dir_table_trim() {
+    TEST_ASSERT(dir_table_trim("/a/b//", 6) == 4);
+    TEST_ASSERT(dir_table_trim("/a/b", 4) == 4);
+    TEST_ASSERT(dir_table_trim("/", 1) == 0);
+}
+
+int main() {
+    TEST_RUN(test_dir_table_insert_grow);
+    TEST_RUN(test_dir_table_rebuild_clear);
+    TEST_RUN(test_dir_table_trim);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
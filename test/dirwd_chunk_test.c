@@ -0,0 +1,282 @@
+/**
+ * @file dirwd_chunk_test.c
+ * @date 18 Oct 2026
+ * @brief Chunk-level delta detection tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dirent.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_chunk.h"
+
+#define TEST_CHUNK_BYTES ((size_t) 4096)
+
+static char test_dir[64];
+static char table_dir[128];
+
+static struct dirwd_chunk_t* chunk_new() {
+    struct dirwd_chunk_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.enabled = true;
+    strcpy(opts.pattern, "*.img");
+    opts.chunk_bytes = TEST_CHUNK_BYTES;
+    strcpy(opts.dir, table_dir);
+
+    return dirwd_chunk_new(&opts);
+}
+
+/* Write len bytes of value at offset and set modification time to mtime_sec */
+static void file_write(const char* path, off_t offset, size_t len, unsigned char value, time_t mtime_sec) {
+    const int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    unsigned char* buffer = (unsigned char*) malloc(len);
+    memset(buffer, value, len);
+    TEST_ASSERT(pwrite(fd, buffer, len, offset) == (ssize_t) len);
+    free(buffer);
+
+    const struct timespec times[2] = { { .tv_sec = mtime_sec, .tv_nsec = 0 }, { .tv_sec = mtime_sec, .tv_nsec = 0 } };
+    futimens(fd, times);
+    close(fd);
+}
+
+static size_t dir_count(const char* dir, const char* suffix) {
+    DIR* const d = opendir(dir);
+    size_t count = 0;
+    const struct dirent* entry = NULL;
+
+    while ((d != NULL) && ((entry = readdir(d)) != NULL)) {
+        const size_t len = strlen(entry->d_name);
+        count += (len > strlen(suffix)) && (strcmp(entry->d_name + len - strlen(suffix), suffix) == 0);
+    }
+
+    if (d != NULL) {
+        closedir(d);
+    }
+    return count;
+}
+
+static void test_dirwd_chunk_hash() {
+    unsigned char data[1000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (unsigned char) (i * 7);
+    }
+
+    const uint64_t hash = dirwd_chunk_hash(data, sizeof(data));
+    TEST_ASSERT(hash == dirwd_chunk_hash(data, sizeof(data)));
+    TEST_ASSERT(hash != dirwd_chunk_hash(data, sizeof(data) - 1));
+
+    /* Every single byte change is detected, in word lanes and in tail */
+    size_t collisions = 0;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] ^= 0x10;
+        collisions += dirwd_chunk_hash(data, sizeof(data)) == hash;
+        data[i] ^= 0x10;
+    }
+    TEST_ASSERT(collisions == 0);
+
+    unsigned char zeros[64] = { 0 };
+    TEST_ASSERT(dirwd_chunk_hash(zeros, 32) != dirwd_chunk_hash(zeros, 64));
+}
+
+static void test_dirwd_chunk_file() {
+    struct dirwd_chunk_t* chunks = chunk_new();
+    struct dirwd_chunk_ranges_t ranges = { .cap = 0, .len = 0, .buffer = NULL, .size = 0, .removed = 0 };
+    bool has_table = true;
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/disk.img", test_dir);
+    file_write(path, 0, 10 * TEST_CHUNK_BYTES, 'a', 1000);
+
+    /* First pass has nothing to compare with */
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(!has_table && (ranges.len == 1));
+    TEST_ASSERT((ranges.buffer[0].offset == 0) && (ranges.buffer[0].length == 10 * TEST_CHUNK_BYTES));
+    TEST_ASSERT((chunks->files_hashed == 1) && (chunks->bytes_read == 10 * TEST_CHUNK_BYTES));
+
+    /* Unchanged file is not read */
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 0));
+    TEST_ASSERT((chunks->files_hashed == 1) && (chunks->files_unchanged == 1));
+
+    /* Patch and append */
+    file_write(path, 3 * TEST_CHUNK_BYTES + 100, 10, 'b', 2000);
+    file_write(path, 10 * TEST_CHUNK_BYTES, 5000, 'c', 2000);
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 2));
+    TEST_ASSERT((ranges.buffer[0].offset == 3 * TEST_CHUNK_BYTES) && (ranges.buffer[0].length == TEST_CHUNK_BYTES));
+    TEST_ASSERT((ranges.buffer[1].offset == 10 * TEST_CHUNK_BYTES) && (ranges.buffer[1].length == 5000));
+
+    /* Adjacent changed chunks form one range, rewrite with same content is no change */
+    file_write(path, 6 * TEST_CHUNK_BYTES - 1, 2, 'd', 3000);
+    file_write(path, 0, 1, 'a', 3000);
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 1));
+    TEST_ASSERT((ranges.buffer[0].offset == 5 * TEST_CHUNK_BYTES) && (ranges.buffer[0].length == 2 * TEST_CHUNK_BYTES));
+
+    /* Shrunk file reports its new last chunk and the removed tail */
+    TEST_ASSERT(truncate(path, 4 * TEST_CHUNK_BYTES + 10) == 0);
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 1));
+    TEST_ASSERT((ranges.buffer[0].offset == 4 * TEST_CHUNK_BYTES) && (ranges.buffer[0].length == 10));
+    TEST_ASSERT((ranges.size == 4 * TEST_CHUNK_BYTES + 10) && (ranges.removed == 6 * TEST_CHUNK_BYTES + 4990));
+
+    /* Truncation to a chunk boundary changes no remaining chunk, only the tail is reported */
+    TEST_ASSERT(truncate(path, 4 * TEST_CHUNK_BYTES) == 0);
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 0));
+    TEST_ASSERT((ranges.size == 4 * TEST_CHUNK_BYTES) && (ranges.removed == 10));
+
+    TEST_ASSERT(dirwd_chunk_file(chunks, path, &ranges, &has_table));
+    TEST_ASSERT(has_table && (ranges.len == 0) && (ranges.removed == 0));
+
+    dirwd_chunk_forget(chunks, path);
+    TEST_ASSERT(dir_count(table_dir, ".chunks") == 0);
+    TEST_ASSERT(!dirwd_chunk_file(chunks, test_dir, &ranges, &has_table));
+
+    unlink(path);
+    dirwd_chunk_ranges_clean(&ranges);
+    dirwd_chunk_drop(&chunks);
+    TEST_ASSERT(chunks == NULL);
+}
+
+static struct fsnap_t* snap_of(const char* const* paths, size_t len) {
+    struct fsnap_t* snap = fsnap_new();
+    struct stat file_stat;
+
+    for (size_t i = 0; i < len; i++) {
+        if (stat(paths[i], &file_stat) == 0) {
+            fsnap_push(snap, paths[i], &file_stat);
+        }
+    }
+
+    fsnap_seal(snap);
+    return snap;
+}
+
+static void test_dirwd_chunk_update() {
+    char image[128];
+    char log[128];
+    snprintf(image, sizeof(image), "%s/vm.img", test_dir);
+    snprintf(log, sizeof(log), "%s/app.log", test_dir);
+    const char* paths[] = { image, log };
+
+    file_write(image, 0, 8 * TEST_CHUNK_BYTES, 'a', 1000);
+    file_write(log, 0, 8 * TEST_CHUNK_BYTES, 'a', 1000);
+
+    struct dirwd_chunk_t* chunks = chunk_new();
+    struct fsnap_t* empty = fsnap_new();
+    fsnap_seal(empty);
+    struct fsnap_t* old_snap = snap_of(paths, 2);
+    struct fsnap_diff_t diff;
+
+    /* Only matching files get tables */
+    fsnap_diff(empty, old_snap, &diff);
+    dirwd_chunk_update(chunks, empty, old_snap, &diff);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT((chunks->files_hashed == 1) && (dir_count(table_dir, ".chunks") == 1));
+
+    file_write(image, 2 * TEST_CHUNK_BYTES, 1, 'b', 2000);
+    struct fsnap_t* new_snap = snap_of(paths, 2);
+    fsnap_diff(old_snap, new_snap, &diff);
+    dirwd_chunk_update(chunks, old_snap, new_snap, &diff);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT((chunks->files_hashed == 1) && (chunks->delta_files.len == 1));
+    TEST_ASSERT(dir_count(table_dir, ".tsv") == 1);
+
+    /* Truncation to a chunk boundary is reported with the removed tail */
+    TEST_ASSERT(truncate(image, 4 * TEST_CHUNK_BYTES) == 0);
+    fsnap_drop(&old_snap);
+    old_snap = new_snap;
+    new_snap = snap_of(paths, 2);
+    fsnap_diff(old_snap, new_snap, &diff);
+    dirwd_chunk_update(chunks, old_snap, new_snap, &diff);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT((chunks->files_hashed == 1) && (chunks->delta_files.len == 2));
+
+    char expected[256];
+    char line[256] = "";
+    snprintf(expected, sizeof(expected), "%s\t%zu\t%zu\tTRUNCATED\n", image, 4 * TEST_CHUNK_BYTES, 4 * TEST_CHUNK_BYTES);
+    FILE* const fin = fopen(chunks->delta_files.paths[1], "r");
+    TEST_ASSERT((fin != NULL) && (fgets(line, sizeof(line), fin) != NULL) && (strcmp(line, expected) == 0));
+    if (fin != NULL) {
+        fclose(fin);
+    }
+
+    /* After restart every file is new, tables spare reading unchanged ones */
+    dirwd_chunk_drop(&chunks);
+    chunks = chunk_new();
+    fsnap_diff(empty, new_snap, &diff);
+    dirwd_chunk_update(chunks, empty, new_snap, &diff);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT((chunks->files_hashed == 0) && (chunks->files_unchanged == 1));
+    TEST_ASSERT(chunks->delta_files.len == 2);
+
+    /* Deleted file loses its table */
+    fsnap_diff(new_snap, empty, &diff);
+    dirwd_chunk_update(chunks, new_snap, empty, &diff);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT(dir_count(table_dir, ".chunks") == 0);
+
+    fsnap_drop(&new_snap);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&empty);
+    dirwd_chunk_drop(&chunks);
+    unlink(image);
+    unlink(log);
+}
+
+static void test_dirwd_chunk_delta_retention() {
+    /* Table directory is created with the first chunk state */
+    struct dirwd_chunk_t* chunks = chunk_new();
+    dirwd_chunk_drop(&chunks);
+
+    /* Delta files left by earlier daemon runs */
+    char path[256];
+    for (size_t i = 0; i < DIRWD_CHUNK_DELTA_FILES + 5; i++) {
+        snprintf(path, sizeof(path), "%s/delta-%zu-000000000.tsv", table_dir, 1000 + i);
+        FILE* const fout = fopen(path, "w");
+        TEST_ASSERT(fout != NULL);
+        if (fout != NULL) {
+            fclose(fout);
+        }
+    }
+
+    chunks = chunk_new();
+    TEST_ASSERT(chunks->delta_files.len == DIRWD_CHUNK_DELTA_FILES);
+    TEST_ASSERT(dir_count(table_dir, ".tsv") == DIRWD_CHUNK_DELTA_FILES);
+
+    /* Two delta files of the update test are newer than all of them */
+    snprintf(path, sizeof(path), "%s/delta-1006-000000000.tsv", table_dir);
+    TEST_ASSERT(access(path, F_OK) != 0);
+    snprintf(path, sizeof(path), "%s/delta-1007-000000000.tsv", table_dir);
+    TEST_ASSERT(access(path, F_OK) == 0);
+
+    dirwd_chunk_drop(&chunks);
+}
+
+int main() {
+    snprintf(test_dir, sizeof(test_dir), "/tmp/dirwd_chunk_test_%d", (int) getpid());
+    snprintf(table_dir, sizeof(table_dir), "%s/tables", test_dir);
+    mkdir(test_dir, 0755);
+
+    TEST_RUN(test_dirwd_chunk_hash);
+    TEST_RUN(test_dirwd_chunk_file);
+    TEST_RUN(test_dirwd_chunk_update);
+    TEST_RUN(test_dirwd_chunk_delta_retention);
+
+    char command[256];
+    snprintf(command, sizeof(command), "rm -rf '%s'", test_dir);
+    TEST_ASSERT(system(command) == 0);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
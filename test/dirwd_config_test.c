@@ -0,0 +1,108 @@
+/**
+ * @file dirwd_config_test.c
+ * @date 18 Oct 2026
+ * @brief Configuration file reading tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/daemon/dirwd_config.h"
+
+static char config_path[64];
+
+static bool config_write(const char* config) {
+    FILE* const fout = fopen(config_path, "w");
+    if (fout == NULL) {
+        return false;
+    }
+
+    const bool is_written = (fputs(config, fout) >= 0);
+    return (fclose(fout) == 0) && is_written;
+}
+
+static dirwd_status_t config_read(const char* config, struct dirwd_config_t* config_buf) {
+    TEST_ASSERT(config_write(config));
+    const dirwd_status_t status = dirwd_config_read(config_path, config_buf);
+    if (status != DIRWD_SUCCESS) {
+        TEST_ASSERT(config_buf->target_dir == NULL);
+    }
+    return status;
+}
+
+static void test_dirwd_config_long_line() {
+    struct dirwd_config_t config;
+
+    /* Ordinary daemon paths take the line well over 256 characters */
+    const char* line =
+        "\"/srv/data dir\" 30 events=both ring=/run/dirwdd/events.ring journal=/var/lib/dirwdd/journal "
+        "storm_threshold=1000 storm_dir=/var/lib/dirwdd/storm control=/run/dirwdd/control.sock "
+        "query=/run/dirwdd/query.sock chunk_pattern=*.img chunk_dir=/var/lib/dirwdd/chunks "
+        "profile_file=/var/lib/dirwdd/profile.txt\n";
+    TEST_ASSERT(strlen(line) > 256);
+    TEST_ASSERT(config_read(line, &config) == DIRWD_SUCCESS);
+    TEST_ASSERT(strcmp(config.target_dir, "/srv/data dir") == 0);
+    TEST_ASSERT(config.timeout_sec == 30);
+    TEST_ASSERT(strcmp(config.output_opts.journal_dir, "/var/lib/dirwdd/journal") == 0);
+    TEST_ASSERT(strcmp(config.chunk_opts.dir, "/var/lib/dirwdd/chunks") == 0);
+    TEST_ASSERT(strcmp(config.prof_opts.file, "/var/lib/dirwdd/profile.txt") == 0);
+    free(config.target_dir);
+
+    /* Path option values up to their limits */
+    char ring_path[PATH_MAX];
+    memset(ring_path, 'r', sizeof(ring_path) - 1);
+    ring_path[0] = '/';
+    ring_path[sizeof(ring_path) - 1] = '\0';
+
+    const size_t config_size = 2 * PATH_MAX + 256;
+    char* config_string = (char*) malloc(config_size);
+    snprintf(config_string, config_size, "/tmp 10 ring=%s journal=/var/lib/dirwdd/journal\n", ring_path);
+    TEST_ASSERT(config_read(config_string, &config) == DIRWD_SUCCESS);
+    TEST_ASSERT(strcmp(config.output_opts.ring_path, ring_path) == 0);
+    TEST_ASSERT(strcmp(config.output_opts.journal_dir, "/var/lib/dirwdd/journal") == 0);
+    free(config.target_dir);
+
+    snprintf(config_string, config_size, "/tmp 10 ring=%sr\n", ring_path);
+    TEST_ASSERT(config_read(config_string, &config) == DIRWD_INVALID_CONFIG_OPTION);
+
+    /* Over-long line is an error, not split into several lines */
+    char* long_string = (char*) malloc(DIRWD_CONFIG_MAX_LINE_LEN + 2);
+    memset(long_string, 'x', DIRWD_CONFIG_MAX_LINE_LEN + 1);
+    long_string[0] = '/';
+    long_string[DIRWD_CONFIG_MAX_LINE_LEN + 1] = '\0';
+    TEST_ASSERT(config_read(long_string, &config) == DIRWD_INVALID_CONFIG_FORMAT);
+
+    free(long_string);
+    free(config_string);
+}
+
+static void test_dirwd_config_lines() {
+    struct dirwd_config_t config;
+
+    TEST_ASSERT(config_read("\n\n/tmp 10 one_fs=yes\n\n", &config) == DIRWD_SUCCESS);
+    TEST_ASSERT((strcmp(config.target_dir, "/tmp") == 0) && config.scan_opts.one_fs);
+    free(config.target_dir);
+
+    TEST_ASSERT(config_read("/tmp 10\n/var 10\n", &config) == DIRWD_INVALID_CONFIG_FORMAT);
+    TEST_ASSERT(config_read("\n", &config) == DIRWD_INVALID_CONFIG_FORMAT);
+    TEST_ASSERT(config_read("/tmp 10 unknown=1\n", &config) == DIRWD_INVALID_CONFIG_OPTION);
+    TEST_ASSERT(config_read("/tmp 1000000000000000000000000000000000000000000000000\n", &config)
+        == DIRWD_INVALID_CONFIG_TIMEOUT);
+}
+
+int main() {
+    snprintf(config_path, sizeof(config_path), "/tmp/dirwd_config_test_%d.config", (int) getpid());
+
+    TEST_RUN(test_dirwd_config_long_line);
+    TEST_RUN(test_dirwd_config_lines);
+
+    unlink(config_path);
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
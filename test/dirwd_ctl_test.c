@@ -0,0 +1,234 @@
+/**
+ * @file dirwd_ctl_test.c
+ * @date 18 Oct 2026
+ * @brief Control socket and targeted subtree rescan tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+#include "../src/daemon/dirwd_memfs.h"
+#include "../src/daemon/dirwd_ctl.h"
+
+static struct dirwd_ctl_t* ctl_new(const char* socket_path) {
+    struct dirwd_ctl_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    if (socket_path != NULL) {
+        strcpy(opts.socket_path, socket_path);
+    }
+
+    return dirwd_ctl_open("/sim/", &opts);
+}
+
+static struct fsnap_t* memfs_scan(struct dirwd_memfs_t* memfs, dirwd_scan_filter_t filter, void* filter_ctx) {
+    const struct dirwd_scan_opts_t scan_opts = {
+        .threads = 3,
+        .one_fs = true,
+        .follow_symlinks = true,
+        .inode_order = false,
+        .filter = filter,
+        .filter_ctx = filter_ctx,
+        .prof = NULL,
+        .fs = dirwd_memfs_ops(),
+        .fs_ctx = memfs,
+    };
+
+    struct fsnap_t* snap = fsnap_new();
+    dirwd_scan_tree(snap, memfs->root, &scan_opts);
+    return snap;
+}
+
+/* Rescan queued requests, diff against old snapshot which is replaced by the result */
+static void ctl_rescan(struct dirwd_ctl_t* ctl, struct dirwd_memfs_t* memfs, struct fsnap_t** snap, struct fsnap_diff_t* diff) {
+    dirwd_ctl_begin(ctl);
+    struct fsnap_t* new_snap = memfs_scan(memfs, dirwd_ctl_filter, ctl);
+    dirwd_ctl_carry(ctl, *snap, new_snap);
+    fsnap_seal(new_snap);
+
+    fsnap_diff(*snap, new_snap, diff);
+    dirwd_ctl_end(ctl, diff);
+
+    fsnap_drop(snap);
+    *snap = new_snap;
+}
+
+static void test_dirwd_ctl_request() {
+    struct dirwd_ctl_t* ctl = ctl_new(NULL);
+    TEST_ASSERT((ctl != NULL) && (ctl->fd < 0));
+    TEST_ASSERT(dirwd_ctl_due_ms(ctl, dirwd_ctl_now_ms()) == -1);
+
+    TEST_ASSERT(!dirwd_ctl_request(ctl, "sim/a"));
+    TEST_ASSERT(!dirwd_ctl_request(ctl, "/simulated/a"));
+    TEST_ASSERT(!dirwd_ctl_request(ctl, "/sim/../etc"));
+    TEST_ASSERT(!dirwd_ctl_request(ctl, "/sim/./a"));
+    TEST_ASSERT(!dirwd_ctl_request(ctl, "/sim//a"));
+    TEST_ASSERT(ctl->len == 0);
+
+    /* Nested paths are merged */
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/a/b/"));
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/a/c"));
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/a/b/d"));
+    TEST_ASSERT(ctl->len == 2);
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/a"));
+    TEST_ASSERT((ctl->len == 1) && (strcmp(ctl->requests[0], "/sim/a") == 0));
+
+    const int64_t now_ms = dirwd_ctl_now_ms();
+    TEST_ASSERT(dirwd_ctl_due_ms(ctl, now_ms) <= DIRWD_CTL_COALESCE_MS);
+    TEST_ASSERT(dirwd_ctl_due_ms(ctl, now_ms + DIRWD_CTL_COALESCE_MS) == 0);
+
+    /* Too many subtrees rescan whole target */
+    char path[64];
+    for (size_t i = 0; i < DIRWD_CTL_MAX_REQUESTS; i++) {
+        snprintf(path, sizeof(path), "/sim/x%zu", i);
+        TEST_ASSERT(dirwd_ctl_request(ctl, path));
+    }
+    TEST_ASSERT((ctl->len == 1) && (strcmp(ctl->requests[0], "/sim") == 0));
+
+    dirwd_ctl_begin(ctl);
+    TEST_ASSERT((ctl->len == 0) && (ctl->active_len == 1));
+    dirwd_ctl_end(ctl, NULL);
+    TEST_ASSERT(ctl->active_len == 0);
+
+    dirwd_ctl_close(&ctl);
+    TEST_ASSERT(ctl == NULL);
+}
+
+static void test_dirwd_ctl_rescan() {
+    const struct dirwd_memfs_opts_t memfs_opts = { .seed = 11, .opendir_latency_ns = 0, .stat_latency_ns = 0 };
+    struct dirwd_memfs_t* memfs = dirwd_memfs_new("/sim", &memfs_opts);
+    dirwd_memfs_generate(memfs, 4, 2, 5);
+
+    struct fsnap_t* snap = memfs_scan(memfs, NULL, NULL);
+    fsnap_seal(snap);
+    const size_t files = fsnap_len(snap);
+
+    struct dirwd_ctl_t* ctl = ctl_new(NULL);
+    struct fsnap_diff_t diff;
+
+    /* Changes in requested subtree and in files of its parent directory are found */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d1/d2/f0", false, 12345));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d1/new", false, 1));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/top", false, 1));
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/d2/d3/f4"));
+
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/d1"));
+    ctl_rescan(ctl, memfs, &snap, &diff);
+    TEST_ASSERT(diff.new_entries.len == 2);
+    TEST_ASSERT(diff.modified_entries.len == 1);
+    TEST_ASSERT(diff.deleted_entries.len == 0);
+    TEST_ASSERT(ctl->entries_carried == files - 5 * 5 - 5);
+    TEST_ASSERT(ctl->dirs_skip == 3);
+    fsnap_diff_clean(&diff);
+
+    /* File and removed directory requests */
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/d3/d0"));
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/d2/d3/f4"));
+    TEST_ASSERT(dirwd_ctl_request(ctl, "/sim/d3/d0"));
+    ctl_rescan(ctl, memfs, &snap, &diff);
+    TEST_ASSERT(diff.new_entries.len == 0);
+    TEST_ASSERT(diff.modified_entries.len == 0);
+    TEST_ASSERT(diff.deleted_entries.len == 6);
+    fsnap_diff_clean(&diff);
+
+    /* Result equals full scan */
+    struct fsnap_t* full = memfs_scan(memfs, NULL, NULL);
+    fsnap_seal(full);
+    fsnap_diff(snap, full, &diff);
+    TEST_ASSERT(diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0);
+    fsnap_diff_clean(&diff);
+
+    fsnap_drop(&full);
+    fsnap_drop(&snap);
+    dirwd_ctl_close(&ctl);
+    dirwd_memfs_drop(&memfs);
+}
+
+struct ctl_client_t {
+    const char* socket_path;
+    char reply[64];
+    bool is_sent;
+};
+
+static void* ctl_client_run(void* arg) {
+    struct ctl_client_t* client = (struct ctl_client_t*) arg;
+    client->is_sent = dirwd_ctl_send(client->socket_path, "RESCAN /sim/d0", client->reply, sizeof(client->reply));
+    return NULL;
+}
+
+static void test_dirwd_ctl_socket() {
+    char socket_path[64];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/dirwd_ctl_test_%d.sock", (int) getpid());
+
+    struct dirwd_ctl_t* ctl = ctl_new(socket_path);
+    TEST_ASSERT((ctl != NULL) && (ctl->fd >= 0));
+
+    /* Idle socket does not block */
+    dirwd_ctl_read(ctl);
+    TEST_ASSERT(ctl->len == 0);
+
+    /* Unknown command is answered right away */
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT(connect(fd, (const struct sockaddr*) &addr, sizeof(addr)) == 0);
+    TEST_ASSERT(send(fd, "STATUS\n", 7, 0) == 7);
+    dirwd_ctl_read(ctl);
+
+    char reply[64] = { 0 };
+    TEST_ASSERT(recv(fd, reply, sizeof(reply) - 1, 0) > 0);
+    TEST_ASSERT(strncmp(reply, "ERR", 3) == 0);
+    TEST_ASSERT(ctl->len == 0);
+    close(fd);
+
+    /* Client waits for result of the rescan */
+    struct ctl_client_t client = { .socket_path = socket_path, .reply = { 0 }, .is_sent = false };
+    pthread_t thread;
+    pthread_create(&thread, NULL, ctl_client_run, &client);
+
+    for (size_t i = 0; (i < 100) && (ctl->len == 0); i++) {
+        struct pollfd poll_fd = { .fd = ctl->fd, .events = POLLIN, .revents = 0 };
+        poll(&poll_fd, 1, 50);
+        dirwd_ctl_read(ctl);
+    }
+    TEST_ASSERT((ctl->len == 1) && (ctl->clients_len == 1));
+
+    struct fsnap_diff_t diff;
+    memset(&diff, 0, sizeof(diff));
+    fsnap_idx_vec_push(&diff.new_entries, 0);
+    fsnap_idx_vec_push(&diff.deleted_entries, 0);
+
+    dirwd_ctl_begin(ctl);
+    dirwd_ctl_end(ctl, &diff);
+    fsnap_diff_clean(&diff);
+
+    pthread_join(thread, NULL);
+    TEST_ASSERT(client.is_sent);
+    TEST_ASSERT(strcmp(client.reply, "OK 2") == 0);
+
+    dirwd_ctl_close(&ctl);
+    TEST_ASSERT(access(socket_path, F_OK) != 0);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_ctl_request);
+    TEST_RUN(test_dirwd_ctl_rescan);
+    TEST_RUN(test_dirwd_ctl_socket);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
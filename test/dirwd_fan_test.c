@@ -0,0 +1,167 @@
+/**
+ * @file dirwd_fan_test.c
+ * @date 18 Oct 2026
+ * @brief Fanotify change source tests on temporary directory tree
+ *
+ * Fanotify filesystem marks need CAP_SYS_ADMIN, tests are skipped if the
+ * watch can not be set up.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "tree.h"
+
+static bool tree_open(struct tree_t* tree, size_t reconcile_ticks) {
+    if (!tree_create(tree, "dirwd_fan")) {
+        return false;
+    }
+
+    const struct dirwd_fan_opts_t opts = { .enabled = true, .reconcile_ticks = reconcile_ticks };
+    tree->fan = dirwd_fan_open(tree->root, &opts);
+
+    if (tree->fan == NULL) {
+        printf("fanotify is not available, skipped\n");
+        tree_destroy(tree);
+        return false;
+    }
+
+    return true;
+}
+
+static void test_dirwd_fan_partial_scan() {
+    struct tree_t tree;
+    if (!tree_open(&tree, 1000)) {
+        return;
+    }
+
+    tree_mkdir(&tree, "a");
+    tree_mkdir(&tree, "b");
+    tree_mkdir(&tree, "b/c");
+    tree_write(&tree, "a/f", "x");
+    tree_write(&tree, "b/g", "x");
+    tree_write(&tree, "b/c/h", "x");
+
+    /* First inspection scans whole tree */
+    struct fsnap_diff_t diff;
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.new_entries.len == 3);
+    fsnap_diff_clean(&diff);
+
+    /* Nothing changed, nothing is read */
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0);
+    TEST_ASSERT(tree.fan->dirs_full == 0);
+    TEST_ASSERT(tree.fan->entries_carried == 3);
+    fsnap_diff_clean(&diff);
+
+    /* Only modified directory is scanned, its ancestors are descended */
+    tree_write(&tree, "b/c/h", "y");
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.modified_entries.len == 1);
+    TEST_ASSERT(tree.fan->dirs_full == 1);
+    TEST_ASSERT(tree.fan->dirs_descend == 2);
+    TEST_ASSERT(tree.fan->entries_carried == 2);
+    fsnap_diff_clean(&diff);
+
+    /* New file */
+    tree_write(&tree, "a/n", "x");
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.new_entries.len == 1);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT(tree_is_consistent(&tree));
+
+    tree_destroy(&tree);
+}
+
+static void test_dirwd_fan_subtree_changes() {
+    struct tree_t tree;
+    if (!tree_open(&tree, 1000)) {
+        return;
+    }
+
+    tree_mkdir(&tree, "a");
+    tree_mkdir(&tree, "a/b");
+    tree_mkdir(&tree, "c");
+    tree_write(&tree, "a/f", "x");
+    tree_write(&tree, "a/b/g", "x");
+    tree_write(&tree, "c/h", "x");
+
+    struct fsnap_diff_t diff;
+    tree_inspect(&tree, &diff);
+    fsnap_diff_clean(&diff);
+
+    /* Moved directory is deleted under old path and new under new one */
+    tree_rename(&tree, "a", "c/a");
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.deleted_entries.len == 2);
+    TEST_ASSERT(diff.new_entries.len == 2);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT(tree_is_consistent(&tree));
+
+    /* Removed subtree */
+    char path[PATH_MAX];
+    tree_path(&tree, "c/a", path);
+    tree_remove(path);
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.deleted_entries.len == 2);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT(tree_is_consistent(&tree));
+
+    /* Directory created with content between inspections */
+    tree_mkdir(&tree, "d");
+    tree_mkdir(&tree, "d/e");
+    tree_write(&tree, "d/e/i", "x");
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.new_entries.len == 1);
+    fsnap_diff_clean(&diff);
+    TEST_ASSERT(tree_is_consistent(&tree));
+
+    tree_destroy(&tree);
+}
+
+static void test_dirwd_fan_dirty_reconcile() {
+    struct tree_t tree;
+    if (!tree_open(&tree, 2)) {
+        return;
+    }
+
+    tree_write(&tree, "f", "x");
+
+    struct fsnap_diff_t diff;
+    tree_inspect(&tree, &diff);
+    fsnap_diff_clean(&diff);
+
+    /* Explicit rescan request, paths outside target are refused */
+    TEST_ASSERT(dirwd_fan_dirty(tree.fan, tree.root, false));
+    TEST_ASSERT(!dirwd_fan_dirty(tree.fan, "/nonexistent/dir", false));
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(tree.fan->dirs_full == 1);
+    fsnap_diff_clean(&diff);
+
+    /* Every second inspection scans whole tree */
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(tree.fan->full_scan);
+    TEST_ASSERT(tree.fan->entries_carried == 0);
+    fsnap_diff_clean(&diff);
+
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_fan_partial_scan);
+    TEST_RUN(test_dirwd_fan_subtree_changes);
+    TEST_RUN(test_dirwd_fan_dirty_reconcile);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file dirwd_fprint_test.c
+ * @date 18 Oct 2026
+ * @brief Bounded-memory directory fingerprint tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+#include "../src/daemon/dirwd_memfs.h"
+#include "../src/daemon/dirwd_fprint.h"
+
+/* Events of one inspection, types of entries are 'N', 'D' and 'M' */
+struct events_t {
+    struct fsnap_t* old_snap;
+    struct fsnap_t* new_snap;
+    struct fsnap_diff_t diff;
+};
+
+static struct dirwd_memfs_t* memfs_new(size_t fanout, size_t depth, size_t files) {
+    const struct dirwd_memfs_opts_t opts = { .seed = 5, .opendir_latency_ns = 0, .stat_latency_ns = 0 };
+    struct dirwd_memfs_t* memfs = dirwd_memfs_new("/sim", &opts);
+    dirwd_memfs_generate(memfs, fanout, depth, files);
+    return memfs;
+}
+
+static struct dirwd_scan_opts_t scan_opts_of(struct dirwd_memfs_t* memfs, struct dirwd_fprint_t* fprint) {
+    const struct dirwd_scan_opts_t scan_opts = {
+        .threads = 3,
+        .one_fs = true,
+        .follow_symlinks = true,
+        .inode_order = false,
+        .visit = (fprint != NULL) ? dirwd_fprint_visit : NULL,
+        .visit_ctx = fprint,
+        .fs = dirwd_memfs_ops(),
+        .fs_ctx = memfs,
+    };
+
+    return scan_opts;
+}
+
+static void fprint_inspect(struct dirwd_fprint_t* fprint, struct dirwd_memfs_t* memfs, struct events_t* events) {
+    const struct dirwd_scan_opts_t scan_opts = scan_opts_of(memfs, fprint);
+    struct fsnap_t* unused = fsnap_new();
+
+    dirwd_fprint_begin(fprint);
+    dirwd_scan_tree(unused, memfs->root, &scan_opts);
+    dirwd_fprint_end(fprint);
+    TEST_ASSERT(fsnap_len(unused) == 0);
+    fsnap_drop(&unused);
+
+    events->old_snap = fprint->old_events;
+    events->new_snap = fprint->new_events;
+    fsnap_diff(events->old_snap, events->new_snap, &events->diff);
+}
+
+static struct fsnap_t* full_scan(struct dirwd_memfs_t* memfs) {
+    const struct dirwd_scan_opts_t scan_opts = scan_opts_of(memfs, NULL);
+    struct fsnap_t* snap = fsnap_new();
+
+    dirwd_scan_tree(snap, memfs->root, &scan_opts);
+    fsnap_seal(snap);
+    return snap;
+}
+
+static size_t events_len(const struct events_t* events) {
+    return events->diff.new_entries.len + events->diff.deleted_entries.len + events->diff.modified_entries.len;
+}
+
+static bool events_has(const struct events_t* events, char type, const char* path) {
+    const struct fsnap_idx_vec_t* vec = (type == 'N') ? &events->diff.new_entries
+        : (type == 'D') ? &events->diff.deleted_entries
+        : &events->diff.modified_entries;
+    const struct fsnap_t* snap = (type == 'D') ? events->old_snap : events->new_snap;
+
+    for (size_t i = 0; i < vec->len; i++) {
+        if (strcmp(fsnap_path(snap, vec->buffer[i]), path) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Event of file is reported itself or covered by directory event of its parent */
+static bool events_covers(const struct events_t* events, char type, const char* path) {
+    if (events_has(events, type, path)) {
+        return true;
+    }
+
+    char dir[256];
+    const size_t dir_len = (size_t) (strrchr(path, '/') - path) + 1;
+    snprintf(dir, sizeof(dir), "%.*s", (int) dir_len, path);
+
+    return events_has(events, 'M', dir) || events_has(events, 'D', dir);
+}
+
+static size_t cached_listings(const struct dirwd_fprint_t* fprint) {
+    size_t len = 0;
+    for (size_t i = 0; i < fprint->opts.cache_dirs; i++) {
+        len += (fprint->cache[i].files != NULL) ? 1 : 0;
+    }
+
+    return len;
+}
+
+static void test_dirwd_fprint_files() {
+    struct fsnap_t* a = fsnap_new();
+    struct fsnap_t* b = fsnap_new();
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(file_stat));
+
+    file_stat.st_size = 1;
+    fsnap_push(a, "/x/a", &file_stat);
+    file_stat.st_size = 2;
+    fsnap_push(a, "/x/b", &file_stat);
+    fsnap_push(b, "/x/b", &file_stat);
+    file_stat.st_size = 1;
+    fsnap_push(b, "/x/a", &file_stat);
+
+    /* Order does not matter, size, time and name do */
+    TEST_ASSERT(dirwd_fprint_files(a) == dirwd_fprint_files(b));
+
+    file_stat.st_mtim.tv_nsec = 1;
+    fsnap_clear(b);
+    fsnap_push(b, "/x/a", &file_stat);
+    file_stat.st_mtim.tv_nsec = 0;
+    file_stat.st_size = 2;
+    fsnap_push(b, "/x/b", &file_stat);
+    TEST_ASSERT(dirwd_fprint_files(a) != dirwd_fprint_files(b));
+
+    fsnap_clear(b);
+    fsnap_push(b, "/x/b", &file_stat);
+    file_stat.st_size = 1;
+    fsnap_push(b, "/x/c", &file_stat);
+    TEST_ASSERT(dirwd_fprint_files(a) != dirwd_fprint_files(b));
+
+    fsnap_clear(b);
+    TEST_ASSERT(dirwd_fprint_files(b) != dirwd_fprint_files(a));
+
+    fsnap_drop(&a);
+    fsnap_drop(&b);
+}
+
+static void test_dirwd_fprint_events() {
+    struct dirwd_memfs_t* memfs = memfs_new(3, 2, 5);
+    const struct dirwd_fprint_opts_t opts = { .enabled = true, .cache_dirs = 2 };
+    struct dirwd_fprint_t* fprint = dirwd_fprint_new(&opts);
+    struct events_t events;
+
+    /* First inspection records fingerprints only */
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT((events_len(&events) == 0) && (fprint->dirs.len == 13));
+    TEST_ASSERT(cached_listings(fprint) == 0);
+    fsnap_diff_clean(&events.diff);
+
+    /* First change of directory is reported for the directory */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d0/f1", false, 777));
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT((events_len(&events) == 1) && events_has(&events, 'M', "/sim/d0/"));
+    TEST_ASSERT((fprint->dirs_changed == 1) && (fprint->dirs_detailed == 0));
+    fsnap_diff_clean(&events.diff);
+
+    /* Next one is detailed from cached listing */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d0/f2", false, 778));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d0/new", false, 1));
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/d0/f3"));
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT(events_len(&events) == 3);
+    TEST_ASSERT(events_has(&events, 'M', "/sim/d0/f2"));
+    TEST_ASSERT(events_has(&events, 'N', "/sim/d0/new"));
+    TEST_ASSERT(events_has(&events, 'D', "/sim/d0/f3"));
+    TEST_ASSERT(fprint->dirs_detailed == 1);
+    fsnap_diff_clean(&events.diff);
+
+    /* Files of new directory are reported, parent fingerprint does not include subdirectories */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d1/n/a", false, 1));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d1/n/b", false, 1));
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT(events_len(&events) == 2);
+    TEST_ASSERT(events_has(&events, 'N', "/sim/d1/n/a") && events_has(&events, 'N', "/sim/d1/n/b"));
+    TEST_ASSERT((fprint->dirs_new == 1) && (fprint->dirs_changed == 0) && (fprint->dirs.len == 14));
+    fsnap_diff_clean(&events.diff);
+
+    /* Removed directories, cached one in detail */
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/d1/n"));
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/d2/d0"));
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT(events_len(&events) == 3);
+    TEST_ASSERT(events_has(&events, 'D', "/sim/d1/n/a") && events_has(&events, 'D', "/sim/d1/n/b"));
+    TEST_ASSERT(events_has(&events, 'D', "/sim/d2/d0/"));
+    TEST_ASSERT((fprint->dirs_removed == 2) && (fprint->dirs.len == 12));
+    fsnap_diff_clean(&events.diff);
+
+    /* Least recently changed listing is evicted */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d2/f0", false, 5));
+    fprint_inspect(fprint, memfs, &events);
+    fsnap_diff_clean(&events.diff);
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d1/f0", false, 5));
+    fprint_inspect(fprint, memfs, &events);
+    fsnap_diff_clean(&events.diff);
+    TEST_ASSERT(cached_listings(fprint) == 2);
+
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/d0/f0", false, 5));
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT((events_len(&events) == 1) && events_has(&events, 'M', "/sim/d0/"));
+    fsnap_diff_clean(&events.diff);
+
+    /* Unchanged tree gives no events */
+    fprint_inspect(fprint, memfs, &events);
+    TEST_ASSERT(events_len(&events) == 0);
+    fsnap_diff_clean(&events.diff);
+
+    dirwd_fprint_drop(&fprint);
+    TEST_ASSERT(fprint == NULL);
+    dirwd_memfs_drop(&memfs);
+}
+
+static void test_dirwd_fprint_churn() {
+    struct dirwd_memfs_t* memfs = memfs_new(4, 3, 8);
+    const struct dirwd_fprint_opts_t opts = { .enabled = true, .cache_dirs = 32 };
+    struct dirwd_fprint_t* fprint = dirwd_fprint_new(&opts);
+    struct events_t events;
+
+    fprint_inspect(fprint, memfs, &events);
+    fsnap_diff_clean(&events.diff);
+    struct fsnap_t* old_snap = full_scan(memfs);
+
+    size_t detailed = 0;
+    for (size_t round = 0; round < 20; round++) {
+        const struct dirwd_memfs_churn_t churn = { .creates = 20, .removes = 5, .modifies = 5, .create_dirs = 4 };
+        struct dirwd_memfs_churn_t done;
+        dirwd_memfs_churn(memfs, &churn, &done);
+
+        fprint_inspect(fprint, memfs, &events);
+        struct fsnap_t* new_snap = full_scan(memfs);
+        struct fsnap_diff_t diff;
+        fsnap_diff(old_snap, new_snap, &diff);
+
+        /* Every change is reported itself or by its directory */
+        size_t uncovered = 0;
+        for (size_t i = 0; i < diff.new_entries.len; i++) {
+            uncovered += !events_covers(&events, 'N', fsnap_path(new_snap, diff.new_entries.buffer[i]));
+        }
+        for (size_t i = 0; i < diff.deleted_entries.len; i++) {
+            uncovered += !events_covers(&events, 'D', fsnap_path(old_snap, diff.deleted_entries.buffer[i]));
+        }
+        for (size_t i = 0; i < diff.modified_entries.len; i++) {
+            uncovered += !events_covers(&events, 'M', fsnap_path(new_snap, diff.modified_entries.buffer[i]));
+        }
+        TEST_ASSERT(uncovered == 0);
+
+        /* Every reported file change happened */
+        struct events_t full = { .old_snap = old_snap, .new_snap = new_snap, .diff = diff };
+        size_t spurious = 0;
+        for (size_t i = 0; i < events.diff.modified_entries.len; i++) {
+            const char* path = fsnap_path(events.new_snap, events.diff.modified_entries.buffer[i]);
+            spurious += (path[strlen(path) - 1] != '/') && !events_has(&full, 'M', path);
+        }
+        for (size_t i = 0; i < events.diff.new_entries.len; i++) {
+            spurious += !events_has(&full, 'N', fsnap_path(events.new_snap, events.diff.new_entries.buffer[i]));
+        }
+        TEST_ASSERT(spurious == 0);
+        TEST_ASSERT(cached_listings(fprint) <= opts.cache_dirs);
+
+        detailed += fprint->dirs_detailed;
+        fsnap_diff_clean(&diff);
+        fsnap_diff_clean(&events.diff);
+        fsnap_drop(&old_snap);
+        old_snap = new_snap;
+    }
+
+    /* Changed directories fit the cache, new files go to few of them */
+    TEST_ASSERT(detailed > 0);
+    TEST_ASSERT(dirwd_fprint_memory(fprint) > 0);
+
+    fsnap_drop(&old_snap);
+    dirwd_fprint_drop(&fprint);
+    dirwd_memfs_drop(&memfs);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_fprint_files);
+    TEST_RUN(test_dirwd_fprint_events);
+    TEST_RUN(test_dirwd_fprint_churn);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,308 @@
+/**
+ * @file dirwd_journal_test.c
+ * @date 18 Oct 2026
+ * @brief Sequenced change journal tests on temporary directory
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "test.h"
+#include "dirwd_ring.h"
+#include "../src/journal/dirwd_journal.h"
+
+#define SEGMENT_BYTES ((size_t) 1024)
+
+static void journal_dir(char* dir) {
+    strcpy(dir, "/tmp/dirwd_journal_test_XXXXXX");
+    TEST_ASSERT(mkdtemp(dir) != NULL);
+}
+
+static size_t journal_remove(const char* dir) {
+    DIR* const journal = opendir(dir);
+    struct dirent* dir_entry = NULL;
+    char path[PATH_MAX];
+    size_t removed = 0;
+
+    while ((journal != NULL) && ((dir_entry = readdir(journal)) != NULL)) {
+        if (dir_entry->d_name[0] != '.') {
+            snprintf(path, sizeof(path), "%s/%s", dir, dir_entry->d_name);
+            removed += (unlink(path) == 0) ? 1 : 0;
+        }
+    }
+
+    if (journal != NULL) {
+        closedir(journal);
+    }
+    rmdir(dir);
+
+    return removed;
+}
+
+static size_t journal_segments(const char* dir) {
+    DIR* const journal = opendir(dir);
+    struct dirent* dir_entry = NULL;
+    size_t segments = 0;
+
+    while ((journal != NULL) && ((dir_entry = readdir(journal)) != NULL)) {
+        const size_t len = strlen(dir_entry->d_name);
+        segments += ((len > 4) && (strcmp(dir_entry->d_name + len - 4, ".seg") == 0)) ? 1 : 0;
+    }
+
+    if (journal != NULL) {
+        closedir(journal);
+    }
+
+    return segments;
+}
+
+static bool segment_file(const char* dir, uint64_t first_seq, const char* ext, char* path) {
+    const int len = snprintf(path, PATH_MAX, "%s/%020" PRIu64 ".%s", dir, first_seq, ext);
+    return (len > 0) && (len < PATH_MAX);
+}
+
+/* Create segment and index files as left by a crash before the segment header was written */
+static bool segment_create_torn(const char* dir, uint64_t first_seq, size_t header_len) {
+    char path[PATH_MAX];
+    FILE* fout = NULL;
+
+    if (!segment_file(dir, first_seq, "seg", path) || ((fout = fopen(path, "wb")) == NULL)) {
+        return false;
+    }
+    const bool is_written = (fwrite(DIRWD_JOURNAL_MAGIC, 1, header_len, fout) == header_len);
+    fclose(fout);
+
+    if (!is_written || !segment_file(dir, first_seq, "idx", path) || ((fout = fopen(path, "wb")) == NULL)) {
+        return false;
+    }
+    fclose(fout);
+    return true;
+}
+
+static uint64_t append_seq(struct dirwd_journal_t* journal, uint64_t seq) {
+    char path[64];
+    snprintf(path, sizeof(path), "/f/%" PRIu64, seq);
+    return dirwd_journal_append(journal, DIRWD_RING_MODIFIED, path, (int64_t) seq, (int64_t) seq * 2);
+}
+
+static bool event_is_consistent(const struct dirwd_journal_event_t* event) {
+    char path[64];
+    snprintf(path, sizeof(path), "/f/%" PRIu64, event->seq);
+
+    return (strcmp(event->path, path) == 0)
+        && (event->type == DIRWD_RING_MODIFIED)
+        && (event->size == (int64_t) event->seq)
+        && (event->mtime_ns == (int64_t) event->seq * 2);
+}
+
+/* Read everything after since and check that sequence numbers are since + 1 .. last */
+static bool read_since(const char* dir, uint64_t since, uint64_t last) {
+    struct dirwd_journal_cursor_t cursor;
+    struct dirwd_journal_event_t event;
+
+    if (dirwd_journal_cursor_open(&cursor, dir, since) != DIRWD_JOURNAL_OK) {
+        return false;
+    }
+
+    uint64_t expected = (since == 0) ? dirwd_journal_cursor_oldest(&cursor) : since + 1;
+    bool is_consistent = true;
+
+    while (is_consistent && dirwd_journal_cursor_next(&cursor, &event)) {
+        is_consistent = (event.seq == expected) && event_is_consistent(&event);
+        expected++;
+    }
+
+    dirwd_journal_cursor_close(&cursor);
+    return is_consistent && (expected == last + 1);
+}
+
+static void test_dirwd_journal_since() {
+    char dir[PATH_MAX];
+    journal_dir(dir);
+
+    struct dirwd_journal_t* journal = dirwd_journal_open(dir, SEGMENT_BYTES, SIZE_MAX);
+    TEST_ASSERT(journal != NULL);
+    TEST_ASSERT(read_since(dir, 0, 0));
+
+    for (uint64_t seq = 1; seq <= 500; seq++) {
+        TEST_ASSERT(append_seq(journal, seq) == seq);
+    }
+    TEST_ASSERT(dirwd_journal_commit(journal));
+    TEST_ASSERT(journal_segments(dir) > 4);
+
+    /* Positions around index stride and segment boundaries */
+    const uint64_t since_values[] = { 0, 1, 21, 22, 23, 63, 64, 65, 128, 333, 499, 500, 600 };
+    for (size_t i = 0; i < sizeof(since_values) / sizeof(since_values[0]); i++) {
+        const uint64_t since = since_values[i];
+        TEST_ASSERT(read_since(dir, since, (since > 500) ? since : 500));
+    }
+
+    dirwd_journal_close(&journal);
+    TEST_ASSERT(journal == NULL);
+    journal_remove(dir);
+}
+
+static void test_dirwd_journal_retention() {
+    char dir[PATH_MAX];
+    journal_dir(dir);
+
+    struct dirwd_journal_t* journal = dirwd_journal_open(dir, SEGMENT_BYTES, 4 * SEGMENT_BYTES);
+
+    for (uint64_t seq = 1; seq <= 500; seq++) {
+        append_seq(journal, seq);
+    }
+    TEST_ASSERT(dirwd_journal_commit(journal));
+    TEST_ASSERT(journal_segments(dir) <= 5);
+
+    struct dirwd_journal_cursor_t cursor;
+    TEST_ASSERT(dirwd_journal_cursor_open(&cursor, dir, 0) == DIRWD_JOURNAL_OK);
+    const uint64_t oldest = dirwd_journal_cursor_oldest(&cursor);
+    dirwd_journal_cursor_close(&cursor);
+    TEST_ASSERT(oldest > 1);
+
+    /* Removed records are reported as gap, retained ones are still readable */
+    TEST_ASSERT(dirwd_journal_cursor_open(&cursor, dir, 1) == DIRWD_JOURNAL_GAP);
+    TEST_ASSERT(dirwd_journal_cursor_oldest(&cursor) == oldest);
+    dirwd_journal_cursor_close(&cursor);
+    TEST_ASSERT(dirwd_journal_cursor_open(&cursor, dir, oldest - 2) == DIRWD_JOURNAL_GAP);
+    dirwd_journal_cursor_close(&cursor);
+    TEST_ASSERT(read_since(dir, oldest - 1, 500));
+    TEST_ASSERT(read_since(dir, 0, 500));
+
+    dirwd_journal_close(&journal);
+    journal_remove(dir);
+}
+
+static void test_dirwd_journal_reopen() {
+    char dir[PATH_MAX];
+    journal_dir(dir);
+
+    struct dirwd_journal_t* journal = dirwd_journal_open(dir, SEGMENT_BYTES, SIZE_MAX);
+    for (uint64_t seq = 1; seq <= 30; seq++) {
+        append_seq(journal, seq);
+    }
+    dirwd_journal_commit(journal);
+    dirwd_journal_close(&journal);
+
+    journal = dirwd_journal_open(dir, SEGMENT_BYTES, SIZE_MAX);
+    TEST_ASSERT(journal != NULL);
+    TEST_ASSERT(append_seq(journal, 31) == 31);
+    dirwd_journal_commit(journal);
+
+    TEST_ASSERT(read_since(dir, 0, 31));
+    TEST_ASSERT(read_since(dir, 30, 31));
+
+    dirwd_journal_close(&journal);
+    journal_remove(dir);
+}
+
+static void test_dirwd_journal_torn_tail() {
+    char dir[PATH_MAX];
+    journal_dir(dir);
+
+    struct dirwd_journal_t* journal = dirwd_journal_open(dir, SIZE_MAX, SIZE_MAX);
+    for (uint64_t seq = 1; seq <= 10; seq++) {
+        append_seq(journal, seq);
+    }
+    dirwd_journal_commit(journal);
+    dirwd_journal_close(&journal);
+
+    /* Cut last record in half as if the daemon crashed during write */
+    char segment_path[PATH_MAX];
+    struct stat segment_stat;
+    TEST_ASSERT(segment_file(dir, 1, "seg", segment_path));
+    TEST_ASSERT(stat(segment_path, &segment_stat) == 0);
+    TEST_ASSERT(truncate(segment_path, segment_stat.st_size - 5) == 0);
+
+    TEST_ASSERT(read_since(dir, 0, 9));
+    TEST_ASSERT(read_since(dir, 5, 9));
+
+    /* Writer drops the torn record and reuses its sequence number */
+    journal = dirwd_journal_open(dir, SIZE_MAX, SIZE_MAX);
+    TEST_ASSERT(journal != NULL);
+    TEST_ASSERT(append_seq(journal, 10) == 10);
+    TEST_ASSERT(append_seq(journal, 11) == 11);
+    dirwd_journal_commit(journal);
+
+    TEST_ASSERT(read_since(dir, 0, 11));
+    dirwd_journal_close(&journal);
+
+    /* Next segment was created, but its header was not written completely */
+    TEST_ASSERT(segment_create_torn(dir, 12, 4));
+    journal = dirwd_journal_open(dir, SIZE_MAX, SIZE_MAX);
+    TEST_ASSERT(journal != NULL);
+    TEST_ASSERT(journal_segments(dir) == 1);
+    TEST_ASSERT(append_seq(journal, 12) == 12);
+    dirwd_journal_commit(journal);
+    dirwd_journal_close(&journal);
+
+    TEST_ASSERT(read_since(dir, 0, 12));
+    TEST_ASSERT(read_since(dir, 11, 12));
+
+    /* Empty segment left alone after retention removed all older ones */
+    TEST_ASSERT(journal_remove(dir) == 2);
+    TEST_ASSERT(mkdir(dir, 0755) == 0);
+    TEST_ASSERT(segment_create_torn(dir, 13, 0));
+    journal = dirwd_journal_open(dir, SIZE_MAX, SIZE_MAX);
+    TEST_ASSERT(journal != NULL);
+    TEST_ASSERT(append_seq(journal, 13) == 13);
+    dirwd_journal_commit(journal);
+
+    TEST_ASSERT(read_since(dir, 12, 13));
+    TEST_ASSERT(read_since(dir, 0, 13));
+
+    dirwd_journal_close(&journal);
+    journal_remove(dir);
+}
+
+static void test_dirwd_journal_roll_failure() {
+    char dir[PATH_MAX];
+    journal_dir(dir);
+
+    /* Every record fills a segment, so the second append starts segment 2 */
+    struct dirwd_journal_t* journal = dirwd_journal_open(dir, 1, SIZE_MAX);
+    TEST_ASSERT(append_seq(journal, 1) == 1);
+
+    /* Index of the next segment can not be opened */
+    char index_path[PATH_MAX];
+    char segment_path[PATH_MAX];
+    TEST_ASSERT(segment_file(dir, 2, "idx", index_path) && segment_file(dir, 2, "seg", segment_path));
+    TEST_ASSERT(mkdir(index_path, 0755) == 0);
+
+    TEST_ASSERT(append_seq(journal, 2) == 0);
+    TEST_ASSERT(append_seq(journal, 2) == 0);
+    TEST_ASSERT(!dirwd_journal_commit(journal));
+    TEST_ASSERT(access(segment_path, F_OK) != 0);
+    TEST_ASSERT(journal_segments(dir) == 1);
+
+    /* Segment is started once the index can be opened again */
+    TEST_ASSERT(rmdir(index_path) == 0);
+    TEST_ASSERT(append_seq(journal, 2) == 2);
+    TEST_ASSERT(append_seq(journal, 3) == 3);
+    TEST_ASSERT(dirwd_journal_commit(journal));
+    TEST_ASSERT(read_since(dir, 0, 3));
+
+    dirwd_journal_close(&journal);
+    journal_remove(dir);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_journal_since);
+    TEST_RUN(test_dirwd_journal_retention);
+    TEST_RUN(test_dirwd_journal_reopen);
+    TEST_RUN(test_dirwd_journal_torn_tail);
+    TEST_RUN(test_dirwd_journal_roll_failure);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
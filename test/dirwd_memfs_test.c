@@ -0,0 +1,234 @@
+/**
+ * @file dirwd_memfs_test.c
+ * @date 18 Oct 2026
+ * @brief Simulated filesystem backend tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+#include "../src/daemon/dirwd_memfs.h"
+
+static struct dirwd_memfs_t* memfs_new(uint64_t seed) {
+    const struct dirwd_memfs_opts_t opts = { .seed = seed, .opendir_latency_ns = 0, .stat_latency_ns = 0 };
+    return dirwd_memfs_new("/sim", &opts);
+}
+
+static struct fsnap_t* memfs_scan(struct dirwd_memfs_t* memfs, size_t threads, bool inode_order) {
+    const struct dirwd_scan_opts_t scan_opts = {
+        .threads = threads,
+        .one_fs = true,
+        .follow_symlinks = true,
+        .inode_order = inode_order,
+        .filter = NULL,
+        .filter_ctx = NULL,
+        .prof = NULL,
+        .fs = dirwd_memfs_ops(),
+        .fs_ctx = memfs,
+    };
+
+    struct fsnap_t* snap = fsnap_new();
+    dirwd_scan_tree(snap, memfs->root, &scan_opts);
+    fsnap_seal(snap);
+    return snap;
+}
+
+static void test_dirwd_memfs_generate() {
+    struct dirwd_memfs_t* memfs = memfs_new(1);
+    dirwd_memfs_generate(memfs, 3, 2, 5);
+
+    TEST_ASSERT(memfs->dirs == 13);
+    TEST_ASSERT(memfs->files == 65);
+
+    struct fsnap_t* snap = memfs_scan(memfs, 4, false);
+    TEST_ASSERT(fsnap_len(snap) == 65);
+
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_find(snap, "/sim/d2/d1/f4", &idx));
+    TEST_ASSERT(!fsnap_find(snap, "/sim/d3/f0", &idx));
+
+    /* Same seed gives the same tree */
+    struct dirwd_memfs_t* other = memfs_new(1);
+    dirwd_memfs_generate(other, 3, 2, 5);
+    struct fsnap_t* other_snap = memfs_scan(other, 1, true);
+
+    uint64_t summary = 0;
+    uint64_t other_summary = 0;
+    TEST_ASSERT(fsnap_dir_summary(snap, "/sim", &summary));
+    TEST_ASSERT(fsnap_dir_summary(other_snap, "/sim", &other_summary));
+    TEST_ASSERT(summary == other_summary);
+
+    fsnap_drop(&other_snap);
+    fsnap_drop(&snap);
+    dirwd_memfs_drop(&other);
+    dirwd_memfs_drop(&memfs);
+    TEST_ASSERT(memfs == NULL);
+}
+
+static void test_dirwd_memfs_churn_diff() {
+    struct dirwd_memfs_t* memfs = memfs_new(7);
+    dirwd_memfs_generate(memfs, 4, 2, 20);
+
+    for (size_t round = 0; round < 3; round++) {
+        struct fsnap_t* old_snap = memfs_scan(memfs, 4, round == 1);
+
+        const struct dirwd_memfs_churn_t churn = { .creates = 50, .removes = 30, .modifies = 40, .create_dirs = 2 };
+        struct dirwd_memfs_churn_t done;
+        dirwd_memfs_churn(memfs, &churn, &done);
+        TEST_ASSERT((done.creates == 50) && (done.removes == 30) && (done.modifies == 40));
+
+        /* Every applied change is exactly one event */
+        struct fsnap_t* new_snap = memfs_scan(memfs, 4, round == 2);
+        struct fsnap_diff_t diff;
+        fsnap_diff(old_snap, new_snap, &diff);
+
+        TEST_ASSERT(diff.new_entries.len == 50);
+        TEST_ASSERT(diff.deleted_entries.len == 30);
+        TEST_ASSERT(diff.modified_entries.len == 40);
+        TEST_ASSERT(fsnap_len(new_snap) == memfs->files);
+
+        fsnap_diff_clean(&diff);
+        fsnap_drop(&new_snap);
+        fsnap_drop(&old_snap);
+    }
+
+    dirwd_memfs_drop(&memfs);
+}
+
+static void test_dirwd_memfs_add_remove() {
+    struct dirwd_memfs_t* memfs = memfs_new(3);
+
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/a/b/c", false, 10));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/a/d", false, 20));
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/e/", true, 0));
+    TEST_ASSERT(!dirwd_memfs_add(memfs, "/other/x", false, 1));
+    TEST_ASSERT(!dirwd_memfs_add(memfs, "/sim/a/d/x", false, 1));
+    TEST_ASSERT((memfs->files == 2) && (memfs->dirs == 4));
+
+    const struct dirwd_fs_ops_t* ops = dirwd_memfs_ops();
+    struct stat file_stat;
+    TEST_ASSERT((ops->stat(memfs, "/sim/a/b/c", &file_stat) == 0) && (file_stat.st_size == 10));
+    TEST_ASSERT(S_ISDIR(file_stat.st_mode) == false);
+    TEST_ASSERT((ops->stat(memfs, "/sim/e", &file_stat) == 0) && S_ISDIR(file_stat.st_mode));
+
+    TEST_ASSERT(dirwd_memfs_remove(memfs, "/sim/a"));
+    TEST_ASSERT(!dirwd_memfs_remove(memfs, "/sim/a"));
+    TEST_ASSERT((memfs->files == 0) && (memfs->dirs == 2));
+
+    errno = 0;
+    TEST_ASSERT((ops->opendir(memfs, "/sim/a/b") == NULL) && (errno == ENOENT));
+
+    /* Removed name can be created again */
+    TEST_ASSERT(dirwd_memfs_add(memfs, "/sim/a/b/c", false, 30));
+    struct fsnap_t* snap = memfs_scan(memfs, 2, false);
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_len(snap) == 1);
+    TEST_ASSERT(fsnap_find(snap, "/sim/a/b/c", &idx) && (snap->size[idx] == 30));
+
+    fsnap_drop(&snap);
+    dirwd_memfs_drop(&memfs);
+}
+
+static void test_dirwd_memfs_replay() {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+
+    struct fsnap_t* recorded = fsnap_new();
+    char path[64];
+    for (size_t i = 0; i < 100; i++) {
+        snprintf(path, sizeof(path), "/sim/dir%zu/sub%zu/file%zu", i % 7, i % 3, i);
+        file_stat.st_size = (off_t) i;
+        fsnap_push(recorded, path, &file_stat);
+    }
+    fsnap_push(recorded, "/simulated/outside", &file_stat);
+    fsnap_seal(recorded);
+
+    struct dirwd_memfs_t* memfs = memfs_new(5);
+    TEST_ASSERT(dirwd_memfs_replay(memfs, recorded) == 100);
+
+    struct fsnap_t* snap = memfs_scan(memfs, 3, false);
+    TEST_ASSERT(fsnap_len(snap) == 100);
+
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_find(snap, "/sim/dir5/sub2/file26", &idx) && (snap->size[idx] == 26));
+    TEST_ASSERT(!fsnap_find(snap, "/simulated/outside", &idx));
+
+    fsnap_drop(&snap);
+    fsnap_drop(&recorded);
+    dirwd_memfs_drop(&memfs);
+}
+
+static struct fsnap_t* recorded_new(size_t first, size_t last, int64_t size_bump) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+
+    struct fsnap_t* recorded = fsnap_new();
+    char path[64];
+    for (size_t i = first; i < last; i++) {
+        snprintf(path, sizeof(path), "/sim/dir%zu/file%zu", i % 5, i);
+        file_stat.st_size = (off_t) i + ((i % 4 == 0) ? size_bump : 0);
+        fsnap_push(recorded, path, &file_stat);
+    }
+    fsnap_seal(recorded);
+    return recorded;
+}
+
+static void test_dirwd_memfs_apply() {
+    /* Files 0-9 removed, 60-69 created, every fourth one modified */
+    struct fsnap_t* recorded_old = recorded_new(0, 60, 0);
+    struct fsnap_t* recorded_next = recorded_new(10, 70, 100);
+    struct fsnap_diff_t recorded_diff;
+    fsnap_diff(recorded_old, recorded_next, &recorded_diff);
+
+    struct dirwd_memfs_t* memfs = memfs_new(9);
+    TEST_ASSERT(dirwd_memfs_replay(memfs, recorded_old) == 60);
+    struct fsnap_t* old_snap = memfs_scan(memfs, 2, false);
+
+    struct dirwd_memfs_churn_t done;
+    dirwd_memfs_apply(memfs, recorded_old, recorded_next, &recorded_diff, &done);
+    TEST_ASSERT((done.creates == 10) && (done.removes == 10) && (done.modifies == 12));
+
+    /* Simulated tree has recorded files and sizes, each change is one event */
+    struct fsnap_t* new_snap = memfs_scan(memfs, 2, true);
+    TEST_ASSERT(fsnap_len(new_snap) == fsnap_len(recorded_next));
+    for (size_t i = 0; i < fsnap_len(recorded_next); i++) {
+        size_t idx = 0;
+        TEST_ASSERT(fsnap_find(new_snap, fsnap_path(recorded_next, i), &idx));
+        TEST_ASSERT(new_snap->size[idx] == recorded_next->size[fsnap_primary(recorded_next, i)]);
+    }
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+    TEST_ASSERT(diff.new_entries.len == 10);
+    TEST_ASSERT(diff.deleted_entries.len == 10);
+    TEST_ASSERT(diff.modified_entries.len == 12);
+
+    fsnap_diff_clean(&diff);
+    fsnap_diff_clean(&recorded_diff);
+    fsnap_drop(&new_snap);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&recorded_next);
+    fsnap_drop(&recorded_old);
+    dirwd_memfs_drop(&memfs);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_memfs_generate);
+    TEST_RUN(test_dirwd_memfs_churn_diff);
+    TEST_RUN(test_dirwd_memfs_add_remove);
+    TEST_RUN(test_dirwd_memfs_replay);
+    TEST_RUN(test_dirwd_memfs_apply);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
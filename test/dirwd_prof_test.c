@@ -0,0 +1,175 @@
+/**
+ * @file dirwd_prof_test.c
+ * @date 18 Oct 2026
+ * @brief Per-directory scan profiling tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "tree.h"
+#include "../src/daemon/dirwd_prof.h"
+
+static struct dirwd_prof_t* prof_new(size_t top) {
+    struct dirwd_prof_opts_t opts = { .enabled = true, .top = top, .file = "" };
+    return dirwd_prof_new(&opts);
+}
+
+static void prof_record(struct dirwd_prof_t* prof, const char* path, uint64_t readdir_ns, uint64_t entries) {
+    const struct dirwd_prof_dir_stats_t stats = { readdir_ns, 0, entries, 0 };
+    dirwd_prof_record(prof, path, &stats);
+}
+
+static void test_dirwd_prof_subtree_sums() {
+    struct dirwd_prof_t* prof = prof_new(DIRWD_PROF_TOP_DEFAULT);
+
+    /* Recorded in scan order, parent always before its subdirectories */
+    dirwd_prof_begin(prof);
+    prof_record(prof, "/r", 10, 2);
+    prof_record(prof, "/r/a/", 100, 1);
+    prof_record(prof, "/r/b", 500, 7);
+    prof_record(prof, "/r/a/x", 1000, 3);
+    dirwd_prof_end(prof);
+
+    TEST_ASSERT(prof->last_dirs == 4);
+    TEST_ASSERT(prof->last_entries == 13);
+
+    /* Root and '/r/a' are dominated by their slowest subdirectory */
+    TEST_ASSERT(prof->slow_len == 2);
+    if (prof->slow_len == 2) {
+        TEST_ASSERT(strcmp(prof->slow[0].path, "/r/a/x") == 0);
+        TEST_ASSERT(prof->slow[0].dir.subtree_ns == 1000);
+        TEST_ASSERT(strcmp(prof->slow[1].path, "/r/b") == 0);
+        TEST_ASSERT(prof->slow[1].dir.subtree_entries == 7);
+    }
+
+    dirwd_prof_drop(&prof);
+    TEST_ASSERT(prof == NULL);
+}
+
+static void test_dirwd_prof_top() {
+    struct dirwd_prof_t* prof = prof_new(3);
+    char path[64];
+
+    dirwd_prof_begin(prof);
+    prof_record(prof, "/r", 1, 10);
+    for (size_t i = 1; i <= 10; i++) {
+        snprintf(path, sizeof(path), "/r/d%zu", i);
+        prof_record(prof, path, i * 100, 1);
+    }
+    dirwd_prof_end(prof);
+
+    TEST_ASSERT(prof->slow_len == 3);
+    if (prof->slow_len == 3) {
+        TEST_ASSERT(strcmp(prof->slow[0].path, "/r") == 0);
+        TEST_ASSERT(prof->slow[0].dir.subtree_ns == 5501);
+        TEST_ASSERT(prof->slow[0].dir.subtree_dirs == 11);
+        TEST_ASSERT(prof->slow[0].dir.subtree_entries == 20);
+        TEST_ASSERT(strcmp(prof->slow[1].path, "/r/d10") == 0);
+        TEST_ASSERT(strcmp(prof->slow[2].path, "/r/d9") == 0);
+    }
+
+    /* Next inspection replaces the report */
+    dirwd_prof_begin(prof);
+    prof_record(prof, "/r", 7, 0);
+    dirwd_prof_end(prof);
+
+    TEST_ASSERT(prof->inspections == 2);
+    TEST_ASSERT(prof->last_dirs == 1);
+    TEST_ASSERT((prof->slow_len == 1) && (prof->slow[0].dir.subtree_ns == 7));
+
+    dirwd_prof_drop(&prof);
+}
+
+static void test_dirwd_prof_histograms() {
+    struct dirwd_prof_t* prof = prof_new(DIRWD_PROF_TOP_DEFAULT);
+
+    dirwd_prof_begin(prof);
+    prof_record(prof, "/h", 0, 0);
+    prof_record(prof, "/h/a", 1, 1);
+    prof_record(prof, "/h/b", 3, 2);
+    prof_record(prof, "/h/c", 1024, 1000);
+    prof_record(prof, "/h/d", UINT64_MAX, 1);
+    dirwd_prof_end(prof);
+
+    TEST_ASSERT(prof->readdir_hist.count[0] == 1);
+    TEST_ASSERT(prof->readdir_hist.count[1] == 1);
+    TEST_ASSERT(prof->readdir_hist.count[2] == 1);
+    TEST_ASSERT(prof->readdir_hist.count[11] == 1);
+    TEST_ASSERT(prof->readdir_hist.count[DIRWD_PROF_BUCKETS - 1] == 1);
+    TEST_ASSERT(prof->stat_hist.count[0] == 5);
+    TEST_ASSERT(prof->entries_hist.count[1] == 2);
+    TEST_ASSERT(prof->entries_hist.count[10] == 1);
+
+    /* Histograms accumulate over inspections */
+    dirwd_prof_begin(prof);
+    prof_record(prof, "/h", 0, 0);
+    dirwd_prof_end(prof);
+    TEST_ASSERT(prof->readdir_hist.count[0] == 2);
+
+    dirwd_prof_drop(&prof);
+}
+
+static void test_dirwd_prof_scan() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "dirwd_prof_test")) {
+        return;
+    }
+
+    tree_mkdir(&tree, "a");
+    tree_mkdir(&tree, "a/b");
+    tree_mkdir(&tree, "c");
+    tree_write(&tree, "f1", "");
+    tree_write(&tree, "a/f2", "");
+    tree_write(&tree, "a/b/f3", "");
+    tree_write(&tree, "a/b/f4", "");
+
+    struct dirwd_prof_opts_t prof_opts = { .enabled = true, .top = DIRWD_PROF_TOP_DEFAULT, .file = "" };
+    TEST_ASSERT(snprintf(prof_opts.file, sizeof(prof_opts.file), "%s/report/profile.txt", tree.root)
+        < (int) sizeof(prof_opts.file));
+
+    struct dirwd_prof_t* prof = dirwd_prof_new(&prof_opts);
+    struct dirwd_scan_opts_t scan_opts = tree_scan_opts();
+    scan_opts.prof = prof;
+
+    struct fsnap_t* snap = fsnap_new();
+    dirwd_prof_begin(prof);
+    dirwd_scan_tree(snap, tree.root, &scan_opts);
+    dirwd_prof_end(prof);
+
+    /* Every directory is recorded once, entries include subdirectories */
+    TEST_ASSERT(fsnap_len(snap) == 4);
+    TEST_ASSERT(prof->last_dirs == 4);
+    TEST_ASSERT(prof->last_entries == 7);
+    TEST_ASSERT(prof->last_errors == 0);
+    TEST_ASSERT(prof->slow_len > 0);
+
+    /* Report directory is created on dump */
+    TEST_ASSERT(dirwd_prof_dump(prof));
+
+    struct stat report_stat;
+    TEST_ASSERT((stat(prof_opts.file, &report_stat) == 0) && (report_stat.st_size > 0));
+
+    fsnap_drop(&snap);
+    dirwd_prof_drop(&prof);
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_prof_subtree_sums);
+    TEST_RUN(test_dirwd_prof_top);
+    TEST_RUN(test_dirwd_prof_histograms);
+    TEST_RUN(test_dirwd_prof_scan);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file dirwd_query_test.c
+ * @date 18 Oct 2026
+ * @brief Query socket tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/util/fsnap_pub.h"
+#include "../src/daemon/dirwd_ctl.h"
+#include "../src/daemon/dirwd_query.h"
+#include "../src/daemon/dirwd_state.h"
+#include "../src/daemon/dirwd.h"
+
+static struct fsnap_t* snap_new(int64_t size) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(file_stat));
+    file_stat.st_size = (off_t) size;
+    file_stat.st_mtim.tv_sec = 7;
+
+    struct fsnap_t* snap = fsnap_new();
+    fsnap_push(snap, "/r/a/x", &file_stat);
+    fsnap_push(snap, "/r/b", &file_stat);
+    fsnap_seal(snap);
+    return snap;
+}
+
+static void test_dirwd_query_answer() {
+    struct fsnap_pub_t* pub = fsnap_pub_new();
+    char reply[DIRWD_QUERY_REPLY_SIZE];
+
+    dirwd_query_answer(pub, "INFO", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, "ERR no snapshot published yet") == 0);
+
+    fsnap_pub_publish(pub, snap_new(1));
+    fsnap_pub_publish(pub, snap_new(42));
+
+    dirwd_query_answer(pub, "INFO", reply, sizeof(reply));
+    TEST_ASSERT(strncmp(reply, "OK 2 2 ", 7) == 0);
+
+    dirwd_query_answer(pub, "STAT /r/a/x", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, "FILE 2 42 7000000000") == 0);
+
+    uint64_t summary = 0;
+    char expected[DIRWD_QUERY_REPLY_SIZE];
+    TEST_ASSERT(fsnap_dir_summary(fsnap_pub_latest(pub), "/r/a", &summary));
+    snprintf(expected, sizeof(expected), "DIR 2 %016llx", (unsigned long long) summary);
+    dirwd_query_answer(pub, "STAT /r/a/", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, expected) == 0);
+
+    dirwd_query_answer(pub, "STAT /r/c", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, "NONE 2") == 0);
+
+    dirwd_query_answer(pub, "STATS /r/b", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, "ERR unknown command") == 0);
+    dirwd_query_answer(pub, "", reply, sizeof(reply));
+    TEST_ASSERT(strcmp(reply, "ERR unknown command") == 0);
+
+    /* Answers take no reference with them */
+    TEST_ASSERT(fsnap_pub_reclaim(pub) == 0);
+
+    fsnap_pub_drop(&pub);
+}
+
+static void test_dirwd_query_socket() {
+    char socket_path[64];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/dirwd_query_test_%d.sock", (int) getpid());
+
+    struct dirwd_query_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    strcpy(opts.socket_path, socket_path);
+
+    struct fsnap_pub_t* pub = fsnap_pub_new();
+    struct dirwd_query_t* query = dirwd_query_open(pub, &opts);
+    TEST_ASSERT(query != NULL);
+
+    char reply[DIRWD_QUERY_REPLY_SIZE];
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "STAT /r/b", reply, sizeof(reply)));
+    TEST_ASSERT(strcmp(reply, "ERR no snapshot published yet") == 0);
+
+    /* Publishing needs no coordination with the serving thread */
+    fsnap_pub_publish(pub, snap_new(5));
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "STAT /r/b", reply, sizeof(reply)));
+    TEST_ASSERT(strcmp(reply, "FILE 1 5 7000000000") == 0);
+
+    fsnap_pub_publish(pub, snap_new(6));
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "STAT /r/b", reply, sizeof(reply)));
+    TEST_ASSERT(strcmp(reply, "FILE 2 6 7000000000") == 0);
+
+    dirwd_query_close(&query);
+    TEST_ASSERT(query == NULL);
+    TEST_ASSERT(access(socket_path, F_OK) != 0);
+
+    fsnap_pub_drop(&pub);
+}
+
+static bool config_write(const char* config_path, const char* config) {
+    FILE* const fout = fopen(config_path, "w");
+    if (fout == NULL) {
+        return false;
+    }
+
+    const bool is_written = (fputs(config, fout) >= 0);
+    return (fclose(fout) == 0) && is_written;
+}
+
+static void test_dirwd_query_reload() {
+    char config_path[64];
+    char socket_path[64];
+    char config[256];
+    snprintf(config_path, sizeof(config_path), "/tmp/dirwd_query_test_%d.config", (int) getpid());
+    snprintf(socket_path, sizeof(socket_path), "/tmp/dirwd_query_test_%d.reload.sock", (int) getpid());
+
+    struct dirwd_state_t state;
+    memset(&state, 0, sizeof(state));
+
+    snprintf(config, sizeof(config), "/tmp 10 query=%s\n", socket_path);
+    TEST_ASSERT(config_write(config_path, config));
+    TEST_ASSERT(dirwd_init(config_path, &state) == DIRWD_SUCCESS);
+    TEST_ASSERT((state.query != NULL) && (strcmp(state.target_dir, "/tmp") == 0));
+
+    char reply[DIRWD_QUERY_REPLY_SIZE];
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "INFO", reply, sizeof(reply)));
+
+    /* Failed setup keeps the running state */
+    struct dirwd_query_t* const query = state.query;
+    TEST_ASSERT(config_write(config_path, "/tmp 10 query=/nonexistent/dirwd/query.sock\n"));
+    TEST_ASSERT(dirwd_init(config_path, &state) != DIRWD_SUCCESS);
+    TEST_ASSERT((state.query == query) && (strcmp(state.target_dir, "/tmp") == 0));
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "INFO", reply, sizeof(reply)));
+
+    /* Closing the previous socket does not remove the new one at the same path */
+    snprintf(config, sizeof(config), "/tmp 10 query=%s\n", socket_path);
+    TEST_ASSERT(config_write(config_path, config));
+    TEST_ASSERT(dirwd_init(config_path, &state) == DIRWD_SUCCESS);
+    TEST_ASSERT(dirwd_ctl_send(socket_path, "INFO", reply, sizeof(reply)));
+    TEST_ASSERT(strcmp(reply, "ERR no snapshot published yet") == 0);
+
+    dirwd_state_clean(&state);
+    TEST_ASSERT((state.target_dir == NULL) && (state.query == NULL) && (state.pub == NULL));
+    TEST_ASSERT(access(socket_path, F_OK) != 0);
+    unlink(config_path);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_query_answer);
+    TEST_RUN(test_dirwd_query_socket);
+    TEST_RUN(test_dirwd_query_reload);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file dirwd_ring_test.c
+ * @date 18 Oct 2026
+ * @brief Shared memory event ring correctness tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include "test.h"
+#include "dirwd_ring.h"
+
+#define RING_PATH_TEMPLATE "/tmp/dirwd_ring_test_%d"
+#define STRESS_EVENTS ((uint64_t) 200000)
+
+static void ring_path(char* path, size_t len) {
+    snprintf(path, len, RING_PATH_TEMPLATE, (int) getpid());
+}
+
+static void publish_seq(struct dirwd_ring_t* ring, uint64_t seq) {
+    char path[64];
+    snprintf(path, sizeof(path), "/f/%" PRIu64, seq);
+    dirwd_ring_publish(ring, DIRWD_RING_MODIFIED, path, (int64_t) seq, (int64_t) seq * 2);
+}
+
+static bool event_is_consistent(const struct dirwd_ring_event_t* event) {
+    char path[64];
+    snprintf(path, sizeof(path), "/f/%" PRIu64, event->seq);
+
+    return (strcmp(event->path, path) == 0)
+        && (event->size == (int64_t) event->seq)
+        && (event->mtime_ns == (int64_t) event->seq * 2);
+}
+
+static void test_dirwd_ring_publish_read() {
+    char path[64];
+    ring_path(path, sizeof(path));
+    unlink(path);
+
+    struct dirwd_ring_t* ring = dirwd_ring_open(path, 16);
+    TEST_ASSERT(ring != NULL);
+    TEST_ASSERT(dirwd_ring_open(path, 12) == NULL);
+
+    struct dirwd_ring_reader_t reader;
+    struct dirwd_ring_event_t event;
+    TEST_ASSERT(dirwd_ring_reader_open(&reader, path, true));
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EMPTY);
+
+    dirwd_ring_publish(ring, DIRWD_RING_NEW, "/a", 1, 2);
+    dirwd_ring_publish(ring, DIRWD_RING_DELETED, "/b", 3, 4);
+
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT);
+    TEST_ASSERT((event.seq == 1) && (event.type == DIRWD_RING_NEW) && (strcmp(event.path, "/a") == 0));
+    TEST_ASSERT((event.size == 1) && (event.mtime_ns == 2) && (event.flags == 0));
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT);
+    TEST_ASSERT((event.seq == 2) && (event.type == DIRWD_RING_DELETED) && (strcmp(event.path, "/b") == 0));
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EMPTY);
+
+    /* Long path is truncated and flagged */
+    char long_path[DIRWD_RING_PATH_CAP + 100];
+    memset(long_path, 'x', sizeof(long_path) - 1);
+    long_path[sizeof(long_path) - 1] = '\0';
+    dirwd_ring_publish(ring, DIRWD_RING_NEW, long_path, 0, 0);
+
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT);
+    TEST_ASSERT((event.flags & DIRWD_RING_TRUNCATED) != 0);
+    TEST_ASSERT(strlen(event.path) == DIRWD_RING_PATH_CAP);
+
+    /* Reader opened at head only sees new events */
+    struct dirwd_ring_reader_t tail_reader;
+    TEST_ASSERT(dirwd_ring_reader_open(&tail_reader, path, false));
+    TEST_ASSERT(dirwd_ring_read(&tail_reader, &event) == DIRWD_RING_EMPTY);
+    dirwd_ring_publish(ring, DIRWD_RING_NEW, "/c", 0, 0);
+    TEST_ASSERT((dirwd_ring_read(&tail_reader, &event) == DIRWD_RING_EVENT) && (event.seq == 4));
+
+    dirwd_ring_reader_close(&tail_reader);
+    dirwd_ring_reader_close(&reader);
+    dirwd_ring_close(&ring);
+    TEST_ASSERT(ring == NULL);
+    unlink(path);
+}
+
+static void test_dirwd_ring_overrun() {
+    char path[64];
+    ring_path(path, sizeof(path));
+    unlink(path);
+
+    struct dirwd_ring_t* ring = dirwd_ring_open(path, 8);
+    struct dirwd_ring_reader_t reader;
+    struct dirwd_ring_event_t event;
+    TEST_ASSERT(dirwd_ring_reader_open(&reader, path, true));
+
+    for (uint64_t seq = 1; seq <= 20; seq++) {
+        publish_seq(ring, seq);
+    }
+
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_OVERRUN);
+    TEST_ASSERT(reader.lost == 12);
+
+    for (uint64_t seq = 13; seq <= 20; seq++) {
+        TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT);
+        TEST_ASSERT((event.seq == seq) && event_is_consistent(&event));
+    }
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EMPTY);
+
+    dirwd_ring_reader_close(&reader);
+    dirwd_ring_close(&ring);
+    unlink(path);
+}
+
+static void test_dirwd_ring_reopen() {
+    char path[64];
+    ring_path(path, sizeof(path));
+    unlink(path);
+
+    struct dirwd_ring_t* ring = dirwd_ring_open(path, 8);
+    struct dirwd_ring_reader_t reader;
+    struct dirwd_ring_event_t event;
+    TEST_ASSERT(dirwd_ring_reader_open(&reader, path, true));
+
+    publish_seq(ring, 1);
+    publish_seq(ring, 2);
+    dirwd_ring_close(&ring);
+
+    /* Same geometry: sequence continues, reader keeps position */
+    ring = dirwd_ring_open(path, 8);
+    publish_seq(ring, 3);
+
+    for (uint64_t seq = 1; seq <= 3; seq++) {
+        TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT);
+        TEST_ASSERT((event.seq == seq) && event_is_consistent(&event));
+    }
+    dirwd_ring_close(&ring);
+
+    /* Other geometry: ring is replaced, old readers must reopen */
+    ring = dirwd_ring_open(path, 32);
+    TEST_ASSERT(ring != NULL);
+    publish_seq(ring, 1);
+    TEST_ASSERT(dirwd_ring_read(&reader, &event) == DIRWD_RING_STALE);
+    dirwd_ring_reader_close(&reader);
+
+    TEST_ASSERT(dirwd_ring_reader_open(&reader, path, true));
+    TEST_ASSERT((dirwd_ring_read(&reader, &event) == DIRWD_RING_EVENT) && (event.seq == 1));
+
+    dirwd_ring_reader_close(&reader);
+    dirwd_ring_close(&ring);
+    unlink(path);
+}
+
+struct stress_reader_t {
+    struct dirwd_ring_reader_t reader;
+    pthread_t thread;
+    uint64_t read;
+    uint64_t lost;
+    bool is_consistent;
+};
+
+static void* stress_reader(void* arg) {
+    struct stress_reader_t* self = (struct stress_reader_t*) arg;
+    struct dirwd_ring_event_t event;
+    uint64_t last_seq = 0;
+
+    self->is_consistent = true;
+
+    while (self->is_consistent && (last_seq < STRESS_EVENTS)) {
+        const int status = dirwd_ring_read(&self->reader, &event);
+
+        if (status == DIRWD_RING_EVENT) {
+            self->is_consistent = (event.seq > last_seq) && event_is_consistent(&event);
+            last_seq = event.seq;
+            self->read++;
+        } else if (status == DIRWD_RING_STALE) {
+            self->is_consistent = false;
+        }
+    }
+
+    self->lost = self->reader.lost;
+    return NULL;
+}
+
+static void test_dirwd_ring_concurrent_readers() {
+    char path[64];
+    ring_path(path, sizeof(path));
+    unlink(path);
+
+    struct dirwd_ring_t* ring = dirwd_ring_open(path, 64);
+    struct stress_reader_t readers[2];
+
+    for (size_t i = 0; i < 2; i++) {
+        TEST_ASSERT(dirwd_ring_reader_open(&readers[i].reader, path, true));
+        readers[i].read = 0;
+        readers[i].lost = 0;
+        pthread_create(&readers[i].thread, NULL, stress_reader, &readers[i]);
+    }
+
+    for (uint64_t seq = 1; seq <= STRESS_EVENTS; seq++) {
+        publish_seq(ring, seq);
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        pthread_join(readers[i].thread, NULL);
+        TEST_ASSERT(readers[i].is_consistent);
+        TEST_ASSERT(readers[i].read + readers[i].lost == STRESS_EVENTS);
+        dirwd_ring_reader_close(&readers[i].reader);
+    }
+
+    dirwd_ring_close(&ring);
+    unlink(path);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_ring_publish_read);
+    TEST_RUN(test_dirwd_ring_overrun);
+    TEST_RUN(test_dirwd_ring_reopen);
+    TEST_RUN(test_dirwd_ring_concurrent_readers);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
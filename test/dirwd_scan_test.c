@@ -0,0 +1,91 @@
+/**
+ * @file dirwd_scan_test.c
+ * @date 18 Oct 2026
+ * @brief Parallel tree scanner tests on temporary directory tree
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "tree.h"
+
+static struct fsnap_t* scan_tree(const char* root, size_t threads) {
+    struct dirwd_scan_opts_t scan_opts = tree_scan_opts();
+    scan_opts.threads = threads;
+
+    struct fsnap_t* snap = fsnap_new();
+    dirwd_scan_tree(snap, root, &scan_opts);
+    fsnap_seal(snap);
+    return snap;
+}
+
+static bool scan_has(const struct fsnap_t* snap, const struct tree_t* tree, const char* name) {
+    char path[PATH_MAX];
+    size_t idx = 0;
+
+    return tree_path(tree, name, path) && fsnap_find(snap, path, &idx);
+}
+
+static void test_dirwd_scan_aliases() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "dirwd_scan")) {
+        return;
+    }
+
+    /* real is reached as real, a_link and b_link, other also through real/z_link */
+    tree_mkdir(&tree, "real");
+    tree_mkdir(&tree, "real/sub");
+    tree_mkdir(&tree, "other");
+    tree_write(&tree, "real/f", "");
+    tree_write(&tree, "real/sub/f", "");
+    tree_write(&tree, "other/f", "");
+    tree_symlink(&tree, "real", "a_link");
+    tree_symlink(&tree, "real", "b_link");
+    tree_symlink(&tree, "../other", "real/z_link");
+
+    struct fsnap_t* expected = scan_tree(tree.root, 1);
+    TEST_ASSERT(fsnap_len(expected) == 3);
+    TEST_ASSERT(scan_has(expected, &tree, "a_link/f"));
+    TEST_ASSERT(scan_has(expected, &tree, "a_link/sub/f"));
+    TEST_ASSERT(scan_has(expected, &tree, "a_link/z_link/f"));
+    TEST_ASSERT(!scan_has(expected, &tree, "real/f"));
+    TEST_ASSERT(!scan_has(expected, &tree, "other/f"));
+
+    uint64_t expected_summary = 0;
+    TEST_ASSERT(fsnap_dir_summary(expected, tree.root, &expected_summary));
+
+    /* Whichever path wins the race, recorded paths are the same */
+    for (size_t run = 0; run < 32; run++) {
+        struct fsnap_t* snap = scan_tree(tree.root, 4);
+        uint64_t summary = 0;
+
+        TEST_ASSERT(fsnap_len(snap) == 3);
+        TEST_ASSERT(fsnap_dir_summary(snap, tree.root, &summary) && (summary == expected_summary));
+        TEST_ASSERT(scan_has(snap, &tree, "a_link/z_link/f"));
+
+        struct fsnap_diff_t diff;
+        fsnap_diff(expected, snap, &diff);
+        TEST_ASSERT((diff.new_entries.len == 0) && (diff.deleted_entries.len == 0));
+        fsnap_diff_clean(&diff);
+        fsnap_drop(&snap);
+    }
+
+    fsnap_drop(&expected);
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_scan_aliases);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file dirwd_storm_test.c
+ * @date 18 Oct 2026
+ * @brief Event storm aggregation tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_storm.h"
+#include "../src/daemon/dirwd_output.h"
+#include "tree.h"
+
+static void push_files(struct fsnap_t* snap, const char* dir, const char* prefix, size_t count, off_t size) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+    file_stat.st_size = size;
+
+    char path[128];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s%zu", dir, prefix, i);
+        fsnap_push(snap, path, &file_stat);
+    }
+}
+
+/* Every entry of sealed snapshot is an event */
+static void find_storms(struct dirwd_storm_t* storm, struct fsnap_t* snap, size_t threshold) {
+    fsnap_seal(snap);
+
+    struct fsnap_idx_vec_t entries = { 0, 0, NULL };
+    for (size_t i = 0; i < fsnap_len(snap); i++) {
+        fsnap_idx_vec_push(&entries, i);
+    }
+
+    dirwd_storm_find(storm, snap, &entries, threshold);
+    free(entries.buffer);
+}
+
+static const struct dirwd_storm_root_t* find_root(const struct dirwd_storm_t* storm, const char* dir) {
+    for (size_t i = 0; i < storm->roots_len; i++) {
+        const struct dirwd_storm_root_t* root = &storm->roots[i];
+        if ((root->dir_len == strlen(dir)) && (strncmp(root->dir, dir, root->dir_len) == 0)) {
+            return root;
+        }
+    }
+
+    return NULL;
+}
+
+static size_t count_alone(const struct dirwd_storm_t* storm) {
+    size_t alone = 0;
+    for (size_t i = 0; i < storm->len; i++) {
+        alone += (storm->events[i].root == DIRWD_STORM_NONE) ? 1 : 0;
+    }
+
+    return alone;
+}
+
+static void test_dirwd_storm_below_threshold() {
+    struct fsnap_t* snap = fsnap_new();
+    push_files(snap, "/t/x", "f", 99, 1);
+
+    struct dirwd_storm_t storm;
+    find_storms(&storm, snap, 100);
+    TEST_ASSERT(storm.len == 99);
+    TEST_ASSERT(storm.roots_len == 0);
+    TEST_ASSERT(count_alone(&storm) == 99);
+
+    dirwd_storm_clean(&storm);
+    fsnap_drop(&snap);
+}
+
+static void test_dirwd_storm_deepest_roots() {
+    struct fsnap_t* snap = fsnap_new();
+    push_files(snap, "/t/x/d1", "f", 150, 10);
+    push_files(snap, "/t/x/d2", "f", 150, 20);
+    push_files(snap, "/t/x", "g", 1, 1);
+    push_files(snap, "/t/y", "h", 5, 1);
+
+    /* Both subdirectories reach threshold, the rest is reported alone */
+    struct dirwd_storm_t storm;
+    find_storms(&storm, snap, 100);
+    TEST_ASSERT(storm.roots_len == 2);
+    TEST_ASSERT(count_alone(&storm) == 6);
+
+    const struct dirwd_storm_root_t* root = find_root(&storm, "/t/x/d1");
+    TEST_ASSERT((root != NULL) && (root->count == 150) && (root->bytes == 1500));
+    root = find_root(&storm, "/t/x/d2");
+    TEST_ASSERT((root != NULL) && (root->count == 150) && (root->bytes == 3000));
+    dirwd_storm_clean(&storm);
+
+    /* No subdirectory reaches higher threshold, their parent is the root */
+    find_storms(&storm, snap, 200);
+    TEST_ASSERT(storm.roots_len == 1);
+    root = find_root(&storm, "/t/x");
+    TEST_ASSERT((root != NULL) && (root->count == 301) && (root->bytes == 4501));
+    TEST_ASSERT(count_alone(&storm) == 5);
+
+    dirwd_storm_clean(&storm);
+    fsnap_drop(&snap);
+}
+
+static void test_dirwd_storm_rest_of_directory() {
+    struct fsnap_t* snap = fsnap_new();
+    push_files(snap, "/t/big/sub", "f", 150, 1);
+    push_files(snap, "/t/big", "f", 120, 1);
+    push_files(snap, "/t/big.old", "f", 3, 1);
+    push_files(snap, "/t", "big-", 3, 1);
+
+    /* Names sorting between "/t/big" and "/t/big/" must not split the subtree */
+    struct dirwd_storm_t storm;
+    find_storms(&storm, snap, 100);
+    TEST_ASSERT(storm.roots_len == 2);
+
+    const struct dirwd_storm_root_t* root = find_root(&storm, "/t/big/sub");
+    TEST_ASSERT((root != NULL) && (root->count == 150));
+    root = find_root(&storm, "/t/big");
+    TEST_ASSERT((root != NULL) && (root->count == 120));
+    TEST_ASSERT(count_alone(&storm) == 6);
+
+    for (size_t i = 0; i < storm.len; i++) {
+        const struct dirwd_storm_event_t* event = &storm.events[i];
+        if (event->root != DIRWD_STORM_NONE) {
+            const struct dirwd_storm_root_t* event_root = &storm.roots[event->root];
+            TEST_ASSERT(strncmp(event->path, event_root->dir, event_root->dir_len) == 0);
+            TEST_ASSERT(event->path[event_root->dir_len] == '/');
+        }
+    }
+
+    dirwd_storm_clean(&storm);
+    fsnap_drop(&snap);
+}
+
+static void test_dirwd_storm_top_level() {
+    struct fsnap_t* snap = fsnap_new();
+    push_files(snap, "", "f", 10, 1);
+
+    struct dirwd_storm_t storm;
+    find_storms(&storm, snap, 10);
+    TEST_ASSERT(storm.roots_len == 1);
+    TEST_ASSERT((storm.roots_len == 1) && (storm.roots[0].dir_len == 0) && (storm.roots[0].count == 10));
+
+    dirwd_storm_clean(&storm);
+    fsnap_drop(&snap);
+}
+
+static size_t count_details(const struct tree_t* tree) {
+    DIR* const dir = opendir(tree->root);
+    struct dirent* dir_entry = NULL;
+    size_t count = 0;
+
+    while ((dir != NULL) && ((dir_entry = readdir(dir)) != NULL)) {
+        count += (strncmp(dir_entry->d_name, "storm-", 6) == 0) ? 1 : 0;
+    }
+
+    if (dir != NULL) {
+        closedir(dir);
+    }
+    return count;
+}
+
+static void test_dirwd_storm_detail_retention() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "dirwd_storm")) {
+        return;
+    }
+
+    /* Detail files left by earlier daemon runs */
+    char name[64];
+    for (size_t i = 0; i < DIRWD_OUTPUT_STORM_FILES + 8; i++) {
+        snprintf(name, sizeof(name), "storm-%zu-000000000.tsv", 1000 + i);
+        tree_write(&tree, name, "");
+    }
+
+    struct dirwd_output_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.sinks = DIRWD_OUTPUT_SYSLOG;
+    opts.storm_threshold = 5;
+    strcpy(opts.storm_dir, tree.root);
+
+    struct dirwd_output_t output;
+    TEST_ASSERT(dirwd_output_open(&output, &opts) == DIRWD_SUCCESS);
+    TEST_ASSERT(count_details(&tree) == DIRWD_OUTPUT_STORM_FILES);
+    TEST_ASSERT(tree_path(&tree, "storm-1007-000000000.tsv", name) && (access(name, F_OK) != 0));
+    TEST_ASSERT(tree_path(&tree, "storm-1008-000000000.tsv", name) && (access(name, F_OK) == 0));
+
+    /* New detail file replaces the oldest one */
+    struct fsnap_t* old_snap = fsnap_new();
+    struct fsnap_t* new_snap = fsnap_new();
+    push_files(new_snap, "/t/x", "f", 10, 1);
+    fsnap_seal(old_snap);
+    fsnap_seal(new_snap);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+    dirwd_output_diff(&output, old_snap, new_snap, &diff);
+    TEST_ASSERT(count_details(&tree) == DIRWD_OUTPUT_STORM_FILES);
+    TEST_ASSERT(tree_path(&tree, "storm-1008-000000000.tsv", name) && (access(name, F_OK) != 0));
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&new_snap);
+    fsnap_drop(&old_snap);
+    dirwd_output_close(&output);
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_storm_below_threshold);
+    TEST_RUN(test_dirwd_storm_deepest_roots);
+    TEST_RUN(test_dirwd_storm_rest_of_directory);
+    TEST_RUN(test_dirwd_storm_top_level);
+    TEST_RUN(test_dirwd_storm_detail_retention);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file dirwd_tier_test.c
+ * @date 18 Oct 2026
+ * @brief Adaptive scan tier tests on temporary directory tree
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "tree.h"
+
+static uint8_t tree_tier(const struct tree_t* tree, const char* name) {
+    char path[PATH_MAX];
+    tree_path(tree, name, path);
+
+    uint8_t tier = 0xff;
+    dirwd_tier_get(tree->tiers, path, &tier);
+    return tier;
+}
+
+static void test_dirwd_tier_promote_demote() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "dirwd_tier")) {
+        return;
+    }
+
+    const struct dirwd_tier_opts_t opts = { .enabled = true, .warm_ticks = 2, .cold_ticks = 4 };
+    tree.tiers = dirwd_tier_new(&opts);
+
+    tree_mkdir(&tree, "hot");
+    tree_mkdir(&tree, "archive");
+    tree_mkdir(&tree, "archive/old");
+    tree_write(&tree, "hot/log", "x");
+    tree_write(&tree, "archive/a", "x");
+    tree_write(&tree, "archive/old/b", "x");
+
+    TEST_ASSERT(tree_inspect_count(&tree) == 3);
+    TEST_ASSERT(tree_tier(&tree, "hot") == DIRWD_TIER_HOT);
+    TEST_ASSERT(tree_tier(&tree, "archive/old") == DIRWD_TIER_HOT);
+
+    /* Hot directory changes every inspection, archive stays quiet */
+    size_t skipped = 0;
+    for (size_t i = 0; i < 40; i++) {
+        tree_write(&tree, "hot/log", "x");
+        TEST_ASSERT(tree_inspect_count(&tree) == 1);
+        skipped += tree.tiers->dirs_skip;
+    }
+
+    TEST_ASSERT(tree_tier(&tree, "hot") == DIRWD_TIER_HOT);
+    TEST_ASSERT(tree_tier(&tree, "archive") == DIRWD_TIER_COLD);
+    TEST_ASSERT(tree_tier(&tree, "archive/old") == DIRWD_TIER_COLD);
+
+    /* Skipped subtrees are carried over, not reported as deleted */
+    TEST_ASSERT(skipped > 0);
+    TEST_ASSERT(fsnap_len(tree.entries) == 3);
+
+    /* Change in cold directory is found within cold interval and promotes it */
+    tree_write(&tree, "archive/old/b", "x");
+    bool is_found = false;
+    for (size_t i = 0; (i < opts.cold_ticks) && !is_found; i++) {
+        struct fsnap_diff_t diff;
+        tree_inspect(&tree, &diff);
+        is_found = diff.modified_entries.len == 1;
+        fsnap_diff_clean(&diff);
+    }
+    TEST_ASSERT(is_found);
+    TEST_ASSERT(tree_tier(&tree, "archive/old") == DIRWD_TIER_HOT);
+    TEST_ASSERT(tree_tier(&tree, "archive") == DIRWD_TIER_COLD);
+
+    /* Removed directory is reported and forgotten */
+    char path[PATH_MAX];
+    tree_path(&tree, "archive/old", path);
+    tree_remove(path);
+
+    struct fsnap_diff_t diff;
+    tree_inspect(&tree, &diff);
+    TEST_ASSERT(diff.deleted_entries.len == 1);
+    fsnap_diff_clean(&diff);
+
+    uint8_t tier = 0;
+    TEST_ASSERT(!dirwd_tier_get(tree.tiers, path, &tier));
+
+    tree_destroy(&tree);
+    TEST_ASSERT(tree.tiers == NULL);
+}
+
+static void test_dirwd_tier_new_dir_in_cold_parent() {
+    struct tree_t tree;
+    if (!tree_create(&tree, "dirwd_tier")) {
+        return;
+    }
+
+    const struct dirwd_tier_opts_t opts = { .enabled = true, .warm_ticks = 1, .cold_ticks = 3 };
+    tree.tiers = dirwd_tier_new(&opts);
+
+    tree_mkdir(&tree, "a");
+    tree_write(&tree, "a/f", "x");
+
+    for (size_t i = 0; i < 20; i++) {
+        tree_inspect_count(&tree);
+    }
+    TEST_ASSERT(tree_tier(&tree, "a") == DIRWD_TIER_COLD);
+
+    /* Whole tree is skipped while nothing is due */
+    size_t skipped = 0;
+    for (size_t i = 0; i < opts.cold_ticks; i++) {
+        TEST_ASSERT(tree_inspect_count(&tree) == 0);
+        skipped += (tree.tiers->dirs_full == 0) ? 1 : 0;
+    }
+    TEST_ASSERT(skipped > 0);
+
+    tree_mkdir(&tree, "a/b");
+    tree_write(&tree, "a/b/g", "x");
+
+    size_t events = 0;
+    for (size_t i = 0; i < opts.cold_ticks; i++) {
+        events += tree_inspect_count(&tree);
+    }
+    TEST_ASSERT(events == 1);
+    TEST_ASSERT(fsnap_len(tree.entries) == 2);
+
+    tree_destroy(&tree);
+}
+
+int main() {
+    TEST_RUN(test_dirwd_tier_promote_demote);
+    TEST_RUN(test_dirwd_tier_new_dir_in_cold_parent);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file fentry_test.c
+ * @date 18 Oct 2026
+ * @brief File entry set correctness tests
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "test.h"
+#include "../src/util/fentry.h"
+
+static struct fentry_t* make_entry(const char* name, off_t size, time_t mtime) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+    file_stat.st_size = size;
+    file_stat.st_mtime = mtime;
+
+    return fentry_new(name, &file_stat);
+}
+
+static struct fentry_set_t* make_set(size_t len) {
+    struct fentry_set_t* set = fentry_set_new();
+    char name[64];
+
+    for (size_t i = 0; i < len; i++) {
+        snprintf(name, sizeof(name), "/tmp/file_%zu", i);
+        fentry_set_insert(set, make_entry(name, (off_t) i, 0));
+    }
+
+    return set;
+}
+
+static void test_fentry_new_clone_equals() {
+    struct fentry_t* a = make_entry("/a", 10, 100);
+    struct fentry_t* b = fentry_clone(a);
+
+    TEST_ASSERT(a != b);
+    TEST_ASSERT(strcmp(a->file_name, b->file_name) == 0);
+    TEST_ASSERT(a->file_name != b->file_name);
+    TEST_ASSERT(fentry_equals(a, b));
+
+    b->file_stat.st_size = 11;
+    TEST_ASSERT(!fentry_equals(a, b));
+    TEST_ASSERT(!fentry_equals(a, NULL));
+    TEST_ASSERT(fentry_new(NULL, &a->file_stat) == NULL);
+
+    fentry_drop(&a);
+    fentry_drop(&b);
+    TEST_ASSERT(a == NULL);
+    TEST_ASSERT(b == NULL);
+}
+
+static void test_fentry_set_insert_get() {
+    struct fentry_set_t* set = make_set(100);
+
+    TEST_ASSERT(fentry_set_len(set) == 100);
+    TEST_ASSERT(!fentry_set_is_empty(set));
+    TEST_ASSERT(fentry_set_contains(set, "/tmp/file_0"));
+    TEST_ASSERT(fentry_set_contains(set, "/tmp/file_99"));
+    TEST_ASSERT(!fentry_set_contains(set, "/tmp/file_100"));
+
+    const struct fentry_t* entry = fentry_set_get(set, "/tmp/file_42");
+    TEST_ASSERT((entry != NULL) && (entry->file_stat.st_size == 42));
+
+    /* Duplicate insert is ignored */
+    fentry_set_insert(set, make_entry("/tmp/file_42", 1000, 0));
+    TEST_ASSERT(fentry_set_len(set) == 100);
+    TEST_ASSERT(fentry_set_get(set, "/tmp/file_42")->file_stat.st_size == 42);
+
+    fentry_set_drop(&set);
+    TEST_ASSERT(set == NULL);
+}
+
+static void test_fentry_set_remove() {
+    /* Full set: len == cap, shift must not read past the buffer */
+    struct fentry_set_t* set = make_set(FENTRY_VEC_DEFAULT_CAP);
+    TEST_ASSERT(set->len == set->cap);
+
+    fentry_set_remove(set, "/tmp/file_0");
+    TEST_ASSERT(fentry_set_len(set) == FENTRY_VEC_DEFAULT_CAP - 1);
+    TEST_ASSERT(!fentry_set_contains(set, "/tmp/file_0"));
+    TEST_ASSERT(fentry_set_contains(set, "/tmp/file_1"));
+
+    fentry_set_remove(set, "/tmp/file_7");
+    TEST_ASSERT(!fentry_set_contains(set, "/tmp/file_7"));
+
+    fentry_set_remove(set, "/tmp/file_3");
+    fentry_set_remove(set, "/tmp/missing");
+    TEST_ASSERT(fentry_set_len(set) == FENTRY_VEC_DEFAULT_CAP - 3);
+
+    for (size_t i = 0; i < set->len; i++) {
+        TEST_ASSERT(set->buffer[i] != NULL);
+    }
+
+    fentry_set_drop(&set);
+}
+
+static void test_fentry_set_pop() {
+    struct fentry_set_t* set = make_set(3);
+
+    struct fentry_t* entry = fentry_set_pop(set);
+    TEST_ASSERT((entry != NULL) && (strcmp(entry->file_name, "/tmp/file_2") == 0));
+    fentry_drop(&entry);
+
+    entry = fentry_set_pop(set);
+    fentry_drop(&entry);
+    entry = fentry_set_pop(set);
+    fentry_drop(&entry);
+
+    TEST_ASSERT(fentry_set_is_empty(set));
+    TEST_ASSERT(fentry_set_pop(set) == NULL);
+
+    fentry_set_drop(&set);
+}
+
+static void test_fentry_set_diff() {
+    struct fentry_set_t* a = make_set(50);
+    struct fentry_set_t* b = make_set(40);
+    fentry_set_insert(b, make_entry("/tmp/extra", 0, 0));
+
+    struct fentry_set_t* a_b = fentry_set_diff(a, b);
+    struct fentry_set_t* b_a = fentry_set_diff(b, a);
+
+    TEST_ASSERT(fentry_set_len(a_b) == 10);
+    TEST_ASSERT(fentry_set_contains(a_b, "/tmp/file_45"));
+    TEST_ASSERT(!fentry_set_contains(a_b, "/tmp/file_5"));
+    TEST_ASSERT(fentry_set_len(b_a) == 1);
+    TEST_ASSERT(fentry_set_contains(b_a, "/tmp/extra"));
+
+    struct fentry_set_t* empty = fentry_set_new();
+    struct fentry_set_t* a_empty = fentry_set_diff(a, empty);
+    struct fentry_set_t* empty_a = fentry_set_diff(empty, a);
+    TEST_ASSERT(fentry_set_len(a_empty) == 50);
+    TEST_ASSERT(fentry_set_is_empty(empty_a));
+    TEST_ASSERT(fentry_set_diff(NULL, a) == NULL);
+
+    fentry_set_drop(&a);
+    fentry_set_drop(&b);
+    fentry_set_drop(&a_b);
+    fentry_set_drop(&b_a);
+    fentry_set_drop(&empty);
+    fentry_set_drop(&a_empty);
+    fentry_set_drop(&empty_a);
+}
+
+static void test_fentry_set_clone() {
+    struct fentry_set_t* set = make_set(20);
+    struct fentry_set_t* clone = fentry_set_clone(set);
+
+    TEST_ASSERT(fentry_set_len(clone) == 20);
+    for (size_t i = 0; i < set->len; i++) {
+        const struct fentry_t* entry = fentry_set_get(clone, set->buffer[i]->file_name);
+        TEST_ASSERT(entry != NULL);
+        TEST_ASSERT(entry != set->buffer[i]);
+        TEST_ASSERT(fentry_equals(entry, set->buffer[i]));
+    }
+
+    /* Clone stays usable after source is dropped */
+    fentry_set_drop(&set);
+    fentry_set_insert(clone, make_entry("/tmp/after", 0, 0));
+    fentry_set_remove(clone, "/tmp/file_0");
+    TEST_ASSERT(fentry_set_len(clone) == 20);
+
+    struct fentry_set_t* empty = fentry_set_new();
+    struct fentry_set_t* empty_clone = fentry_set_clone(empty);
+    fentry_set_insert(empty_clone, make_entry("/tmp/one", 0, 0));
+    TEST_ASSERT(fentry_set_len(empty_clone) == 1);
+
+    fentry_set_drop(&clone);
+    fentry_set_drop(&empty);
+    fentry_set_drop(&empty_clone);
+}
+
+int main() {
+    TEST_RUN(test_fentry_new_clone_equals);
+    TEST_RUN(test_fentry_set_insert_get);
+    TEST_RUN(test_fentry_set_remove);
+    TEST_RUN(test_fentry_set_pop);
+    TEST_RUN(test_fentry_set_diff);
+    TEST_RUN(test_fentry_set_clone);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
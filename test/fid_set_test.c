@@ -0,0 +1,70 @@
+/**
+ * @file fid_set_test.c
+ * @date 18 Oct 2026
+ * @brief File identity set correctness tests
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "test.h"
+#include "../src/util/fid_set.h"
+
+static void test_fid_set_insert_contains() {
+    struct fid_set_t* set = fid_set_new();
+
+    TEST_ASSERT(fid_set_insert(set, 1, 100));
+    TEST_ASSERT(fid_set_insert(set, 2, 100));
+    TEST_ASSERT(!fid_set_insert(set, 1, 100));
+    TEST_ASSERT(fid_set_len(set) == 2);
+
+    TEST_ASSERT(fid_set_contains(set, 1, 100));
+    TEST_ASSERT(fid_set_contains(set, 2, 100));
+    TEST_ASSERT(!fid_set_contains(set, 1, 101));
+    TEST_ASSERT(!fid_set_contains(NULL, 1, 100));
+
+    fid_set_drop(&set);
+    TEST_ASSERT(set == NULL);
+}
+
+static void test_fid_set_grow() {
+    struct fid_set_t* set = fid_set_new();
+    const size_t count = 10 * FID_SET_DEFAULT_CAP;
+
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT(fid_set_insert(set, i % 3, i));
+    }
+
+    TEST_ASSERT(fid_set_len(set) == count);
+    TEST_ASSERT(2 * fid_set_len(set) <= set->cap);
+
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT(fid_set_contains(set, i % 3, i));
+        TEST_ASSERT(!fid_set_contains(set, (i % 3) + 3, i));
+    }
+
+    fid_set_drop(&set);
+}
+
+static void test_fid_set_clear() {
+    struct fid_set_t* set = fid_set_new();
+
+    for (size_t i = 0; i < 100; i++) {
+        fid_set_insert(set, 0, i);
+    }
+
+    fid_set_clear(set);
+    TEST_ASSERT(fid_set_len(set) == 0);
+    TEST_ASSERT(!fid_set_contains(set, 0, 5));
+    TEST_ASSERT(fid_set_insert(set, 0, 5));
+
+    fid_set_drop(&set);
+}
+
+int main() {
+    TEST_RUN(test_fid_set_insert_contains);
+    TEST_RUN(test_fid_set_grow);
+    TEST_RUN(test_fid_set_clear);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file fsnap_pub_test.c
+ * @date 18 Oct 2026
+ * @brief Snapshot publishing tests
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <sys/stat.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/util/fsnap_pub.h"
+
+#define READERS     ((size_t) 4)
+#define GENERATIONS ((uint64_t) 2000)
+
+/* Snapshot of one file whose size is the expected generation */
+static struct fsnap_t* snap_of(uint64_t generation) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(file_stat));
+    file_stat.st_size = (off_t) generation;
+
+    struct fsnap_t* snap = fsnap_new();
+    fsnap_push(snap, "/gen", &file_stat);
+    fsnap_seal(snap);
+    return snap;
+}
+
+static void test_fsnap_pub_generations() {
+    struct fsnap_pub_t* pub = fsnap_pub_new();
+
+    TEST_ASSERT(fsnap_pub_acquire(pub) == NULL);
+    TEST_ASSERT(fsnap_pub_latest(pub) == NULL);
+
+    TEST_ASSERT(fsnap_pub_publish(pub, snap_of(1)) == 1);
+    struct fsnap_gen_t* first = fsnap_pub_acquire(pub);
+    TEST_ASSERT((first != NULL) && (first->generation == 1) && (first->snap->size[0] == 1));
+    TEST_ASSERT(fsnap_pub_latest(pub) == first->snap);
+
+    /* Referenced generation outlives publishes */
+    TEST_ASSERT(fsnap_pub_publish(pub, snap_of(2)) == 2);
+    TEST_ASSERT(fsnap_pub_publish(pub, snap_of(3)) == 3);
+    TEST_ASSERT(pub->retired_len == 1);
+    TEST_ASSERT(first->snap->size[0] == 1);
+
+    struct fsnap_gen_t* latest = fsnap_pub_acquire(pub);
+    TEST_ASSERT((latest != NULL) && (latest->generation == 3) && (latest->snap->size[0] == 3));
+
+    fsnap_pub_release(first);
+    TEST_ASSERT(fsnap_pub_reclaim(pub) == 0);
+
+    /* Current generation is never reclaimed */
+    fsnap_pub_release(latest);
+    TEST_ASSERT(fsnap_pub_reclaim(pub) == 0);
+    TEST_ASSERT(fsnap_pub_latest(pub)->size[0] == 3);
+
+    fsnap_pub_drop(&pub);
+    TEST_ASSERT(pub == NULL);
+}
+
+struct reader_t {
+    pthread_t thread;
+    struct fsnap_pub_t* pub;
+    atomic_bool* stop;
+    size_t reads;
+    size_t errors;
+};
+
+static void* reader_thread(void* arg) {
+    struct reader_t* reader = (struct reader_t*) arg;
+    uint64_t last = 0;
+
+    while (!atomic_load(reader->stop)) {
+        struct fsnap_gen_t* gen = fsnap_pub_acquire(reader->pub);
+        if (gen == NULL) {
+            continue;
+        }
+
+        /* Generations only move forward and their snapshots are intact */
+        size_t idx = 0;
+        const bool is_found = fsnap_find(gen->snap, "/gen", &idx);
+        if (!is_found || (gen->snap->size[idx] != (int64_t) gen->generation) || (gen->generation < last)) {
+            reader->errors++;
+        }
+        last = gen->generation;
+        reader->reads++;
+
+        fsnap_pub_release(gen);
+    }
+
+    return NULL;
+}
+
+static void test_fsnap_pub_concurrent() {
+    struct fsnap_pub_t* pub = fsnap_pub_new();
+    atomic_bool stop;
+    atomic_init(&stop, false);
+
+    struct reader_t readers[READERS];
+    for (size_t i = 0; i < READERS; i++) {
+        readers[i] = (struct reader_t) { .pub = pub, .stop = &stop, .reads = 0, .errors = 0 };
+        pthread_create(&readers[i].thread, NULL, reader_thread, &readers[i]);
+    }
+
+    size_t max_retained = 0;
+    for (uint64_t generation = 1; generation <= GENERATIONS; generation++) {
+        fsnap_pub_publish(pub, snap_of(generation));
+        max_retained = (pub->retired_len > max_retained) ? pub->retired_len : max_retained;
+    }
+
+    atomic_store(&stop, true);
+    size_t reads = 0;
+    for (size_t i = 0; i < READERS; i++) {
+        pthread_join(readers[i].thread, NULL);
+        reads += readers[i].reads;
+        TEST_ASSERT(readers[i].errors == 0);
+    }
+
+    /* Each reader holds at most one generation at a time */
+    TEST_ASSERT(reads > 0);
+    TEST_ASSERT(max_retained <= READERS);
+    TEST_ASSERT(fsnap_pub_reclaim(pub) == 0);
+    TEST_ASSERT(fsnap_pub_latest(pub)->size[0] == (int64_t) GENERATIONS);
+
+    fsnap_pub_drop(&pub);
+}
+
+int main() {
+    TEST_RUN(test_fsnap_pub_generations);
+    TEST_RUN(test_fsnap_pub_concurrent);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,492 @@
+/**
+ * @file fsnap_test.c
+ * @date 18 Oct 2026
+ * @brief Column snapshot correctness tests
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+
+static void push_file(struct fsnap_t* snap, const char* path, off_t size, time_t mtime) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+    file_stat.st_size = size;
+    file_stat.st_mtime = mtime;
+
+    fsnap_push(snap, path, &file_stat);
+}
+
+static bool idx_vec_has_path(const struct fsnap_idx_vec_t* vec, const struct fsnap_t* snap, const char* path) {
+    for (size_t i = 0; i < vec->len; i++) {
+        if (strcmp(fsnap_path(snap, vec->buffer[i]), path) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void test_fsnap_seal_sorted_unique() {
+    struct fsnap_t* snap = fsnap_new();
+    char path[64];
+
+    for (size_t i = 0; i < 5000; i++) {
+        snprintf(path, sizeof(path), "/d/%zu/%zu", (i % 4000) % 8, i % 4000);
+        push_file(snap, path, (off_t) i, 0);
+    }
+    fsnap_seal(snap);
+
+    /* Children of each directory are contiguous and sorted by path hash */
+    TEST_ASSERT(fsnap_len(snap) == 4000);
+    TEST_ASSERT(snap->dir_entry_off[snap->dir_len] == 4000);
+    for (size_t pos = 0; pos < snap->dir_len; pos++) {
+        for (size_t i = snap->dir_entry_off[pos] + 1; i < snap->dir_entry_off[pos + 1]; i++) {
+            TEST_ASSERT(snap->path_hash[i - 1] < snap->path_hash[i]);
+        }
+    }
+
+    /* First pushed duplicate is kept */
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_find(snap, "/d/2/10", &idx));
+    TEST_ASSERT(snap->size[idx] == 10);
+    TEST_ASSERT(!fsnap_find(snap, "/d/0/4000", NULL));
+    TEST_ASSERT(!fsnap_find(snap, "/d/1/10", NULL));
+
+    fsnap_drop(&snap);
+    TEST_ASSERT(snap == NULL);
+}
+
+static void test_fsnap_diff() {
+    struct fsnap_t* old_snap = fsnap_new();
+    struct fsnap_t* new_snap = fsnap_new();
+    char path[64];
+
+    for (size_t i = 0; i < 1000; i++) {
+        snprintf(path, sizeof(path), "/d/%zu", i);
+        push_file(old_snap, path, 1, 1);
+
+        if (i % 10 == 0) {
+            continue;
+        }
+        push_file(new_snap, path, (i % 7 == 0) ? 2 : 1, (i % 11 == 0) ? 2 : 1);
+    }
+    push_file(new_snap, "/d/new", 1, 1);
+    fsnap_seal(old_snap);
+    fsnap_seal(new_snap);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+
+    size_t expected_modified = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        if ((i % 10 != 0) && ((i % 7 == 0) || (i % 11 == 0))) {
+            expected_modified++;
+        }
+    }
+
+    TEST_ASSERT(diff.new_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.new_entries, new_snap, "/d/new"));
+    TEST_ASSERT(diff.deleted_entries.len == 100);
+    TEST_ASSERT(idx_vec_has_path(&diff.deleted_entries, old_snap, "/d/990"));
+    TEST_ASSERT(diff.modified_entries.len == expected_modified);
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/d/7"));
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/d/11"));
+    TEST_ASSERT(!idx_vec_has_path(&diff.modified_entries, new_snap, "/d/1"));
+
+    fsnap_diff_clean(&diff);
+
+    /* Snapshot against itself has no changes */
+    fsnap_diff(new_snap, new_snap, &diff);
+    TEST_ASSERT(diff.new_entries.len == 0);
+    TEST_ASSERT(diff.deleted_entries.len == 0);
+    TEST_ASSERT(diff.modified_entries.len == 0);
+    fsnap_diff_clean(&diff);
+
+    fsnap_drop(&old_snap);
+    fsnap_drop(&new_snap);
+}
+
+static void test_fsnap_diff_collision() {
+    struct fsnap_t* old_snap = fsnap_new();
+    struct fsnap_t* new_snap = fsnap_new();
+
+    push_file(old_snap, "/c/a", 1, 1);
+    push_file(old_snap, "/c/b", 1, 1);
+    push_file(old_snap, "/c/c", 1, 1);
+    push_file(new_snap, "/c/b", 2, 1);
+    push_file(new_snap, "/c/c", 1, 1);
+    push_file(new_snap, "/c/d", 1, 1);
+
+    /* Force all paths into a single hash collision group */
+    for (size_t i = 0; i < 3; i++) {
+        old_snap->path_hash[i] = 42;
+        new_snap->path_hash[i] = 42;
+    }
+    fsnap_seal(old_snap);
+    fsnap_seal(new_snap);
+
+    TEST_ASSERT(strcmp(fsnap_path(old_snap, 0), "/c/a") == 0);
+    TEST_ASSERT(strcmp(fsnap_path(old_snap, 2), "/c/c") == 0);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+
+    TEST_ASSERT(diff.new_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.new_entries, new_snap, "/c/d"));
+    TEST_ASSERT(diff.deleted_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.deleted_entries, old_snap, "/c/a"));
+    TEST_ASSERT(diff.modified_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/c/b"));
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&new_snap);
+}
+
+static void test_fsnap_dir_collision() {
+    /* Distinct directories with equal 64-bit path hash, so their children collide as well */
+    const char* dir_a = "/179ae20b704a3f0c";
+    const char* dir_b = "/1bb1905f0ea4246c";
+    TEST_ASSERT(fsnap_hash_path(dir_a) == fsnap_hash_path(dir_b));
+    TEST_ASSERT(fsnap_hash_path("/179ae20b704a3f0c/f") == fsnap_hash_path("/1bb1905f0ea4246c/f"));
+
+    struct fsnap_t* old_snap = fsnap_new();
+    struct fsnap_t* new_snap = fsnap_new();
+
+    push_file(old_snap, "/179ae20b704a3f0c/f", 1, 1);
+    push_file(old_snap, "/1bb1905f0ea4246c/f", 1, 1);
+    push_file(old_snap, "/1bb1905f0ea4246c/g", 1, 1);
+    push_file(new_snap, "/1bb1905f0ea4246c/f", 1, 1);
+    push_file(new_snap, "/179ae20b704a3f0c/f", 2, 1);
+    push_file(new_snap, "/179ae20b704a3f0c/h", 1, 1);
+    fsnap_seal(old_snap);
+    fsnap_seal(new_snap);
+
+    /* Top level and both directories */
+    TEST_ASSERT(old_snap->dir_len == 3);
+
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_find(new_snap, "/179ae20b704a3f0c/f", &idx) && (new_snap->size[idx] == 2));
+    TEST_ASSERT(fsnap_find(new_snap, "/1bb1905f0ea4246c/f", &idx) && (new_snap->size[idx] == 1));
+    TEST_ASSERT(!fsnap_find(new_snap, "/1bb1905f0ea4246c/h", NULL));
+    TEST_ASSERT(fsnap_subtree_changed(old_snap, new_snap, dir_a));
+    TEST_ASSERT(fsnap_subtree_changed(old_snap, new_snap, dir_b));
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+
+    TEST_ASSERT(diff.new_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.new_entries, new_snap, "/179ae20b704a3f0c/h"));
+    TEST_ASSERT(diff.deleted_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.deleted_entries, old_snap, "/1bb1905f0ea4246c/g"));
+    TEST_ASSERT(diff.modified_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/179ae20b704a3f0c/f"));
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&new_snap);
+}
+
+static void test_fsnap_empty() {
+    struct fsnap_t* empty = fsnap_new();
+    struct fsnap_t* snap = fsnap_new();
+    push_file(snap, "/e/1", 1, 1);
+    fsnap_seal(empty);
+    fsnap_seal(snap);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(empty, snap, &diff);
+    TEST_ASSERT(diff.new_entries.len == 1);
+    TEST_ASSERT(diff.deleted_entries.len == 0);
+    fsnap_diff_clean(&diff);
+
+    fsnap_diff(snap, empty, &diff);
+    TEST_ASSERT(diff.new_entries.len == 0);
+    TEST_ASSERT(diff.deleted_entries.len == 1);
+    fsnap_diff_clean(&diff);
+
+    fsnap_drop(&empty);
+    fsnap_drop(&snap);
+}
+
+static void test_fsnap_append_write_read() {
+    struct fsnap_t* a = fsnap_new();
+    struct fsnap_t* b = fsnap_new();
+    char path[64];
+
+    for (size_t i = 0; i < 300; i++) {
+        snprintf(path, sizeof(path), "/w/%zu", i);
+        push_file((i % 2 == 0) ? a : b, path, (off_t) i, (time_t) i);
+    }
+
+    fsnap_append(a, b);
+    TEST_ASSERT(fsnap_len(b) == 0);
+    fsnap_seal(a);
+    TEST_ASSERT(fsnap_len(a) == 300);
+
+    FILE* tmp = tmpfile();
+    TEST_ASSERT(tmp != NULL);
+    TEST_ASSERT(fsnap_write(a, tmp));
+    rewind(tmp);
+
+    struct fsnap_t* read_snap = fsnap_read(tmp);
+    TEST_ASSERT(read_snap != NULL);
+
+    if (read_snap != NULL) {
+        struct fsnap_diff_t diff;
+        fsnap_diff(a, read_snap, &diff);
+        TEST_ASSERT(fsnap_len(read_snap) == 300);
+        TEST_ASSERT(diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0);
+        TEST_ASSERT(fsnap_find(read_snap, "/w/299", NULL));
+        fsnap_diff_clean(&diff);
+    }
+
+    /* Truncated file is rejected */
+    rewind(tmp);
+    TEST_ASSERT(ftruncate(fileno(tmp), 40) == 0);
+    TEST_ASSERT(fsnap_read(tmp) == NULL);
+
+    fclose(tmp);
+    fsnap_drop(&read_snap);
+    fsnap_drop(&a);
+    fsnap_drop(&b);
+}
+
+static void push_link(struct fsnap_t* snap, const char* path, off_t size, ino_t ino) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+    file_stat.st_size = size;
+    file_stat.st_ino = ino;
+    file_stat.st_nlink = 2;
+
+    fsnap_push(snap, path, &file_stat);
+}
+
+static void test_fsnap_hard_links() {
+    struct fsnap_t* old_snap = fsnap_new();
+    struct fsnap_t* new_snap = fsnap_new();
+
+    push_link(old_snap, "/h/a", 1, 7);
+    push_link(old_snap, "/h/b", 1, 7);
+    push_link(old_snap, "/h/c", 1, 7);
+    push_file(old_snap, "/h/d", 1, 1);
+    push_link(new_snap, "/h/b", 2, 7);
+    push_link(new_snap, "/h/c", 2, 7);
+    push_link(new_snap, "/h/new", 2, 7);
+    push_file(new_snap, "/h/d", 1, 1);
+    fsnap_seal(old_snap);
+    fsnap_seal(new_snap);
+
+    /* Inode metadata is stored once */
+    TEST_ASSERT(old_snap->len == 2);
+    TEST_ASSERT(old_snap->alias_len == 2);
+    TEST_ASSERT(fsnap_len(old_snap) == 4);
+
+    size_t idx = 0;
+    TEST_ASSERT(fsnap_find(old_snap, "/h/a", &idx));
+    TEST_ASSERT(old_snap->ino[fsnap_primary(old_snap, idx)] == 7);
+    TEST_ASSERT(fsnap_find(old_snap, "/h/c", &idx));
+    TEST_ASSERT(old_snap->ino[fsnap_primary(old_snap, idx)] == 7);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(old_snap, new_snap, &diff);
+
+    TEST_ASSERT(diff.new_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.new_entries, new_snap, "/h/new"));
+    TEST_ASSERT(diff.deleted_entries.len == 1);
+    TEST_ASSERT(idx_vec_has_path(&diff.deleted_entries, old_snap, "/h/a"));
+    TEST_ASSERT(diff.modified_entries.len == 2);
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/h/b"));
+    TEST_ASSERT(idx_vec_has_path(&diff.modified_entries, new_snap, "/h/c"));
+    fsnap_diff_clean(&diff);
+
+    /* Aliases survive snapshot file round trip */
+    FILE* tmp = tmpfile();
+    TEST_ASSERT(fsnap_write(new_snap, tmp));
+    rewind(tmp);
+    struct fsnap_t* read_snap = fsnap_read(tmp);
+    TEST_ASSERT((read_snap != NULL) && (fsnap_len(read_snap) == 4));
+
+    fsnap_diff(new_snap, read_snap, &diff);
+    TEST_ASSERT(diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0);
+    fsnap_diff_clean(&diff);
+
+    fclose(tmp);
+    fsnap_drop(&read_snap);
+    fsnap_drop(&old_snap);
+    fsnap_drop(&new_snap);
+}
+
+static void test_fsnap_clear() {
+    struct fsnap_t* snap = fsnap_new();
+    push_link(snap, "/c/a", 1, 9);
+    push_link(snap, "/c/b", 1, 9);
+    push_file(snap, "/c/d/e", 1, 1);
+    fsnap_seal(snap);
+    TEST_ASSERT((fsnap_len(snap) == 3) && (snap->alias_len == 1) && (snap->dir_len > 0));
+
+    fsnap_clear(snap);
+    TEST_ASSERT((fsnap_len(snap) == 0) && (snap->dir_len == 0) && snap->sorted);
+
+    /* Cleared snapshot is reused like a new one */
+    push_file(snap, "/c/x", 2, 2);
+    push_file(snap, "/c/y", 2, 2);
+    fsnap_seal(snap);
+
+    struct fsnap_t* other = fsnap_new();
+    push_file(other, "/c/y", 2, 2);
+    push_file(other, "/c/x", 2, 2);
+    fsnap_seal(other);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(snap, other, &diff);
+    TEST_ASSERT(diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0);
+    fsnap_diff_clean(&diff);
+
+    fsnap_drop(&other);
+    fsnap_drop(&snap);
+}
+
+static void test_fsnap_dir_summary() {
+    struct fsnap_t* a = fsnap_new();
+    struct fsnap_t* b = fsnap_new();
+    const char* paths[] = { "/r/x", "/r/x/1", "/r/x/y", "/r/x/y/2", "/r/z", "/r/z/3", "/r/4" };
+    const size_t paths_len = sizeof(paths) / sizeof(paths[0]);
+
+    /* Push order does not matter */
+    for (size_t i = 0; i < paths_len; i++) {
+        push_file(a, paths[i], 1, 1);
+        push_file(b, paths[paths_len - 1 - i], 1, 1);
+    }
+    fsnap_seal(a);
+    fsnap_seal(b);
+
+    uint64_t summary_a = 0;
+    uint64_t summary_b = 0;
+    TEST_ASSERT(fsnap_dir_summary(a, "/r", &summary_a) && fsnap_dir_summary(b, "/r/", &summary_b));
+    TEST_ASSERT(summary_a == summary_b);
+    TEST_ASSERT(fsnap_dir_summary(a, "/", NULL));
+    TEST_ASSERT(!fsnap_dir_summary(a, "/r/4", NULL));
+    TEST_ASSERT(!fsnap_subtree_changed(a, b, "/"));
+
+    /* Change is visible in all ancestors only */
+    fsnap_drop(&b);
+    b = fsnap_new();
+    for (size_t i = 0; i < paths_len; i++) {
+        push_file(b, paths[i], (strcmp(paths[i], "/r/x/y/2") == 0) ? 2 : 1, 1);
+    }
+    fsnap_seal(b);
+
+    TEST_ASSERT(fsnap_subtree_changed(a, b, "/r/x/y"));
+    TEST_ASSERT(fsnap_subtree_changed(a, b, "/r/x"));
+    TEST_ASSERT(fsnap_subtree_changed(a, b, "/r"));
+    TEST_ASSERT(fsnap_subtree_changed(a, b, ""));
+    TEST_ASSERT(!fsnap_subtree_changed(a, b, "/r/z"));
+    TEST_ASSERT(!fsnap_subtree_changed(a, b, "/missing"));
+
+    /* Directory with children in one snapshot only */
+    push_file(b, "/r/4/5", 1, 1);
+    fsnap_seal(b);
+    TEST_ASSERT(fsnap_subtree_changed(a, b, "/r/4"));
+
+    fsnap_drop(&a);
+    fsnap_drop(&b);
+}
+
+/* Tree walk diff matches path by path lookup on random trees */
+static void test_fsnap_diff_random() {
+    unsigned seed = 12345;
+    char path[64];
+
+    for (size_t round = 0; round < 20; round++) {
+        struct fsnap_t* old_snap = fsnap_new();
+        struct fsnap_t* new_snap = fsnap_new();
+
+        for (size_t i = 0; i < 2000; i++) {
+            seed = seed * 1103515245 + 12345;
+            const unsigned r = seed >> 8;
+            snprintf(path, sizeof(path), "/t/%u/%zu/%zu", r % 7, (r / 7) % (round + 2), i % 300);
+
+            const unsigned action = (r / 64) % 16;
+            const off_t size = (off_t) (r % 3);
+
+            if (action == 0) {
+                push_file(new_snap, path, size, 1);
+            } else if (action == 1) {
+                push_file(old_snap, path, size, 1);
+            } else if (action == 2) {
+                push_link(old_snap, path, 1, (ino_t) (r % 5 + 1));
+                push_link(new_snap, path, (round % 2 == 0) ? 1 : 2, (ino_t) (r % 5 + 1));
+            } else {
+                push_file(old_snap, path, size, 1);
+                push_file(new_snap, path, (action == 3) ? size + 1 : size, 1);
+            }
+        }
+
+        /* Whole subtree appears in one snapshot only */
+        snprintf(path, sizeof(path), "/t/only/%zu", round);
+        push_file((round % 2 == 0) ? old_snap : new_snap, path, 1, 1);
+
+        fsnap_seal(old_snap);
+        fsnap_seal(new_snap);
+
+        size_t expected_new = 0;
+        size_t expected_deleted = 0;
+        size_t expected_modified = 0;
+        size_t found_idx = 0;
+
+        for (size_t i = 0; i < fsnap_len(old_snap); i++) {
+            if (!fsnap_find(new_snap, fsnap_path(old_snap, i), &found_idx)) {
+                expected_deleted++;
+            } else {
+                const size_t old_primary = fsnap_primary(old_snap, i);
+                const size_t new_primary = fsnap_primary(new_snap, found_idx);
+                expected_modified += ((old_snap->size[old_primary] != new_snap->size[new_primary])
+                    || (old_snap->mtime_ns[old_primary] != new_snap->mtime_ns[new_primary])) ? 1 : 0;
+            }
+        }
+        for (size_t i = 0; i < fsnap_len(new_snap); i++) {
+            expected_new += fsnap_find(old_snap, fsnap_path(new_snap, i), NULL) ? 0 : 1;
+        }
+
+        struct fsnap_diff_t diff;
+        fsnap_diff(old_snap, new_snap, &diff);
+
+        TEST_ASSERT(diff.new_entries.len == expected_new);
+        TEST_ASSERT(diff.deleted_entries.len == expected_deleted);
+        TEST_ASSERT(diff.modified_entries.len == expected_modified);
+        for (size_t i = 0; i < diff.new_entries.len; i++) {
+            TEST_ASSERT(!fsnap_find(old_snap, fsnap_path(new_snap, diff.new_entries.buffer[i]), NULL));
+        }
+        for (size_t i = 0; i < diff.deleted_entries.len; i++) {
+            TEST_ASSERT(!fsnap_find(new_snap, fsnap_path(old_snap, diff.deleted_entries.buffer[i]), NULL));
+        }
+        fsnap_diff_clean(&diff);
+
+        fsnap_drop(&old_snap);
+        fsnap_drop(&new_snap);
+    }
+}
+
+int main() {
+    TEST_RUN(test_fsnap_seal_sorted_unique);
+    TEST_RUN(test_fsnap_diff);
+    TEST_RUN(test_fsnap_diff_collision);
+    TEST_RUN(test_fsnap_dir_collision);
+    TEST_RUN(test_fsnap_empty);
+    TEST_RUN(test_fsnap_append_write_read);
+    TEST_RUN(test_fsnap_hard_links);
+    TEST_RUN(test_fsnap_clear);
+    TEST_RUN(test_fsnap_dir_summary);
+    TEST_RUN(test_fsnap_diff_random);
+
+    return (test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,361 @@
+/**
+ * @file microbench.c
+ * @date 18 Oct 2026
+ * @brief File entry container microbenchmark
+ *
+ * Usage: microbench [max entries] [time budget per measurement, sec]
+ *
+ * Allocations are counted through linker wrapped malloc/calloc/realloc.
+ * Measurements whose running time is estimated to exceed the budget
+ * (from the previous size and operation complexity) are skipped.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/stat.h>
+
+#include "../src/util/fentry.h"
+#include "../src/util/fsnap.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define BENCH_DEFAULT_MAX_ENTRIES ((size_t) 10000000)
+#define BENCH_DEFAULT_BUDGET_SEC  (5.0)
+#define BENCH_MIN_ENTRIES         ((size_t) 1000)
+#define BENCH_LOOKUPS             ((size_t) 1000)
+#define BENCH_FILES_PER_DIR       ((size_t) 1000)
+
+/* Structures ---------------------------------------------------------------*/
+
+struct bench_names_t {
+    size_t len;
+    size_t* offsets;
+    char* pool;
+};
+
+struct bench_op_t {
+    const char* container;
+    const char* op;
+    unsigned complexity;   /* Exponent of running time growth with entries */
+    double (*run)(size_t entries, size_t* ops, size_t* allocs);
+
+    /* Previous measurement */
+    size_t last_entries;
+    double last_sec;
+};
+
+/* Allocation counter -------------------------------------------------------*/
+
+static size_t alloc_count = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t num, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    alloc_count++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t num, size_t size) {
+    alloc_count++;
+    return __real_calloc(num, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    alloc_count++;
+    return __real_realloc(ptr, size);
+}
+
+/* Helpers ------------------------------------------------------------------*/
+
+static struct bench_names_t names;
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void names_init(size_t len) {
+    names.len = len;
+    names.offsets = (size_t*) malloc(len * sizeof(size_t));
+    names.pool = (char*) malloc(len * 48);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < len; i++) {
+        names.offsets[i] = offset;
+        offset += (size_t) sprintf(names.pool + offset,
+            "/bench/dir_%zu/file_%zu", i / BENCH_FILES_PER_DIR, i) + 1;
+    }
+}
+
+static const char* name_at(size_t idx) {
+    return names.pool + names.offsets[idx];
+}
+
+static struct stat stat_at(size_t idx) {
+    struct stat file_stat;
+    memset(&file_stat, 0, sizeof(struct stat));
+    file_stat.st_size = (off_t) idx;
+    file_stat.st_ino = (ino_t) idx;
+    return file_stat;
+}
+
+/* Fill set without duplicate check, setup only */
+static struct fentry_set_t* fentry_set_fill(size_t entries, size_t skip_every) {
+    struct fentry_set_t* set = fentry_set_new();
+    set->cap = entries;
+    set->buffer = (struct fentry_t**) realloc(set->buffer, entries * sizeof(struct fentry_t*));
+
+    for (size_t i = 0; i < entries; i++) {
+        if ((skip_every != 0) && (i % skip_every == 0)) {
+            continue;
+        }
+        const struct stat file_stat = stat_at(i);
+        set->buffer[set->len++] = fentry_new(name_at(i), &file_stat);
+    }
+
+    return set;
+}
+
+static struct fsnap_t* fsnap_fill(size_t entries, size_t skip_every) {
+    struct fsnap_t* snap = fsnap_new();
+
+    for (size_t i = 0; i < entries; i++) {
+        if ((skip_every != 0) && (i % skip_every == 0)) {
+            continue;
+        }
+        const struct stat file_stat = stat_at(i);
+        fsnap_push(snap, name_at(i), &file_stat);
+    }
+    fsnap_seal(snap);
+
+    return snap;
+}
+
+/* fentry_set_t -------------------------------------------------------------*/
+
+static double bench_fentry_insert(size_t entries, size_t* ops, size_t* allocs) {
+    struct fentry_set_t* set = fentry_set_new();
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    for (size_t i = 0; i < entries; i++) {
+        const struct stat file_stat = stat_at(i);
+        fentry_set_insert(set, fentry_new(name_at(i), &file_stat));
+    }
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fentry_set_drop(&set);
+    *ops = entries;
+    return elapsed;
+}
+
+static double bench_fentry_get(size_t entries, size_t* ops, size_t* allocs) {
+    struct fentry_set_t* set = fentry_set_fill(entries, 0);
+    const size_t lookups = (entries < BENCH_LOOKUPS) ? entries : BENCH_LOOKUPS;
+    size_t found = 0;
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    for (size_t i = 0; i < lookups; i++) {
+        found += (fentry_set_get(set, name_at((i * 7919) % entries)) != NULL) ? 1 : 0;
+    }
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    if (found != lookups) {
+        fprintf(stderr, "fentry_set_get: lookup failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fentry_set_drop(&set);
+    *ops = lookups;
+    return elapsed;
+}
+
+static double bench_fentry_remove(size_t entries, size_t* ops, size_t* allocs) {
+    struct fentry_set_t* set = fentry_set_fill(entries, 0);
+    const size_t removes = (entries < BENCH_LOOKUPS) ? entries : BENCH_LOOKUPS;
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    for (size_t i = 0; i < removes; i++) {
+        fentry_set_remove(set, name_at((i * entries) / removes));
+    }
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fentry_set_drop(&set);
+    *ops = removes;
+    return elapsed;
+}
+
+static double bench_fentry_diff(size_t entries, size_t* ops, size_t* allocs) {
+    struct fentry_set_t* a = fentry_set_fill(entries, 0);
+    struct fentry_set_t* b = fentry_set_fill(entries, 10);
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    struct fentry_set_t* diff = fentry_set_diff(a, b);
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fentry_set_drop(&diff);
+    fentry_set_drop(&a);
+    fentry_set_drop(&b);
+    *ops = entries;
+    return elapsed;
+}
+
+static double bench_fentry_clone(size_t entries, size_t* ops, size_t* allocs) {
+    struct fentry_set_t* set = fentry_set_fill(entries, 0);
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    struct fentry_set_t* clone = fentry_set_clone(set);
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fentry_set_drop(&clone);
+    fentry_set_drop(&set);
+    *ops = entries;
+    return elapsed;
+}
+
+/* fsnap_t ------------------------------------------------------------------*/
+
+static double bench_fsnap_insert(size_t entries, size_t* ops, size_t* allocs) {
+    struct fsnap_t* snap = fsnap_new();
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    for (size_t i = 0; i < entries; i++) {
+        const struct stat file_stat = stat_at(i);
+        fsnap_push(snap, name_at(i), &file_stat);
+    }
+    fsnap_seal(snap);
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fsnap_drop(&snap);
+    *ops = entries;
+    return elapsed;
+}
+
+static double bench_fsnap_get(size_t entries, size_t* ops, size_t* allocs) {
+    struct fsnap_t* snap = fsnap_fill(entries, 0);
+    const size_t lookups = (entries < BENCH_LOOKUPS) ? entries : BENCH_LOOKUPS;
+    size_t found = 0;
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    for (size_t i = 0; i < lookups; i++) {
+        found += fsnap_find(snap, name_at((i * 7919) % entries), NULL) ? 1 : 0;
+    }
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    if (found != lookups) {
+        fprintf(stderr, "fsnap_find: lookup failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fsnap_drop(&snap);
+    *ops = lookups;
+    return elapsed;
+}
+
+static double bench_fsnap_diff(size_t entries, size_t* ops, size_t* allocs) {
+    struct fsnap_t* a = fsnap_fill(entries, 0);
+    struct fsnap_t* b = fsnap_fill(entries, 10);
+    struct fsnap_diff_t diff;
+
+    const size_t allocs_before = alloc_count;
+    const double start = now_sec();
+    fsnap_diff(b, a, &diff);
+    const double elapsed = now_sec() - start;
+    *allocs = alloc_count - allocs_before;
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&a);
+    fsnap_drop(&b);
+    *ops = entries;
+    return elapsed;
+}
+
+/* Main ---------------------------------------------------------------------*/
+
+static struct bench_op_t bench_ops[] = {
+    { "fentry_set", "insert", 2, bench_fentry_insert, 0, 0.0 },
+    { "fentry_set", "get",    1, bench_fentry_get,    0, 0.0 },
+    { "fentry_set", "remove", 1, bench_fentry_remove, 0, 0.0 },
+    { "fentry_set", "diff",   2, bench_fentry_diff,   0, 0.0 },
+    { "fentry_set", "clone",  1, bench_fentry_clone,  0, 0.0 },
+    { "fsnap",      "insert", 1, bench_fsnap_insert,  0, 0.0 },
+    { "fsnap",      "get",    1, bench_fsnap_get,     0, 0.0 },
+    { "fsnap",      "diff",   1, bench_fsnap_diff,    0, 0.0 },
+};
+
+int main(int argc, char** argv) {
+    const size_t max_entries = (argc > 1)
+        ? (size_t) strtoull(argv[1], NULL, 10)
+        : BENCH_DEFAULT_MAX_ENTRIES;
+    const double budget_sec = (argc > 2) ? strtod(argv[2], NULL) : BENCH_DEFAULT_BUDGET_SEC;
+
+    if (max_entries < BENCH_MIN_ENTRIES) {
+        fprintf(stderr, "Max entries must be at least %zu\n", BENCH_MIN_ENTRIES);
+        return EXIT_FAILURE;
+    }
+
+    names_init(max_entries);
+
+    printf("%-12s %-8s %10s %14s %12s\n", "container", "op", "entries", "ns/op", "allocs/op");
+
+    const size_t ops_num = sizeof(bench_ops) / sizeof(bench_ops[0]);
+    for (size_t entries = BENCH_MIN_ENTRIES; entries <= max_entries; entries *= 10) {
+        for (size_t i = 0; i < ops_num; i++) {
+            struct bench_op_t* op = &bench_ops[i];
+
+            if (op->last_entries != 0) {
+                double estimate = op->last_sec;
+                for (unsigned k = 0; k < op->complexity; k++) {
+                    estimate *= (double) entries / (double) op->last_entries;
+                }
+
+                if (estimate > budget_sec) {
+                    printf("%-12s %-8s %10zu %14s %12s\n",
+                        op->container, op->op, entries, "skipped", "-");
+                    continue;
+                }
+            }
+
+            size_t ops = 0;
+            size_t allocs = 0;
+            const double elapsed = op->run(entries, &ops, &allocs);
+
+            op->last_entries = entries;
+            op->last_sec = elapsed;
+
+            printf("%-12s %-8s %10zu %14.1f %12.3f\n",
+                op->container, op->op, entries,
+                elapsed * 1e9 / (double) ops,
+                (double) allocs / (double) ops
+            );
+            fflush(stdout);
+        }
+    }
+
+    free(names.offsets);
+    free(names.pool);
+    return EXIT_SUCCESS;
+}
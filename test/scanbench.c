@@ -0,0 +1,194 @@
+/**
+ * @file scanbench.c
+ * @date 18 Oct 2026
+ * @brief Directory scan throughput benchmark on large flat directories
+ *
+ * Usage: scanbench [files] [parent dir] [rounds] [drop caches: 0|1]
+ *
+ * Creates a flat directory with files named in random order, so readdir
+ * order (name hash on ext4) differs from inode allocation order, and
+ * scans it in readdir and in inode order. With drop caches (root only)
+ * page, dentry and inode caches are dropped before every scan, which is
+ * the case inode ordering is meant for on rotational disks. Readdir order
+ * scan is also run with per-directory profiling to measure its overhead.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define BENCH_DEFAULT_FILES  ((size_t) 200000)
+#define BENCH_DEFAULT_PARENT "/tmp"
+#define BENCH_DEFAULT_ROUNDS ((size_t) 3)
+
+/* Scan modes */
+#define BENCH_READDIR  ((size_t) 0)
+#define BENCH_INODE    ((size_t) 1)
+#define BENCH_PROFILED ((size_t) 2)
+#define BENCH_MODES    ((size_t) 3)
+
+static const char* const bench_mode_names[BENCH_MODES] = { "readdir", "inode", "profiled" };
+
+/* Helpers ------------------------------------------------------------------*/
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rand_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rand_next() {
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 7;
+    rand_state ^= rand_state << 17;
+    return rand_state;
+}
+
+static bool drop_caches() {
+    sync();
+
+    FILE* const fout = fopen("/proc/sys/vm/drop_caches", "w");
+    if (fout == NULL) {
+        return false;
+    }
+
+    const bool is_dropped = fputs("3\n", fout) >= 0;
+    return (fclose(fout) == 0) && is_dropped;
+}
+
+/* Create files with random names, inode numbers follow creation order */
+static bool bench_create(const char* dir, size_t files) {
+    char path[PATH_MAX];
+
+    for (size_t i = 0; i < files; i++) {
+        if (snprintf(path, sizeof(path), "%s/%016llx", dir, (unsigned long long) rand_next()) >= (int) sizeof(path)) {
+            fprintf(stderr, "Path is too long: '%s'\n", dir);
+            return false;
+        }
+
+        const int fd = open(path, O_CREAT | O_WRONLY, 0644);
+        if (fd < 0) {
+            perror(path);
+            return false;
+        }
+        close(fd);
+    }
+
+    return true;
+}
+
+static void bench_remove(const char* dir) {
+    char cmd[PATH_MAX + 16];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+
+    if (system(cmd) != 0) {
+        fprintf(stderr, "Failed to remove '%s'\n", dir);
+    }
+}
+
+static double bench_scan(const char* dir, size_t mode, bool cold, size_t* files) {
+    const struct dirwd_prof_opts_t prof_opts = { .enabled = true, .top = DIRWD_PROF_TOP_DEFAULT, .file = "" };
+    struct dirwd_scan_opts_t opts = {
+        .threads = 1,
+        .one_fs = false,
+        .follow_symlinks = true,
+        .inode_order = mode == BENCH_INODE,
+        .filter = NULL,
+        .filter_ctx = NULL,
+        .prof = (mode == BENCH_PROFILED) ? dirwd_prof_new(&prof_opts) : NULL,
+        .fs = NULL,
+        .fs_ctx = NULL,
+    };
+
+    if (cold && !drop_caches()) {
+        fprintf(stderr, "Failed to drop caches\n");
+    }
+
+    struct fsnap_t* snap = fsnap_new();
+    const double start = now_sec();
+    dirwd_prof_begin(opts.prof);
+    dirwd_scan_tree(snap, dir, &opts);
+    dirwd_prof_end(opts.prof);
+    const double elapsed = now_sec() - start;
+
+    *files = fsnap_len(snap);
+    fsnap_drop(&snap);
+    dirwd_prof_drop(&opts.prof);
+    return elapsed;
+}
+
+/* Main ---------------------------------------------------------------------*/
+
+int main(int argc, char** argv) {
+    const size_t files = (argc > 1) ? strtoull(argv[1], NULL, 10) : BENCH_DEFAULT_FILES;
+    const char* parent = (argc > 2) ? argv[2] : BENCH_DEFAULT_PARENT;
+    const size_t rounds = (argc > 3) ? strtoull(argv[3], NULL, 10) : BENCH_DEFAULT_ROUNDS;
+    const bool cold = (argc > 4) && (strcmp(argv[4], "1") == 0);
+
+    if (cold && (geteuid() != 0)) {
+        fprintf(stderr, "Dropping caches requires root\n");
+        return EXIT_FAILURE;
+    }
+
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/dirwd_scanbench_XXXXXX", parent);
+    if (mkdtemp(dir) == NULL) {
+        perror(dir);
+        return EXIT_FAILURE;
+    }
+
+    printf("Creating %zu files in '%s'\n", files, dir);
+    if (!bench_create(dir, files)) {
+        bench_remove(dir);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-8s %-8s %12s %14s\n", "round", "mode", "time, s", "files/s");
+
+    double best[BENCH_MODES] = { 0.0, 0.0, 0.0 };
+    for (size_t round = 0; round < rounds; round++) {
+        /* Rotate which mode runs first, so warm cache does not favour one */
+        for (size_t k = 0; k < BENCH_MODES; k++) {
+            const size_t mode = (round + k) % BENCH_MODES;
+            size_t scanned = 0;
+            const double elapsed = bench_scan(dir, mode, cold, &scanned);
+
+            if (scanned != files) {
+                fprintf(stderr, "Scanned %zu files, expected %zu\n", scanned, files);
+            }
+
+            printf("%-8zu %-8s %12.3f %14.0f\n", round, bench_mode_names[mode], elapsed, (double) scanned / elapsed);
+
+            if ((best[mode] == 0.0) || (elapsed < best[mode])) {
+                best[mode] = elapsed;
+            }
+        }
+    }
+
+    if (rounds > 0) {
+        printf("Best: readdir %.3f s, inode %.3f s, speedup %.2fx (%s cache)\n",
+            best[BENCH_READDIR], best[BENCH_INODE], best[BENCH_READDIR] / best[BENCH_INODE], cold ? "cold" : "warm");
+        printf("Profiling overhead: %.3f s vs %.3f s, %+.1f%%\n",
+            best[BENCH_PROFILED], best[BENCH_READDIR], (best[BENCH_PROFILED] / best[BENCH_READDIR] - 1.0) * 100.0);
+    }
+
+    bench_remove(dir);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file simbench.c
+ * @date 18 Oct 2026
+ * @brief Inspection benchmark on simulated filesystem
+ *
+ * Usage: simbench [fanout] [depth] [files per dir] [rounds] [stat latency ns] [threads] [snapshot...]
+ *
+ * Builds an in-memory tree of the given shape, or replays paths of a
+ * snapshot file written by 'dirwdd scan' below their common directory, then
+ * runs inspection rounds: churn, scan, seal, diff and event output to a
+ * ring file. Churn is seeded random, or with later snapshots of the same
+ * tree each round replays the recorded changes to the next one. Tree
+ * contents and events are the same on every run, so phase times can be
+ * compared between builds without page cache noise.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+#include "../src/daemon/dirwd_memfs.h"
+#include "../src/daemon/dirwd_output.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define BENCH_DEFAULT_FANOUT  ((size_t) 10)
+#define BENCH_DEFAULT_DEPTH   ((size_t) 3)
+#define BENCH_DEFAULT_FILES   ((size_t) 100)
+#define BENCH_DEFAULT_ROUNDS  ((size_t) 5)
+#define BENCH_DEFAULT_THREADS ((size_t) 4)
+#define BENCH_ROOT            "/sim"
+#define BENCH_SEED            ((uint64_t) 42)
+
+/* Churn per round in parts per million of files */
+#define BENCH_CREATE_PPM ((size_t) 1000)
+#define BENCH_REMOVE_PPM ((size_t) 1000)
+#define BENCH_MODIFY_PPM ((size_t) 10000)
+
+/* Helpers ------------------------------------------------------------------*/
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static size_t arg_size(int argc, char** argv, int idx, size_t default_value) {
+    return (argc > idx) ? (size_t) strtoull(argv[idx], NULL, 10) : default_value;
+}
+
+static struct fsnap_t* bench_read(const char* snapshot_path) {
+    FILE* const fin = fopen(snapshot_path, "rb");
+    if (fin == NULL) {
+        perror(snapshot_path);
+        return NULL;
+    }
+
+    struct fsnap_t* snap = fsnap_read(fin);
+    fclose(fin);
+
+    if ((snap == NULL) || (fsnap_len(snap) == 0)) {
+        fprintf(stderr, "Failed to read snapshot '%s'\n", snapshot_path);
+        fsnap_drop(&snap);
+        return NULL;
+    }
+
+    return snap;
+}
+
+/* Replay recorded snapshot, common directory of its paths becomes simulated root */
+static struct dirwd_memfs_t* bench_replay(const struct fsnap_t* snap, const struct dirwd_memfs_opts_t* opts) {
+    /* Common parent directory of all paths */
+    const char* first = fsnap_path(snap, 0);
+    size_t root_len = (size_t) (strrchr(first, '/') - first);
+    for (size_t i = 1; i < fsnap_len(snap); i++) {
+        const char* path = fsnap_path(snap, i);
+
+        while ((root_len > 0) && ((strncmp(path, first, root_len) != 0) || (path[root_len] != '/'))) {
+            do {
+                root_len--;
+            } while ((root_len > 0) && (first[root_len] != '/'));
+        }
+    }
+
+    char root[PATH_MAX];
+    snprintf(root, sizeof(root), "%.*s", (int) root_len, first);
+
+    struct dirwd_memfs_t* memfs = dirwd_memfs_new(root, opts);
+    const size_t added = dirwd_memfs_replay(memfs, snap);
+    printf("Replayed %zu of %zu files below '%s'\n", added, fsnap_len(snap), root);
+
+    return memfs;
+}
+
+/* Main ---------------------------------------------------------------------*/
+
+int main(int argc, char** argv) {
+    const size_t fanout = arg_size(argc, argv, 1, BENCH_DEFAULT_FANOUT);
+    const size_t depth = arg_size(argc, argv, 2, BENCH_DEFAULT_DEPTH);
+    const size_t files_per_dir = arg_size(argc, argv, 3, BENCH_DEFAULT_FILES);
+    const size_t rounds = arg_size(argc, argv, 4, BENCH_DEFAULT_ROUNDS);
+    const size_t stat_latency_ns = arg_size(argc, argv, 5, 0);
+    const size_t threads = arg_size(argc, argv, 6, BENCH_DEFAULT_THREADS);
+    const int snapshots = (argc > 7) ? argc - 7 : 0;
+
+    const struct dirwd_memfs_opts_t memfs_opts = {
+        .seed = BENCH_SEED,
+        .opendir_latency_ns = stat_latency_ns,
+        .stat_latency_ns = stat_latency_ns,
+    };
+
+    /* Last recorded snapshot, changes to the next one are replayed in each round */
+    struct fsnap_t* recorded = NULL;
+    struct dirwd_memfs_t* memfs = NULL;
+    if (snapshots > 0) {
+        recorded = bench_read(argv[7]);
+        memfs = (recorded != NULL) ? bench_replay(recorded, &memfs_opts) : NULL;
+    } else {
+        memfs = dirwd_memfs_new(BENCH_ROOT, &memfs_opts);
+        dirwd_memfs_generate(memfs, fanout, depth, files_per_dir);
+    }
+
+    if (memfs == NULL) {
+        fsnap_drop(&recorded);
+        return EXIT_FAILURE;
+    }
+
+    printf("Simulated tree: %zu directories, %zu files, latency %zu ns, %zu threads\n",
+        memfs->dirs, memfs->files, stat_latency_ns, threads);
+
+    /* Events go to ring file only, syslog would dominate output time */
+    struct dirwd_output_opts_t output_opts;
+    memset(&output_opts, 0, sizeof(struct dirwd_output_opts_t));
+    output_opts.sinks = DIRWD_OUTPUT_RING;
+    output_opts.ring_slots = DIRWD_RING_DEFAULT_SLOTS;
+    snprintf(output_opts.ring_path, sizeof(output_opts.ring_path), "/tmp/dirwd_simbench_%d.ring", (int) getpid());
+
+    struct dirwd_output_t output;
+    if (dirwd_output_open(&output, &output_opts) != DIRWD_SUCCESS) {
+        fprintf(stderr, "Failed to open event ring '%s'\n", output_opts.ring_path);
+        dirwd_memfs_drop(&memfs);
+        fsnap_drop(&recorded);
+        return EXIT_FAILURE;
+    }
+
+    const struct dirwd_scan_opts_t scan_opts = {
+        .threads = threads,
+        .one_fs = true,
+        .follow_symlinks = true,
+        .inode_order = false,
+        .filter = NULL,
+        .filter_ctx = NULL,
+        .prof = NULL,
+        .fs = dirwd_memfs_ops(),
+        .fs_ctx = memfs,
+    };
+
+    struct fsnap_t* old_snap = fsnap_new();
+    dirwd_scan_tree(old_snap, memfs->root, &scan_opts);
+    fsnap_seal(old_snap);
+
+    printf("%-8s %10s %10s %10s %10s %10s\n", "round", "scan, ms", "seal, ms", "diff, ms", "output, ms", "events");
+
+    /* With later snapshots there is one round per recorded change */
+    const size_t replay_rounds = (snapshots > 1) ? (size_t) (snapshots - 1) : rounds;
+
+    for (size_t round = 0; round < replay_rounds; round++) {
+        if (snapshots > 1) {
+            struct fsnap_t* next = bench_read(argv[8 + round]);
+            if (next == NULL) {
+                break;
+            }
+
+            struct fsnap_diff_t recorded_diff;
+            fsnap_diff(recorded, next, &recorded_diff);
+            dirwd_memfs_apply(memfs, recorded, next, &recorded_diff, NULL);
+            fsnap_diff_clean(&recorded_diff);
+
+            fsnap_drop(&recorded);
+            recorded = next;
+        } else {
+            const struct dirwd_memfs_churn_t churn = {
+                .creates = memfs->files * BENCH_CREATE_PPM / 1000000,
+                .removes = memfs->files * BENCH_REMOVE_PPM / 1000000,
+                .modifies = memfs->files * BENCH_MODIFY_PPM / 1000000,
+                .create_dirs = 0,
+            };
+            dirwd_memfs_churn(memfs, &churn, NULL);
+        }
+
+        const double scan_start = now_sec();
+        struct fsnap_t* new_snap = fsnap_new();
+        dirwd_scan_tree(new_snap, memfs->root, &scan_opts);
+
+        const double seal_start = now_sec();
+        fsnap_seal(new_snap);
+
+        const double diff_start = now_sec();
+        struct fsnap_diff_t diff;
+        fsnap_diff(old_snap, new_snap, &diff);
+
+        const double output_start = now_sec();
+        dirwd_output_diff(&output, old_snap, new_snap, &diff);
+        const double output_end = now_sec();
+
+        const size_t events = diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len;
+        printf("%-8zu %10.3f %10.3f %10.3f %10.3f %10zu\n",
+            round,
+            (seal_start - scan_start) * 1e3,
+            (diff_start - seal_start) * 1e3,
+            (output_start - diff_start) * 1e3,
+            (output_end - output_start) * 1e3,
+            events);
+
+        fsnap_diff_clean(&diff);
+        fsnap_drop(&old_snap);
+        old_snap = new_snap;
+    }
+
+    fsnap_drop(&old_snap);
+    fsnap_drop(&recorded);
+    dirwd_output_close(&output);
+    unlink(output_opts.ring_path);
+    dirwd_memfs_drop(&memfs);
+
+    return EXIT_SUCCESS;
+}
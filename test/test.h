@@ -0,0 +1,35 @@
+/**
+ * @file test.h
+ * @date 18 Oct 2026
+ * @brief Minimal unit test helpers
+ */
+
+#ifndef __TEST_TEST_H__
+#define __TEST_TEST_H__
+
+#include <stdio.h>
+
+/* Define -------------------------------------------------------------------*/
+
+#define TEST_ASSERT(cond)                                                     \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n",                  \
+                __FILE__, __LINE__, #cond);                                   \
+            test_failures++;                                                  \
+        }                                                                     \
+    } while (0)
+
+#define TEST_RUN(test_fn)                                                     \
+    do {                                                                      \
+        const unsigned failures_before = test_failures;                       \
+        test_fn();                                                            \
+        printf("%-48s %s\n", #test_fn,                                        \
+            (test_failures == failures_before) ? "ok" : "FAILED");            \
+    } while (0)
+
+/* Constants ----------------------------------------------------------------*/
+
+static unsigned test_failures = 0;
+
+#endif /* __TEST_TEST_H__ */
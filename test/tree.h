@@ -0,0 +1,180 @@
+/**
+ * @file tree.h
+ * @date 18 Oct 2026
+ * @brief Temporary directory tree fixture inspected like the daemon does
+ *
+ * Tree is created under /tmp and scanned by tree_inspect in the same steps
+ * as daemon inspection, with tiers or fanotify source set by the test.
+ */
+
+#ifndef __TEST_TREE_H__
+#define __TEST_TREE_H__
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "../src/util/fsnap.h"
+#include "../src/daemon/dirwd_scan.h"
+#include "../src/daemon/dirwd_tier.h"
+#include "../src/daemon/dirwd_fan.h"
+
+/* Define -------------------------------------------------------------------*/
+
+#define TREE_SCAN_THREADS ((size_t) 2)
+
+/* Constants ----------------------------------------------------------------*/
+
+/* Structures ---------------------------------------------------------------*/
+
+struct tree_t {
+    char root[PATH_MAX];
+    struct fsnap_t* entries; /* Baseline of next inspection */
+    struct dirwd_tier_t* tiers; /* NULL unless set by test, dropped with tree */
+    struct dirwd_fan_t* fan; /* NULL unless set by test, closed with tree */
+};
+
+/* Function definitions -----------------------------------------------------*/
+
+static inline struct dirwd_scan_opts_t tree_scan_opts() {
+    const struct dirwd_scan_opts_t scan_opts = {
+        .threads = TREE_SCAN_THREADS,
+        .one_fs = false,
+        .follow_symlinks = true,
+        .inode_order = false,
+        .filter = NULL,
+        .filter_ctx = NULL,
+        .prof = NULL,
+        .fs = NULL,
+        .fs_ctx = NULL,
+    };
+
+    return scan_opts;
+}
+
+static inline bool tree_path(const struct tree_t* tree, const char* name, char* path) {
+    const bool is_fit = (snprintf(path, PATH_MAX, "%s/%s", tree->root, name) < PATH_MAX);
+    TEST_ASSERT(is_fit);
+    return is_fit;
+}
+
+static inline void tree_remove(const char* path) {
+    char command[PATH_MAX + 16];
+    TEST_ASSERT(snprintf(command, sizeof(command), "rm -rf '%s'", path) < (int) sizeof(command));
+    TEST_ASSERT(system(command) == 0);
+}
+
+/* Empty tree in new directory under /tmp named by prefix */
+static inline bool tree_create(struct tree_t* tree, const char* prefix) {
+    tree->entries = NULL;
+    tree->tiers = NULL;
+    tree->fan = NULL;
+
+    const bool is_created = (snprintf(tree->root, sizeof(tree->root), "/tmp/%s_XXXXXX", prefix) < (int) sizeof(tree->root))
+        && (mkdtemp(tree->root) != NULL);
+    TEST_ASSERT(is_created);
+
+    tree->entries = is_created ? fsnap_new() : NULL;
+    return is_created;
+}
+
+static inline void tree_destroy(struct tree_t* tree) {
+    tree_remove(tree->root);
+    fsnap_drop(&tree->entries);
+    dirwd_tier_drop(&tree->tiers);
+    dirwd_fan_close(&tree->fan);
+}
+
+/* Append data to file, file is created if missing */
+static inline void tree_write(const struct tree_t* tree, const char* name, const char* data) {
+    char path[PATH_MAX];
+    if (!tree_path(tree, name, path)) {
+        return;
+    }
+
+    FILE* const fout = fopen(path, "a");
+    TEST_ASSERT(fout != NULL);
+    if (fout != NULL) {
+        fputs(data, fout);
+        fclose(fout);
+    }
+}
+
+static inline void tree_mkdir(const struct tree_t* tree, const char* name) {
+    char path[PATH_MAX];
+    TEST_ASSERT(tree_path(tree, name, path) && (mkdir(path, 0700) == 0));
+}
+
+static inline void tree_symlink(const struct tree_t* tree, const char* target, const char* name) {
+    char path[PATH_MAX];
+    TEST_ASSERT(tree_path(tree, name, path) && (symlink(target, path) == 0));
+}
+
+static inline void tree_rename(const struct tree_t* tree, const char* from, const char* to) {
+    char from_path[PATH_MAX];
+    char to_path[PATH_MAX];
+    TEST_ASSERT(tree_path(tree, from, from_path) && tree_path(tree, to, to_path)
+        && (rename(from_path, to_path) == 0));
+}
+
+/* Same steps as daemon inspection, returns number of events */
+static inline size_t tree_inspect(struct tree_t* tree, struct fsnap_diff_t* diff) {
+    struct dirwd_scan_opts_t scan_opts = tree_scan_opts();
+
+    if (tree->tiers != NULL) {
+        dirwd_tier_begin(tree->tiers);
+        scan_opts.filter = dirwd_tier_filter;
+        scan_opts.filter_ctx = tree->tiers;
+    } else if (tree->fan != NULL) {
+        dirwd_fan_begin(tree->fan);
+        scan_opts.filter = dirwd_fan_filter;
+        scan_opts.filter_ctx = tree->fan;
+    }
+
+    struct fsnap_t* new_snap = fsnap_new();
+    dirwd_scan_tree(new_snap, tree->root, &scan_opts);
+    dirwd_tier_carry(tree->tiers, tree->entries, new_snap);
+    dirwd_fan_carry(tree->fan, tree->entries, new_snap);
+    fsnap_seal(new_snap);
+
+    fsnap_diff(tree->entries, new_snap, diff);
+    dirwd_tier_update(tree->tiers, tree->entries, new_snap, diff);
+    dirwd_fan_end(tree->fan);
+
+    fsnap_drop(&tree->entries);
+    tree->entries = new_snap;
+
+    return diff->new_entries.len + diff->deleted_entries.len + diff->modified_entries.len;
+}
+
+static inline size_t tree_inspect_count(struct tree_t* tree) {
+    struct fsnap_diff_t diff;
+    const size_t events = tree_inspect(tree, &diff);
+    fsnap_diff_clean(&diff);
+    return events;
+}
+
+/* Baseline must be equal to full scan */
+static inline bool tree_is_consistent(const struct tree_t* tree) {
+    const struct dirwd_scan_opts_t scan_opts = tree_scan_opts();
+    struct fsnap_t* full_snap = fsnap_new();
+    dirwd_scan_tree(full_snap, tree->root, &scan_opts);
+    fsnap_seal(full_snap);
+
+    struct fsnap_diff_t diff;
+    fsnap_diff(tree->entries, full_snap, &diff);
+    const bool is_consistent = (diff.new_entries.len + diff.deleted_entries.len + diff.modified_entries.len == 0)
+        && (fsnap_len(tree->entries) == fsnap_len(full_snap));
+
+    fsnap_diff_clean(&diff);
+    fsnap_drop(&full_snap);
+    return is_consistent;
+}
+
+#endif /* __TEST_TREE_H__ */